@@ -12,12 +12,18 @@ LOCAL_SRC_FILES := \
 	$(wildcard $(LOCAL_PATH)/src/*.cpp) \
 	$(wildcard $(LOCAL_PATH)/src/math/*.cpp) \
 	$(wildcard $(LOCAL_PATH)/src/math/collision/*.cpp) \
+	$(wildcard $(LOCAL_PATH)/src/utils/*.cpp) \
 	$(wildcard $(LOCAL_PATH)/src/graphics/*.cpp) \
-	$(wildcard $(LOCAL_PATH)/src/graphics/glutils/*.cpp))
+	$(wildcard $(LOCAL_PATH)/src/graphics/glutils/*.cpp) \
+	$(wildcard $(LOCAL_PATH)/src/graphics/g2d/*.cpp) \
+	$(wildcard $(LOCAL_PATH)/src/graphics/g3d/*.cpp) \
+	$(wildcard $(LOCAL_PATH)/src/graphics/g3d/utils/*.cpp) \
+	$(wildcard $(LOCAL_PATH)/src/maps/*.cpp) \
+	$(wildcard $(LOCAL_PATH)/src/scenes/scene2d/*.cpp))
 
 LOCAL_CFLAGS += -DGL_GLEXT_PROTOTYPES
 LOCAL_CPP_FEATURES := rtti exceptions
-LOCAL_LDLIBS := -ldl -lGLESv1_CM -lGLESv2 -lGLESv3 -llog -landroid
+LOCAL_LDLIBS := -ldl -lGLESv1_CM -lGLESv2 -lGLESv3 -lEGL -llog -landroid
 
 LOCAL_SHARED_LIBRARIES := SDL2 SDL2_image
 
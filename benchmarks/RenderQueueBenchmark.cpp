@@ -0,0 +1,92 @@
+#include "graphics/g3d/utils/RenderQueue.h"
+#include "PerspectiveCamera.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+/** Times the sort of a RenderQueue of 100k renderables: computing the keys and the radix sort, as done once per frame. The
+ * renderables are spread over a few shaders, materials and meshes, a tenth of them blended. Sorting touches no GL state, so
+ * no window is created. */
+
+static const int RENDERABLES = 100000;
+static const int SHADERS = 16, MATERIALS = 256, MESHES = 1024;
+static const int FRAMES = 200;
+
+/** A shader that draws nothing, the queue only needs the instances to tell them apart. */
+class NullShader : public Shader{
+public:
+	void init () override {}
+	int compareTo (const Shader& other) override {return 0;}
+	bool canRender (const Renderable& instance) override {return true;}
+	void begin (const Camera& camera, RenderContext& context) override {}
+	void render (const Renderable& renderable) override {}
+	void end () override {}
+};
+
+/** An attribute with a value, so the materials hash differently. */
+class ValueAttribute : public Attribute{
+public:
+	static const uint64_t Type;
+	int value;
+
+	ValueAttribute (int value):Attribute(Type),value(value){}
+
+	std::shared_ptr<Attribute> copy () const override {
+		return std::make_shared<ValueAttribute>(value);
+	}
+
+	int compareTo (const Attribute& other) const override {
+		if (type != other.type) return Attribute::compareTo(other);
+		const int otherValue = static_cast<const ValueAttribute&>(other).value;
+		return value == otherValue ? 0 : value < otherValue ? -1 : 1;
+	}
+
+	int hashCode () const override {
+		return Attribute::hashCode() * 31 + value;
+	}
+};
+
+const uint64_t ValueAttribute::Type = registerType("benchmarkValue");
+
+int main (int argc, char* argv[]){
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> position(-500, 500);
+
+	std::vector<NullShader> shaders(SHADERS);
+	std::vector<std::shared_ptr<Material>> materials;
+	for (int i = 0; i < MATERIALS; i++)
+		materials.push_back(std::make_shared<Material>("material" + std::to_string(i),
+			std::vector<std::shared_ptr<Attribute>>{std::make_shared<ValueAttribute>(i)}));
+	std::vector<std::shared_ptr<Mesh>> meshes;
+	for (int i = 0; i < MESHES; i++) meshes.push_back(std::make_shared<Mesh>());
+
+	std::vector<Renderable> renderables(RENDERABLES);
+	for (Renderable& renderable : renderables) {
+		renderable.worldTransform.setToTranslation(position(random), position(random), position(random));
+		renderable.meshPart.mesh = meshes[random() % MESHES];
+		renderable.shader = &shaders[random() % SHADERS];
+		renderable.material = materials[random() % MATERIALS];
+		renderable.blended = random() % 10 == 0;
+		renderable.pass = random() % 2;
+	}
+
+	PerspectiveCamera camera(67, 1280, 720);
+	camera.far = 2000;
+	RenderQueue queue;
+	std::vector<double> times;
+	for (int frame = 0; frame < FRAMES; frame++) {
+		//The camera moves, so the depths and the order change each frame
+		camera.position.set(position(random), position(random), position(random));
+		camera.update();
+		const auto start = std::chrono::steady_clock::now();
+		for (const Renderable& renderable : renderables) queue.add(renderable);
+		queue.sort(camera);
+		times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		queue.clear();
+	}
+
+	std::sort(times.begin(), times.end());
+	SDL_Log("RenderQueue: %d renderables, %d frames, keys and sort: median %.2f ms, min %.2f ms, max %.2f ms", RENDERABLES,
+		FRAMES, times[times.size() / 2], times.front(), times.back());
+	return 0;
+}
@@ -0,0 +1,113 @@
+#include "LibGDXApplication.h"
+#include "graphics/Pixmap.h"
+#include "graphics/VertexAttribute.h"
+#include "graphics/g2d/SpriteBatch.h"
+#include "graphics/g2d/TextureRegion.h"
+#include <algorithm>
+#include <random>
+
+/** A scene of 100k sprites, each rotating around its center, drawn by one SpriteBatch every frame. After a warm up it logs the
+ * CPU time from begin to end of the batch, which includes the vertex upload and the draw calls, the frame rate, which vsync
+ * caps at the display rate, and the render calls per frame, then quits. Run it from a desktop session. */
+
+static const int SPRITES = 100000;
+static const int BATCH_SIZE = 8191;
+static const int WARMUP_FRAMES = 30, FRAMES = 300;
+
+/** Ignores input, the application loop hands events to the processor unconditionally. */
+class NullInputProcessor : public RawInputProcessor{
+public:
+	bool controllerAxisEvent (const SDL_ControllerAxisEvent& event) override {return false;}
+	bool controllerButtonEvent (const SDL_ControllerButtonEvent& event) override {return false;}
+	bool controllerDeviceEvent (const SDL_ControllerDeviceEvent& event) override {return false;}
+	bool touchFingerEvent (const SDL_TouchFingerEvent& event) override {return false;}
+	bool keyboardEvent (const SDL_KeyboardEvent& event) override {return false;}
+	bool mouseMotionEvent (const SDL_MouseMotionEvent& event) override {return false;}
+	bool mouseButtonEvent (const SDL_MouseButtonEvent& event) override {return false;}
+	bool mouseWheelEvent (const SDL_MouseWheelEvent& event) override {return false;}
+	bool multiGestureEvent (const SDL_MultiGestureEvent& event) override {return false;}
+};
+
+class SpriteBatchBenchmark : public ApplicationListener{
+	struct Sprite{
+		float x, y, rotation, speed;
+	};
+
+	std::unique_ptr<SpriteBatch> batch;
+	TextureRegion region;
+	std::vector<Sprite> sprites;
+	std::vector<double> batchTimes;
+	Uint64 firstFrame = 0;
+	int frame = 0, renderCalls = 0;
+	int width = 640, height = 480;
+public:
+	bool create () override {
+		setRawInputProcessor(std::make_shared<NullInputProcessor>());
+		Pixmap pixmap(32, 32, Pixmap::RGBA8888);
+		pixmap.setColor(1, 1, 1, 1);
+		pixmap.fill();
+		region = TextureRegion(std::make_shared<Texture>(pixmap, GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE,
+			false));
+		batch.reset(new SpriteBatch(BATCH_SIZE));
+
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> unit(0, 1);
+		for (int i = 0; i < SPRITES; i++)
+			sprites.push_back(Sprite{unit(random) * width, unit(random) * height, unit(random) * 360, 30 + unit(random) * 90});
+		return true;
+	}
+
+	void resize (int width, int height) override {
+		this->width = width;
+		this->height = height;
+		glViewport(0, 0, width, height);
+		if (batch) batch->setProjectionMatrix(Matrix4().setToOrtho2D(0, 0, width, height));
+	}
+
+	void render () override {
+		glClearColor(0, 0, 0, 1);
+		glClear(GL_COLOR_BUFFER_BIT);
+		for (Sprite& sprite : sprites) sprite.rotation += sprite.speed / 60;
+
+		const Uint64 start = SDL_GetPerformanceCounter();
+		batch->begin();
+		for (const Sprite& sprite : sprites)
+			batch->draw(region, sprite.x, sprite.y, 8, 8, 16, 16, 1, 1, sprite.rotation);
+		batch->end();
+		const double millis = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+		if (++frame <= WARMUP_FRAMES) {
+			firstFrame = SDL_GetPerformanceCounter();
+			return;
+		}
+		batchTimes.push_back(millis);
+		renderCalls = batch->renderCalls;
+		if (frame == WARMUP_FRAMES + FRAMES) {
+			const double seconds = (SDL_GetPerformanceCounter() - firstFrame) / (double)SDL_GetPerformanceFrequency();
+			std::sort(batchTimes.begin(), batchTimes.end());
+			SDL_Log("SpriteBatch: %d rotated sprites, %d frames, begin to end: median %.2f ms, max %.2f ms, %.1f FPS, "
+				"%d render calls", SPRITES, FRAMES, batchTimes[batchTimes.size() / 2], batchTimes.back(), FRAMES / seconds,
+				renderCalls);
+			SDL_Event quit;
+			quit.type = SDL_QUIT;
+			SDL_PushEvent(&quit);
+		}
+	}
+
+	void pause () override {}
+
+	void resume () override {}
+
+	void dispose () override {
+		batch.reset();
+		region.setTexture(nullptr);
+	}
+};
+
+int main (int argc, char* argv[]){
+	std::shared_ptr<DesktopConfiguration> config = std::make_shared<DesktopConfiguration>();
+	config->title = "SpriteBatch benchmark";
+	config->resizable = false;
+	LibGDX_Application application(config, std::make_shared<SpriteBatchBenchmark>());
+	return 0;
+}
@@ -1,4 +1,5 @@
 #include "LibGDXApplication.h"
+#include "graphics/glutils/ShaderProgram.h"
 
 bool LibGDX_Application::setAttributes(std::shared_ptr<DesktopConfiguration> desktop,std::shared_ptr<MobileConfiguration> mobile){
     #ifdef DESKTOP
@@ -77,6 +78,17 @@ LibGDX_Application::LibGDX_Application(std::shared_ptr<DesktopConfiguration> des
             return;
         }
 
+		#ifdef DESKTOP
+        const Configuration& config = *desktop;
+        #else
+        const Configuration& config = *mobile;
+        #endif
+        if(config.partialRedraw){
+            damageTracker = std::make_shared<DamageTracker>();
+            damageTracker->init(window);
+            listener->setDamageTracker(damageTracker);
+        }
+
 		//Let listener know that we're created now.
         SDL_Log("++CREATE GDXPP APPLISTENER++");
         if(!listener->create()){
@@ -106,6 +118,14 @@ LibGDX_Application::LibGDX_Application(std::shared_ptr<DesktopConfiguration> des
                                     continue;
                                 case SDL_WINDOWEVENT_SIZE_CHANGED:
                                     listener->resize(e.window.data1,e.window.data2);
+                                    if(damageTracker){
+                                        int width,height;
+                                        SDL_GL_GetDrawableSize(window,&width,&height);
+                                        damageTracker->resize(width,height);
+                                    }
+                                    break;
+                                case SDL_WINDOWEVENT_EXPOSED:
+                                    if(damageTracker) damageTracker->damageAll();
                                     break;
                                 case SDL_WINDOWEVENT_MINIMIZED:
                                     listener->pause();
@@ -114,6 +134,7 @@ LibGDX_Application::LibGDX_Application(std::shared_ptr<DesktopConfiguration> des
                                 case SDL_WINDOWEVENT_RESTORED:
                                     listener->resume();
                                     isPaused = false;
+                                    if(damageTracker) damageTracker->damageAll();
                                     break;
                             }
                         }
@@ -150,14 +171,34 @@ LibGDX_Application::LibGDX_Application(std::shared_ptr<DesktopConfiguration> des
                 }
 			}
 
-			if(!isPaused){
+			if(!isPaused && damageTracker){
+                //Only frames which are drawn count, so idle time doesn't age the textures of a static UI
+                ShaderProgram::updatePending();
+                listener->update();
+                if(damageTracker->hasDamage()){
+                    Texture::nextFrame();
+                    damageTracker->beginFrame();
+                    listener->render();
+                    damageTracker->endFrame(window);
+                    ShaderProgram::endFrameUniformStats();
+                }else{
+                    //Nothing changed, sleep until an event arrives or the next update is due
+                    SDL_WaitEventTimeout(NULL,config.idleWait);
+                }
+            }else if(!isPaused){
+                Texture::nextFrame();
+                ShaderProgram::updatePending();
                 listener->render();
                 SDL_GL_SwapWindow(window);
+                ShaderProgram::endFrameUniformStats();
             }
        }
         
 	   SDL_Log("--STOP GAME LOOP AND TEAR DOWN--");
        listener->dispose();
+       //The copy of the tracker is released while the context exists
+       listener->setDamageTracker(nullptr);
+       damageTracker.reset();
        SDL_GL_DeleteContext(glContext);
 	   SDL_DestroyWindow(window);
 	   SDL_Quit();
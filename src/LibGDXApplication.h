@@ -3,9 +3,11 @@
 #include <map>
 #include "GL.h"
 #include "RawInputProcessor.h"
+#include "graphics/glutils/DamageTracker.h"
 
 class ApplicationListener{
     std::shared_ptr<RawInputProcessor> input;
+    std::shared_ptr<DamageTracker> damageTracker;
 public:
 	virtual bool create() = 0;
 	virtual void resize(int width, int height) = 0;
@@ -13,9 +15,15 @@ public:
 	virtual void pause() = 0;
 	virtual void resume() = 0;
 	virtual void dispose() = 0;
+	/** Called before each render() in partial redraw mode, see Configuration::partialRedraw. Advances the application and
+	 * reports what changed to getDamageTracker(); render() is only called when something did. */
+	virtual void update(){}
 
 	void setRawInputProcessor(std::shared_ptr<RawInputProcessor> input){this->input = input;};
     std::shared_ptr<RawInputProcessor> getRawInputProcessor(){return input;}
+    void setDamageTracker(std::shared_ptr<DamageTracker> damageTracker){this->damageTracker = damageTracker;}
+    /** @return the tracker the changed regions are reported to, nullptr unless in partial redraw mode */
+    std::shared_ptr<DamageTracker> getDamageTracker(){return damageTracker;}
 };
 
 class Configuration{
@@ -25,6 +33,10 @@ public:
     int multiSampleBuffer = 0,multiSampleSamples = 0;
     void setAntiAlias(){multiSampleBuffer = 1;multiSampleSamples = 2;}
     void setBetterAntiAlias(){multiSampleBuffer = 1;multiSampleSamples = 4;}
+    /** Redraws only the regions reported to the DamageTracker, and nothing while none are, for mostly static UIs. */
+    bool partialRedraw = false;
+    /** the milliseconds to wait for events between updates while nothing is damaged, in partial redraw mode */
+    int idleWait = 16;
 };
 
 class DesktopConfiguration: public Configuration{
@@ -46,6 +58,7 @@ private:
     std::shared_ptr<ApplicationListener> listener;
     SDL_Window* window;
     SDL_GLContext glContext;
+    std::shared_ptr<DamageTracker> damageTracker;
     
     void dispose();
     bool setAttributes(std::shared_ptr<DesktopConfiguration> desktop,std::shared_ptr<MobileConfiguration> mobile);
@@ -0,0 +1,144 @@
+#include "AsyncTextureLoader.h"
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+static void premultiplyAlpha (SDL_Surface* image) {
+    for (int y = 0; y < image->h; y++) {
+        Uint8* pixel = (Uint8*)image->pixels + y * image->pitch;
+        for (int x = 0; x < image->w; x++, pixel += 4) {
+            const int alpha = pixel[3];
+            pixel[0] = (pixel[0] * alpha + 127) / 255;
+            pixel[1] = (pixel[1] * alpha + 127) / 255;
+            pixel[2] = (pixel[2] * alpha + 127) / 255;
+        }
+    }
+}
+
+AsyncTextureLoader::AsyncTextureLoader(int threads, int bytesPerFrame, float millisPerFrame)
+    :decoding(0),bytesPerFrame(bytesPerFrame),millisPerFrame(millisPerFrame),pool(threads){}
+
+AsyncTextureLoader::~AsyncTextureLoader(){
+    for (Request& request : uploading)
+        if (request.glHandle != 0) GLStateCache::get().deleteTextures(1, &request.glHandle);
+    if (pixelBuffer != 0) glDeleteBuffers(1, &pixelBuffer);
+}
+
+std::shared_ptr<AsyncTexture> AsyncTextureLoader::load (const std::string& path, GLenum minFilter, GLenum magFilter,
+    GLenum uWrap, GLenum vWrap, bool useMipMaps, bool premultiply){
+    std::shared_ptr<AsyncTexture> handle = std::make_shared<AsyncTexture>(path);
+    decoding++;
+    pool.submit([=]{
+        SDL2::Surface image(IMG_Load(path.c_str()));
+        SDL2::Surface rgba;
+        if (image) rgba.reset(SDL_ConvertSurfaceFormat(image.get(), SDL_PIXELFORMAT_RGBA32, 0));
+        if (!rgba) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "AsyncTextureLoader: cannot load %s: %s", path.c_str(),
+                image ? SDL_GetError() : IMG_GetError());
+            handle->state = AsyncTexture::FAILED;
+            decoding--;
+            return;
+        }
+        if (premultiply) premultiplyAlpha(rgba.get());
+
+        Request request;
+        request.handle = handle;
+        request.image = rgba;
+        request.minFilter = minFilter;
+        request.magFilter = magFilter;
+        request.uWrap = uWrap;
+        request.vWrap = vWrap;
+        request.useMipMaps = useMipMaps;
+        handle->rows = rgba->h;
+
+        std::lock_guard<std::mutex> lock(decodedMutex);
+        decoded.push_back(request);
+        handle->state = AsyncTexture::UPLOADING;
+        decoding--;
+    });
+    return handle;
+}
+
+int AsyncTextureLoader::uploadBand (Request& request, int maxBytes){
+    SDL_Surface* image = request.image.get();
+    AsyncTexture& handle = *request.handle;
+    if (request.glHandle == 0) {
+        glGenTextures(1, &request.glHandle);
+        GLStateCache::get().bindTexture(GL_TEXTURE_2D, request.glHandle);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image->w, image->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    } else GLStateCache::get().bindTexture(GL_TEXTURE_2D, request.glHandle);
+
+    const int rowBytes = image->w * 4;
+    const int rows = std::max(1, std::min(image->h - handle.uploadedRows, maxBytes / rowBytes));
+    const int bytes = rows * rowBytes;
+
+    if (pixelBuffer == 0) glGenBuffers(1, &pixelBuffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+    //Orphan so mapping doesn't wait for the transfer of the previous band
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+    Uint8* mapped = (Uint8*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    const Uint8* source = (const Uint8*)image->pixels + handle.uploadedRows * image->pitch;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (mapped != NULL) {
+        for (int row = 0; row < rows; row++)
+            memcpy(mapped + row * rowBytes, source + row * image->pitch, rowBytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, handle.uploadedRows, image->w, rows, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    } else {
+        //RGBA32 rows are tightly packed, so the surface can be read directly
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, handle.uploadedRows, image->w, rows, GL_RGBA, GL_UNSIGNED_BYTE, source);
+    }
+    handle.uploadedRows += rows;
+    return bytes;
+}
+
+void AsyncTextureLoader::finish (Request& request){
+    if (request.useMipMaps) {
+        GLStateCache::get().bindTexture(GL_TEXTURE_2D, request.glHandle);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    request.handle->texture = std::make_shared<Texture>(GL_TEXTURE_2D, request.glHandle, request.image, request.minFilter,
+        request.magFilter, request.uWrap, request.vWrap, request.useMipMaps);
+    request.glHandle = 0;
+    request.handle->state = AsyncTexture::READY;
+}
+
+bool AsyncTextureLoader::update (){
+    {
+        std::lock_guard<std::mutex> lock(decodedMutex);
+        while (!decoded.empty()) {
+            uploading.push_back(decoded.front());
+            decoded.pop_front();
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    int budget = bytesPerFrame;
+    while (!uploading.empty()) {
+        Request& request = uploading.front();
+        budget -= uploadBand(request, std::max(budget, 0));
+        if (request.handle->uploadedRows >= request.image->h) {
+            finish(request);
+            uploading.pop_front();
+        }
+        const float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (budget <= 0 || elapsed >= millisPerFrame) break;
+    }
+    return getPending() == 0;
+}
+
+void AsyncTextureLoader::finishLoading (){
+    const int frameBytes = bytesPerFrame;
+    const float frameMillis = millisPerFrame;
+    setBudget(std::numeric_limits<int>::max(), std::numeric_limits<float>::max());
+    while (!update())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    setBudget(frameBytes, frameMillis);
+}
+
+int AsyncTextureLoader::getPending (){
+    std::lock_guard<std::mutex> lock(decodedMutex);
+    return decoding + decoded.size() + uploading.size();
+}
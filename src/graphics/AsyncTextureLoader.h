@@ -0,0 +1,103 @@
+#pragma once
+#include "../GL.h"
+#include "../utils/ThreadPool.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/** The result of an {@link AsyncTextureLoader#load} request. It is updated by the loader, query it from the GL thread. */
+class AsyncTexture{
+    friend class AsyncTextureLoader;
+public:
+    enum State{DECODING, UPLOADING, READY, FAILED};
+private:
+    std::atomic<int> state;
+    std::string path;
+    std::shared_ptr<Texture> texture;
+    int uploadedRows = 0;
+    /** set by the decoding thread */
+    std::atomic<int> rows;
+public:
+    AsyncTexture(const std::string& path):state(DECODING),path(path),rows(0){}
+
+    /** @return whether the texture is completely uploaded and can be used */
+    bool isReady () const {return state == READY;}
+
+    /** @return whether the image could not be read or decoded */
+    bool isFailed () const {return state == FAILED;}
+
+    State getState () const {return (State)state.load();}
+
+    /** @return the fraction of the image uploaded so far */
+    float getProgress () const {
+        return state == READY ? 1 : (rows > 0 ? uploadedRows / (float)rows : 0);
+    }
+
+    /** @return the texture, or nullptr until {@link #isReady()} */
+    std::shared_ptr<Texture> getTexture () const {return texture;}
+
+    const std::string& getPath () const {return path;}
+};
+
+/** Loads textures without stalling the render thread. Decoding, the conversion to RGBA and the optional alpha premultiplication
+ * run on a {@link ThreadPool}; the decoded images are then uploaded from {@link #update()} on the GL thread in bands of rows
+ * through a pixel buffer object, limited per frame by a byte and a time budget. Each request returns an {@link AsyncTexture}
+ * which reports when the texture is usable. Requires OpenGL ES 3.0 or OpenGL 2.1 for pixel buffer objects. */
+class AsyncTextureLoader{
+    struct Request{
+        std::shared_ptr<AsyncTexture> handle;
+        SDL2::Surface image;
+        GLenum minFilter, magFilter, uWrap, vWrap;
+        bool useMipMaps;
+        GLuint glHandle = 0;
+    };
+
+    std::mutex decodedMutex;
+    std::deque<Request> decoded;
+    std::deque<Request> uploading;
+    std::atomic<int> decoding;
+    GLuint pixelBuffer = 0;
+    int bytesPerFrame;
+    float millisPerFrame;
+    /** declared last so the workers are joined before the queues they fill are destroyed **/
+    ThreadPool pool;
+
+    /** Uploads the next band of rows of the request. @return the number of bytes uploaded */
+    int uploadBand (Request& request, int maxBytes);
+
+    void finish (Request& request);
+public:
+    /** @param threads the number of decoding threads, 0 for one less than the number of cores
+     * @param bytesPerFrame the number of bytes uploaded at most per {@link #update()}, at least one row is always uploaded
+     * @param millisPerFrame the time spent at most per {@link #update()} */
+    AsyncTextureLoader(int threads = 0, int bytesPerFrame = 4 * 1024 * 1024, float millisPerFrame = 2);
+    ~AsyncTextureLoader();
+    AsyncTextureLoader(const AsyncTextureLoader&) = delete;
+    AsyncTextureLoader& operator= (const AsyncTextureLoader&) = delete;
+
+    /** Queues the image at the given path, returns immediately.
+     * @param premultiplyAlpha whether to multiply the color channels by alpha while decoding */
+    std::shared_ptr<AsyncTexture> load (const std::string& path, GLenum minFilter, GLenum magFilter, GLenum uWrap, GLenum vWrap,
+        bool useMipMaps, bool premultiplyAlpha);
+
+    std::shared_ptr<AsyncTexture> load (const std::string& path) {
+        return load(path, GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, false, false);
+    }
+
+    /** Uploads decoded images within the frame budget. Call once per frame on the GL thread.
+     * @return whether every queued texture is ready */
+    bool update ();
+
+    /** Blocks until every queued texture is ready, e.g. behind a loading screen that doesn't animate. */
+    void finishLoading ();
+
+    /** @return the number of textures still decoding or uploading */
+    int getPending ();
+
+    void setBudget (int bytesPerFrame, float millisPerFrame) {
+        this->bytesPerFrame = bytesPerFrame;
+        this->millisPerFrame = millisPerFrame;
+    }
+};
@@ -52,13 +52,13 @@ void Mesh::render (ShaderProgram& shader, int primitiveType, int offset, int cou
 
 		if (autoBind) bind(shader);
 
-        int dataOffset = offset;
-        if(!isVertexArray) dataOffset = offset * 2;
-        
         if(indices->getNumIndices() > 0){
-            if(!isVertexArray && count + offset > indices->getNumMaxIndices())
-                SDL_Log("Mesh attempting to access memory outside of the index buffer (count: %i, offset: %i, max: %i)",count,dataOffset,indices->getNumMaxIndices());
-            glDrawElements(primitiveType, count, /*GL_UNSIGNED_SHORT*/GL_UNSIGNED_INT, /*&indices->getBuffer().data()[dataOffset]*/0);
+            if(count + offset > indices->getNumIndices())
+                SDL_Log("Mesh attempting to access memory outside of the index buffer (count: %i, offset: %i, max: %i)",count,offset,indices->getNumIndices());
+            //A byte offset into the bound buffer, or a pointer to the indices in memory
+            const void* first = indices->isBufferObject() ? (const void*)(offset * sizeof(GLuint)) :
+                (const void*)(indices->getData().data() + offset);
+            glDrawElements(primitiveType, count, GL_UNSIGNED_INT, first);
         }else glDrawArrays(primitiveType, offset, count);
         
 		if (autoBind) unbind(shader);
@@ -73,10 +73,12 @@ bool Mesh::hasVertexAttribute (int usage){
 }
 
 VertexAttribute& Mesh::getVertexAttribute (int usage){
-    VertexAttributes attributes = vertices->getAttributes();
+    VertexAttributes& attributes = vertices->getAttributes();
     int len = attributes.size();
     for (int i = 0; i < len; i++)
         if (attributes.get(i).usage == usage) return attributes.get(i);
+    SDL_Log("Mesh has no vertex attribute with usage %i", usage);
+    return attributes.get(0);
 }
 
 /*Mesh& Mesh::copy (bool isGL30,bool isStatic, bool removeDuplicates, const std::vector<int>& usage) {
@@ -220,8 +222,8 @@ float Mesh::calculateRadiusSquared (const float centerX, const float centerY, co
 		int numIndices = getNumIndices();
 		if (offset < 0 || count < 1 || offset + count > numIndices) SDL_Log("Not enough indices");
 
-		std::vector<GLfloat> verts = vertices->getBuffer();
-		std::vector<GLuint> index = indices->getBuffer();
+		const std::vector<GLfloat>& verts = vertices->getData();
+		const std::vector<GLuint>& index = indices->getData();
 		VertexAttribute posAttrib = getVertexAttribute(POSITION);
 		const int posoff = posAttrib.offset / 4;
 		const int vertexSize = vertices->getAttributes().vertexSize / 4;
@@ -269,8 +271,8 @@ BoundingBox Mesh::extendBoundingBox (BoundingBox& out, int offset, int count, co
 			SDL_Log("Invalid part specified ( offset=%i, count=%i, max=%i )",
                 offset,count,max);
 
-		const std::vector<GLfloat> verts = vertices->getBuffer();
-		const std::vector<GLuint> index = indices->getBuffer();
+		const std::vector<GLfloat>& verts = vertices->getData();
+		const std::vector<GLuint>& index = indices->getData();
 		const VertexAttribute posAttrib = getVertexAttribute(POSITION);
 		const int posoff = posAttrib.offset / 4;
 		const int vertexSize = vertices->getAttributes().vertexSize / 4;
@@ -314,7 +316,7 @@ BoundingBox Mesh::extendBoundingBox (BoundingBox& out, int offset, int count, co
 		case 3:
 			if (numIndices > 0) {
 				for (int i = offset; i < end; i++) {
-					const int idx = index[idx] * vertexSize + posoff;
+					const int idx = index[i] * vertexSize + posoff;
 					tmpV.set(verts[idx], verts[idx+1], verts[idx+2]);
 					tmpV.mul(transform);
 					out.ext(tmpV);
@@ -336,7 +338,7 @@ void Mesh::calculateBoundingBox (BoundingBox& bbox) {
 		int numVertices = getNumVertices();
 		if (numVertices == 0) SDL_Log("No vertices defined");
 
-		std::vector<GLfloat> verts = vertices->getBuffer();
+		const std::vector<GLfloat>& verts = vertices->getData();
 		bbox.inf();
 		VertexAttribute posAttrib = getVertexAttribute(POSITION);
 		int offset = posAttrib.offset / 4;
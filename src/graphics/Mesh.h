@@ -70,7 +70,6 @@ private:
 	Vector3 tmpV = Vector3();
 public:
     Mesh(){}
-    ~Mesh(){SDL_Log("MESH DESTROY!");}
     std::string toString(){
         std::stringstream ss;
 		ss<< "VERTICES:"<<vertices.get()<<",INDICES:"<<indices.get();
@@ -247,7 +246,7 @@ public:
         
         int counter = 0;
         for(int i = destOffset;i < destOffset+count;i++)
-            vertices[i] = getVerticesBuffer()[srcOffset+(counter++)];
+            vertices[i] = this->vertices->getData()[srcOffset+(counter++)];
 		return vertices;
 	}
 
@@ -310,7 +309,7 @@ public:
         
         int counter = 0;
         for(int i = destOffset;i < destOffset+count;i++)
-            indices[i] = getIndicesBuffer()[srcOffset+(counter++)];  
+            indices[i] = this->indices->getData()[srcOffset+(counter++)];  
 	}
 
 	/** @return the number of defined indices */
@@ -471,6 +470,11 @@ public:
 		return vertices->getBuffer();
 	}
 
+	/** @return the vertices, read only, so they aren't uploaded again */
+	const std::vector<GLfloat>& getVerticesData () const {
+		return vertices->getData();
+	}
+
 	/** Calculates the {@link BoundingBox} of the vertices contained in this mesh. In case no vertices are defined yet a
 	 * {@link GdxRuntimeException} is thrown.
 	 * 
@@ -582,6 +586,11 @@ public:
 	std::vector<GLuint>& getIndicesBuffer () {
 		return indices->getBuffer();
 	}
+
+	/** @return the indices, read only, so they aren't uploaded again */
+	const std::vector<GLuint>& getIndicesData () const {
+		return indices->getData();
+	}
     
     bool hasVertexAttribute (int usage);
 
@@ -0,0 +1,426 @@
+#include "Pixmap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define PIXMAP_SSE2 1
+#endif
+
+/** The source texels contributing to one destination texel along one axis, with their weights. */
+struct ScaleTaps{
+    std::vector<int> first;
+    std::vector<int> count;
+    std::vector<int> offset;
+    std::vector<float> weights;
+
+    void add (int index, const float* tapWeights, int tapCount) {
+        first.push_back(index);
+        count.push_back(tapCount);
+        offset.push_back(weights.size());
+        weights.insert(weights.end(), tapWeights, tapWeights + tapCount);
+    }
+};
+
+/** Computes the taps of destination texels [begin, end) when srcSize texels are stretched over dstSize. */
+static ScaleTaps computeTaps (int srcSize, int dstSize, Pixmap::Filter filter, int begin, int end) {
+    ScaleTaps taps;
+    const double scale = srcSize / (double)dstSize;
+    std::vector<float> weights;
+    for (int i = begin; i < end; i++) {
+        if (filter == Pixmap::NearestNeighbour) {
+            const float weight = 1;
+            taps.add(std::min(srcSize - 1, (int)((i + 0.5) * scale)), &weight, 1);
+        } else if (filter == Pixmap::BiLinear) {
+            const double center = (i + 0.5) * scale - 0.5;
+            const int index = (int)std::floor(center);
+            const float t = (float)(center - index);
+            const float pair[2] = {1 - t, t}, whole = 1;
+            //Past the centers of the edge texels the edge texel is repeated
+            if (index < 0) taps.add(0, &whole, 1);
+            else if (index >= srcSize - 1) taps.add(srcSize - 1, &whole, 1);
+            else taps.add(index, pair, 2);
+        } else {
+            //Coverage of each source texel by the footprint of the destination texel
+            const double low = i * scale, high = (i + 1) * scale;
+            const int first = std::min(srcSize - 1, (int)std::floor(low));
+            const int last = std::min(srcSize - 1, std::max(first, (int)std::ceil(high) - 1));
+            weights.clear();
+            for (int j = first; j <= last; j++)
+                weights.push_back((float)((std::min(j + 1.0, high) - std::max((double)j, low)) / scale));
+            taps.add(first, weights.data(), weights.size());
+        }
+    }
+    return taps;
+}
+
+static void colorToBytes (unsigned int color, unsigned char* rgba) {
+    rgba[0] = color >> 24;
+    rgba[1] = color >> 16;
+    rgba[2] = color >> 8;
+    rgba[3] = color;
+}
+
+/** Source over with straight alpha, done in floats so the SSE2 and scalar paths give the same result. */
+static inline void blendPixel (const unsigned char* src, unsigned char* dst) {
+    const int srcAlpha = src[3];
+    if (srcAlpha == 255) {
+        memcpy(dst, src, 4);
+        return;
+    }
+    if (srcAlpha == 0) return;
+    const float sa = srcAlpha, da = dst[3] * ((255 - sa) / 255), a = sa + da;
+    for (int c = 0; c < 3; c++) dst[c] = (unsigned char)((src[c] * sa + dst[c] * da) / a + 0.5f);
+    dst[3] = (unsigned char)(a + 0.5f);
+}
+
+#ifdef PIXMAP_SSE2
+static inline __m128 blendPixelSSE2 (__m128 src, __m128 dst, __m128 colorMask) {
+    const __m128 sa = _mm_shuffle_ps(src, src, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 da = _mm_mul_ps(_mm_shuffle_ps(dst, dst, _MM_SHUFFLE(3, 3, 3, 3)),
+        _mm_div_ps(_mm_sub_ps(_mm_set1_ps(255), sa), _mm_set1_ps(255)));
+    const __m128 a = _mm_add_ps(sa, da);
+    const __m128 color = _mm_div_ps(_mm_add_ps(_mm_mul_ps(src, sa), _mm_mul_ps(dst, da)), a);
+    return _mm_add_ps(_mm_or_ps(_mm_and_ps(colorMask, color), _mm_andnot_ps(colorMask, a)), _mm_set1_ps(0.5f));
+}
+#endif
+
+void Pixmap::blendRow (const unsigned char* src, unsigned char* dst, int n){
+    int i = 0;
+#ifdef PIXMAP_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i opaque = _mm_set1_epi32(255);
+    const __m128 colorMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    for (; i + 4 <= n; i += 4) {
+        const __m128i source = _mm_loadu_si128((const __m128i*)(src + i * 4));
+        const __m128i alpha = _mm_srli_epi32(source, 24);
+        //Runs of opaque or transparent texels, the common case in sprites and decals, skip the arithmetic
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, opaque)) == 0xFFFF) {
+            _mm_storeu_si128((__m128i*)(dst + i * 4), source);
+            continue;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xFFFF) continue;
+
+        const __m128i target = _mm_loadu_si128((const __m128i*)(dst + i * 4));
+        const __m128i srcLow = _mm_unpacklo_epi8(source, zero), srcHigh = _mm_unpackhi_epi8(source, zero);
+        const __m128i dstLow = _mm_unpacklo_epi8(target, zero), dstHigh = _mm_unpackhi_epi8(target, zero);
+        const __m128i p0 = _mm_cvttps_epi32(blendPixelSSE2(_mm_cvtepi32_ps(_mm_unpacklo_epi16(srcLow, zero)),
+            _mm_cvtepi32_ps(_mm_unpacklo_epi16(dstLow, zero)), colorMask));
+        const __m128i p1 = _mm_cvttps_epi32(blendPixelSSE2(_mm_cvtepi32_ps(_mm_unpackhi_epi16(srcLow, zero)),
+            _mm_cvtepi32_ps(_mm_unpackhi_epi16(dstLow, zero)), colorMask));
+        const __m128i p2 = _mm_cvttps_epi32(blendPixelSSE2(_mm_cvtepi32_ps(_mm_unpacklo_epi16(srcHigh, zero)),
+            _mm_cvtepi32_ps(_mm_unpacklo_epi16(dstHigh, zero)), colorMask));
+        const __m128i p3 = _mm_cvttps_epi32(blendPixelSSE2(_mm_cvtepi32_ps(_mm_unpackhi_epi16(srcHigh, zero)),
+            _mm_cvtepi32_ps(_mm_unpackhi_epi16(dstHigh, zero)), colorMask));
+        __m128i blended = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+        //Texels with a transparent source keep the destination, the arithmetic would divide 0 by 0 for them
+        const __m128i keep = _mm_cmpeq_epi32(alpha, zero);
+        blended = _mm_or_si128(_mm_and_si128(keep, target), _mm_andnot_si128(keep, blended));
+        _mm_storeu_si128((__m128i*)(dst + i * 4), blended);
+    }
+#endif
+    for (; i < n; i++) blendPixel(src + i * 4, dst + i * 4);
+}
+
+void Pixmap::decodeRow (Format format, const unsigned char* src, unsigned char* rgba, int n){
+    switch (format) {
+    case Alpha:
+        for (int i = 0; i < n; i++, rgba += 4) {
+            rgba[0] = rgba[1] = rgba[2] = 255;
+            rgba[3] = src[i];
+        }
+        break;
+    case LuminanceAlpha:
+        for (int i = 0; i < n; i++, src += 2, rgba += 4) {
+            rgba[0] = rgba[1] = rgba[2] = src[0];
+            rgba[3] = src[1];
+        }
+        break;
+    case RGB888:
+        for (int i = 0; i < n; i++, src += 3, rgba += 4) {
+            rgba[0] = src[0];
+            rgba[1] = src[1];
+            rgba[2] = src[2];
+            rgba[3] = 255;
+        }
+        break;
+    case RGBA8888:
+        memcpy(rgba, src, (size_t)n * 4);
+        break;
+    case RGB565:
+        for (int i = 0; i < n; i++, rgba += 4) {
+            unsigned short value;
+            memcpy(&value, src + i * 2, 2);
+            const int r = value >> 11, g = (value >> 5) & 63, b = value & 31;
+            rgba[0] = (r << 3) | (r >> 2);
+            rgba[1] = (g << 2) | (g >> 4);
+            rgba[2] = (b << 3) | (b >> 2);
+            rgba[3] = 255;
+        }
+        break;
+    case RGBA4444:
+        for (int i = 0; i < n; i++, rgba += 4) {
+            unsigned short value;
+            memcpy(&value, src + i * 2, 2);
+            rgba[0] = (value >> 12) * 17;
+            rgba[1] = ((value >> 8) & 15) * 17;
+            rgba[2] = ((value >> 4) & 15) * 17;
+            rgba[3] = (value & 15) * 17;
+        }
+        break;
+    }
+}
+
+void Pixmap::encodeRow (Format format, const unsigned char* rgba, unsigned char* dst, int n){
+    switch (format) {
+    case Alpha:
+        for (int i = 0; i < n; i++, rgba += 4) dst[i] = rgba[3];
+        break;
+    case LuminanceAlpha:
+        for (int i = 0; i < n; i++, rgba += 4, dst += 2) {
+            dst[0] = (rgba[0] * 54 + rgba[1] * 183 + rgba[2] * 19 + 128) >> 8;
+            dst[1] = rgba[3];
+        }
+        break;
+    case RGB888:
+        for (int i = 0; i < n; i++, rgba += 4, dst += 3) {
+            dst[0] = rgba[0];
+            dst[1] = rgba[1];
+            dst[2] = rgba[2];
+        }
+        break;
+    case RGBA8888:
+        memcpy(dst, rgba, (size_t)n * 4);
+        break;
+    case RGB565:
+        for (int i = 0; i < n; i++, rgba += 4) {
+            const unsigned short value = ((rgba[0] * 31 + 127) / 255) << 11 | ((rgba[1] * 63 + 127) / 255) << 5
+                | (rgba[2] * 31 + 127) / 255;
+            memcpy(dst + i * 2, &value, 2);
+        }
+        break;
+    case RGBA4444:
+        for (int i = 0; i < n; i++, rgba += 4) {
+            const unsigned short value = ((rgba[0] + 8) / 17) << 12 | ((rgba[1] + 8) / 17) << 8 | ((rgba[2] + 8) / 17) << 4
+                | (rgba[3] + 8) / 17;
+            memcpy(dst + i * 2, &value, 2);
+        }
+        break;
+    }
+}
+
+Pixmap::Pixmap(int width, int height, Format format)
+    :width(std::max(0, width)),height(std::max(0, height)),format(format){
+    pixels.assign((size_t)this->width * this->height * getBytesPerPixel(format), 0);
+}
+
+Pixmap::Pixmap(SDL2::Surface surface){
+    if (surface) loadSurface(surface.get());
+}
+
+Pixmap::Pixmap(const std::string& path){
+    SDL2::Surface surface(IMG_Load(path.c_str()));
+    if (!surface) SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Pixmap: cannot load %s: %s", path.c_str(), IMG_GetError());
+    else loadSurface(surface.get());
+}
+
+void Pixmap::loadSurface (SDL_Surface* surface){
+    const bool hasAlpha = surface->format->Amask != 0;
+    SDL2::Surface converted(SDL_ConvertSurfaceFormat(surface, hasAlpha ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGB24, 0));
+    if (!converted) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Pixmap: cannot convert surface: %s", SDL_GetError());
+        return;
+    }
+    width = converted->w;
+    height = converted->h;
+    format = hasAlpha ? RGBA8888 : RGB888;
+    const size_t rowBytes = (size_t)width * getBytesPerPixel(format);
+    pixels.resize(rowBytes * height);
+    for (int y = 0; y < height; y++)
+        memcpy(pixels.data() + y * rowBytes, (unsigned char*)converted->pixels + (size_t)y * converted->pitch, rowBytes);
+}
+
+int Pixmap::getBytesPerPixel (Format format){
+    switch (format) {
+    case Alpha: return 1;
+    case LuminanceAlpha: case RGB565: case RGBA4444: return 2;
+    case RGB888: return 3;
+    default: return 4;
+    }
+}
+
+GLenum Pixmap::getGLFormat () const{
+    switch (format) {
+    case Alpha: return GL_ALPHA;
+    case LuminanceAlpha: return GL_LUMINANCE_ALPHA;
+    case RGB888: case RGB565: return GL_RGB;
+    default: return GL_RGBA;
+    }
+}
+
+GLenum Pixmap::getGLType () const{
+    switch (format) {
+    case RGB565: return GL_UNSIGNED_SHORT_5_6_5;
+    case RGBA4444: return GL_UNSIGNED_SHORT_4_4_4_4;
+    default: return GL_UNSIGNED_BYTE;
+    }
+}
+
+void Pixmap::writeRow (const unsigned char* rgba, int x, int y, int n, std::vector<unsigned char>& scratch){
+    unsigned char* dst = pixels.data() + ((size_t)y * width + x) * getBytesPerPixel(format);
+    if (blending == None) {
+        encodeRow(format, rgba, dst, n);
+    } else if (format == RGBA8888) {
+        blendRow(rgba, dst, n);
+    } else {
+        scratch.resize((size_t)n * 4);
+        decodeRow(format, dst, scratch.data(), n);
+        blendRow(rgba, scratch.data(), n);
+        encodeRow(format, scratch.data(), dst, n);
+    }
+}
+
+void Pixmap::fill (){
+    fillRectangle(0, 0, width, height, false);
+}
+
+void Pixmap::fillRectangle (int x, int y, int width, int height){
+    fillRectangle(x, y, width, height, blending == SourceOver && (color & 0xFF) != 255);
+}
+
+void Pixmap::fillRectangle (int x, int y, int width, int height, bool blend){
+    const int x0 = std::max(0, x), y0 = std::max(0, y);
+    const int x1 = std::min(this->width, x + width), y1 = std::min(this->height, y + height);
+    if (x1 <= x0 || y1 <= y0) return;
+    const int n = x1 - x0;
+    std::vector<unsigned char> row((size_t)n * 4), scratch;
+    for (int i = 0; i < n; i++) colorToBytes(color, row.data() + i * 4);
+    if (blend) {
+        for (int py = y0; py < y1; py++) writeRow(row.data(), x0, py, n, scratch);
+        return;
+    }
+    //Encode one row, copy it to the others
+    const int bpp = getBytesPerPixel(format);
+    const size_t rowBytes = (size_t)n * bpp;
+    unsigned char* first = pixels.data() + ((size_t)y0 * this->width + x0) * bpp;
+    encodeRow(format, row.data(), first, n);
+    for (int py = y0 + 1; py < y1; py++) memcpy(first + (size_t)(py - y0) * this->width * bpp, first, rowBytes);
+}
+
+void Pixmap::drawPixel (int x, int y, unsigned int color){
+    if (x < 0 || y < 0 || x >= width || y >= height) return;
+    unsigned char rgba[4];
+    colorToBytes(color, rgba);
+    std::vector<unsigned char> scratch;
+    writeRow(rgba, x, y, 1, scratch);
+}
+
+unsigned int Pixmap::getPixel (int x, int y) const{
+    if (x < 0 || y < 0 || x >= width || y >= height) return 0;
+    unsigned char rgba[4];
+    decodeRow(format, pixels.data() + ((size_t)y * width + x) * getBytesPerPixel(format), rgba, 1);
+    return (unsigned int)rgba[0] << 24 | rgba[1] << 16 | rgba[2] << 8 | rgba[3];
+}
+
+void Pixmap::drawPixmap (const Pixmap& pixmap, int srcX, int srcY, int srcWidth, int srcHeight, int dstX, int dstY,
+    int dstWidth, int dstHeight){
+    if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0 || pixmap.isEmpty() || isEmpty()) return;
+    const int srcBpp = getBytesPerPixel(pixmap.format), dstBpp = getBytesPerPixel(format);
+    std::vector<unsigned char> row, scratch;
+
+    if (srcWidth == dstWidth && srcHeight == dstHeight) {
+        //Clip against both pixmaps, moving the two rectangles together
+        int left = std::max(std::max(0, -srcX), -dstX), top = std::max(std::max(0, -srcY), -dstY);
+        int right = std::min(std::min(srcWidth, pixmap.width - srcX), width - dstX);
+        int bottom = std::min(std::min(srcHeight, pixmap.height - srcY), height - dstY);
+        if (right <= left || bottom <= top) return;
+        const int n = right - left;
+        //Opaque formats blend like a copy
+        const bool opaque = pixmap.format == RGB888 || pixmap.format == RGB565;
+        if (pixmap.format == format && (blending == None || opaque)) {
+            for (int y = top; y < bottom; y++)
+                memmove(pixels.data() + ((size_t)(dstY + y) * width + dstX + left) * dstBpp,
+                    pixmap.pixels.data() + ((size_t)(srcY + y) * pixmap.width + srcX + left) * srcBpp, (size_t)n * dstBpp);
+            return;
+        }
+        row.resize((size_t)n * 4);
+        for (int y = top; y < bottom; y++) {
+            decodeRow(pixmap.format, pixmap.pixels.data() + ((size_t)(srcY + y) * pixmap.width + srcX + left) * srcBpp,
+                row.data(), n);
+            writeRow(row.data(), dstX + left, dstY + y, n, scratch);
+        }
+        return;
+    }
+
+    //Scaling: the source rectangle is clamped to the source, the destination clipped to this pixmap
+    const int sx0 = std::max(0, srcX), sy0 = std::max(0, srcY);
+    const int sw = std::min(pixmap.width, srcX + srcWidth) - sx0, sh = std::min(pixmap.height, srcY + srcHeight) - sy0;
+    const int dx0 = std::max(0, dstX), dy0 = std::max(0, dstY);
+    const int dx1 = std::min(width, dstX + dstWidth), dy1 = std::min(height, dstY + dstHeight);
+    if (sw <= 0 || sh <= 0 || dx1 <= dx0 || dy1 <= dy0) return;
+    const int n = dx1 - dx0;
+    const ScaleTaps columns = computeTaps(sw, dstWidth, filter, dx0 - dstX, dx1 - dstX);
+    const ScaleTaps rows = computeTaps(sh, dstHeight, filter, dy0 - dstY, dy1 - dstY);
+
+    //Filter horizontally only the source rows the visible destination rows read
+    const int firstRow = rows.first.front();
+    const int lastRow = rows.first.back() + rows.count.back();
+    std::vector<float> horizontal((size_t)(lastRow - firstRow) * n * 4);
+    row.resize((size_t)sw * 4);
+    for (int y = firstRow; y < lastRow; y++) {
+        decodeRow(pixmap.format, pixmap.pixels.data() + ((size_t)(sy0 + y) * pixmap.width + sx0) * srcBpp, row.data(), sw);
+        float* out = horizontal.data() + (size_t)(y - firstRow) * n * 4;
+        for (int x = 0; x < n; x++, out += 4) {
+            const unsigned char* texel = row.data() + columns.first[x] * 4;
+            const float* weight = columns.weights.data() + columns.offset[x];
+#ifdef PIXMAP_SSE2
+            __m128 sum = _mm_setzero_ps();
+            for (int i = 0; i < columns.count[x]; i++) {
+                const __m128i value = _mm_cvtsi32_si128(*(const int*)(texel + i * 4));
+                const __m128i wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(value, _mm_setzero_si128()), _mm_setzero_si128());
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weight[i]), _mm_cvtepi32_ps(wide)));
+            }
+            _mm_storeu_ps(out, sum);
+#else
+            out[0] = out[1] = out[2] = out[3] = 0;
+            for (int i = 0; i < columns.count[x]; i++)
+                for (int c = 0; c < 4; c++) out[c] += weight[i] * texel[i * 4 + c];
+#endif
+        }
+    }
+
+    std::vector<unsigned char> result((size_t)n * 4);
+    for (int y = 0; y < dy1 - dy0; y++) {
+        for (int x = 0; x < n; x++) {
+            float sum[4] = {0, 0, 0, 0};
+            for (int i = 0; i < rows.count[y]; i++) {
+                const float weight = rows.weights[rows.offset[y] + i];
+                const float* texel = horizontal.data() + ((size_t)(rows.first[y] + i - firstRow) * n + x) * 4;
+                for (int c = 0; c < 4; c++) sum[c] += weight * texel[c];
+            }
+            for (int c = 0; c < 4; c++) result[x * 4 + c] = (unsigned char)std::min(255.0f, std::max(0.0f, sum[c] + 0.5f));
+        }
+        writeRow(result.data(), dx0, dy0 + y, n, scratch);
+    }
+}
+
+Pixmap Pixmap::convert (Format format) const{
+    Pixmap result(width, height, format);
+    result.blending = None;
+    result.drawPixmap(*this, 0, 0);
+    result.blending = blending;
+    result.filter = filter;
+    result.color = color;
+    return result;
+}
+
+Pixmap Pixmap::scale (int width, int height) const{
+    Pixmap result(width, height, format);
+    result.blending = None;
+    result.filter = filter;
+    result.drawPixmap(*this, 0, 0, this->width, this->height, 0, 0, width, height);
+    result.blending = blending;
+    result.color = color;
+    return result;
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "../GL.h"
+#include "Color.h"
+#include <string>
+#include <vector>
+
+/** An image in CPU memory with an explicit pixel format, for composing images every few frames, e.g. minimaps or decals, and
+ * uploading them with {@link Texture#load(const Pixmap&)} or {@link Texture#draw(const Pixmap&, int, int)}.
+ * <p>
+ * Colors are passed as RGBA8888 ints, 0xRRGGBBAA. Drawing works on rows: the source is converted to RGBA8888, blended with
+ * SSE2 where available and converted to the destination format, with plain copies when the formats match and blending is off.
+ * Blending is source over with straight, not premultiplied, alpha. The origin is the top left corner, rows are tightly packed.
+ * Alpha pixmaps read as white with the stored alpha. */
+class Pixmap{
+public:
+    enum Format{
+        Alpha, LuminanceAlpha, RGB888, RGBA8888, RGB565, RGBA4444
+    };
+
+    enum Blending{
+        None, SourceOver
+    };
+
+    enum Filter{
+        NearestNeighbour,
+        /** interpolates the 4 nearest texels, for enlarging or reducing less than 2 times */
+        BiLinear,
+        /** averages every texel covered by the destination texel, for reducing */
+        Box
+    };
+private:
+    int width = 0, height = 0;
+    Format format = RGBA8888;
+    std::vector<unsigned char> pixels;
+    unsigned int color = 0;
+    Blending blending = SourceOver;
+    Filter filter = BiLinear;
+
+    /** Converts n pixels of the given format to RGBA8888 bytes. */
+    static void decodeRow (Format format, const unsigned char* src, unsigned char* rgba, int n);
+
+    /** Converts n RGBA8888 pixels to the given format. */
+    static void encodeRow (Format format, const unsigned char* rgba, unsigned char* dst, int n);
+
+    /** Blends n RGBA8888 pixels over n RGBA8888 pixels in place. */
+    static void blendRow (const unsigned char* src, unsigned char* dst, int n);
+
+    /** Writes n RGBA8888 pixels to row y starting at x, blending if enabled. The pixels must be inside.
+     * @param scratch holds the decoded destination when blending into formats other than RGBA8888 */
+    void writeRow (const unsigned char* rgba, int x, int y, int n, std::vector<unsigned char>& scratch);
+
+    void fillRectangle (int x, int y, int width, int height, bool blend);
+
+    void loadSurface (SDL_Surface* surface);
+public:
+    Pixmap(){}
+
+    Pixmap(int width, int height, Format format);
+
+    /** Copies an SDL surface, as RGBA8888 if it has an alpha channel, RGB888 otherwise. */
+    Pixmap(SDL2::Surface surface);
+
+    /** Loads an image file with SDL_image. The pixmap is empty if the file can't be read. */
+    Pixmap(const std::string& path);
+
+    int getWidth () const {return width;}
+    int getHeight () const {return height;}
+    Format getFormat () const {return format;}
+    bool isEmpty () const {return pixels.empty();}
+
+    unsigned char* getPixels () {return pixels.data();}
+    const unsigned char* getPixels () const {return pixels.data();}
+
+    static int getBytesPerPixel (Format format);
+
+    /** @return the GL format for glTexImage2D, e.g. GL_RGBA */
+    GLenum getGLFormat () const;
+
+    /** @return the GL type for glTexImage2D, e.g. GL_UNSIGNED_SHORT_5_6_5 */
+    GLenum getGLType () const;
+
+    /** Sets the color used by {@link #fill()}, {@link #fillRectangle} and {@link #drawPixel(int, int)}.
+     * @param color 0xRRGGBBAA */
+    void setColor (unsigned int color) {this->color = color;}
+
+    void setColor (float r, float g, float b, float a) {color = Color::rgba8888(r, g, b, a);}
+
+    void setColor (const Color& color) {this->color = Color::rgba8888(color);}
+
+    /** Sets whether drawing blends with the existing pixels. {@link #fill()} never blends. */
+    void setBlending (Blending blending) {this->blending = blending;}
+
+    Blending getBlending () const {return blending;}
+
+    /** Sets the filter used when {@link #drawPixmap} scales. */
+    void setFilter (Filter filter) {this->filter = filter;}
+
+    Filter getFilter () const {return filter;}
+
+    /** Fills the whole pixmap with the color, ignoring blending. */
+    void fill ();
+
+    /** Fills a rectangle with the color, clipped to the pixmap. */
+    void fillRectangle (int x, int y, int width, int height);
+
+    void drawPixel (int x, int y) {drawPixel(x, y, color);}
+
+    /** Draws a pixel of the given RGBA8888 color, ignored outside the pixmap. */
+    void drawPixel (int x, int y, unsigned int color);
+
+    /** @return the RGBA8888 color of the pixel, 0 outside the pixmap */
+    unsigned int getPixel (int x, int y) const;
+
+    /** Draws the whole pixmap with its top left corner at x, y. */
+    void drawPixmap (const Pixmap& pixmap, int x, int y) {
+        drawPixmap(pixmap, 0, 0, pixmap.width, pixmap.height, x, y, pixmap.width, pixmap.height);
+    }
+
+    /** Draws a part of the pixmap with its top left corner at dstX, dstY. */
+    void drawPixmap (const Pixmap& pixmap, int srcX, int srcY, int srcWidth, int srcHeight, int dstX, int dstY) {
+        drawPixmap(pixmap, srcX, srcY, srcWidth, srcHeight, dstX, dstY, srcWidth, srcHeight);
+    }
+
+    /** Draws a part of the pixmap into a rectangle of this pixmap, scaling it with the {@link #getFilter() filter} if the sizes
+     * differ. Both rectangles are clipped. */
+    void drawPixmap (const Pixmap& pixmap, int srcX, int srcY, int srcWidth, int srcHeight, int dstX, int dstY, int dstWidth,
+        int dstHeight);
+
+    /** @return a copy of the pixmap in another format */
+    Pixmap convert (Format format) const;
+
+    /** @return a copy of the pixmap resized to the given size with the {@link #getFilter() filter} */
+    Pixmap scale (int width, int height) const;
+};
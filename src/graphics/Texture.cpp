@@ -0,0 +1,42 @@
+#include "../GL.h"
+#include "Pixmap.h"
+
+unsigned int Texture::frame = 0;
+
+Texture::Texture (const Pixmap& pixmap,GLenum minFilter,GLenum magFilter,GLenum uWrap,GLenum vWrap,bool useMipMaps){
+    this->minFilter = minFilter;
+    this->magFilter = magFilter;
+    this->uWrap = uWrap;
+    this->vWrap = vWrap;
+    this->useMipMaps = useMipMaps;
+    glGenTextures(1, &glHandle);
+    load(pixmap);
+}
+
+void Texture::load (const Pixmap& pixmap){
+    width = pixmap.getWidth();
+    height = pixmap.getHeight();
+    const GLenum format = pixmap.getGLFormat(), type = pixmap.getGLType();
+
+    bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (useMipMaps && type == GL_UNSIGNED_BYTE) {
+        //Only color is stored in sRGB, alpha and luminance alpha are filtered linearly
+        const bool srgb = pixmap.getFormat() == Pixmap::RGB888 || pixmap.getFormat() == Pixmap::RGBA8888;
+        MipMapGenerator::uploadMipChain(glTarget, MipMapGenerator::generateMipChain(pixmap.getPixels(), width, height,
+            Pixmap::getBytesPerPixel(pixmap.getFormat()), MIPMAP_FILTER_KAISER, srgb), format);
+    } else {
+        glTexImage2D(glTarget, 0, format, width, height, 0, format, type, pixmap.getPixels());
+        if (useMipMaps) glGenerateMipmap(glTarget);
+    }
+    setFilter(minFilter, magFilter);
+    setWrap(uWrap, vWrap);
+    unbind(glTarget);
+}
+
+void Texture::draw (const Pixmap& pixmap, int x, int y){
+    bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(glTarget, 0, x, y, pixmap.getWidth(), pixmap.getHeight(), pixmap.getGLFormat(), pixmap.getGLType(),
+        pixmap.getPixels());
+}
@@ -18,8 +18,11 @@
 
 #include "../GL.h"
 #include "glutils/MipMapGenerator.h"
+#include "glutils/GLStateCache.h"
 //import com.badlogic.gdx.files.FileHandle;
 
+class Pixmap;
+
 /** A Texture wraps a standard OpenGL ES texture.
  * <p>
  * A Texture can be managed. If the OpenGL context is lost all managed textures get invalidated. This happens when a user switches
@@ -52,17 +55,25 @@ class Texture{
 	/** Used internally to reload after context loss. Creates a new GL handle then calls {@link #load(TextureData)}. Use this only
 	 * if you know what you do! */
 	void reload () {
+        if (!data) return;
         destroy();
 		glGenTextures(1, &glHandle);
+		appliedMinFilter = appliedMagFilter = appliedUWrap = appliedVWrap = 0;
 		load(data);
 	}
     
 	/** The target of this texture, used when binding the texture, e.g. GL_TEXTURE_2D */
-	GLenum glTarget;
-	GLuint glHandle;
+	GLenum glTarget = GL_TEXTURE_2D;
+	GLuint glHandle = 0;
 	GLenum minFilter = GL_NEAREST,magFilter = GL_NEAREST;
 	GLenum uWrap = GL_CLAMP_TO_EDGE,vWrap = GL_CLAMP_TO_EDGE;
-    bool useMipMaps;
+    bool useMipMaps = false;
+    int width = 0,height = 0;
+    /** the parameters set on the GL texture, so unchanged ones aren't set again */
+    GLenum appliedMinFilter = 0,appliedMagFilter = 0,appliedUWrap = 0,appliedVWrap = 0;
+    /** the frame this texture was last bound in, see {@link #nextFrame()} */
+    unsigned int lastBound = 0;
+    static unsigned int frame;
 public:
 	SDL2::Surface data;
     
@@ -77,9 +88,47 @@ public:
         data = SDL2::Surface(IMG_Load(internalPath.c_str()));
         if(!data)
             SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"IMG_Load: %s\n",IMG_GetError());
-        else load(data);
+        else {
+            glGenTextures(1, &glHandle);
+            load(data);
+        }
+    }
+    
+    /** Wraps a texture object whose image was already uploaded, e.g. by the {@link AsyncTextureLoader}. The texture takes
+     * ownership of the handle and applies the filters and wraps.
+     * @param data the uploaded image, kept for reloading after context loss */
+    Texture (int glTarget,GLuint glHandle,SDL2::Surface data,GLenum minFilter,GLenum magFilter,GLenum uWrap,GLenum vWrap,
+        bool useMipMaps){
+        this->glTarget = glTarget;
+        this->glHandle = glHandle;
+        this->data = data;
+        this->useMipMaps = useMipMaps;
+        if (data) {
+            width = data->w;
+            height = data->h;
+        }
+		setFilter(minFilter, magFilter);
+		setWrap(uWrap, vWrap);
+		unbind(glTarget);
+    }
+    
+    /** Wraps a texture object whose image was uploaded without an SDL surface, e.g. compressed data. It can't be reloaded after
+     * context loss. */
+    Texture (int glTarget,GLuint glHandle,int width,int height,GLenum minFilter,GLenum magFilter,GLenum uWrap,GLenum vWrap,
+        bool useMipMaps){
+        this->glTarget = glTarget;
+        this->glHandle = glHandle;
+        this->width = width;
+        this->height = height;
+        this->useMipMaps = useMipMaps;
+		setFilter(minFilter, magFilter);
+		setWrap(uWrap, vWrap);
+		unbind(glTarget);
     }
     
+    /** Creates a texture from a {@link Pixmap} in its own format. It can't be reloaded after context loss. */
+    Texture (const Pixmap& pixmap,GLenum minFilter,GLenum magFilter,GLenum uWrap,GLenum vWrap,bool useMipMaps);
+
     Texture (int glTarget,SDL2::Surface data){
         this->glTarget = glTarget;
         glGenTextures(1, &glHandle);
@@ -93,6 +142,8 @@ public:
 
 	void load (SDL2::Surface data) {
 		this->data = data;
+		width = data->w;
+		height = data->h;
         
         //Create image, set its properties.
         bind();
@@ -104,9 +155,13 @@ public:
 		unbind(glTarget);
 	}
     
+	/** Uploads the pixmap, replacing the image, with mip maps if the texture uses them. 8 bit color formats get filtered mip
+	 * maps from the {@link MipMapGenerator}, packed 16 bit formats glGenerateMipmap. */
+	void load (const Pixmap& pixmap);
+    
     void destroy(){
         if (glHandle != 0) {
-			glDeleteTextures(1,&glHandle);
+			GLStateCache::get().deleteTextures(1,&glHandle);
 			glHandle = 0;
 		}        
     }
@@ -122,13 +177,35 @@ public:
 		bind();
 		glTexSubImage2D(glTarget, 0, x, y, data->w, data->h, format, GL_UNSIGNED_BYTE,data->pixels);
 	}
-    
+
+	/** Draws the pixmap to the texture at position x, y in the pixmap's format, which should match the texture's. No clipping is
+	 * performed. Note that this will only draw to mipmap level 0! */
+	void draw (const Pixmap& pixmap, int x, int y);
+
+	/** Draws a sub rectangle of a tightly packed image to the texture at the same position, so only the changed part of a larger
+	 * CPU copy is uploaded. Note that this will only draw to mipmap level 0!
+	 *
+	 * @param pixels the whole image, rows of imageWidth texels
+	 * @param imageWidth the width of the whole image in texels
+	 * @param format GL_RGBA, GL_RGB or GL_ALPHA */
+	void draw (const unsigned char* pixels, int imageWidth, int x, int y, int width, int height, GLenum format) {
+		const int bytesPerPixel = format == GL_RGBA ? 4 : (format == GL_RGB ? 3 : 1);
+		bind();
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, imageWidth);
+		glTexSubImage2D(glTarget, 0, x, y, width, height, format, GL_UNSIGNED_BYTE,
+			pixels + ((size_t)y * imageWidth + x) * bytesPerPixel);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	}
+
     GLuint getTextureObjectHandle () {return glHandle;}
 
+    GLenum getTarget () {return glTarget;}
+
     //SDL_Surface data.
     SDL2::Surface getTextureData () {return data;}
-	int getWidth () {return data->w;}
-	int getHeight () {return data->h;}
+	int getWidth () {return width;}
+	int getHeight () {return height;}
 	int getDepth () {return data->pitch;}
     
     //Filters and wraps.
@@ -137,38 +214,57 @@ public:
     GLenum getUWrap () {return uWrap;}
     GLenum getVWrap () {return vWrap;}
     
-    static void unbind(GLenum target){glBindTexture(target, 0);}
+    static void unbind(GLenum target){GLStateCache::get().bindTexture(target, 0);}
+
+    /** Advances the frame counter recorded by {@link #bind()}, called once per frame by the application. */
+    static void nextFrame () {frame++;}
+
+    static unsigned int getFrame () {return frame;}
+
+    /** @return the frame this texture was last bound in, used by the {@link TextureResidencyManager} to find unused textures */
+    unsigned int getLastBoundFrame () {return lastBound;}
     
 	/** Binds this texture. The texture will be bound to the currently active texture unit specified via
-	 * {@link GL20#glActiveTexture(int)}. */
-	void bind () {glBindTexture(glTarget, glHandle);}
+	 * {@link GL20#glActiveTexture(int)}. Nothing is called if it is already bound there, see {@link GLStateCache}. */
+	void bind () {
+		lastBound = frame;
+		GLStateCache::get().bindTexture(glTarget, glHandle);
+	}
 
-	/** Binds the texture to the given texture unit. Sets the currently active texture unit via {@link GL20#glActiveTexture(int)}.
+	/** Binds the texture to the given texture unit. Sets the currently active texture unit via {@link GL20#glActiveTexture(int)},
+	 * unless the unit already holds the texture.
 	 * @param unit the unit (0 to MAX_TEXTURE_UNITS). */
 	void bind (int unit) {
-		glActiveTexture(GL_TEXTURE0 + unit);
-		glBindTexture(glTarget, glHandle);
+		lastBound = frame;
+		GLStateCache::get().bindTexture(unit, glTarget, glHandle);
 	}
 
-	/** Sets the {@link TextureWrap} for this texture on the u and v axis. This will bind this texture!
+	/** Sets the {@link TextureWrap} for this texture on the u and v axis. This will bind this texture if a wrap changes!
 	 * @param u the u wrap
 	 * @param v the v wrap */
 	void setWrap (GLenum u, GLenum v) {
 		this->uWrap = u;
 		this->vWrap = v;
+		if (u == appliedUWrap && v == appliedVWrap) return;
 		bind();
-		glTexParameterf(glTarget, GL_TEXTURE_WRAP_S, u);
-		glTexParameterf(glTarget, GL_TEXTURE_WRAP_T, v);
+		if (u != appliedUWrap) glTexParameterf(glTarget, GL_TEXTURE_WRAP_S, u);
+		if (v != appliedVWrap) glTexParameterf(glTarget, GL_TEXTURE_WRAP_T, v);
+		appliedUWrap = u;
+		appliedVWrap = v;
 	}
 
-	/** Sets the {@link GLenum} for this texture for minification and magnification. This will bind this texture!
+	/** Sets the {@link GLenum} for this texture for minification and magnification. This will bind this texture if a filter
+	 * changes!
 	 * @param minFilter the minification filter
 	 * @param magFilter the magnification filter */
 	void setFilter (GLenum minFilter, GLenum magFilter) {
 		this->minFilter = minFilter;
 		this->magFilter = magFilter;
+		if (minFilter == appliedMinFilter && magFilter == appliedMagFilter) return;
 		bind();
-		glTexParameterf(glTarget, GL_TEXTURE_MIN_FILTER, minFilter);
-		glTexParameterf(glTarget, GL_TEXTURE_MAG_FILTER, magFilter);
+		if (minFilter != appliedMinFilter) glTexParameterf(glTarget, GL_TEXTURE_MIN_FILTER, minFilter);
+		if (magFilter != appliedMagFilter) glTexParameterf(glTarget, GL_TEXTURE_MAG_FILTER, magFilter);
+		appliedMinFilter = minFilter;
+		appliedMagFilter = magFilter;
 	}
 };
\ No newline at end of file
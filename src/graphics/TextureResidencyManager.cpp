@@ -0,0 +1,223 @@
+#include "TextureResidencyManager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+TextureResidencyManager::TextureResidencyManager(size_t budget, int reducedSize, int threads)
+    :budget(budget),reducedSize(std::max(1, reducedSize)),pool(std::max(1, threads)){}
+
+size_t TextureResidencyManager::estimateBytes (int width, int height, int bytesPerPixel, bool mipMaps){
+    size_t bytes = (size_t)width * height * bytesPerPixel;
+    while (mipMaps && (width > 1 || height > 1)) {
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+        bytes += (size_t)width * height * bytesPerPixel;
+    }
+    return bytes;
+}
+
+std::vector<MipMapLevel> TextureResidencyManager::decode (const std::string& path){
+    SDL2::Surface image(IMG_Load(path.c_str()));
+    SDL2::Surface rgba;
+    if (image) rgba.reset(SDL_ConvertSurfaceFormat(image.get(), SDL_PIXELFORMAT_RGBA32, 0));
+    if (!rgba) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "TextureResidencyManager: cannot load %s: %s", path.c_str(),
+            image ? SDL_GetError() : IMG_GetError());
+        return std::vector<MipMapLevel>();
+    }
+    std::vector<unsigned char> pixels((size_t)rgba->w * rgba->h * 4);
+    for (int y = 0; y < rgba->h; y++)
+        memcpy(pixels.data() + (size_t)y * rgba->w * 4, (unsigned char*)rgba->pixels + (size_t)y * rgba->pitch, (size_t)rgba->w * 4);
+    //Textures without mip maps still need the small levels to be reduced
+    return MipMapGenerator::generateMipChain(pixels.data(), rgba->w, rgba->h, 4, MIPMAP_FILTER_KAISER, true,
+        &ThreadPool::getShared());
+}
+
+void TextureResidencyManager::keepReduced (Entry& entry, const std::vector<MipMapLevel>& levels){
+    size_t first = 0;
+    while (first + 1 < levels.size() && std::max(levels[first].width, levels[first].height) > reducedSize) first++;
+    entry.reduced.clear();
+    if (entry.useMipMaps) entry.reduced.assign(levels.begin() + first, levels.end());
+    else {
+        entry.reduced.push_back(levels[first]);
+        if (first + 1 < levels.size()) entry.reduced.push_back(levels.back());
+    }
+
+    entry.fullBytes = estimateBytes(levels[0].width, levels[0].height, 4, entry.useMipMaps);
+    entry.reducedBytes = estimateBytes(entry.reduced[0].width, entry.reduced[0].height, 4, entry.useMipMaps);
+}
+
+void TextureResidencyManager::upload (GLuint handle, const std::vector<MipMapLevel>& levels, int first, int count){
+    //Bound directly, Texture::bind would count the upload as a use
+    GLStateCache::get().bindTexture(GL_TEXTURE_2D, handle);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = 0; i < count; i++) {
+        const MipMapLevel& level = levels[first + i];
+        glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level.pixels.data());
+    }
+    //Levels past the new chain keep their old sizes, they must not be sampled
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, count - 1);
+}
+
+size_t TextureResidencyManager::getBytes (const Entry& entry) const{
+    switch (entry.residency) {
+    case FULL: return entry.fullBytes;
+    case REDUCED: return entry.reducedBytes;
+    default: return 4;
+    }
+}
+
+void TextureResidencyManager::setResidency (Entry& entry, Residency residency){
+    std::shared_ptr<Texture> texture = entry.texture.lock();
+    if (!texture || residency == entry.residency || residency == FULL) return;
+    if (residency == REDUCED)
+        upload(texture->getTextureObjectHandle(), entry.reduced, 0, entry.useMipMaps ? entry.reduced.size() : 1);
+    else upload(texture->getTextureObjectHandle(), entry.reduced, entry.reduced.size() - 1, 1);
+    entry.residency = residency;
+}
+
+std::shared_ptr<Texture> TextureResidencyManager::load (const std::string& path, GLenum minFilter, GLenum magFilter,
+    GLenum uWrap, GLenum vWrap, bool useMipMaps, bool cacheDecoded){
+    std::vector<MipMapLevel> levels = decode(path);
+    if (levels.empty()) return nullptr;
+
+    GLuint handle;
+    glGenTextures(1, &handle);
+    upload(handle, levels, 0, useMipMaps ? levels.size() : 1);
+    std::shared_ptr<Texture> texture = std::make_shared<Texture>(GL_TEXTURE_2D, handle, levels[0].width, levels[0].height,
+        minFilter, magFilter, uWrap, vWrap, useMipMaps);
+
+    std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+    entry->texture = texture;
+    entry->path = path;
+    entry->useMipMaps = useMipMaps;
+    entry->cacheDecoded = cacheDecoded;
+    keepReduced(*entry, levels);
+    if (cacheDecoded) entry->decoded = std::make_shared<const std::vector<MipMapLevel>>(std::move(levels));
+    entries.push_back(entry);
+    return texture;
+}
+
+void TextureResidencyManager::requestRestore (const std::shared_ptr<Entry>& entry){
+    if (entry->residency == FULL || entry->restoring || entry->failed) return;
+    entry->restoring = true;
+    const std::string path = entry->path;
+    std::shared_ptr<const std::vector<MipMapLevel>> decoded = entry->decoded;
+    pool.submit([=]{
+        Restored result;
+        result.entry = entry;
+        result.levels = decoded ? decoded : std::make_shared<const std::vector<MipMapLevel>>(decode(path));
+        std::lock_guard<std::mutex> lock(restoredMutex);
+        restored.push_back(std::move(result));
+    });
+}
+
+bool TextureResidencyManager::uploadRestored (size_t maxBytes){
+    size_t uploaded = 0;
+    while (true) {
+        Restored result;
+        {
+            std::lock_guard<std::mutex> lock(restoredMutex);
+            if (restored.empty()) return true;
+            //At least one texture per call, however large
+            if (uploaded > 0 && uploaded >= maxBytes) return false;
+            result = std::move(restored.front());
+            restored.pop_front();
+        }
+        Entry& entry = *result.entry;
+        entry.restoring = false;
+        std::shared_ptr<Texture> texture = entry.texture.lock();
+        if (!texture) continue;
+        if (result.levels->empty()) {
+            entry.failed = true;
+            continue;
+        }
+        upload(texture->getTextureObjectHandle(), *result.levels, 0, entry.useMipMaps ? result.levels->size() : 1);
+        entry.residency = FULL;
+        if (entry.cacheDecoded) entry.decoded = result.levels;
+        uploaded += entry.fullBytes;
+    }
+}
+
+void TextureResidencyManager::update (){
+    const unsigned int frame = Texture::getFrame();
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [](const std::shared_ptr<Entry>& entry){
+        return entry->texture.expired();
+    }), entries.end());
+
+    uploadRestored(uploadBytesPerFrame);
+
+    //Dropped textures bound in this or the previous frame are wanted back
+    std::vector<std::pair<unsigned int, Entry*>> idle;
+    for (const std::shared_ptr<Entry>& entry : entries) {
+        std::shared_ptr<Texture> texture = entry->texture.lock();
+        const unsigned int unused = frame - texture->getLastBoundFrame();
+        if (unused <= 1) requestRestore(entry);
+        else if (unused >= idleFrames && entry->residency != EVICTED)
+            idle.push_back(std::make_pair(texture->getLastBoundFrame(), entry.get()));
+    }
+
+    size_t total = getResidentBytes();
+    if (total <= budget) return;
+    //Least recently bound first, everything is reduced before anything is evicted
+    std::sort(idle.begin(), idle.end(), [frame](const std::pair<unsigned int, Entry*>& a,
+        const std::pair<unsigned int, Entry*>& b){
+        return frame - a.first > frame - b.first;
+    });
+    for (Residency target : {REDUCED, EVICTED}) {
+        for (auto& candidate : idle) {
+            if (total <= budget) return;
+            Entry& entry = *candidate.second;
+            if (entry.residency >= target) continue;
+            total -= getBytes(entry);
+            setResidency(entry, target);
+            total += getBytes(entry);
+        }
+    }
+}
+
+void TextureResidencyManager::finishRestoring (){
+    while (true) {
+        uploadRestored(std::numeric_limits<size_t>::max());
+        bool restoring = false;
+        for (const std::shared_ptr<Entry>& entry : entries) restoring |= entry->restoring;
+        if (!restoring) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+std::shared_ptr<TextureResidencyManager::Entry> TextureResidencyManager::find (const std::shared_ptr<Texture>& texture) const{
+    for (const std::shared_ptr<Entry>& entry : entries)
+        if (entry->texture.lock() == texture) return entry;
+    return nullptr;
+}
+
+void TextureResidencyManager::evict (const std::shared_ptr<Texture>& texture, Residency residency){
+    std::shared_ptr<Entry> entry = find(texture);
+    if (entry && residency > entry->residency) setResidency(*entry, residency);
+}
+
+void TextureResidencyManager::prefetch (const std::shared_ptr<Texture>& texture){
+    std::shared_ptr<Entry> entry = find(texture);
+    if (entry) requestRestore(entry);
+}
+
+TextureResidencyManager::Residency TextureResidencyManager::getResidency (const std::shared_ptr<Texture>& texture) const{
+    std::shared_ptr<Entry> entry = find(texture);
+    return entry ? entry->residency : FULL;
+}
+
+size_t TextureResidencyManager::getResidentBytes () const{
+    size_t bytes = 0;
+    for (const std::shared_ptr<Entry>& entry : entries)
+        if (!entry->texture.expired()) bytes += getBytes(*entry);
+    return bytes;
+}
+
+size_t TextureResidencyManager::getFullBytes () const{
+    size_t bytes = 0;
+    for (const std::shared_ptr<Entry>& entry : entries)
+        if (!entry->texture.expired()) bytes += entry->fullBytes;
+    return bytes;
+}
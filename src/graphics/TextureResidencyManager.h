@@ -0,0 +1,130 @@
+#pragma once
+#include "../GL.h"
+#include "../utils/ThreadPool.h"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** Keeps the textures it loads within a memory budget. Every texture's size is estimated from its levels, mip maps included.
+ * When the resident total exceeds the budget, {@link #update()} drops the textures bound least recently, first to a reduced
+ * chain of their small mip levels, kept in memory, then to a single texel of their average color. Both keep the texture
+ * bindable with the same coordinates, only blurrier.
+ * <p>
+ * A dropped texture that is bound again is restored in the background: its image is decoded from its path, or taken from the
+ * decoded copy kept in memory if it was loaded with cacheDecoded, on a worker thread, and uploaded by a later
+ * {@link #update()}. Recently bound textures are never dropped, so what is on screen stays sharp even over budget.
+ * <p>
+ * Use is detected through {@link Texture#bind()}, which records {@link Texture#getFrame()}. Call {@link #update()} once per
+ * frame on the GL thread. Textures are released when the last reference outside the manager goes away. */
+class TextureResidencyManager{
+public:
+    enum Residency{
+        /** every level is uploaded */
+        FULL,
+        /** only the levels no larger than the reduced size are uploaded */
+        REDUCED,
+        /** a single texel is uploaded */
+        EVICTED
+    };
+private:
+    struct Entry{
+        std::weak_ptr<Texture> texture;
+        std::string path;
+        bool useMipMaps;
+        bool cacheDecoded;
+        /** the full mip chain, kept only with cacheDecoded */
+        std::shared_ptr<const std::vector<MipMapLevel>> decoded;
+        /** the smallest levels, uploaded when reduced; the last one is the single texel uploaded when evicted */
+        std::vector<MipMapLevel> reduced;
+        size_t fullBytes = 0, reducedBytes = 0;
+        Residency residency = FULL;
+        bool restoring = false;
+        /** whether restoring failed, it isn't retried */
+        bool failed = false;
+    };
+
+    struct Restored{
+        std::shared_ptr<Entry> entry;
+        std::shared_ptr<const std::vector<MipMapLevel>> levels;
+    };
+
+    std::vector<std::shared_ptr<Entry>> entries;
+    std::mutex restoredMutex;
+    std::deque<Restored> restored;
+    size_t budget;
+    size_t uploadBytesPerFrame = 8 * 1024 * 1024;
+    int reducedSize;
+    unsigned int idleFrames = 2;
+    /** declared last so the workers are joined before the queue they fill is destroyed **/
+    ThreadPool pool;
+
+    /** Decodes the image and builds its levels, on a worker. @return the levels, empty if the image can't be read */
+    static std::vector<MipMapLevel> decode (const std::string& path);
+
+    void keepReduced (Entry& entry, const std::vector<MipMapLevel>& levels);
+
+    /** Uploads count levels starting at first as levels 0 to count - 1 of the texture. */
+    static void upload (GLuint handle, const std::vector<MipMapLevel>& levels, int first, int count);
+
+    void setResidency (Entry& entry, Residency residency);
+
+    void requestRestore (const std::shared_ptr<Entry>& entry);
+
+    /** Uploads decoded restores until maxBytes are uploaded. @return whether the queue is empty */
+    bool uploadRestored (size_t maxBytes);
+
+    size_t getBytes (const Entry& entry) const;
+
+    std::shared_ptr<Entry> find (const std::shared_ptr<Texture>& texture) const;
+public:
+    /** @param budget the number of bytes the managed textures may use
+     * @param reducedSize the largest side of the levels kept for reduced textures
+     * @param threads the number of decoding threads */
+    TextureResidencyManager(size_t budget, int reducedSize = 64, int threads = 1);
+    TextureResidencyManager(const TextureResidencyManager&) = delete;
+    TextureResidencyManager& operator= (const TextureResidencyManager&) = delete;
+
+    /** Loads the image at the path, blocking, and manages the texture. The texture is GL_RGBA with sRGB correct mip maps.
+     * @param cacheDecoded whether to keep the decoded levels in memory, so restoring doesn't read and decode the file again
+     * @return the texture, or nullptr if the image can't be read */
+    std::shared_ptr<Texture> load (const std::string& path, GLenum minFilter, GLenum magFilter, GLenum uWrap, GLenum vWrap,
+        bool useMipMaps, bool cacheDecoded = false);
+
+    /** Uploads restored textures and drops the least recently bound ones until the budget is met. */
+    void update ();
+
+    /** Blocks until every requested restore is uploaded. */
+    void finishRestoring ();
+
+    /** Drops the texture now, whether or not it is over budget. */
+    void evict (const std::shared_ptr<Texture>& texture, Residency residency = EVICTED);
+
+    /** Starts restoring the texture before it is bound, e.g. when approaching an area that uses it. */
+    void prefetch (const std::shared_ptr<Texture>& texture);
+
+    /** @return the residency of the texture, FULL if it isn't managed */
+    Residency getResidency (const std::shared_ptr<Texture>& texture) const;
+
+    /** @return the estimated bytes of the uploaded levels of every managed texture */
+    size_t getResidentBytes () const;
+
+    /** @return the estimated bytes of every managed texture if it was fully resident */
+    size_t getFullBytes () const;
+
+    int getManagedCount () const {return entries.size();}
+
+    void setBudget (size_t budget) {this->budget = budget;}
+
+    size_t getBudget () const {return budget;}
+
+    /** @param frames the number of frames a texture must stay unbound before it can be dropped */
+    void setIdleFrames (unsigned int frames) {idleFrames = frames;}
+
+    /** @param bytes the number of bytes of restored textures uploaded at most per {@link #update()}, at least one texture */
+    void setUploadBudget (size_t bytes) {uploadBytesPerFrame = bytes;}
+
+    /** @return the estimated size of a mip chain, or of its first level only */
+    static size_t estimateBytes (int width, int height, int bytesPerPixel, bool mipMaps);
+};
@@ -0,0 +1,285 @@
+#include "BitmapFont.h"
+#include "BitmapFontCache.h"
+#include "GlyphLayout.h"
+#include "../../utils/MappedFile.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+namespace {
+	/** A line of a text .fnt file: a tag followed by key=value pairs, values may be quoted. */
+	struct FontLine{
+		std::string tag;
+		std::map<std::string, std::string> values;
+
+		int getInt (const std::string& key, int defaultValue) const {
+			auto value = values.find(key);
+			return value == values.end() ? defaultValue : (int)strtol(value->second.c_str(), nullptr, 10);
+		}
+
+		std::string get (const std::string& key) const {
+			auto value = values.find(key);
+			return value == values.end() ? std::string() : value->second;
+		}
+	};
+
+	void parseLine (const char* begin, const char* end, FontLine& line){
+		line.tag.clear();
+		line.values.clear();
+		const char* cursor = begin;
+		while (cursor < end && (*cursor == ' ' || *cursor == '\t')) cursor++;
+		const char* tagEnd = cursor;
+		while (tagEnd < end && *tagEnd != ' ' && *tagEnd != '\t') tagEnd++;
+		line.tag.assign(cursor, tagEnd);
+		cursor = tagEnd;
+		while (cursor < end) {
+			while (cursor < end && (*cursor == ' ' || *cursor == '\t')) cursor++;
+			const char* keyEnd = cursor;
+			while (keyEnd < end && *keyEnd != '=' && *keyEnd != ' ' && *keyEnd != '\t') keyEnd++;
+			if (keyEnd >= end || *keyEnd != '=') {
+				cursor = keyEnd;
+				continue;
+			}
+			const std::string key(cursor, keyEnd);
+			cursor = keyEnd + 1;
+			const char* valueEnd;
+			if (cursor < end && *cursor == '"') {
+				cursor++;
+				valueEnd = cursor;
+				while (valueEnd < end && *valueEnd != '"') valueEnd++;
+				line.values[key].assign(cursor, valueEnd);
+				cursor = valueEnd < end ? valueEnd + 1 : end;
+			} else {
+				valueEnd = cursor;
+				while (valueEnd < end && *valueEnd != ' ' && *valueEnd != '\t') valueEnd++;
+				line.values[key].assign(cursor, valueEnd);
+				cursor = valueEnd;
+			}
+		}
+	}
+}
+
+BitmapFont::BitmapFont(const std::string& fontPath, GLenum minFilter, GLenum magFilter){
+	glyphPages.resize(MAX_CHAR / PAGE_SIZE + 1);
+	MappedFile file(fontPath);
+	if (!file.isValid()) {
+		SDL_Log("BitmapFont: cannot read %s", fontPath.c_str());
+		return;
+	}
+	if (!parse((const char*)file.data(), file.size())) {
+		SDL_Log("BitmapFont: cannot parse %s", fontPath.c_str());
+		return;
+	}
+
+	const size_t slash = fontPath.find_last_of("/\\");
+	const std::string directory = slash == std::string::npos ? std::string() : fontPath.substr(0, slash + 1);
+	std::vector<TextureRegion> pages;
+	for (const std::string& imagePath : imagePaths) {
+		std::shared_ptr<Texture> texture = std::make_shared<Texture>(directory + imagePath, minFilter, magFilter,
+			GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, false);
+		if (texture->getTextureObjectHandle() == 0 || texture->getWidth() <= 0) {
+			SDL_Log("BitmapFont: cannot load the page %s", (directory + imagePath).c_str());
+			return;
+		}
+		pages.push_back(TextureRegion(texture));
+	}
+	setPages(pages);
+}
+
+BitmapFont::BitmapFont(const std::string& fontPath, const std::vector<TextureRegion>& regions){
+	glyphPages.resize(MAX_CHAR / PAGE_SIZE + 1);
+	MappedFile file(fontPath);
+	if (!file.isValid()) {
+		SDL_Log("BitmapFont: cannot read %s", fontPath.c_str());
+		return;
+	}
+	if (!parse((const char*)file.data(), file.size())) {
+		SDL_Log("BitmapFont: cannot parse %s", fontPath.c_str());
+		return;
+	}
+	if (regions.size() < imagePaths.size()) {
+		SDL_Log("BitmapFont: %s has %i pages, %i regions given", fontPath.c_str(), (int)imagePaths.size(), (int)regions.size());
+		return;
+	}
+	setPages(regions);
+}
+
+BitmapFont::~BitmapFont(){
+}
+
+bool BitmapFont::parse (const char* data, size_t length){
+	if (length >= 3 && memcmp(data, "BMF", 3) == 0) {
+		SDL_Log("BitmapFont: the binary .fnt format is not supported, export the text format");
+		return false;
+	}
+
+	int baseLine = 0;
+	bool hasCommon = false;
+	FontLine line;
+	for (size_t position = 0; position < length;) {
+		const void* newline = memchr(data + position, '\n', length - position);
+		const size_t lineEnd = newline ? (const char*)newline - data : length;
+		size_t end = lineEnd;
+		if (end > position && data[end - 1] == '\r') end--;
+		parseLine(data + position, data + end, line);
+		position = lineEnd + 1;
+
+		if (line.tag == "info") {
+			//padding=top,right,bottom,left
+			const std::string padding = line.get("padding");
+			int values[4] = {0, 0, 0, 0};
+			const char* cursor = padding.c_str();
+			for (int i = 0; i < 4 && *cursor; i++) {
+				char* next;
+				values[i] = (int)strtol(cursor, &next, 10);
+				cursor = *next == ',' ? next + 1 : next;
+			}
+			padTop = values[0];
+			padRight = values[1];
+			padBottom = values[2];
+			padLeft = values[3];
+		} else if (line.tag == "common") {
+			lineHeight = line.getInt("lineHeight", 0);
+			baseLine = line.getInt("base", 0);
+			imagePaths.resize(std::max(1, line.getInt("pages", 1)));
+			hasCommon = true;
+		} else if (line.tag == "page") {
+			const int id = line.getInt("id", 0);
+			if (id < 0 || id >= (int)imagePaths.size()) {
+				SDL_Log("BitmapFont: invalid page id %i", id);
+				return false;
+			}
+			imagePaths[id] = line.get("file");
+		} else if (line.tag == "char") {
+			const int id = line.getInt("id", -1);
+			if (id < 0 || (uint32_t)id > MAX_CHAR) continue;
+			std::unique_ptr<Glyph> glyph(new Glyph());
+			glyph->id = id;
+			glyph->srcX = line.getInt("x", 0);
+			glyph->srcY = line.getInt("y", 0);
+			glyph->width = line.getInt("width", 0);
+			glyph->height = line.getInt("height", 0);
+			glyph->xoffset = line.getInt("xoffset", 0);
+			//From the top of the line down to the top of the glyph, to the bottom of the glyph with y up
+			glyph->yoffset = -(glyph->height + line.getInt("yoffset", 0));
+			glyph->xadvance = line.getInt("xadvance", 0);
+			glyph->page = line.getInt("page", 0);
+			glyph->u = glyph->v = glyph->u2 = glyph->v2 = 0;
+			setGlyph(id, std::move(glyph));
+		} else if (line.tag == "kerning") {
+			const int first = line.getInt("first", -1), second = line.getInt("second", -1);
+			const int amount = line.getInt("amount", 0);
+			if (first >= 0 && second >= 0 && amount != 0) kernings[(uint64_t)first << 32 | (uint32_t)second] = amount;
+		}
+	}
+	if (!hasCommon || glyphs.empty()) return false;
+
+	const float padY = padTop + padBottom;
+	descent = 0;
+	for (const std::unique_ptr<Glyph>& glyph : glyphs)
+		if (glyph->width > 0 && glyph->height > 0) descent = std::min(descent, (float)(baseLine + glyph->yoffset));
+	descent += padBottom;
+
+	if (!getGlyph(' ')) {
+		std::unique_ptr<Glyph> space(new Glyph());
+		memset(space.get(), 0, sizeof(Glyph));
+		space->id = ' ';
+		const Glyph* l = getGlyph('l');
+		space->xadvance = (l ? l->xadvance : glyphs.front()->xadvance);
+		setGlyph(' ', std::move(space));
+	}
+	spaceXadvance = getGlyph(' ')->xadvance;
+
+	const Glyph* x = nullptr;
+	for (const char* c = "xeaonsruvwz"; *c && !x; c++)
+		x = getGlyph(*c);
+	xHeight = (x ? x->height : 1) - padY;
+
+	const Glyph* capital = nullptr;
+	for (const char* c = "MNBDCEFKAGHIJLOPQRSTUVWXYZ"; *c && !capital; c++)
+		capital = getGlyph(*c);
+	if (capital) capHeight = capital->height;
+	else {
+		capHeight = 0;
+		for (const std::unique_ptr<Glyph>& glyph : glyphs)
+			if (glyph->width > 0 && glyph->height > 0) capHeight = std::max(capHeight, (float)glyph->height);
+	}
+	capHeight -= padY;
+	ascent = baseLine - capHeight;
+	return true;
+}
+
+void BitmapFont::setGlyph (uint32_t ch, std::unique_ptr<Glyph> glyph){
+	std::unique_ptr<std::array<Glyph*, PAGE_SIZE>>& page = glyphPages[ch / PAGE_SIZE];
+	if (!page) {
+		page.reset(new std::array<Glyph*, PAGE_SIZE>());
+		page->fill(nullptr);
+	}
+	(*page)[ch & (PAGE_SIZE - 1)] = glyph.get();
+	glyphs.push_back(std::move(glyph));
+}
+
+void BitmapFont::setGlyphRegion (Glyph& glyph, const TextureRegion& region){
+	const float invTexWidth = 1.0f / region.texture->getWidth();
+	const float invTexHeight = 1.0f / region.texture->getHeight();
+	const float offsetX = region.getRegionX(), offsetY = region.getRegionY();
+	glyph.u = (offsetX + glyph.srcX) * invTexWidth;
+	glyph.u2 = (offsetX + glyph.srcX + glyph.width) * invTexWidth;
+	glyph.v = (offsetY + glyph.srcY) * invTexHeight;
+	glyph.v2 = (offsetY + glyph.srcY + glyph.height) * invTexHeight;
+}
+
+void BitmapFont::setPages (const std::vector<TextureRegion>& regions){
+	this->regions = regions;
+	for (const std::unique_ptr<Glyph>& glyph : glyphs) {
+		if (glyph->page < 0 || glyph->page >= (int)regions.size()) {
+			SDL_Log("BitmapFont: glyph %u is on the missing page %i", glyph->id, glyph->page);
+			glyph->width = glyph->height = 0;
+			continue;
+		}
+		setGlyphRegion(*glyph, regions[glyph->page]);
+	}
+}
+
+const GlyphLayout& BitmapFont::draw (SpriteBatch& batch, const std::string& text, float x, float y){
+	return draw(batch, text, x, y, 0, Align::left, false);
+}
+
+const GlyphLayout& BitmapFont::draw (SpriteBatch& batch, const std::string& text, float x, float y, float targetWidth,
+	int halign, bool wrap){
+	BitmapFontCache& cache = getCache();
+	cache.setColor(color);
+	const GlyphLayout& layout = cache.setText(text, x, y, targetWidth, halign, wrap);
+	cache.draw(batch);
+	return layout;
+}
+
+void BitmapFont::draw (SpriteBatch& batch, const GlyphLayout& layout, float x, float y){
+	BitmapFontCache& cache = getCache();
+	cache.setText(layout, x, y);
+	cache.draw(batch);
+}
+
+BitmapFontCache& BitmapFont::getCache (){
+	if (!cache) cache.reset(new BitmapFontCache(*this, integer));
+	return *cache;
+}
+
+void BitmapFont::setScale (float scaleX, float scaleY){
+	if (scaleX == 0 || scaleY == 0) {
+		SDL_Log("BitmapFont: scale cannot be 0");
+		return;
+	}
+	if (this->scaleX == scaleX && this->scaleY == scaleY) return;
+	this->scaleX = scaleX;
+	this->scaleY = scaleY;
+	version++;
+}
+
+void BitmapFont::setUseIntegerPositions (bool integer){
+	if (this->integer == integer) return;
+	this->integer = integer;
+	//The cache rounds positions as the font did when it was created
+	cache = nullptr;
+}
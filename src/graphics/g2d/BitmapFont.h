@@ -0,0 +1,211 @@
+#pragma once
+#include "TextureRegion.h"
+#include "../Color.h"
+#include "../../utils/Align.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class SpriteBatch;
+class GlyphLayout;
+class BitmapFontCache;
+
+/** Renders bitmap fonts. The font consists of 2 parts: the AngelCode BMFont file in its text format, describing the glyphs,
+ * and one or more images, the pages, containing the glyphs, given as {@link TextureRegion}s or loaded from the paths in the
+ * file.
+ * <p>
+ * Text is laid out by a {@link GlyphLayout} and drawn from the vertices of a {@link BitmapFontCache}. The draw methods of this
+ * class use a cache of the font which keeps the layout of the last text drawn, drawing the same text again, even somewhere else,
+ * costs no layout work. For many labels, keep a {@link BitmapFontCache} per label.
+ * <p>
+ * The font uses a y-up coordinate system, text is drawn with y at the top of the capital letters.
+ * @author Nathan Sweet
+ * @author Matthias Mann */
+class BitmapFont{
+public:
+	/** Represents a single character in a font page. */
+	struct Glyph{
+		uint32_t id;
+		int srcX, srcY;
+		int width, height;
+		float u, v, u2, v2;
+		int xoffset, yoffset;
+		int xadvance;
+		int page;
+	};
+private:
+	static const int PAGE_SIZE = 512;
+	static const uint32_t MAX_CHAR = 0x10FFFF;
+
+	std::vector<TextureRegion> regions;
+	/** the glyphs by code point, in pages of PAGE_SIZE allocated when a glyph of the page is set */
+	std::vector<std::unique_ptr<std::array<Glyph*, PAGE_SIZE>>> glyphPages;
+	std::vector<std::unique_ptr<Glyph>> glyphs;
+	/** the kerning amounts by the first and second code points */
+	std::unordered_map<uint64_t, int> kernings;
+	std::vector<std::string> imagePaths;
+
+	float lineHeight = 0;
+	float capHeight = 1;
+	float ascent = 0;
+	float descent = 0;
+	float xHeight = 1;
+	float spaceXadvance = 0;
+	float padTop = 0, padRight = 0, padBottom = 0, padLeft = 0;
+	float scaleX = 1, scaleY = 1;
+	bool integer = true;
+	Color color = Color(1, 1, 1, 1);
+	/** changed with the metrics, so cached layouts know they are stale */
+	unsigned int version = 0;
+
+	std::unique_ptr<BitmapFontCache> cache;
+
+	/** Reads the glyphs and metrics from the content of a text .fnt file.
+	 * @return whether the content could be parsed */
+	bool parse (const char* data, size_t length);
+
+	void setGlyph (uint32_t ch, std::unique_ptr<Glyph> glyph);
+
+	void setGlyphRegion (Glyph& glyph, const TextureRegion& region);
+
+	/** Finishes the metrics and glyph texture coordinates once the pages are known. */
+	void setPages (const std::vector<TextureRegion>& regions);
+public:
+	/** Creates a font from the .fnt file, loading the page images from the paths in the file, relative to it.
+	 * {@link #isValid()} tells whether the file and images could be loaded. */
+	BitmapFont(const std::string& fontPath, GLenum minFilter = GL_LINEAR, GLenum magFilter = GL_LINEAR);
+
+	/** Creates a font from the .fnt file using the regions as pages, e.g. from a texture atlas, in the order of the file. */
+	BitmapFont(const std::string& fontPath, const std::vector<TextureRegion>& regions);
+
+	~BitmapFont();
+
+	BitmapFont (const BitmapFont&) = delete;
+	BitmapFont& operator= (const BitmapFont&) = delete;
+
+	/** @return whether the font file was parsed and has its pages */
+	bool isValid () const {
+		return !glyphs.empty() && !regions.empty();
+	}
+
+	/** @return the glyph of the code point, or nullptr */
+	const Glyph* getGlyph (uint32_t ch) const {
+		if (ch > MAX_CHAR) return nullptr;
+		const std::unique_ptr<std::array<Glyph*, PAGE_SIZE>>& page = glyphPages[ch / PAGE_SIZE];
+		return page ? (*page)[ch & (PAGE_SIZE - 1)] : nullptr;
+	}
+
+	/** @return the kerning between the glyphs, in pixels of the font, not scaled */
+	int getKerning (uint32_t first, uint32_t second) const {
+		if (kernings.empty()) return 0;
+		auto kerning = kernings.find((uint64_t)first << 32 | second);
+		return kerning == kernings.end() ? 0 : kerning->second;
+	}
+
+	/** Draws text at the specified position, y being the top of the capital letters.
+	 * @return the layout of the text, valid until the next draw */
+	const GlyphLayout& draw (SpriteBatch& batch, const std::string& text, float x, float y);
+
+	/** Draws text at the specified position, aligned within and wrapped at the target width if wrap is true.
+	 * @param halign one of {@link Align#left}, {@link Align#center} or {@link Align#right}
+	 * @return the layout of the text, valid until the next draw */
+	const GlyphLayout& draw (SpriteBatch& batch, const std::string& text, float x, float y, float targetWidth, int halign,
+		bool wrap);
+
+	/** Draws text laid out before, at the specified position. */
+	void draw (SpriteBatch& batch, const GlyphLayout& layout, float x, float y);
+
+	/** @return the cache the draw methods use, created on first use */
+	BitmapFontCache& getCache ();
+
+	/** @return the color the draw methods use */
+	const Color& getColor () const {
+		return color;
+	}
+
+	void setColor (const Color& color) {
+		this->color.set(color);
+	}
+
+	void setColor (float r, float g, float b, float a) {
+		color.set(r, g, b, a);
+	}
+
+	float getScaleX () const {
+		return scaleX;
+	}
+
+	float getScaleY () const {
+		return scaleY;
+	}
+
+	/** Scales the font, layouts set before are laid out again when set next. */
+	void setScale (float scaleX, float scaleY);
+
+	void setScale (float scale) {
+		setScale(scale, scale);
+	}
+
+	/** @return the first page */
+	const TextureRegion& getRegion () const {
+		return regions.front();
+	}
+
+	const std::vector<TextureRegion>& getRegions () const {
+		return regions;
+	}
+
+	/** @return the distance from one line of text to the next, scaled */
+	float getLineHeight () const {
+		return lineHeight * scaleY;
+	}
+
+	/** @return the width of the space character, scaled */
+	float getSpaceXadvance () const {
+		return spaceXadvance * scaleX;
+	}
+
+	/** @return the x-height, the distance from the top of most lowercase characters to the baseline, scaled */
+	float getXHeight () const {
+		return xHeight * scaleY;
+	}
+
+	/** @return the cap height, the distance from the top of most uppercase characters to the baseline, scaled */
+	float getCapHeight () const {
+		return capHeight * scaleY;
+	}
+
+	/** @return the ascent, the distance from the cap height to the top of the tallest glyph, scaled */
+	float getAscent () const {
+		return ascent * scaleY;
+	}
+
+	/** @return the descent, the distance from the bottom of the glyph that extends the lowest to the baseline, scaled. This
+	 * number is negative. */
+	float getDescent () const {
+		return descent * scaleY;
+	}
+
+	float getPadLeft () const {
+		return padLeft * scaleX;
+	}
+
+	float getPadRight () const {
+		return padRight * scaleX;
+	}
+
+	/** Specifies whether to use integer positions. Default is to use them so filtering doesn't kick in as badly. */
+	void setUseIntegerPositions (bool integer);
+
+	bool usesIntegerPositions () const {
+		return integer;
+	}
+
+	/** @return a number changed whenever the metrics change, see {@link GlyphLayout} */
+	unsigned int getVersion () const {
+		return version;
+	}
+};
@@ -0,0 +1,168 @@
+#include "BitmapFontCache.h"
+#include "../VertexAttribute.h"
+#include "SpriteBatch.h"
+#include "../../utils/NumberUtils.h"
+#include <cmath>
+
+BitmapFontCache::BitmapFontCache(BitmapFont& font, bool integer):font(font), integer(integer){
+	pageVertices.resize(font.getRegions().size());
+	pageColors.resize(font.getRegions().size());
+}
+
+void BitmapFontCache::translate (float xAmount, float yAmount){
+	if (integer) {
+		xAmount = std::round(xAmount);
+		yAmount = std::round(yAmount);
+	}
+	if (xAmount == 0 && yAmount == 0) return;
+	x += xAmount;
+	y += yAmount;
+
+	for (std::vector<float>& vertices : pageVertices) {
+		for (size_t i = 0, n = vertices.size(); i < n; i += 5) {
+			vertices[i] += xAmount;
+			vertices[i + 1] += yAmount;
+		}
+	}
+}
+
+void BitmapFontCache::tint (const Color& tint){
+	for (size_t page = 0; page < pageVertices.size(); page++) {
+		std::vector<float>& vertices = pageVertices[page];
+		const std::vector<float>& colors = pageColors[page];
+		for (size_t glyph = 0, n = colors.size(); glyph < n; glyph++) {
+			const int c = NumberUtils::floatToIntColor(colors[glyph]);
+			const float tinted = Color::toFloatBits((int)((c & 0xff) * tint.r), (int)(((c >> 8) & 0xff) * tint.g),
+				(int)(((c >> 16) & 0xff) * tint.b), (int)(((c >> 24) & 0xff) * tint.a));
+			float* vertex = vertices.data() + glyph * SpriteBatch::SPRITE_SIZE;
+			vertex[2] = vertex[7] = vertex[12] = vertex[17] = tinted;
+		}
+	}
+}
+
+void BitmapFontCache::setColors (const Color& color){
+	const float packedColor = Color::toFloatBits(color.r, color.g, color.b, color.a);
+	for (size_t page = 0; page < pageVertices.size(); page++) {
+		std::vector<float>& vertices = pageVertices[page];
+		std::vector<float>& colors = pageColors[page];
+		for (size_t glyph = 0, n = colors.size(); glyph < n; glyph++) {
+			colors[glyph] = packedColor;
+			float* vertex = vertices.data() + glyph * SpriteBatch::SPRITE_SIZE;
+			vertex[2] = vertex[7] = vertex[12] = vertex[17] = packedColor;
+		}
+	}
+}
+
+void BitmapFontCache::draw (SpriteBatch& batch){
+	const std::vector<TextureRegion>& regions = font.getRegions();
+	if (batch.getSpriteSize() == SpriteBatch::SPRITE_SIZE) {
+		for (size_t page = 0; page < pageVertices.size(); page++)
+			if (!pageVertices[page].empty())
+				batch.draw(regions[page].texture, pageVertices[page].data(), 0, pageVertices[page].size());
+		return;
+	}
+
+	//The batch has more attributes per vertex, draw the glyphs one by one
+	const float batchColor = batch.getPackedColor();
+	for (size_t page = 0; page < pageVertices.size(); page++) {
+		const std::vector<float>& vertices = pageVertices[page];
+		for (size_t i = 0, n = vertices.size(); i < n; i += SpriteBatch::SPRITE_SIZE) {
+			const float* vertex = vertices.data() + i;
+			batch.setPackedColor(vertex[2]);
+			batch.draw(regions[page].texture, vertex[0], vertex[1], vertex[10] - vertex[0], vertex[11] - vertex[1], vertex[3],
+				vertex[4], vertex[13], vertex[14]);
+		}
+	}
+	batch.setPackedColor(batchColor);
+}
+
+void BitmapFontCache::clear (){
+	x = 0;
+	y = 0;
+	glyphCount = 0;
+	holdsLayout = false;
+	for (std::vector<float>& vertices : pageVertices)
+		vertices.clear();
+	for (std::vector<float>& colors : pageColors)
+		colors.clear();
+}
+
+const GlyphLayout& BitmapFontCache::setText (const std::string& text, float x, float y, float targetWidth, int halign,
+	bool wrap){
+	if (!layout.setText(font, text, color, targetWidth, halign, wrap) && holdsLayout) {
+		//Same glyphs, only move them
+		setPosition(x - layoutX, y - layoutY);
+		return layout;
+	}
+	clear();
+	addText(layout, x, y);
+	layoutX = x;
+	layoutY = y;
+	holdsLayout = true;
+	return layout;
+}
+
+const GlyphLayout& BitmapFontCache::addText (const std::string& text, float x, float y, float targetWidth, int halign,
+	bool wrap){
+	scratchLayout.setText(font, text, color, targetWidth, halign, wrap);
+	addText(scratchLayout, x, y);
+	return scratchLayout;
+}
+
+void BitmapFontCache::addText (const GlyphLayout& layout, float x, float y){
+	holdsLayout = false;
+	const float scaleX = font.getScaleX(), scaleY = font.getScaleY();
+	const float ascent = font.getAscent();
+	for (const GlyphLayout::GlyphRun& run : layout.runs) {
+		const float runX = x + run.x, runY = y + run.y + ascent;
+		for (size_t i = 0, n = run.glyphs.size(); i < n; i++) {
+			const BitmapFont::Glyph& glyph = *run.glyphs[i];
+			addGlyph(glyph, runX + run.xPositions[i] + glyph.xoffset * scaleX, runY + glyph.yoffset * scaleY, run.color);
+		}
+	}
+}
+
+void BitmapFontCache::addGlyph (const BitmapFont::Glyph& glyph, float x, float y, float color){
+	if (glyph.page < 0 || glyph.page >= (int)pageVertices.size()) return;
+	const float scaleX = font.getScaleX(), scaleY = font.getScaleY();
+	float x2 = x + glyph.width * scaleX;
+	float y2 = y + glyph.height * scaleY;
+	if (integer) {
+		x = std::round(x);
+		y = std::round(y);
+		x2 = std::round(x2);
+		y2 = std::round(y2);
+	}
+	const float u = glyph.u, v = glyph.v2, u2 = glyph.u2, v2 = glyph.v;
+
+	std::vector<float>& vertices = pageVertices[glyph.page];
+	const size_t idx = vertices.size();
+	vertices.resize(idx + SpriteBatch::SPRITE_SIZE);
+	float* out = vertices.data() + idx;
+	out[0] = x;
+	out[1] = y;
+	out[2] = color;
+	out[3] = u;
+	out[4] = v;
+
+	out[5] = x;
+	out[6] = y2;
+	out[7] = color;
+	out[8] = u;
+	out[9] = v2;
+
+	out[10] = x2;
+	out[11] = y2;
+	out[12] = color;
+	out[13] = u2;
+	out[14] = v2;
+
+	out[15] = x2;
+	out[16] = y;
+	out[17] = color;
+	out[18] = u2;
+	out[19] = v;
+
+	pageColors[glyph.page].push_back(color);
+	glyphCount++;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "BitmapFont.h"
+#include "GlyphLayout.h"
+#include <vector>
+
+class SpriteBatch;
+
+/** Caches glyph geometry for a BitmapFont for faster rendering of static text. The vertices of the glyphs are computed once,
+ * when text is set or added, in the vertex format of {@link SpriteBatch}, one array per font page. Drawing copies them to the
+ * batch as they are, moving the text only offsets the positions and tinting only rewrites the colors, neither lays out the text
+ * again. {@link #setText} keeps the vertices when the text, the parameters and the font did not change.
+ * @author Nathan Sweet
+ * @author Matthias Mann */
+class BitmapFontCache{
+	BitmapFont& font;
+	bool integer;
+	/** the vertices of the glyphs of each page, and the color of each glyph before tinting */
+	std::vector<std::vector<float>> pageVertices;
+	std::vector<std::vector<float>> pageColors;
+	int glyphCount = 0;
+	float x = 0, y = 0;
+	Color color = Color(1, 1, 1, 1);
+
+	/** the layout of {@link #setText}, where it was added, and whether the cache holds nothing else */
+	GlyphLayout layout;
+	float layoutX = 0, layoutY = 0;
+	bool holdsLayout = false;
+	/** the layout of {@link #addText(const std::string&, float, float, float, int, bool)} */
+	GlyphLayout scratchLayout;
+
+	void addGlyph (const BitmapFont::Glyph& glyph, float x, float y, float color);
+public:
+	BitmapFontCache(BitmapFont& font):BitmapFontCache(font, font.usesIntegerPositions()){}
+
+	/** @param integer If true, rendering positions will be at integer values to avoid filtering artifacts. */
+	BitmapFontCache(BitmapFont& font, bool integer);
+
+	/** Sets the position of the text, relative to the position when the text was cached. */
+	void setPosition (float x, float y) {
+		translate(x - this->x, y - this->y);
+	}
+
+	/** Sets the position of the text, relative to its current position. */
+	void translate (float xAmount, float yAmount);
+
+	float getX () const {
+		return x;
+	}
+
+	float getY () const {
+		return y;
+	}
+
+	/** Tints all text currently in the cache. Does not affect subsequently added text. */
+	void tint (const Color& tint);
+
+	/** Sets the color of all text currently in the cache. Does not affect subsequently added text. */
+	void setColors (const Color& color);
+
+	/** Sets the color of subsequently added text. Does not affect text currently in the cache. */
+	void setColor (const Color& color) {
+		this->color.set(color);
+	}
+
+	void setColor (float r, float g, float b, float a) {
+		color.set(r, g, b, a);
+	}
+
+	const Color& getColor () const {
+		return color;
+	}
+
+	void draw (SpriteBatch& batch);
+
+	/** Removes all glyphs in the cache. */
+	void clear ();
+
+	/** Clears any cached glyphs and adds the specified glyphs, unless they are those already in the cache, then the text is only
+	 * moved to x, y if it was elsewhere.
+	 * @return the layout of the text */
+	const GlyphLayout& setText (const std::string& text, float x, float y) {
+		return setText(text, x, y, 0, Align::left, false);
+	}
+
+	const GlyphLayout& setText (const std::string& text, float x, float y, float targetWidth, int halign, bool wrap);
+
+	/** Clears any cached glyphs and adds glyphs for the specified layout. */
+	void setText (const GlyphLayout& layout, float x, float y) {
+		clear();
+		addText(layout, x, y);
+	}
+
+	/** Adds glyphs for the text to the glyphs already in the cache, laid out with the color of the cache.
+	 * @return the layout of the text, valid until the next call */
+	const GlyphLayout& addText (const std::string& text, float x, float y, float targetWidth = 0, int halign = Align::left,
+		bool wrap = false);
+
+	/** Adds glyphs for the specified layout, x, y being the top left of its first line. */
+	void addText (const GlyphLayout& layout, float x, float y);
+
+	/** @return the number of glyphs in the cache */
+	int getGlyphCount () const {
+		return glyphCount;
+	}
+
+	/** @return the vertices of the glyphs of the page, 20 floats per glyph */
+	const std::vector<float>& getVertices (int page) const {
+		return pageVertices[page];
+	}
+
+	BitmapFont& getFont () const {
+		return font;
+	}
+
+	bool usesIntegerPositions () const {
+		return integer;
+	}
+};
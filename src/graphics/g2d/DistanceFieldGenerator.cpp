@@ -0,0 +1,215 @@
+#include "DistanceFieldGenerator.h"
+#include <algorithm>
+#include <cmath>
+
+static const float INF = 1e20f;
+
+/** Computes the squared distance transform of the sampled function f along a line of n samples, the lower envelope of the
+ * parabolas rooted at each sample, see Felzenszwalb and Huttenlocher, Distance Transforms of Sampled Functions.
+ * @param v receives the roots of the envelope, n ints
+ * @param z receives the boundaries between the parabolas of the envelope, n + 1 floats */
+static void transformLine (const float* f, int n, float* d, int* v, float* z) {
+    int k = 0;
+    v[0] = 0;
+    z[0] = -INF;
+    z[1] = INF;
+    for (int q = 1; q < n; q++) {
+        //s never drops to z[0], the samples are at most INF
+        float s = ((f[q] + (float)q * q) - (f[v[k]] + (float)v[k] * v[k])) / (2.0f * (q - v[k]));
+        while (s <= z[k]) {
+            k--;
+            s = ((f[q] + (float)q * q) - (f[v[k]] + (float)v[k] * v[k])) / (2.0f * (q - v[k]));
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = INF;
+    }
+    k = 0;
+    for (int q = 0; q < n; q++) {
+        while (z[k + 1] < q) k++;
+        const float offset = (float)(q - v[k]);
+        d[q] = offset * offset + f[v[k]];
+    }
+}
+
+/** Transforms the rows [rowBegin, rowEnd) of the width × height src, writing each row as a column of the height × width dst. */
+static void transformRows (const float* src, float* dst, int width, int height, int rowBegin, int rowEnd) {
+    std::vector<float> d(width), z(width + 1);
+    std::vector<int> v(width);
+    for (int y = rowBegin; y < rowEnd; y++) {
+        transformLine(src + (size_t)y * width, width, d.data(), v.data(), z.data());
+        for (int x = 0; x < width; x++)
+            dst[(size_t)x * height + y] = d[x];
+    }
+}
+
+/** The first pass for a binary image, where the transform of a row is the squared distance to the nearest texel of the row
+ * equal to target, found by scanning the row in both directions. Writes each row as a column like transformRows. */
+static void scanRows (const unsigned char* inside, unsigned char target, float* dst, int width, int height, int rowBegin,
+    int rowEnd) {
+    std::vector<int> distances(width);
+    for (int y = rowBegin; y < rowEnd; y++) {
+        const unsigned char* row = inside + (size_t)y * width;
+        int distance = -1;
+        for (int x = 0; x < width; x++) {
+            if (row[x] == target) distance = 0;
+            else if (distance >= 0) distance++;
+            distances[x] = distance;
+        }
+        distance = -1;
+        for (int x = width - 1; x >= 0; x--) {
+            if (row[x] == target) distance = 0;
+            else if (distance >= 0) distance++;
+            if (distance >= 0 && (distances[x] < 0 || distance < distances[x])) distances[x] = distance;
+            dst[(size_t)x * height + y] = distances[x] < 0 ? INF : (float)distances[x] * distances[x];
+        }
+    }
+}
+
+/** Marks the texels of the mask which are inside the shape, in a grid with padding empty texels on every side. */
+static void readMask (const Pixmap& mask, std::vector<unsigned char>& inside, int padding) {
+    const int width = mask.getWidth(), height = mask.getHeight();
+    const int stride = width + 2 * padding;
+    int bytesPerPixel, channel;
+    switch (mask.getFormat()) {
+    case Pixmap::Alpha: bytesPerPixel = 1; channel = 0; break;
+    case Pixmap::LuminanceAlpha: bytesPerPixel = 2; channel = 1; break;
+    case Pixmap::RGB888: bytesPerPixel = 3; channel = 0; break;
+    case Pixmap::RGBA8888: bytesPerPixel = 4; channel = 3; break;
+    default: {
+        const Pixmap converted = mask.convert(mask.getFormat() == Pixmap::RGB565 ? Pixmap::RGB888 : Pixmap::RGBA8888);
+        readMask(converted, inside, padding);
+        return;
+    }
+    }
+    const unsigned char* pixels = mask.getPixels();
+    for (int y = 0; y < height; y++) {
+        const unsigned char* row = pixels + (size_t)y * width * bytesPerPixel + channel;
+        unsigned char* out = inside.data() + (size_t)(y + padding) * stride + padding;
+        for (int x = 0; x < width; x++)
+            out[x] = row[x * bytesPerPixel] >= 128;
+    }
+}
+
+DistanceFieldGenerator::DistanceFieldGenerator(int spread, int downscale, ThreadPool& pool)
+    :spread(std::max(1, spread)),downscale(std::max(1, downscale)),pool(pool){
+}
+
+Pixmap DistanceFieldGenerator::generate (const Pixmap& mask, bool parallel) const {
+    if (mask.isEmpty()) {
+        SDL_Log("DistanceFieldGenerator: the mask is empty");
+        return Pixmap();
+    }
+    const int width = mask.getWidth() + 2 * spread, height = mask.getHeight() + 2 * spread;
+    const size_t size = (size_t)width * height;
+    std::vector<unsigned char> inside(size, 0);
+    readMask(mask, inside, spread);
+
+    auto forRows = [&](int count, const std::function<void(int,int)>& body) {
+        if (parallel) pool.parallelFor(0, count, 32, body);
+        else body(0, count);
+    };
+
+    //The squared distance of the outside texels to the shape, and of the inside texels to the outside
+    std::vector<float> toInside(size), toOutside(size), transposed(size);
+    for (int pass = 0; pass < 2; pass++) {
+        std::vector<float>& field = pass == 0 ? toInside : toOutside;
+        const unsigned char target = pass == 0 ? 1 : 0;
+        forRows(height, [&](int begin, int end) {scanRows(inside.data(), target, transposed.data(), width, height, begin, end);});
+        forRows(width, [&](int begin, int end) {transformRows(transposed.data(), field.data(), height, width, begin, end);});
+    }
+
+    const int fieldWidth = (width + downscale - 1) / downscale, fieldHeight = (height + downscale - 1) / downscale;
+    Pixmap result(fieldWidth, fieldHeight, Pixmap::RGBA8888);
+    unsigned char* pixels = result.getPixels();
+    const unsigned char r = color >> 16, g = color >> 8, b = color;
+    const float scale = 0.5f / spread;
+    forRows(fieldHeight, [&](int begin, int end) {
+        for (int fieldY = begin; fieldY < end; fieldY++) {
+            const int y0 = fieldY * downscale, y1 = std::min(height, y0 + downscale);
+            for (int fieldX = 0; fieldX < fieldWidth; fieldX++) {
+                const int x0 = fieldX * downscale, x1 = std::min(width, x0 + downscale);
+                //The mean signed distance of the block, positive inside, 0 halfway between the texels on either side
+                float sum = 0;
+                for (int y = y0; y < y1; y++) {
+                    for (int x = x0; x < x1; x++) {
+                        const size_t i = (size_t)y * width + x;
+                        sum += inside[i] ? std::sqrt(toOutside[i]) - 0.5f : 0.5f - std::sqrt(toInside[i]);
+                    }
+                }
+                const float distance = sum / ((x1 - x0) * (y1 - y0));
+                const float value = std::min(1.0f, std::max(0.0f, 0.5f + distance * scale));
+                unsigned char* out = pixels + ((size_t)fieldY * fieldWidth + fieldX) * 4;
+                out[0] = r;
+                out[1] = g;
+                out[2] = b;
+                out[3] = (unsigned char)(value * 255 + 0.5f);
+            }
+        }
+    });
+    return result;
+}
+
+void DistanceFieldGenerator::generate (const std::vector<const Pixmap*>& masks, std::vector<Pixmap>& fields) const {
+    fields.clear();
+    fields.resize(masks.size());
+    pool.parallelFor(0, masks.size(), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+            fields[i] = generate(*masks[i], false);
+    });
+}
+
+std::vector<std::shared_ptr<TextureRegion>> DistanceFieldGenerator::generate (PixmapPacker& packer,
+    const std::vector<std::pair<std::string, const Pixmap*>>& masks) const {
+    std::vector<const Pixmap*> pixmaps;
+    pixmaps.reserve(masks.size());
+    for (const auto& mask : masks)
+        pixmaps.push_back(mask.second);
+    std::vector<Pixmap> fields;
+    generate(pixmaps, fields);
+
+    //The packer is not thread safe, pack on the calling thread
+    std::vector<std::shared_ptr<TextureRegion>> regions;
+    regions.reserve(masks.size());
+    for (size_t i = 0; i < masks.size(); i++)
+        regions.push_back(fields[i].isEmpty() ? nullptr : packer.pack(masks[i].first, fields[i]));
+    return regions;
+}
+
+std::shared_ptr<ShaderProgram> DistanceFieldGenerator::createDistanceFieldShader () {
+    const std::string vertexShader = "attribute vec4 " + ShaderProgram::POSITION_ATTRIBUTE + ";\n"
+        "attribute vec4 " + ShaderProgram::COLOR_ATTRIBUTE + ";\n"
+        "attribute vec2 " + ShaderProgram::TEXCOORD_ATTRIBUTE + "0;\n"
+        "uniform mat4 u_projTrans;\n"
+        "varying vec4 v_color;\n"
+        "varying vec2 v_texCoords;\n"
+        "\n"
+        "void main()\n"
+        "{\n"
+        "   v_color = " + ShaderProgram::COLOR_ATTRIBUTE + ";\n"
+        "   v_color.a = v_color.a * (255.0/254.0);\n"
+        "   v_texCoords = " + ShaderProgram::TEXCOORD_ATTRIBUTE + "0;\n"
+        "   gl_Position =  u_projTrans * " + ShaderProgram::POSITION_ATTRIBUTE + ";\n"
+        "}\n";
+    const std::string fragmentShader = "#ifdef GL_ES\n"
+        "#define LOWP lowp\n"
+        "precision mediump float;\n"
+        "#else\n"
+        "#define LOWP \n"
+        "#endif\n"
+        "varying LOWP vec4 v_color;\n"
+        "varying vec2 v_texCoords;\n"
+        "uniform sampler2D u_texture;\n"
+        "uniform float u_smoothing;\n"
+        "void main()\n"
+        "{\n"
+        "  float distance = texture2D(u_texture, v_texCoords).a;\n"
+        "  float alpha = smoothstep(0.5 - u_smoothing, 0.5 + u_smoothing, distance);\n"
+        "  gl_FragColor = vec4(v_color.rgb, v_color.a * alpha);\n"
+        "}";
+
+    std::shared_ptr<ShaderProgram> shader = std::make_shared<ShaderProgram>(vertexShader, fragmentShader, "DistanceField");
+    if (!shader->isCompiled()) SDL_Log("DistanceFieldGenerator: distance field shader failed to compile");
+    return shader;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "../Pixmap.h"
+#include "../glutils/ShaderProgram.h"
+#include "../../utils/ThreadPool.h"
+#include "PixmapPacker.h"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** Generates signed distance fields from high resolution masks, e.g. glyphs or icons rendered large, so they can be drawn
+ * crisply at any scale from one small atlas with {@link #createDistanceFieldShader()}.
+ * <p>
+ * A texel of the mask is inside the shape if its alpha, or its red channel for formats without alpha, is at least half. The
+ * exact Euclidean distance of every texel to the nearest texel on the other side is computed with the separable distance
+ * transform of Felzenszwalb and Huttenlocher, in linear time; the first pass, on the binary mask, is a plain scan of each row.
+ * Both passes run along rows and write their result transposed, so no pass walks down the columns of a large mask. The field
+ * is then averaged over blocks of downscale × downscale texels and stored in the alpha channel: 0.5 on the edge, 1 at spread
+ * texels inside the shape and 0 at spread texels outside. The color channels are the color of the generator.
+ * <p>
+ * A single mask is transformed with its rows split across the {@link ThreadPool}, a list of masks with whole masks per worker.
+ * Generating touches no GL state; only {@link PixmapPacker#updateTextures()} must run on the GL thread afterwards. */
+class DistanceFieldGenerator{
+    int spread;
+    int downscale;
+    unsigned int color = 0xffffff;
+    ThreadPool& pool;
+
+    Pixmap generate (const Pixmap& mask, bool parallel) const;
+public:
+    /** @param spread the distance in texels of the mask at which the field reaches 0 or 1, also the padding added around the
+     * shape
+     * @param downscale the factor the field is smaller than the mask
+     * @param pool the pool running the transforms */
+    DistanceFieldGenerator(int spread = 8, int downscale = 1, ThreadPool& pool = ThreadPool::getShared());
+
+    /** Sets the color of the texels of the field.
+     * @param color 0xRRGGBB */
+    void setColor (unsigned int color) {this->color = color & 0xffffff;}
+
+    int getSpread () const {return spread;}
+
+    int getDownscale () const {return downscale;}
+
+    /** @return the spread in texels of the field, what the smoothing of the shader depends on */
+    float getFieldSpread () const {return (float)spread / downscale;}
+
+    /** @return the RGBA8888 field of the mask, 2 * spread texels larger than the mask before downscaling, or an empty pixmap if
+     * the mask is empty */
+    Pixmap generate (const Pixmap& mask) const {
+        return generate(mask, true);
+    }
+
+    Pixmap generate (SDL2::Surface mask) const {
+        return generate(Pixmap(mask), true);
+    }
+
+    /** Generates the fields of the masks in parallel.
+     * @param fields receives the field of each mask, in order */
+    void generate (const std::vector<const Pixmap*>& masks, std::vector<Pixmap>& fields) const;
+
+    /** Generates the fields of the named masks in parallel and packs them, see {@link PixmapPacker#pack}.
+     * @return the region of each mask, in order, nullptr for masks which did not fit */
+    std::vector<std::shared_ptr<TextureRegion>> generate (PixmapPacker& packer,
+        const std::vector<std::pair<std::string, const Pixmap*>>& masks) const;
+
+    /** Creates a shader for {@link SpriteBatch} drawing distance fields with the batch color. Set its u_smoothing uniform to
+     * about 0.25 / ({@link #getFieldSpread()} * the scale the field is drawn at). */
+    static std::shared_ptr<ShaderProgram> createDistanceFieldShader ();
+};
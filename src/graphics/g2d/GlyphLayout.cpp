@@ -0,0 +1,162 @@
+#include "GlyphLayout.h"
+#include <algorithm>
+
+bool GlyphLayout::setText (const BitmapFont& font, const std::string& text, const Color& color, float targetWidth, int halign,
+	bool wrap){
+	const float packedColor = Color::toFloatBits(color.r, color.g, color.b, color.a);
+	if (this->font == &font && fontVersion == font.getVersion() && this->targetWidth == targetWidth && this->halign == halign
+		&& this->wrap == wrap && this->text == text) {
+		if (this->color == packedColor) return false;
+		this->color = packedColor;
+		for (GlyphRun& run : runs)
+			run.color = packedColor;
+		return true;
+	}
+
+	this->font = &font;
+	fontVersion = font.getVersion();
+	this->text = text;
+	this->targetWidth = targetWidth;
+	this->halign = halign;
+	this->wrap = wrap;
+	this->color = packedColor;
+	runs.clear();
+	width = 0;
+	height = 0;
+
+	std::vector<uint32_t> codePoints;
+	decodeUtf8(text, codePoints);
+	const float scaleX = font.getScaleX();
+	const float down = -font.getLineHeight();
+	const bool wrapping = wrap && targetWidth > 0;
+	float y = 0;
+	int lines = 0;
+	for (size_t lineStart = 0; lineStart <= codePoints.size();) {
+		size_t lineEnd = lineStart;
+		while (lineEnd < codePoints.size() && codePoints[lineEnd] != '\n')
+			lineEnd++;
+
+		size_t start = lineStart;
+		do {
+			size_t end = lineEnd, next = lineEnd;
+			if (wrapping) {
+				//Find the first glyph past the target width, then break at the last space before it
+				const BitmapFont::Glyph* last = nullptr;
+				size_t lastSpace = start;
+				float penX = 0;
+				for (size_t i = start; i < lineEnd; i++) {
+					const BitmapFont::Glyph* glyph = font.getGlyph(codePoints[i]);
+					if (!glyph) continue;
+					penX = last ? penX + (last->xadvance + font.getKerning(last->id, glyph->id)) * scaleX : -glyph->xoffset * scaleX;
+					if (codePoints[i] == ' ')
+						lastSpace = i;
+					else if (last && penX + (glyph->xoffset + glyph->width) * scaleX > targetWidth) {
+						end = next = lastSpace > start ? lastSpace : i;
+						break;
+					}
+					last = glyph;
+				}
+				while (end > start && codePoints[end - 1] == ' ')
+					end--;
+				while (next < lineEnd && codePoints[next] == ' ')
+					next++;
+			}
+			addRun(font, codePoints, start, end, y);
+			y += down;
+			lines++;
+			start = next;
+		} while (start < lineEnd);
+		lineStart = lineEnd + 1;
+	}
+
+	for (GlyphRun& run : runs) {
+		width = std::max(width, run.width);
+		run.color = packedColor;
+	}
+	//Align each run within the target width, or around x without one
+	const float alignWidth = targetWidth > 0 ? targetWidth : 0;
+	for (GlyphRun& run : runs) {
+		if (halign & Align::center)
+			run.x = (alignWidth - run.width) / 2;
+		else if (halign & Align::right)
+			run.x = alignWidth - run.width;
+	}
+	if (!runs.empty()) height = font.getCapHeight() + (lines - 1) * font.getLineHeight();
+	return true;
+}
+
+void GlyphLayout::addRun (const BitmapFont& font, const std::vector<uint32_t>& codePoints, size_t start, size_t end, float y){
+	GlyphRun run;
+	run.y = y;
+	const float scaleX = font.getScaleX();
+	const BitmapFont::Glyph* last = nullptr;
+	float penX = 0;
+	for (size_t i = start; i < end; i++) {
+		const BitmapFont::Glyph* glyph = font.getGlyph(codePoints[i]);
+		if (!glyph) continue;
+		//The first glyph is moved left by its offset so the text is flush with x
+		penX = last ? penX + (last->xadvance + font.getKerning(last->id, glyph->id)) * scaleX : -glyph->xoffset * scaleX;
+		last = glyph;
+		if (glyph->width == 0 || glyph->height == 0) continue;
+		run.glyphs.push_back(glyph);
+		run.xPositions.push_back(penX);
+		run.width = std::max(run.width, penX + (glyph->xoffset + glyph->width) * scaleX);
+	}
+	if (!run.glyphs.empty()) runs.push_back(std::move(run));
+}
+
+void GlyphLayout::reset (){
+	runs.clear();
+	width = 0;
+	height = 0;
+	font = nullptr;
+	text.clear();
+}
+
+int GlyphLayout::getGlyphCount () const {
+	int count = 0;
+	for (const GlyphRun& run : runs)
+		count += run.glyphs.size();
+	return count;
+}
+
+void GlyphLayout::decodeUtf8 (const std::string& text, std::vector<uint32_t>& codePoints){
+	codePoints.clear();
+	codePoints.reserve(text.size());
+	const unsigned char* bytes = (const unsigned char*)text.data();
+	const size_t length = text.size();
+	for (size_t i = 0; i < length;) {
+		const unsigned char lead = bytes[i];
+		int extra;
+		uint32_t codePoint, min;
+		if (lead < 0x80) {
+			codePoints.push_back(lead);
+			i++;
+			continue;
+		} else if ((lead & 0xe0) == 0xc0) {
+			extra = 1;
+			codePoint = lead & 0x1f;
+			min = 0x80;
+		} else if ((lead & 0xf0) == 0xe0) {
+			extra = 2;
+			codePoint = lead & 0x0f;
+			min = 0x800;
+		} else if ((lead & 0xf8) == 0xf0) {
+			extra = 3;
+			codePoint = lead & 0x07;
+			min = 0x10000;
+		} else {
+			codePoints.push_back(0xfffd);
+			i++;
+			continue;
+		}
+		size_t j = i + 1;
+		for (; j <= i + extra && j < length && (bytes[j] & 0xc0) == 0x80; j++)
+			codePoint = codePoint << 6 | (bytes[j] & 0x3f);
+		if (j != i + extra + 1 || codePoint < min || codePoint > 0x10ffff || (codePoint >= 0xd800 && codePoint <= 0xdfff))
+			codePoints.push_back(0xfffd);
+		else
+			codePoints.push_back(codePoint);
+		i = j;
+	}
+}
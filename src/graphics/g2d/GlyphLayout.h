@@ -0,0 +1,74 @@
+#pragma once
+#include "BitmapFont.h"
+#include <string>
+#include <vector>
+
+/** Stores the runs of glyphs for a piece of text: the line breaks, the kerning and the position of each glyph, so drawing the
+ * text needs no more layout work. {@link #setText} does nothing when called again with the same text and parameters for the
+ * same font, as long as the font was not scaled since, so a layout can be set every frame at no cost.
+ * <p>
+ * The text is UTF-8. Lines are broken at newlines and, when wrapping, at the last space before the target width, or before the
+ * glyph overflowing it for words longer than the width. Characters without a glyph in the font are skipped.
+ * @author Nathan Sweet */
+class GlyphLayout{
+public:
+	/** Stores glyphs and positions for a line of text.
+	 * @author Nathan Sweet */
+	struct GlyphRun{
+		std::vector<const BitmapFont::Glyph*> glyphs;
+		/** the x of each glyph relative to the run, where its offset is added */
+		std::vector<float> xPositions;
+		/** the position of the run relative to the layout, y being the top of the capital letters */
+		float x = 0, y = 0;
+		float width = 0;
+		/** the packed color of the glyphs */
+		float color = 0;
+	};
+
+	std::vector<GlyphRun> runs;
+	float width = 0, height = 0;
+private:
+	const BitmapFont* font = nullptr;
+	unsigned int fontVersion = 0;
+	std::string text;
+	float targetWidth = 0;
+	int halign = Align::left;
+	bool wrap = false;
+	float color = 0;
+
+	/** Lays out the code points in a new run, starting at x = 0. */
+	void addRun (const BitmapFont& font, const std::vector<uint32_t>& codePoints, size_t start, size_t end, float y);
+public:
+	GlyphLayout(){}
+
+	/** Calls {@link #setText} with the color of the font. */
+	GlyphLayout(const BitmapFont& font, const std::string& text) {
+		setText(font, text);
+	}
+
+	GlyphLayout(const BitmapFont& font, const std::string& text, const Color& color, float targetWidth, int halign, bool wrap) {
+		setText(font, text, color, targetWidth, halign, wrap);
+	}
+
+	/** Calls {@link #setText} with the color of the font, no target width and no wrapping. */
+	bool setText (const BitmapFont& font, const std::string& text) {
+		return setText(font, text, font.getColor(), 0, Align::left, false);
+	}
+
+	/** Lays out the text, unless it is the same as the last time for the same font and parameters. A different color alone only
+	 * recolors the runs.
+	 * @param targetWidth the width to align and wrap the text within, 0 aligns around x
+	 * @param halign one of {@link Align#left}, {@link Align#center} or {@link Align#right}
+	 * @return whether the layout changed */
+	bool setText (const BitmapFont& font, const std::string& text, const Color& color, float targetWidth, int halign,
+		bool wrap);
+
+	/** Clears the runs and forgets the text. */
+	void reset ();
+
+	/** @return the number of glyphs in the runs */
+	int getGlyphCount () const;
+
+	/** Decodes the UTF-8 text, invalid sequences become U+FFFD. */
+	static void decodeUtf8 (const std::string& text, std::vector<uint32_t>& codePoints);
+};
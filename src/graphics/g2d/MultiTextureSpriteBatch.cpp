@@ -0,0 +1,144 @@
+#include "MultiTextureSpriteBatch.h"
+#include "../VertexAttribute.h"
+#include <algorithm>
+#include <sstream>
+
+const std::string MultiTextureSpriteBatch::TEXTURE_INDEX_ATTRIBUTE = "a_texIndex";
+
+static std::vector<VertexAttribute> createIndexedAttributes (std::vector<VertexAttribute> attributes){
+	attributes.push_back(VertexAttribute(GENERIC, 1, GL_FLOAT, false, MultiTextureSpriteBatch::TEXTURE_INDEX_ATTRIBUTE));
+	return attributes;
+}
+
+MultiTextureSpriteBatch::MultiTextureSpriteBatch(int size, int maxTextures, std::shared_ptr<ShaderProgram> defaultShader)
+	:SpriteBatch(size, defaultShader ? defaultShader : createDefaultShader(getSupportedTextures(maxTextures)),
+	createIndexedAttributes(createAttributes())),maxTextures(getSupportedTextures(maxTextures)){
+	textures.resize(this->maxTextures);
+	fetchHandles();
+}
+
+int MultiTextureSpriteBatch::getSupportedTextures (int maxTextures){
+	GLint units = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &units);
+	if (units <= 0) units = 8;
+	if (maxTextures <= 0) maxTextures = MAX_TEXTURES;
+	return std::max(1, std::min(maxTextures, std::min((int)units, (int)MAX_TEXTURES)));
+}
+
+std::shared_ptr<ShaderProgram> MultiTextureSpriteBatch::createDefaultShader (int maxTextures){
+	const std::string vertexShader = "attribute vec4 " + ShaderProgram::POSITION_ATTRIBUTE + ";\n"
+		"attribute vec4 " + ShaderProgram::COLOR_ATTRIBUTE + ";\n"
+		"attribute vec2 " + ShaderProgram::TEXCOORD_ATTRIBUTE + "0;\n"
+		"attribute float " + TEXTURE_INDEX_ATTRIBUTE + ";\n"
+		"uniform mat4 u_projTrans;\n"
+		"varying vec4 v_color;\n"
+		"varying vec2 v_texCoords;\n"
+		"varying float v_texIndex;\n"
+		"\n"
+		"void main()\n"
+		"{\n"
+		"   v_color = " + ShaderProgram::COLOR_ATTRIBUTE + ";\n"
+		"   v_color.a = v_color.a * (255.0/254.0);\n"
+		"   v_texCoords = " + ShaderProgram::TEXCOORD_ATTRIBUTE + "0;\n"
+		"   v_texIndex = " + TEXTURE_INDEX_ATTRIBUTE + ";\n"
+		"   gl_Position =  u_projTrans * " + ShaderProgram::POSITION_ATTRIBUTE + ";\n"
+		"}\n";
+
+	//GLSL ES 1.00 only indexes sampler arrays with constants, so the unit is picked by comparisons
+	std::stringstream fragmentShader;
+	fragmentShader << "#ifdef GL_ES\n"
+		"#define LOWP lowp\n"
+		"precision mediump float;\n"
+		"#else\n"
+		"#define LOWP \n"
+		"#endif\n"
+		"varying LOWP vec4 v_color;\n"
+		"varying vec2 v_texCoords;\n"
+		"varying float v_texIndex;\n"
+		"uniform sampler2D u_textures[" << maxTextures << "];\n"
+		"void main()\n"
+		"{\n"
+		"  vec4 texel;\n";
+	for (int i = 0; i < maxTextures; i++) {
+		fragmentShader << "  ";
+		if (i > 0) fragmentShader << "else ";
+		if (i < maxTextures - 1) fragmentShader << "if (v_texIndex < " << i << ".5) ";
+		fragmentShader << "texel = texture2D(u_textures[" << i << "], v_texCoords);\n";
+	}
+	fragmentShader << "  gl_FragColor = v_color * texel;\n"
+		"}";
+
+	std::shared_ptr<ShaderProgram> shader = std::make_shared<ShaderProgram>(vertexShader, fragmentShader.str(),
+		"MultiTextureSpriteBatch");
+	if (!shader->isCompiled()) SDL_Log("MultiTextureSpriteBatch: default shader failed to compile");
+	return shader;
+}
+
+void MultiTextureSpriteBatch::begin (){
+	textureSwitches = 0;
+	SpriteBatch::begin();
+}
+
+void MultiTextureSpriteBatch::end (){
+	SpriteBatch::end();
+	releaseTextures();
+}
+
+void MultiTextureSpriteBatch::releaseTextures (){
+	for (std::shared_ptr<Texture>& texture : textures) texture = nullptr;
+	usedTextures = 0;
+}
+
+void MultiTextureSpriteBatch::switchTexture (const std::shared_ptr<Texture>& texture){
+	if (lastTexture) textureSwitches++;
+	lastTexture = texture;
+	for (int i = 0; i < maxTextures; i++) {
+		if (textures[i] == texture) {
+			textureIndex = i;
+			return;
+		}
+	}
+
+	if (usedTextures == maxTextures) {
+		//Every unit is sampled by the batch, it must be drawn before the units are given away
+		flush();
+		releaseTextures();
+	}
+	//Prefer a unit the texture is still bound to from an earlier batch, it needn't be bound again
+	GLStateCache& cache = GLStateCache::get();
+	int unit = -1;
+	for (int i = 0; i < maxTextures; i++) {
+		if (textures[i]) continue;
+		if (unit == -1) unit = i;
+		if (cache.getBoundTexture(i, GL_TEXTURE_2D) == texture->getTextureObjectHandle()) {
+			unit = i;
+			break;
+		}
+	}
+	textures[unit] = texture;
+	usedTextures++;
+	textureIndex = unit;
+}
+
+void MultiTextureSpriteBatch::bindTextures (){
+	for (int i = 0; i < maxTextures; i++)
+		if (textures[i]) textures[i]->bind(i);
+}
+
+void MultiTextureSpriteBatch::setupMatrices (){
+	SpriteBatch::setupMatrices();
+	if (samplersSet) return;
+	ShaderProgram& shader = getActiveShader();
+	for (int i = 0; i < (int)samplerLocations.size(); i++)
+		if (samplerLocations[i] >= 0) shader.setUniformi(samplerLocations[i], i);
+	samplersSet = true;
+}
+
+void MultiTextureSpriteBatch::fetchHandles (){
+	SpriteBatch::fetchHandles();
+	ShaderProgram& shader = getActiveShader();
+	samplerLocations.resize(maxTextures);
+	for (int i = 0; i < maxTextures; i++)
+		samplerLocations[i] = shader.fetchUniformLocation("u_textures[" + std::to_string(i) + "]", false);
+	samplersSet = false;
+}
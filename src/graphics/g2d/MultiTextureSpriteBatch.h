@@ -0,0 +1,66 @@
+#pragma once
+#include "SpriteBatch.h"
+
+/** A {@link SpriteBatch} that doesn't flush when the texture changes. The textures of a batch are bound to several texture units
+ * at once and each vertex carries the index of the unit its texture is bound to, so sprites of up to {@link #getMaxTextures()}
+ * different textures are drawn with one call. Only when a batch needs one texture more than there are units is it flushed, the
+ * same as {@link SpriteBatch} does on every texture change, and the next batch starts with every unit free.
+ * <p>
+ * The textures stay bound to their units after a flush and after {@link #end()}, so the next batch or frame drawing the textures
+ * in the same order binds nothing at all, see {@link GLStateCache}.
+ * <p>
+ * Custom shaders get the texture index as the float attribute {@link #TEXTURE_INDEX_ATTRIBUTE} and the units in the sampler
+ * array u_textures, see {@link #createDefaultShader(int)}. */
+class MultiTextureSpriteBatch: public SpriteBatch{
+public:
+	/** the name of the texture index attribute */
+	static const std::string TEXTURE_INDEX_ATTRIBUTE;
+	/** the most texture units used, GLES 3 guarantees 16 units to the fragment shader */
+	static const int MAX_TEXTURES = 16;
+private:
+	int maxTextures;
+	/** the textures sampled by the batch, by unit, nullptr for free units */
+	std::vector<std::shared_ptr<Texture>> textures;
+	int usedTextures = 0;
+	/** the locations of u_textures of the active shader, set once per shader */
+	std::vector<int> samplerLocations;
+	bool samplersSet = false;
+	int textureSwitches = 0;
+
+	static int getSupportedTextures (int maxTextures);
+
+	void releaseTextures ();
+protected:
+	void switchTexture (const std::shared_ptr<Texture>& texture) override;
+
+	void bindTextures () override;
+
+	void setupMatrices () override;
+
+	void fetchHandles () override;
+public:
+	/** @param size the max number of sprites in a single batch
+	 * @param maxTextures the most textures in a single batch, or 0 for as many as the fragment shader can sample, up to
+	 *           {@link #MAX_TEXTURES}
+	 * @param defaultShader the default shader to use, nullptr to create one with {@link #createDefaultShader(int)} */
+	MultiTextureSpriteBatch(int size = 1000, int maxTextures = 0, std::shared_ptr<ShaderProgram> defaultShader = nullptr);
+
+	/** Returns a new instance of the default shader, sampling the texture with the vertex's index out of maxTextures units. */
+	static std::shared_ptr<ShaderProgram> createDefaultShader (int maxTextures);
+
+	/** @return the most textures in a single batch */
+	int getMaxTextures () const {
+		return maxTextures;
+	}
+
+	/** @return the number of texture changes between sprites since the last {@link #begin()}, each of which would have flushed a
+	 *         {@link SpriteBatch} */
+	int getTextureSwitches () const {
+		return textureSwitches;
+	}
+
+	void begin () override;
+
+	/** Finishes off rendering and releases the textures of the last batch, which stay bound to their units. */
+	void end () override;
+};
@@ -0,0 +1,274 @@
+#include "PixmapPacker.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+static bool intersects (const PixmapPacker::Rect& a, const PixmapPacker::Rect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static bool contains (const PixmapPacker::Rect& a, const PixmapPacker::Rect& b) {
+    return b.x >= a.x && b.y >= a.y && b.x + b.width <= a.x + a.width && b.y + b.height <= a.y + a.height;
+}
+
+/** Removes the free rectangles contained in another one. */
+static void prune (std::vector<PixmapPacker::Rect>& rects) {
+    for (size_t i = 0; i < rects.size(); i++) {
+        for (size_t j = i + 1; j < rects.size();) {
+            if (contains(rects[i], rects[j])) {
+                rects.erase(rects.begin() + j);
+            } else if (contains(rects[j], rects[i])) {
+                rects.erase(rects.begin() + i);
+                j = i + 1;
+            } else j++;
+        }
+    }
+}
+
+PixmapPacker::PixmapPacker(int maxPageWidth, int maxPageHeight, int padding, bool duplicateBorder, PackStrategy strategy,
+    int initialPageSize)
+    :maxPageWidth(maxPageWidth),maxPageHeight(maxPageHeight),padding(std::max(0, padding)),duplicateBorder(duplicateBorder),
+    strategy(strategy){
+    this->initialPageSize = initialPageSize > 0 ? initialPageSize : std::max(maxPageWidth, maxPageHeight);
+}
+
+PixmapPacker::Page* PixmapPacker::newPage (int width, int height){
+    std::unique_ptr<Page> page(new Page());
+    page->width = width;
+    page->height = height;
+    page->pixels.assign((size_t)width * height * 4, 0);
+    page->freeRects.push_back(Rect{0, 0, width, height});
+    page->skyline.push_back(SkylineNode{0, 0, width});
+    pages.push_back(std::move(page));
+    return pages.back().get();
+}
+
+void PixmapPacker::resize (Page& page, int width, int height){
+    std::vector<unsigned char> pixels((size_t)width * height * 4, 0);
+    for (int y = 0; y < page.height; y++)
+        memcpy(pixels.data() + (size_t)y * width * 4, page.pixels.data() + (size_t)y * page.width * 4, (size_t)page.width * 4);
+    page.pixels.swap(pixels);
+
+    //Free rectangles reaching the old edges extend into the new space, so images can straddle the old edge
+    for (Rect& rect : page.freeRects) {
+        if (rect.x + rect.width == page.width) rect.width = width - rect.x;
+        if (rect.y + rect.height == page.height) rect.height = height - rect.y;
+    }
+    if (width > page.width) {
+        page.freeRects.push_back(Rect{page.width, 0, width - page.width, height});
+        page.skyline.push_back(SkylineNode{page.width, 0, width - page.width});
+    }
+    if (height > page.height) page.freeRects.push_back(Rect{0, page.height, width, height - page.height});
+    prune(page.freeRects);
+
+    page.width = width;
+    page.height = height;
+    page.resized = true;
+}
+
+bool PixmapPacker::grow (Page& page, int width, int height, Rect& out){
+    while (page.width < maxPageWidth || page.height < maxPageHeight) {
+        int newWidth = page.width, newHeight = page.height;
+        if ((newWidth <= newHeight || newHeight >= maxPageHeight) && newWidth < maxPageWidth)
+            newWidth = std::min(maxPageWidth, newWidth * 2);
+        else newHeight = std::min(maxPageHeight, newHeight * 2);
+        resize(page, newWidth, newHeight);
+        if (insert(page, width, height, out)) return true;
+    }
+    return false;
+}
+
+bool PixmapPacker::insert (Page& page, int width, int height, Rect& out){
+    return strategy == SKYLINE ? insertSkyline(page, width, height, out) : insertMaxRects(page, width, height, out);
+}
+
+bool PixmapPacker::insertMaxRects (Page& page, int width, int height, Rect& out){
+    int bestShortSide = INT_MAX, bestLongSide = INT_MAX;
+    for (const Rect& rect : page.freeRects) {
+        if (rect.width < width || rect.height < height) continue;
+        const int leftoverX = rect.width - width, leftoverY = rect.height - height;
+        const int shortSide = std::min(leftoverX, leftoverY), longSide = std::max(leftoverX, leftoverY);
+        if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide)) {
+            out = Rect{rect.x, rect.y, width, height};
+            bestShortSide = shortSide;
+            bestLongSide = longSide;
+        }
+    }
+    if (bestShortSide == INT_MAX) return false;
+
+    //Split every free rectangle overlapping the placed one into the maximal rectangles around it
+    std::vector<Rect> freeRects;
+    for (const Rect& rect : page.freeRects) {
+        if (!intersects(rect, out)) {
+            freeRects.push_back(rect);
+            continue;
+        }
+        if (out.x > rect.x) freeRects.push_back(Rect{rect.x, rect.y, out.x - rect.x, rect.height});
+        if (out.x + out.width < rect.x + rect.width)
+            freeRects.push_back(Rect{out.x + out.width, rect.y, rect.x + rect.width - out.x - out.width, rect.height});
+        if (out.y > rect.y) freeRects.push_back(Rect{rect.x, rect.y, rect.width, out.y - rect.y});
+        if (out.y + out.height < rect.y + rect.height)
+            freeRects.push_back(Rect{rect.x, out.y + out.height, rect.width, rect.y + rect.height - out.y - out.height});
+    }
+    prune(freeRects);
+    page.freeRects.swap(freeRects);
+    return true;
+}
+
+bool PixmapPacker::insertSkyline (Page& page, int width, int height, Rect& out){
+    std::vector<SkylineNode>& skyline = page.skyline;
+    int bestIndex = -1, bestBottom = INT_MAX, bestWidth = INT_MAX;
+    for (size_t i = 0; i < skyline.size(); i++) {
+        const int x = skyline[i].x;
+        if (x + width > page.width) break;
+        int y = 0;
+        for (size_t j = i; j < skyline.size() && skyline[j].x < x + width; j++) y = std::max(y, skyline[j].y);
+        if (y + height > page.height) continue;
+        if (y + height < bestBottom || (y + height == bestBottom && skyline[i].width < bestWidth)) {
+            bestIndex = i;
+            bestBottom = y + height;
+            bestWidth = skyline[i].width;
+            out = Rect{x, y, width, height};
+        }
+    }
+    if (bestIndex == -1) return false;
+
+    skyline.insert(skyline.begin() + bestIndex, SkylineNode{out.x, out.y + height, width});
+    //Shrink or remove the nodes now covered by the new one
+    for (size_t i = bestIndex + 1; i < skyline.size();) {
+        const int end = skyline[i - 1].x + skyline[i - 1].width;
+        if (skyline[i].x >= end) break;
+        const int shrink = end - skyline[i].x;
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width > 0) break;
+        skyline.erase(skyline.begin() + i);
+    }
+    for (size_t i = 1; i < skyline.size();) {
+        if (skyline[i - 1].y == skyline[i].y) {
+            skyline[i - 1].width += skyline[i].width;
+            skyline.erase(skyline.begin() + i);
+        } else i++;
+    }
+    return true;
+}
+
+void PixmapPacker::copy (Page& page, const Rect& rect, const unsigned char* pixels, int width, int height, int pitch){
+    for (int row = 0; row < rect.height; row++) {
+        unsigned char* dst = page.pixels.data() + ((size_t)(rect.y + row) * page.width + rect.x) * 4;
+        const int y = row - padding;
+        if ((y < 0 || y >= height) && !duplicateBorder) {
+            memset(dst, 0, (size_t)rect.width * 4);
+            continue;
+        }
+        const unsigned char* src = pixels + (size_t)std::min(height - 1, std::max(0, y)) * pitch;
+        for (int x = 0; x < padding; x++) {
+            if (duplicateBorder) {
+                memcpy(dst + x * 4, src, 4);
+                memcpy(dst + (padding + width + x) * 4, src + (width - 1) * 4, 4);
+            } else {
+                memset(dst + x * 4, 0, 4);
+                memset(dst + (padding + width + x) * 4, 0, 4);
+            }
+        }
+        memcpy(dst + padding * 4, src, (size_t)width * 4);
+    }
+
+    if (page.dirtyX1 <= page.dirtyX0) {
+        page.dirtyX0 = rect.x;
+        page.dirtyY0 = rect.y;
+        page.dirtyX1 = rect.x + rect.width;
+        page.dirtyY1 = rect.y + rect.height;
+    } else {
+        page.dirtyX0 = std::min(page.dirtyX0, rect.x);
+        page.dirtyY0 = std::min(page.dirtyY0, rect.y);
+        page.dirtyX1 = std::max(page.dirtyX1, rect.x + rect.width);
+        page.dirtyY1 = std::max(page.dirtyY1, rect.y + rect.height);
+    }
+}
+
+std::shared_ptr<TextureRegion> PixmapPacker::pack (const std::string& name, const unsigned char* rgba, int width, int height){
+    auto existing = regions.find(name);
+    if (existing != regions.end()) return existing->second;
+    const int packedWidth = width + padding * 2, packedHeight = height + padding * 2;
+    if (width <= 0 || height <= 0 || packedWidth > maxPageWidth || packedHeight > maxPageHeight) {
+        SDL_Log("PixmapPacker: %s (%dx%d) doesn't fit a %dx%d page", name.c_str(), width, height, maxPageWidth, maxPageHeight);
+        return nullptr;
+    }
+
+    Rect rect;
+    Page* page = nullptr;
+    for (auto& candidate : pages) {
+        if (insert(*candidate, packedWidth, packedHeight, rect)) {
+            page = candidate.get();
+            break;
+        }
+    }
+    //Only the last page can still grow, the previous ones reached the maximum size before it was added
+    if (page == nullptr && !pages.empty() && grow(*pages.back(), packedWidth, packedHeight, rect)) page = pages.back().get();
+    if (page == nullptr) {
+        page = newPage(std::min(initialPageSize, maxPageWidth), std::min(initialPageSize, maxPageHeight));
+        if (!insert(*page, packedWidth, packedHeight, rect)) grow(*page, packedWidth, packedHeight, rect);
+    }
+
+    copy(*page, rect, rgba, width, height, width * 4);
+    std::shared_ptr<TextureRegion> region = std::make_shared<TextureRegion>();
+    page->regions.push_back(std::make_pair(Rect{rect.x + padding, rect.y + padding, width, height}, region));
+    regions[name] = region;
+    return region;
+}
+
+std::shared_ptr<TextureRegion> PixmapPacker::pack (const std::string& name, SDL2::Surface image){
+    if (!image) return nullptr;
+    SDL2::Surface rgba(SDL_ConvertSurfaceFormat(image.get(), SDL_PIXELFORMAT_RGBA32, 0));
+    if (!rgba) {
+        SDL_Log("PixmapPacker: cannot convert %s: %s", name.c_str(), SDL_GetError());
+        return nullptr;
+    }
+    //Converted surfaces may have padded rows
+    std::vector<unsigned char> pixels((size_t)rgba->w * rgba->h * 4);
+    for (int y = 0; y < rgba->h; y++)
+        memcpy(pixels.data() + (size_t)y * rgba->w * 4, (unsigned char*)rgba->pixels + (size_t)y * rgba->pitch, (size_t)rgba->w * 4);
+    return pack(name, pixels.data(), rgba->w, rgba->h);
+}
+
+std::shared_ptr<TextureRegion> PixmapPacker::pack (const std::string& name, const Pixmap& pixmap){
+    if (pixmap.getFormat() == Pixmap::RGBA8888) return pack(name, pixmap.getPixels(), pixmap.getWidth(), pixmap.getHeight());
+    const Pixmap rgba = pixmap.convert(Pixmap::RGBA8888);
+    return pack(name, rgba.getPixels(), rgba.getWidth(), rgba.getHeight());
+}
+
+std::shared_ptr<TextureRegion> PixmapPacker::getRegion (const std::string& name) const{
+    auto region = regions.find(name);
+    return region != regions.end() ? region->second : nullptr;
+}
+
+void PixmapPacker::updateTextures (){
+    for (auto& page : pages) {
+        if (page->resized) {
+            //A new texture of the new size, the regions switch to it and get coordinates relative to it
+            GLuint handle;
+            glGenTextures(1, &handle);
+            GLStateCache::get().bindTexture(GL_TEXTURE_2D, handle);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, page->width, page->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, page->pixels.data());
+            page->texture = std::make_shared<Texture>(GL_TEXTURE_2D, handle, page->width, page->height, minFilter, magFilter,
+                GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, false);
+            for (auto& packed : page->regions) {
+                packed.second->setTexture(page->texture);
+                packed.second->setRegion(packed.first.x, packed.first.y, packed.first.width, packed.first.height);
+            }
+            page->resized = false;
+        } else if (page->dirtyX1 > page->dirtyX0) {
+            page->texture->draw(page->pixels.data(), page->width, page->dirtyX0, page->dirtyY0, page->dirtyX1 - page->dirtyX0,
+                page->dirtyY1 - page->dirtyY0, GL_RGBA);
+            Texture::unbind(GL_TEXTURE_2D);
+            for (auto& packed : page->regions) {
+                if (packed.second->getTexture() == page->texture) continue;
+                packed.second->setTexture(page->texture);
+                packed.second->setRegion(packed.first.x, packed.first.y, packed.first.width, packed.first.height);
+            }
+        }
+        page->dirtyX0 = page->dirtyY0 = page->dirtyX1 = page->dirtyY1 = 0;
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "../../GL.h"
+#include "../Pixmap.h"
+#include "TextureRegion.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** Packs images into atlas pages at runtime, so sprites loaded separately end up in a few textures and can be drawn without
+ * switching textures in between. Each image gets {@link #getPadding()} texels on every side, filled with copies of its edge
+ * texels if duplicateBorder is set so filtering at the region edges doesn't bleed in the neighbours.
+ * <p>
+ * Pages start small and double, alternating width and height, up to the maximum page size; when a full size page has no room
+ * left a new page is added. Images are only copied to the CPU copy of their page by {@link #pack}; {@link #updateTextures()}
+ * uploads the changed rectangle of each page with glTexSubImage2D, creating or resizing the textures as needed, and updates
+ * the returned regions. Call it once after a batch of packs, before drawing, on the GL thread.
+ * <p>
+ * Pages are GL_RGBA without mip maps, so use GL_NEAREST or GL_LINEAR filters. */
+class PixmapPacker{
+public:
+    enum PackStrategy{
+        /** MaxRects with the best short side fit, the tightest packing */
+        MAX_RECTS,
+        /** bottom left skyline, faster but wastes the space under tall images */
+        SKYLINE
+    };
+
+    /** A rectangle in page texels. */
+    struct Rect{
+        int x, y, width, height;
+    };
+private:
+    struct SkylineNode{
+        int x, y, width;
+    };
+
+    struct Page{
+        int width, height;
+        std::vector<unsigned char> pixels;
+        std::shared_ptr<Texture> texture;
+        std::vector<Rect> freeRects;
+        std::vector<SkylineNode> skyline;
+        /** the packed images and their regions */
+        std::vector<std::pair<Rect, std::shared_ptr<TextureRegion>>> regions;
+        /** the bounds of the texels changed since the last upload, empty if dirtyX1 <= dirtyX0 */
+        int dirtyX0 = 0, dirtyY0 = 0, dirtyX1 = 0, dirtyY1 = 0;
+        /** whether the page was resized since the last upload and needs a new texture */
+        bool resized = true;
+    };
+
+    int maxPageWidth, maxPageHeight;
+    int initialPageSize;
+    int padding;
+    bool duplicateBorder;
+    PackStrategy strategy;
+    GLenum minFilter = GL_LINEAR, magFilter = GL_LINEAR;
+    std::vector<std::unique_ptr<Page>> pages;
+    std::map<std::string, std::shared_ptr<TextureRegion>> regions;
+
+    Page* newPage (int width, int height);
+
+    /** Doubles the page until an image of the given size fits or the maximum size is reached. @return whether it fits */
+    bool grow (Page& page, int width, int height, Rect& out);
+
+    void resize (Page& page, int width, int height);
+
+    bool insert (Page& page, int width, int height, Rect& out);
+
+    static bool insertMaxRects (Page& page, int width, int height, Rect& out);
+
+    static bool insertSkyline (Page& page, int width, int height, Rect& out);
+
+    /** Copies the image into the page at the given rectangle, which includes the padding. */
+    void copy (Page& page, const Rect& rect, const unsigned char* pixels, int width, int height, int pitch);
+public:
+    /** @param maxPageWidth the maximum width of a page, should not exceed GL_MAX_TEXTURE_SIZE
+     * @param maxPageHeight the maximum height of a page
+     * @param padding the number of texels kept free around each image
+     * @param duplicateBorder whether to fill the padding with the edge texels of the image
+     * @param strategy how the free space of a page is tracked
+     * @param initialPageSize the size new pages start with, the maximum size if 0 */
+    PixmapPacker(int maxPageWidth, int maxPageHeight, int padding, bool duplicateBorder, PackStrategy strategy = MAX_RECTS,
+        int initialPageSize = 256);
+    PixmapPacker(const PixmapPacker&) = delete;
+    PixmapPacker& operator= (const PixmapPacker&) = delete;
+
+    /** Packs tightly packed RGBA8888 texels.
+     * @return the region the image will occupy, updated by {@link #updateTextures()}, or nullptr if the image can't fit a page.
+     * Packing a name twice returns the region packed first. */
+    std::shared_ptr<TextureRegion> pack (const std::string& name, const unsigned char* rgba, int width, int height);
+
+    /** Packs an image of any pixel format, converting it to RGBA8888. */
+    std::shared_ptr<TextureRegion> pack (const std::string& name, SDL2::Surface image);
+
+    /** Packs a pixmap, converting it to RGBA8888 if needed. */
+    std::shared_ptr<TextureRegion> pack (const std::string& name, const Pixmap& pixmap);
+
+    /** @return the region of the image packed under the name, or nullptr */
+    std::shared_ptr<TextureRegion> getRegion (const std::string& name) const;
+
+    /** Creates or resizes the textures of the pages and uploads the texels changed since the last call. */
+    void updateTextures ();
+
+    /** Sets the filters of the page textures. This will bind the existing textures! */
+    void setFilter (GLenum minFilter, GLenum magFilter) {
+        this->minFilter = minFilter;
+        this->magFilter = magFilter;
+        for (auto& page : pages)
+            if (page->texture) page->texture->setFilter(minFilter, magFilter);
+    }
+
+    int getPageCount () const {return pages.size();}
+
+    /** @return the texture of the page, nullptr before the first {@link #updateTextures()} */
+    std::shared_ptr<Texture> getPageTexture (int page) const {return pages[page]->texture;}
+
+    int getPadding () const {return padding;}
+};
@@ -0,0 +1,398 @@
+#include "SpriteBatch.h"
+#include "../VertexAttribute.h"
+#include "../../math/MathUtils.h"
+#include <cstring>
+
+SpriteBatch::SpriteBatch(int size, std::shared_ptr<ShaderProgram> defaultShader)
+	:SpriteBatch(size, defaultShader, createAttributes()){}
+
+SpriteBatch::SpriteBatch(int size, std::shared_ptr<ShaderProgram> defaultShader, const std::vector<VertexAttribute>& attributes)
+	:vertexSize(VertexAttributes(attributes).vertexSize / 4),spriteSize(4 * vertexSize){
+	if (size <= 0) {
+		SDL_Log("SpriteBatch: size must be positive, using 1: %i", size);
+		size = 1;
+	}
+	mesh = std::make_unique<Mesh>(true, false, true, size * 4, size * 6, VertexAttributes(attributes));
+	vertices.resize((size_t)size * spriteSize);
+
+	//Every quad is two triangles of the same layout, so the indices never change
+	std::vector<GLuint> indices((size_t)size * 6);
+	for (GLuint i = 0, j = 0; i < indices.size(); i += 6, j += 4) {
+		indices[i] = j;
+		indices[i + 1] = j + 1;
+		indices[i + 2] = j + 2;
+		indices[i + 3] = j + 2;
+		indices[i + 4] = j + 3;
+		indices[i + 5] = j;
+	}
+	mesh->setIndices(indices);
+
+	GLint viewport[4] = {0, 0, 0, 0};
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	projectionMatrix.setToOrtho2D(0, 0, viewport[2], viewport[3]);
+
+	this->defaultShader = defaultShader ? defaultShader : createDefaultShader();
+	fetchHandles();
+}
+
+std::vector<VertexAttribute> SpriteBatch::createAttributes (){
+	return {VertexAttribute(POSITION, 2, ShaderProgram::POSITION_ATTRIBUTE),
+		VertexAttribute(COLOR_PACKED, 4, GL_UNSIGNED_BYTE, true, ShaderProgram::COLOR_ATTRIBUTE),
+		VertexAttribute(TEXTURE_COORDINATES, 2, ShaderProgram::TEXCOORD_ATTRIBUTE + "0")};
+}
+
+std::shared_ptr<ShaderProgram> SpriteBatch::createDefaultShader (){
+	const std::string vertexShader = "attribute vec4 " + ShaderProgram::POSITION_ATTRIBUTE + ";\n"
+		"attribute vec4 " + ShaderProgram::COLOR_ATTRIBUTE + ";\n"
+		"attribute vec2 " + ShaderProgram::TEXCOORD_ATTRIBUTE + "0;\n"
+		"uniform mat4 u_projTrans;\n"
+		"varying vec4 v_color;\n"
+		"varying vec2 v_texCoords;\n"
+		"\n"
+		"void main()\n"
+		"{\n"
+		"   v_color = " + ShaderProgram::COLOR_ATTRIBUTE + ";\n"
+		//Packed colors lose the lowest alpha bit, see NumberUtils::intToFloatColor
+		"   v_color.a = v_color.a * (255.0/254.0);\n"
+		"   v_texCoords = " + ShaderProgram::TEXCOORD_ATTRIBUTE + "0;\n"
+		"   gl_Position =  u_projTrans * " + ShaderProgram::POSITION_ATTRIBUTE + ";\n"
+		"}\n";
+	const std::string fragmentShader = "#ifdef GL_ES\n"
+		"#define LOWP lowp\n"
+		"precision mediump float;\n"
+		"#else\n"
+		"#define LOWP \n"
+		"#endif\n"
+		"varying LOWP vec4 v_color;\n"
+		"varying vec2 v_texCoords;\n"
+		"uniform sampler2D u_texture;\n"
+		"void main()\n"
+		"{\n"
+		"  gl_FragColor = v_color * texture2D(u_texture, v_texCoords);\n"
+		"}";
+
+	std::shared_ptr<ShaderProgram> shader = std::make_shared<ShaderProgram>(vertexShader, fragmentShader, "SpriteBatch");
+	if (!shader->isCompiled()) SDL_Log("SpriteBatch: default shader failed to compile");
+	return shader;
+}
+
+void SpriteBatch::fetchHandles (){
+	ShaderProgram& shader = getActiveShader();
+	projTransHandle = shader.fetchUniformHandle("u_projTrans");
+	textureHandle = shader.fetchUniformHandle("u_texture");
+}
+
+void SpriteBatch::begin (){
+	if (drawing) {
+		SDL_Log("SpriteBatch.end must be called before begin.");
+		return;
+	}
+	renderCalls = 0;
+
+	GLStateCache::get().depthMask(false);
+	getActiveShader().begin();
+	setupMatrices();
+
+	drawing = true;
+}
+
+void SpriteBatch::end (){
+	if (!drawing) {
+		SDL_Log("SpriteBatch.begin must be called before end.");
+		return;
+	}
+	if (idx > 0) flush();
+	lastTexture = nullptr;
+	drawing = false;
+
+	GLStateCache& cache = GLStateCache::get();
+	cache.depthMask(true);
+	if (isBlendingEnabled()) cache.setEnabled(GL_BLEND, false);
+
+	getActiveShader().end();
+}
+
+void SpriteBatch::switchTexture (const std::shared_ptr<Texture>& texture){
+	flush();
+	lastTexture = texture;
+}
+
+void SpriteBatch::bindTextures (){
+	lastTexture->bind(0);
+}
+
+void SpriteBatch::draw (const std::shared_ptr<Texture>& texture, float x, float y, float width, float height, float u, float v,
+	float u2, float v2){
+	if (!drawing) {
+		SDL_Log("SpriteBatch.begin must be called before draw.");
+		return;
+	}
+
+	if (texture != lastTexture) switchTexture(texture);
+	//A switch doesn't flush when the texture gets a unit of a MultiTextureSpriteBatch
+	if (idx == (int)vertices.size()) flush();
+
+	const float fx2 = x + width;
+	const float fy2 = y + height;
+	const float color = colorPacked;
+	float* out = vertices.data() + idx;
+	out = putVertex(out, x, y, color, u, v);
+	out = putVertex(out, x, fy2, color, u, v2);
+	out = putVertex(out, fx2, fy2, color, u2, v2);
+	out = putVertex(out, fx2, y, color, u2, v);
+	idx += spriteSize;
+}
+
+void SpriteBatch::draw (const std::shared_ptr<Texture>& texture, const float* spriteVertices, int offset, int count){
+	if (!drawing) {
+		SDL_Log("SpriteBatch.begin must be called before draw.");
+		return;
+	}
+
+	if (texture != lastTexture) switchTexture(texture);
+	const int verticesLength = vertices.size();
+	while (count > 0) {
+		if (idx == verticesLength) flush();
+		const int copyCount = std::min(verticesLength - idx, count);
+		float* out = vertices.data() + idx;
+		memcpy(out, spriteVertices + offset, copyCount * sizeof(float));
+		//The caller can't know the unit the texture got, the index after each vertex is written here
+		if (vertexSize != VERTEX_SIZE)
+			for (int i = VERTEX_SIZE; i < copyCount; i += vertexSize)
+				out[i] = textureIndex;
+		idx += copyCount;
+		offset += copyCount;
+		count -= copyCount;
+	}
+}
+
+void SpriteBatch::draw (const TextureRegion& region, float x, float y, float width, float height){
+	if (!drawing) {
+		SDL_Log("SpriteBatch.begin must be called before draw.");
+		return;
+	}
+
+	if (region.texture != lastTexture) switchTexture(region.texture);
+	if (idx == (int)vertices.size()) flush();
+
+	const float fx2 = x + width;
+	const float fy2 = y + height;
+	const float u = region.u;
+	const float v = region.v2;
+	const float u2 = region.u2;
+	const float v2 = region.v;
+	const float color = colorPacked;
+	float* out = vertices.data() + idx;
+	out = putVertex(out, x, y, color, u, v);
+	out = putVertex(out, x, fy2, color, u, v2);
+	out = putVertex(out, fx2, fy2, color, u2, v2);
+	out = putVertex(out, fx2, y, color, u2, v);
+	idx += spriteSize;
+}
+
+void SpriteBatch::draw (const TextureRegion& region, float x, float y, float originX, float originY, float width, float height,
+	float scaleX, float scaleY, float rotation){
+	if (!drawing) {
+		SDL_Log("SpriteBatch.begin must be called before draw.");
+		return;
+	}
+
+	if (region.texture != lastTexture) switchTexture(region.texture);
+	if (idx == (int)vertices.size()) flush();
+
+	// bottom left and top right corner points relative to origin
+	const float worldOriginX = x + originX;
+	const float worldOriginY = y + originY;
+	float fx = -originX;
+	float fy = -originY;
+	float fx2 = width - originX;
+	float fy2 = height - originY;
+
+	// scale
+	if (scaleX != 1 || scaleY != 1) {
+		fx *= scaleX;
+		fy *= scaleY;
+		fx2 *= scaleX;
+		fy2 *= scaleY;
+	}
+
+	// construct corner points, start from top left and go counter clockwise
+	const float p1x = fx;
+	const float p1y = fy;
+	const float p2x = fx;
+	const float p2y = fy2;
+	const float p3x = fx2;
+	const float p3y = fy2;
+	const float p4x = fx2;
+	const float p4y = fy;
+
+	float x1, y1, x2, y2, x3, y3, x4, y4;
+
+	// rotate
+	if (rotation != 0) {
+		const float cos = MathUtils::cosDeg(rotation);
+		const float sin = MathUtils::sinDeg(rotation);
+
+		x1 = cos * p1x - sin * p1y;
+		y1 = sin * p1x + cos * p1y;
+
+		x2 = cos * p2x - sin * p2y;
+		y2 = sin * p2x + cos * p2y;
+
+		x3 = cos * p3x - sin * p3y;
+		y3 = sin * p3x + cos * p3y;
+
+		x4 = x1 + (x3 - x2);
+		y4 = y3 - (y2 - y1);
+	} else {
+		x1 = p1x;
+		y1 = p1y;
+
+		x2 = p2x;
+		y2 = p2y;
+
+		x3 = p3x;
+		y3 = p3y;
+
+		x4 = p4x;
+		y4 = p4y;
+	}
+
+	x1 += worldOriginX;
+	y1 += worldOriginY;
+	x2 += worldOriginX;
+	y2 += worldOriginY;
+	x3 += worldOriginX;
+	y3 += worldOriginY;
+	x4 += worldOriginX;
+	y4 += worldOriginY;
+
+	const float u = region.u;
+	const float v = region.v2;
+	const float u2 = region.u2;
+	const float v2 = region.v;
+	const float color = colorPacked;
+	float* out = vertices.data() + idx;
+	out = putVertex(out, x1, y1, color, u, v);
+	out = putVertex(out, x2, y2, color, u, v2);
+	out = putVertex(out, x3, y3, color, u2, v2);
+	out = putVertex(out, x4, y4, color, u2, v);
+	idx += spriteSize;
+}
+
+void SpriteBatch::draw (const TextureRegion& region, float width, float height, const Affine2& transform){
+	if (!drawing) {
+		SDL_Log("SpriteBatch.begin must be called before draw.");
+		return;
+	}
+
+	if (region.texture != lastTexture) switchTexture(region.texture);
+	if (idx == (int)vertices.size()) flush();
+
+	// construct corner points
+	const float x1 = transform.m02;
+	const float y1 = transform.m12;
+	const float x2 = transform.m01 * height + transform.m02;
+	const float y2 = transform.m11 * height + transform.m12;
+	const float x3 = transform.m00 * width + transform.m01 * height + transform.m02;
+	const float y3 = transform.m10 * width + transform.m11 * height + transform.m12;
+	const float x4 = transform.m00 * width + transform.m02;
+	const float y4 = transform.m10 * width + transform.m12;
+
+	const float u = region.u;
+	const float v = region.v2;
+	const float u2 = region.u2;
+	const float v2 = region.v;
+	const float color = colorPacked;
+	float* out = vertices.data() + idx;
+	out = putVertex(out, x1, y1, color, u, v);
+	out = putVertex(out, x2, y2, color, u, v2);
+	out = putVertex(out, x3, y3, color, u2, v2);
+	out = putVertex(out, x4, y4, color, u2, v);
+	idx += spriteSize;
+}
+
+void SpriteBatch::flush (){
+	if (idx == 0) return;
+
+	renderCalls++;
+	totalRenderCalls++;
+	const int spritesInBatch = idx / spriteSize;
+	if (spritesInBatch > maxSpritesInBatch) maxSpritesInBatch = spritesInBatch;
+	const int count = spritesInBatch * 6;
+
+	bindTextures();
+	mesh->setVertices(vertices, 0, idx);
+
+	GLStateCache& cache = GLStateCache::get();
+	if (blendingDisabled) {
+		cache.setEnabled(GL_BLEND, false);
+	} else {
+		cache.setEnabled(GL_BLEND, true);
+		cache.blendFuncSeparate(blendSrcFunc, blendDstFunc, blendSrcFuncAlpha, blendDstFuncAlpha);
+	}
+
+	mesh->render(getActiveShader(), GL_TRIANGLES, 0, count);
+
+	idx = 0;
+}
+
+void SpriteBatch::disableBlending (){
+	if (blendingDisabled) return;
+	flush();
+	blendingDisabled = true;
+}
+
+void SpriteBatch::enableBlending (){
+	if (!blendingDisabled) return;
+	flush();
+	blendingDisabled = false;
+}
+
+void SpriteBatch::setBlendFunction (GLenum srcFunc, GLenum dstFunc){
+	setBlendFunctionSeparate(srcFunc, dstFunc, srcFunc, dstFunc);
+}
+
+void SpriteBatch::setBlendFunctionSeparate (GLenum srcFuncColor, GLenum dstFuncColor, GLenum srcFuncAlpha,
+	GLenum dstFuncAlpha){
+	if (blendSrcFunc == srcFuncColor && blendDstFunc == dstFuncColor && blendSrcFuncAlpha == srcFuncAlpha
+		&& blendDstFuncAlpha == dstFuncAlpha) return;
+	flush();
+	blendSrcFunc = srcFuncColor;
+	blendDstFunc = dstFuncColor;
+	blendSrcFuncAlpha = srcFuncAlpha;
+	blendDstFuncAlpha = dstFuncAlpha;
+}
+
+void SpriteBatch::setProjectionMatrix (const Matrix4& projection){
+	if (drawing) flush();
+	projectionMatrix.set(projection);
+	if (drawing) setupMatrices();
+}
+
+void SpriteBatch::setTransformMatrix (const Matrix4& transform){
+	if (drawing) flush();
+	transformMatrix.set(transform);
+	if (drawing) setupMatrices();
+}
+
+void SpriteBatch::setupMatrices (){
+	combinedMatrix.set(projectionMatrix).mul(transformMatrix);
+	ShaderProgram& shader = getActiveShader();
+	shader.setUniformMatrix(projTransHandle, combinedMatrix);
+	shader.setUniformi(textureHandle, 0);
+}
+
+void SpriteBatch::setShader (std::shared_ptr<ShaderProgram> shader){
+	if (shader == customShader) return;
+	if (drawing) {
+		flush();
+		getActiveShader().end();
+	}
+	customShader = shader;
+	fetchHandles();
+	if (drawing) {
+		getActiveShader().begin();
+		setupMatrices();
+	}
+}
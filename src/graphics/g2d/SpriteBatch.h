@@ -0,0 +1,264 @@
+#pragma once
+#include "TextureRegion.h"
+#include "../Color.h"
+#include "../Mesh.h"
+#include "../../math/Affine2.h"
+#include "../../math/Matrix4.h"
+#include <memory>
+#include <vector>
+
+/** Draws batched quads using indices. Each sprite is written as four vertices of position, packed color and texture
+ * coordinates into a vertex array that is uploaded to a dynamic {@link Mesh} in one go, drawn with a static index buffer shared
+ * by every quad. The batch is flushed, i.e. drawn with a single call, only when the texture, the shader or the blending changes,
+ * or when it is full, so sprites sharing a texture (e.g. from one atlas) cost one draw call per batch size.
+ * <p>
+ * Drawing happens between {@link #begin()} and {@link #end()}. The batch sets the blend state, the program and texture unit 0
+ * through the {@link GLStateCache}, state that is already set costs nothing.
+ * <p>
+ * The default shader expects the attributes {@link ShaderProgram#POSITION_ATTRIBUTE}, {@link ShaderProgram#COLOR_ATTRIBUTE}
+ * (normalized unsigned bytes) and {@link ShaderProgram#TEXCOORD_ATTRIBUTE}0, and the uniforms u_projTrans and u_texture, custom
+ * shaders must use the same names.
+ * @author mzechner
+ * @author Nathan Sweet */
+class SpriteBatch{
+public:
+	/** the floats per vertex: x, y, packed color, u and v */
+	static const int VERTEX_SIZE = 5;
+	/** the floats per sprite */
+	static const int SPRITE_SIZE = 4 * VERTEX_SIZE;
+
+	/** Number of render calls since the last {@link #begin()}. **/
+	int renderCalls = 0;
+
+	/** Number of rendering calls, ever. Will not be reset unless set manually. **/
+	int totalRenderCalls = 0;
+
+	/** The maximum number of sprites rendered in one batch so far. **/
+	int maxSpritesInBatch = 0;
+private:
+	std::unique_ptr<Mesh> mesh;
+	std::vector<GLfloat> vertices;
+	int idx = 0;
+
+	bool drawing = false;
+
+	Matrix4 transformMatrix;
+	Matrix4 projectionMatrix;
+	Matrix4 combinedMatrix;
+
+	bool blendingDisabled = false;
+	GLenum blendSrcFunc = GL_SRC_ALPHA;
+	GLenum blendDstFunc = GL_ONE_MINUS_SRC_ALPHA;
+	GLenum blendSrcFuncAlpha = GL_SRC_ALPHA;
+	GLenum blendDstFuncAlpha = GL_ONE_MINUS_SRC_ALPHA;
+
+	std::shared_ptr<ShaderProgram> defaultShader;
+	std::shared_ptr<ShaderProgram> customShader;
+	/** the handles of the shader in use, fetched when it changes */
+	UniformHandle projTransHandle, textureHandle;
+
+	Color color = Color(1, 1, 1, 1);
+	float colorPacked = Color::toFloatBits(1.0f, 1.0f, 1.0f, 1.0f);
+
+	/** Writes a vertex, followed by the texture index if the vertices have one.
+	 * @return the position after the vertex */
+	float* putVertex (float* out, float x, float y, float color, float u, float v) const {
+		out[0] = x;
+		out[1] = y;
+		out[2] = color;
+		out[3] = u;
+		out[4] = v;
+		if (vertexSize == VERTEX_SIZE) return out + VERTEX_SIZE;
+		out[5] = textureIndex;
+		return out + VERTEX_SIZE + 1;
+	}
+protected:
+	/** the floats per vertex and per sprite */
+	const int vertexSize, spriteSize;
+	/** the texture of the sprites drawn last */
+	std::shared_ptr<Texture> lastTexture;
+	/** the value written after each vertex if the vertices have a texture index */
+	float textureIndex = 0;
+
+	/** Constructs a batch with the given vertex attributes, the {@link #createAttributes()} optionally followed by one float
+	 * attribute that is written from {@link #textureIndex}. */
+	SpriteBatch(int size, std::shared_ptr<ShaderProgram> defaultShader, const std::vector<VertexAttribute>& attributes);
+
+	ShaderProgram& getActiveShader () {
+		return customShader ? *customShader : *defaultShader;
+	}
+
+	/** Called when a sprite uses another texture than the last one, flushes the batch and makes the texture the last one. */
+	virtual void switchTexture (const std::shared_ptr<Texture>& texture);
+
+	/** Binds the textures of the batch before it is drawn, the last texture to unit 0. */
+	virtual void bindTextures ();
+
+	/** Sets the matrices and samplers of the active shader, which is in use. */
+	virtual void setupMatrices ();
+
+	/** Fetches the uniforms of the active shader. */
+	virtual void fetchHandles ();
+public:
+	/** Constructs a new SpriteBatch with a size of 1000, one buffer, and the default shader.
+	 * @see SpriteBatch#SpriteBatch(int, ShaderProgram) */
+	SpriteBatch():SpriteBatch(1000){}
+
+	/** Constructs a SpriteBatch with one buffer and the default shader.
+	 * @param size The max number of sprites in a single batch. */
+	SpriteBatch(int size):SpriteBatch(size, nullptr){}
+
+	/** Constructs a new SpriteBatch. Sets the projection matrix to an orthographic projection with y-axis point upwards, x-axis
+	 * point to the right and the origin being in the bottom left corner of the screen. The projection will be pixel perfect with
+	 * respect to the current screen resolution.
+	 * @param size The max number of sprites in a single batch.
+	 * @param defaultShader The default shader to use, nullptr to create one with {@link #createDefaultShader()}. */
+	SpriteBatch(int size, std::shared_ptr<ShaderProgram> defaultShader);
+
+	SpriteBatch (const SpriteBatch&) = delete;
+	SpriteBatch& operator= (const SpriteBatch&) = delete;
+
+	virtual ~SpriteBatch(){}
+
+	/** @return the position, packed color and texture coordinates attributes of the vertices */
+	static std::vector<VertexAttribute> createAttributes ();
+
+	/** Returns a new instance of the default shader used by SpriteBatch when no shader is specified. */
+	static std::shared_ptr<ShaderProgram> createDefaultShader ();
+
+	/** Sets up the SpriteBatch for drawing. This will disable depth buffer writing. It enables blending and texturing, as
+	 * configured. */
+	virtual void begin ();
+
+	/** Finishes off rendering. Enables depth writes, disables blending and texturing. Must always be called after a call to
+	 * {@link #begin()} */
+	virtual void end ();
+
+	void setColor (const Color& tint) {
+		color.set(tint);
+		colorPacked = color.toFloatBits();
+	}
+
+	void setColor (float r, float g, float b, float a) {
+		color.set(r, g, b, a);
+		colorPacked = color.toFloatBits();
+	}
+
+	const Color& getColor () const {
+		return color;
+	}
+
+	/** Sets the color as packed ABGR, see {@link Color#toFloatBits()}. */
+	void setPackedColor (float packedColor) {
+		colorPacked = packedColor;
+		Color::abgr8888ToColor(color, packedColor);
+	}
+
+	float getPackedColor () const {
+		return colorPacked;
+	}
+
+	void draw (const std::shared_ptr<Texture>& texture, float x, float y, float width, float height) {
+		draw(texture, x, y, width, height, 0, 1, 1, 0);
+	}
+
+	/** Draws a rectangle with the texture coordinates given, e.g. 0, 1, 1, 0 for the whole texture. */
+	void draw (const std::shared_ptr<Texture>& texture, float x, float y, float width, float height, float u, float v, float u2,
+		float v2);
+
+	/** Draws the given vertices, count floats from offset, which must be whole sprites of {@link #getSpriteSize()} floats laid
+	 * out as this batch writes them. A texture index following each vertex is overwritten with the unit of the texture. */
+	void draw (const std::shared_ptr<Texture>& texture, const float* spriteVertices, int offset, int count);
+
+	/** Draws a rectangle with the bottom left corner at x,y having the width and height of the region. */
+	void draw (const TextureRegion& region, float x, float y) {
+		draw(region, x, y, region.getRegionWidth(), region.getRegionHeight());
+	}
+
+	/** Draws a rectangle with the bottom left corner at x,y and stretching the region to cover the given width and height. */
+	void draw (const TextureRegion& region, float x, float y, float width, float height);
+
+	/** Draws a rectangle with the bottom left corner at x,y and stretching the region to cover the given width and height. The
+	 * rectangle is offset by originX, originY relative to the origin. Scale specifies the scaling factor by which the rectangle
+	 * should be scaled around originX, originY. Rotation specifies the angle of counter clockwise rotation of the rectangle
+	 * around originX, originY. */
+	void draw (const TextureRegion& region, float x, float y, float originX, float originY, float width, float height,
+		float scaleX, float scaleY, float rotation);
+
+	/** Draws a rectangle transformed by the given matrix. */
+	void draw (const TextureRegion& region, float width, float height, const Affine2& transform);
+
+	/** Causes any pending sprites to be rendered, without ending the SpriteBatch. */
+	void flush ();
+
+	/** Disables blending for drawing sprites. Calling this within {@link #begin()}/{@link #end()} will flush the batch. */
+	void disableBlending ();
+
+	/** Enables blending for drawing sprites. Calling this within {@link #begin()}/{@link #end()} will flush the batch. */
+	void enableBlending ();
+
+	/** Sets the blending function to be used when rendering sprites, flushing the batch if it changes. */
+	void setBlendFunction (GLenum srcFunc, GLenum dstFunc);
+
+	/** Sets different blending functions for the color and the alpha channels, flushing the batch if they change. */
+	void setBlendFunctionSeparate (GLenum srcFuncColor, GLenum dstFuncColor, GLenum srcFuncAlpha, GLenum dstFuncAlpha);
+
+	GLenum getBlendSrcFunc () const {
+		return blendSrcFunc;
+	}
+
+	GLenum getBlendDstFunc () const {
+		return blendDstFunc;
+	}
+
+	GLenum getBlendSrcFuncAlpha () const {
+		return blendSrcFuncAlpha;
+	}
+
+	GLenum getBlendDstFuncAlpha () const {
+		return blendDstFuncAlpha;
+	}
+
+	bool isBlendingEnabled () const {
+		return !blendingDisabled;
+	}
+
+	/** Returns the current projection matrix. Changing this within {@link #begin()}/{@link #end()} results in undefined
+	 * behaviour. */
+	const Matrix4& getProjectionMatrix () const {
+		return projectionMatrix;
+	}
+
+	/** Returns the current transform matrix. Changing this within {@link #begin()}/{@link #end()} results in undefined
+	 * behaviour. */
+	const Matrix4& getTransformMatrix () const {
+		return transformMatrix;
+	}
+
+	/** Sets the projection matrix to be used by this Batch. If this is called inside a {@link #begin()}/{@link #end()} block,
+	 * the current batch is flushed to the gpu. */
+	void setProjectionMatrix (const Matrix4& projection);
+
+	/** Sets the transform matrix to be used by this Batch. */
+	void setTransformMatrix (const Matrix4& transform);
+
+	/** Sets the shader to be used in a GLES 2.0 environment. Vertex position attribute is called "a_position", the texture
+	 * coordinates attribute is called "a_texCoord0", the color attribute is called "a_color". The uniforms are u_projTrans and
+	 * u_texture. Call this method with nullptr to use the default shader. This method will flush the batch before setting the
+	 * new shader, you can call it in between {@link #begin()} and {@link #end()}. */
+	void setShader (std::shared_ptr<ShaderProgram> shader);
+
+	/** @return the current {@link ShaderProgram} set by {@link #setShader(ShaderProgram)} or the defaultShader */
+	std::shared_ptr<ShaderProgram> getShader () const {
+		return customShader ? customShader : defaultShader;
+	}
+
+	bool isDrawing () const {
+		return drawing;
+	}
+
+	/** @return the floats per sprite, {@link #SPRITE_SIZE} unless the vertices have more attributes */
+	int getSpriteSize () const {
+		return spriteSize;
+	}
+};
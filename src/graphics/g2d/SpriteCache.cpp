@@ -0,0 +1,354 @@
+#include "SpriteCache.h"
+#include "../VertexAttribute.h"
+#include "../../math/MathUtils.h"
+#include <algorithm>
+
+SpriteCache::SpriteCache(int size, std::shared_ptr<ShaderProgram> shader){
+	if (size <= 0) {
+		SDL_Log("SpriteCache: size must be positive, using 1: %i", size);
+		size = 1;
+	}
+	mesh = std::make_unique<Mesh>(true, true, true, size * 4, size * 6, VertexAttributes(SpriteBatch::createAttributes()));
+	vertices.resize((size_t)size * SPRITE_SIZE);
+
+	std::vector<GLuint> indices((size_t)size * 6);
+	for (GLuint i = 0, j = 0; i < indices.size(); i += 6, j += 4) {
+		indices[i] = j;
+		indices[i + 1] = j + 1;
+		indices[i + 2] = j + 2;
+		indices[i + 3] = j + 2;
+		indices[i + 4] = j + 3;
+		indices[i + 5] = j;
+	}
+	mesh->setIndices(indices);
+
+	GLint viewport[4] = {0, 0, 0, 0};
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	projectionMatrix.setToOrtho2D(0, 0, viewport[2], viewport[3]);
+
+	this->shader = shader ? shader : SpriteBatch::createDefaultShader();
+	fetchHandles();
+}
+
+void SpriteCache::fetchHandles (){
+	ShaderProgram& shader = getActiveShader();
+	projTransHandle = shader.fetchUniformHandle("u_projTrans");
+	textureHandle = shader.fetchUniformHandle("u_texture");
+}
+
+void SpriteCache::beginCache (){
+	if (drawing) {
+		SDL_Log("SpriteCache: end must be called before beginCache");
+		return;
+	}
+	if (currentCache != -1) {
+		SDL_Log("SpriteCache: endCache must be called before begin.");
+		return;
+	}
+	Cache cache;
+	cache.offset = usedSprites;
+	cache.count = 0;
+	cache.maxCount = vertices.size() / SPRITE_SIZE - usedSprites;
+	caches.push_back(cache);
+	currentCache = caches.size() - 1;
+	redefining = false;
+}
+
+void SpriteCache::beginCache (int cacheID){
+	if (drawing) {
+		SDL_Log("SpriteCache: end must be called before beginCache");
+		return;
+	}
+	if (currentCache != -1) {
+		SDL_Log("SpriteCache: endCache must be called before begin.");
+		return;
+	}
+	if (!isValid(cacheID)) return;
+	Cache& cache = caches[cacheID];
+	//The last cache can grow into the free space after it
+	if (cacheID == (int)caches.size() - 1) {
+		usedSprites = cache.offset;
+		cache.maxCount = vertices.size() / SPRITE_SIZE - usedSprites;
+	}
+	cache.count = 0;
+	cache.spriteTextures.clear();
+	currentCache = cacheID;
+	redefining = true;
+}
+
+int SpriteCache::endCache (){
+	if (currentCache == -1) {
+		SDL_Log("SpriteCache: beginCache must be called before endCache.");
+		return -1;
+	}
+	const int cacheID = currentCache;
+	Cache& cache = caches[cacheID];
+	currentCache = -1;
+	createRuns(cache);
+
+	const int first = cache.offset * SPRITE_SIZE;
+	const int count = cache.count * SPRITE_SIZE;
+	if (cacheID == (int)caches.size() - 1) {
+		//The mesh holds the vertices up to the end of the last cache
+		cache.maxCount = cache.count;
+		usedSprites = cache.offset + cache.count;
+		mesh->setVertices(vertices, 0, usedSprites * SPRITE_SIZE);
+	} else if (count > 0) mesh->updateVertices(first, vertices, first, count);
+	return cacheID;
+}
+
+void SpriteCache::clear (){
+	caches.clear();
+	usedSprites = 0;
+	currentCache = -1;
+	mesh->setVertices(vertices, 0, 0);
+}
+
+void SpriteCache::createRuns (Cache& cache){
+	cache.textures.clear();
+	cache.counts.clear();
+	for (const std::shared_ptr<Texture>& texture : cache.spriteTextures) {
+		if (!cache.textures.empty() && cache.textures.back() == texture) cache.counts.back()++;
+		else {
+			cache.textures.push_back(texture);
+			cache.counts.push_back(1);
+		}
+	}
+}
+
+void SpriteCache::putSprite (float* out, const TextureRegion& region, const float* corners) const{
+	const float u = region.u;
+	const float v = region.v2;
+	const float u2 = region.u2;
+	const float v2 = region.v;
+	const float texCoords[] = {u, v, u, v2, u2, v2, u2, v};
+	for (int i = 0; i < 4; i++, out += SpriteBatch::VERTEX_SIZE) {
+		out[0] = corners[i * 2];
+		out[1] = corners[i * 2 + 1];
+		out[2] = colorPacked;
+		out[3] = texCoords[i * 2];
+		out[4] = texCoords[i * 2 + 1];
+	}
+}
+
+void SpriteCache::add (const TextureRegion& region, const float* corners){
+	if (currentCache == -1) {
+		SDL_Log("SpriteCache: beginCache must be called before add.");
+		return;
+	}
+	Cache& cache = caches[currentCache];
+	if (cache.count == cache.maxCount) {
+		if (redefining)
+			SDL_Log("If a cache is not the last created, it cannot be redefined with more entries than when it was first "
+				"created: %i (%i max)", cache.count + 1, cache.maxCount);
+		else SDL_Log("SpriteCache is full: %i", (int)(vertices.size() / SPRITE_SIZE));
+		return;
+	}
+	putSprite(vertices.data() + (size_t)(cache.offset + cache.count) * SPRITE_SIZE, region, corners);
+	cache.spriteTextures.push_back(region.texture);
+	cache.count++;
+}
+
+void SpriteCache::set (int cacheID, int index, const TextureRegion& region, const float* corners){
+	if (!isValid(cacheID)) return;
+	if (cacheID == currentCache) {
+		SDL_Log("SpriteCache: endCache must be called before set.");
+		return;
+	}
+	Cache& cache = caches[cacheID];
+	if (index < 0 || index >= cache.count) {
+		SDL_Log("SpriteCache: no sprite %i in cache %i (%i sprites)", index, cacheID, cache.count);
+		return;
+	}
+	const int first = (cache.offset + index) * SPRITE_SIZE;
+	putSprite(vertices.data() + first, region, corners);
+	mesh->updateVertices(first, vertices, first, SPRITE_SIZE);
+	if (cache.spriteTextures[index] != region.texture) {
+		cache.spriteTextures[index] = region.texture;
+		createRuns(cache);
+	}
+}
+
+void SpriteCache::rectangleCorners (float* corners, float x, float y, float width, float height){
+	const float fx2 = x + width;
+	const float fy2 = y + height;
+	corners[0] = x;
+	corners[1] = y;
+	corners[2] = x;
+	corners[3] = fy2;
+	corners[4] = fx2;
+	corners[5] = fy2;
+	corners[6] = fx2;
+	corners[7] = y;
+}
+
+void SpriteCache::transformedCorners (float* corners, float x, float y, float originX, float originY, float width,
+	float height, float scaleX, float scaleY, float rotation){
+	// bottom left and top right corner points relative to origin
+	const float worldOriginX = x + originX;
+	const float worldOriginY = y + originY;
+	const float fx = -originX * scaleX;
+	const float fy = -originY * scaleY;
+	const float fx2 = (width - originX) * scaleX;
+	const float fy2 = (height - originY) * scaleY;
+	const float points[] = {fx, fy, fx, fy2, fx2, fy2, fx2, fy};
+
+	const float cos = rotation != 0 ? MathUtils::cosDeg(rotation) : 1;
+	const float sin = rotation != 0 ? MathUtils::sinDeg(rotation) : 0;
+	for (int i = 0; i < 8; i += 2) {
+		corners[i] = cos * points[i] - sin * points[i + 1] + worldOriginX;
+		corners[i + 1] = sin * points[i] + cos * points[i + 1] + worldOriginY;
+	}
+}
+
+void SpriteCache::affineCorners (float* corners, float width, float height, const Affine2& transform){
+	corners[0] = transform.m02;
+	corners[1] = transform.m12;
+	corners[2] = transform.m01 * height + transform.m02;
+	corners[3] = transform.m11 * height + transform.m12;
+	corners[4] = transform.m00 * width + transform.m01 * height + transform.m02;
+	corners[5] = transform.m10 * width + transform.m11 * height + transform.m12;
+	corners[6] = transform.m00 * width + transform.m02;
+	corners[7] = transform.m10 * width + transform.m12;
+}
+
+void SpriteCache::add (const std::shared_ptr<Texture>& texture, float x, float y, float width, float height, float u, float v,
+	float u2, float v2){
+	//Regions are drawn with v2 at the bottom, the texture coordinates as given have v there
+	TextureRegion region;
+	region.texture = texture;
+	region.u = u;
+	region.v = v2;
+	region.u2 = u2;
+	region.v2 = v;
+	float corners[8];
+	rectangleCorners(corners, x, y, width, height);
+	add(region, corners);
+}
+
+void SpriteCache::add (const TextureRegion& region, float x, float y, float width, float height){
+	float corners[8];
+	rectangleCorners(corners, x, y, width, height);
+	add(region, corners);
+}
+
+void SpriteCache::add (const TextureRegion& region, float x, float y, float originX, float originY, float width, float height,
+	float scaleX, float scaleY, float rotation){
+	float corners[8];
+	transformedCorners(corners, x, y, originX, originY, width, height, scaleX, scaleY, rotation);
+	add(region, corners);
+}
+
+void SpriteCache::add (const TextureRegion& region, float width, float height, const Affine2& transform){
+	float corners[8];
+	affineCorners(corners, width, height, transform);
+	add(region, corners);
+}
+
+void SpriteCache::set (int cacheID, int index, const TextureRegion& region, float x, float y, float width, float height){
+	float corners[8];
+	rectangleCorners(corners, x, y, width, height);
+	set(cacheID, index, region, corners);
+}
+
+void SpriteCache::set (int cacheID, int index, const TextureRegion& region, float x, float y, float originX, float originY,
+	float width, float height, float scaleX, float scaleY, float rotation){
+	float corners[8];
+	transformedCorners(corners, x, y, originX, originY, width, height, scaleX, scaleY, rotation);
+	set(cacheID, index, region, corners);
+}
+
+void SpriteCache::set (int cacheID, int index, const TextureRegion& region, float width, float height,
+	const Affine2& transform){
+	float corners[8];
+	affineCorners(corners, width, height, transform);
+	set(cacheID, index, region, corners);
+}
+
+void SpriteCache::begin (){
+	if (drawing) {
+		SDL_Log("SpriteCache: end must be called before begin.");
+		return;
+	}
+	if (currentCache != -1) {
+		SDL_Log("SpriteCache: endCache must be called before begin");
+		return;
+	}
+	renderCalls = 0;
+	combinedMatrix.set(projectionMatrix).mul(transformMatrix);
+
+	GLStateCache::get().depthMask(false);
+
+	ShaderProgram& shader = getActiveShader();
+	shader.begin();
+	shader.setUniformMatrix(projTransHandle, combinedMatrix);
+	shader.setUniformi(textureHandle, 0);
+	//Uploads the sprites set since the last frame
+	mesh->bind(shader);
+
+	drawing = true;
+}
+
+void SpriteCache::end (){
+	if (!drawing) {
+		SDL_Log("SpriteCache: begin must be called before end.");
+		return;
+	}
+	drawing = false;
+
+	GLStateCache::get().depthMask(true);
+	ShaderProgram& shader = getActiveShader();
+	mesh->unbind(shader);
+	shader.end();
+}
+
+void SpriteCache::draw (int cacheID){
+	if (!isValid(cacheID)) return;
+	draw(cacheID, 0, caches[cacheID].count);
+}
+
+void SpriteCache::draw (int cacheID, int offset, int length){
+	if (!drawing) {
+		SDL_Log("SpriteCache: begin must be called before draw.");
+		return;
+	}
+	if (!isValid(cacheID)) return;
+	const Cache& cache = caches[cacheID];
+	const int end = std::min(offset + length, cache.count);
+	ShaderProgram& shader = getActiveShader();
+	for (int i = 0, first = 0, n = cache.counts.size(); i < n && first < end; first += cache.counts[i++]) {
+		const int runEnd = first + cache.counts[i];
+		if (runEnd <= offset) continue;
+		const int start = std::max(first, offset);
+		const int count = std::min(runEnd, end) - start;
+		cache.textures[i]->bind(0);
+		mesh->render(shader, GL_TRIANGLES, (cache.offset + start) * 6, count * 6, false);
+		renderCalls++;
+		totalRenderCalls++;
+	}
+}
+
+void SpriteCache::setProjectionMatrix (const Matrix4& projection){
+	if (drawing) {
+		SDL_Log("SpriteCache: Can't set the matrix within begin/end.");
+		return;
+	}
+	projectionMatrix.set(projection);
+}
+
+void SpriteCache::setTransformMatrix (const Matrix4& transform){
+	if (drawing) {
+		SDL_Log("SpriteCache: Can't set the matrix within begin/end.");
+		return;
+	}
+	transformMatrix.set(transform);
+}
+
+void SpriteCache::setShader (std::shared_ptr<ShaderProgram> shader){
+	if (drawing) {
+		SDL_Log("SpriteCache: Can't set the shader within begin/end.");
+		return;
+	}
+	customShader = shader;
+	fetchHandles();
+}
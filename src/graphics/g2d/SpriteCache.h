@@ -0,0 +1,210 @@
+#pragma once
+#include "SpriteBatch.h"
+
+/** Draws 2D images, optimized for geometry that does not change. Sprites are stored in a static {@link Mesh} once, in caches,
+ * and drawn each frame by cache id. Each cache remembers the runs of sprites sharing a texture, so drawing it costs one draw call
+ * per run whatever the number of sprites, under any projection and transform matrix. Use this for backgrounds and tile layers,
+ * {@link SpriteBatch} for what changes every frame.
+ * <p>
+ * A cache is recorded between {@link #beginCache()} and {@link #endCache()}, which returns its id. {@link #beginCache(int)}
+ * records a cache again, with at most as many sprites as it had at first. Single sprites are replaced with the set methods,
+ * only their vertices are uploaded again, on the next {@link #begin()} if called outside of {@link #begin()}/{@link #end()}.
+ * <p>
+ * Caches are drawn between {@link #begin()} and {@link #end()}. The vertices and the shader are those of {@link SpriteBatch},
+ * the default shader is {@link SpriteBatch#createDefaultShader()}.
+ * @author Nathan Sweet */
+class SpriteCache{
+public:
+	/** Number of render calls since the last {@link #begin()}. **/
+	int renderCalls = 0;
+
+	/** Number of rendering calls, ever. Will not be reset unless set manually. **/
+	int totalRenderCalls = 0;
+private:
+	static const int SPRITE_SIZE = SpriteBatch::SPRITE_SIZE;
+
+	struct Cache{
+		/** the first sprite of the cache in the mesh */
+		int offset;
+		/** the sprites recorded and the most sprites the cache can hold */
+		int count, maxCount;
+		/** the texture of each sprite */
+		std::vector<std::shared_ptr<Texture>> spriteTextures;
+		/** the runs of sprites sharing a texture, and the sprites in each */
+		std::vector<std::shared_ptr<Texture>> textures;
+		std::vector<int> counts;
+	};
+
+	std::unique_ptr<Mesh> mesh;
+	/** the vertices of every cache, as in the mesh */
+	std::vector<GLfloat> vertices;
+	/** the sprites used by the caches */
+	int usedSprites = 0;
+	std::vector<Cache> caches;
+	/** the cache being recorded, or -1 */
+	int currentCache = -1;
+	bool redefining = false;
+
+	bool drawing = false;
+
+	Matrix4 transformMatrix;
+	Matrix4 projectionMatrix;
+	Matrix4 combinedMatrix;
+
+	std::shared_ptr<ShaderProgram> shader;
+	std::shared_ptr<ShaderProgram> customShader;
+	UniformHandle projTransHandle, textureHandle;
+
+	Color color = Color(1, 1, 1, 1);
+	float colorPacked = Color::toFloatBits(1.0f, 1.0f, 1.0f, 1.0f);
+
+	ShaderProgram& getActiveShader () {
+		return customShader ? *customShader : *shader;
+	}
+
+	void fetchHandles ();
+
+	/** Writes the sprite with the corners x1,y1 (bottom left) to x4,y4 (bottom right), counter clockwise. */
+	void putSprite (float* out, const TextureRegion& region, const float* corners) const;
+
+	void add (const TextureRegion& region, const float* corners);
+
+	void set (int cacheID, int index, const TextureRegion& region, const float* corners);
+
+	/** Rebuilds the texture runs from the textures of the sprites. */
+	static void createRuns (Cache& cache);
+
+	static void rectangleCorners (float* corners, float x, float y, float width, float height);
+
+	static void transformedCorners (float* corners, float x, float y, float originX, float originY, float width, float height,
+		float scaleX, float scaleY, float rotation);
+
+	static void affineCorners (float* corners, float width, float height, const Affine2& transform);
+
+	bool isValid (int cacheID) const {
+		if (cacheID >= 0 && cacheID < (int)caches.size()) return true;
+		SDL_Log("SpriteCache: no cache with id %i", cacheID);
+		return false;
+	}
+public:
+	/** Creates a cache that uses indexed geometry and can contain up to 1000 images. */
+	SpriteCache():SpriteCache(1000){}
+
+	/** Creates a cache with the specified size, using a default shader if OpenGL ES 2.0 is being used.
+	 * @param size The maximum number of images this cache can hold, over all caches. */
+	SpriteCache(int size):SpriteCache(size, nullptr){}
+
+	/** Creates a cache with the specified size and shader.
+	 * @param size The maximum number of images this cache can hold, over all caches.
+	 * @param shader the default shader, nullptr to create one with {@link SpriteBatch#createDefaultShader()} */
+	SpriteCache(int size, std::shared_ptr<ShaderProgram> shader);
+
+	SpriteCache (const SpriteCache&) = delete;
+	SpriteCache& operator= (const SpriteCache&) = delete;
+
+	/** Sets the color used to tint images when they are added to the SpriteCache. Default is {@link Color#WHITE}. */
+	void setColor (const Color& tint) {
+		color.set(tint);
+		colorPacked = color.toFloatBits();
+	}
+
+	void setColor (float r, float g, float b, float a) {
+		color.set(r, g, b, a);
+		colorPacked = color.toFloatBits();
+	}
+
+	const Color& getColor () const {
+		return color;
+	}
+
+	void setPackedColor (float packedColor) {
+		colorPacked = packedColor;
+		Color::abgr8888ToColor(color, packedColor);
+	}
+
+	/** Starts the definition of a new cache, allowing the add and {@link #endCache()} methods to be called. */
+	void beginCache ();
+
+	/** Starts the redefinition of an existing cache, allowing the add and {@link #endCache()} methods to be called. If this is
+	 * not the last cache created, it cannot have more entries added to it than when it was first created. To do that, use
+	 * {@link #clear()} and then {@link #beginCache()}. */
+	void beginCache (int cacheID);
+
+	/** Ends the definition of a cache, returning the cache ID to be used with {@link #draw(int)}. */
+	int endCache ();
+
+	/** Invalidates all cache IDs and resets the SpriteCache so new caches can be added. */
+	void clear ();
+
+	/** Adds the specified image to the cache, with the given texture coordinates. */
+	void add (const std::shared_ptr<Texture>& texture, float x, float y, float width, float height, float u, float v, float u2,
+		float v2);
+
+	/** Adds the specified region to the cache. */
+	void add (const TextureRegion& region, float x, float y) {
+		add(region, x, y, region.getRegionWidth(), region.getRegionHeight());
+	}
+
+	/** Adds the specified region to the cache. */
+	void add (const TextureRegion& region, float x, float y, float width, float height);
+
+	/** Adds the specified region to the cache, scaled by scaleX, scaleY and rotated counter clockwise by rotation degrees around
+	 * originX, originY. */
+	void add (const TextureRegion& region, float x, float y, float originX, float originY, float width, float height,
+		float scaleX, float scaleY, float rotation);
+
+	/** Adds the specified region to the cache, transformed by the given matrix. */
+	void add (const TextureRegion& region, float width, float height, const Affine2& transform);
+
+	/** Replaces a sprite of a cache, in the order they were added, with the current color. Only the sprite is uploaded again.
+	 * A sprite with another texture than the one it replaces splits the texture runs of the cache. */
+	void set (int cacheID, int index, const TextureRegion& region, float x, float y, float width, float height);
+
+	void set (int cacheID, int index, const TextureRegion& region, float x, float y, float originX, float originY, float width,
+		float height, float scaleX, float scaleY, float rotation);
+
+	void set (int cacheID, int index, const TextureRegion& region, float width, float height, const Affine2& transform);
+
+	/** @return the number of sprites in the cache */
+	int getSpriteCount (int cacheID) const {
+		return isValid(cacheID) ? caches[cacheID].count : 0;
+	}
+
+	/** @return the number of draw calls drawing the whole cache takes */
+	int getRunCount (int cacheID) const {
+		return isValid(cacheID) ? caches[cacheID].counts.size() : 0;
+	}
+
+	/** Prepares the OpenGL state for SpriteCache rendering. */
+	void begin ();
+
+	/** Completes rendering for this SpriteCache. */
+	void end ();
+
+	/** Draws all the images defined for the specified cache ID. */
+	void draw (int cacheID);
+
+	/** Draws a subset of images defined for the specified cache ID.
+	 * @param offset The first image to render.
+	 * @param length The number of images from the first image (inclusive) to render. */
+	void draw (int cacheID, int offset, int length);
+
+	const Matrix4& getProjectionMatrix () const {
+		return projectionMatrix;
+	}
+
+	void setProjectionMatrix (const Matrix4& projection);
+
+	const Matrix4& getTransformMatrix () const {
+		return transformMatrix;
+	}
+
+	void setTransformMatrix (const Matrix4& transform);
+
+	/** Sets the shader to be used, nullptr for the default shader. Must be called outside of {@link #begin()}/{@link #end()}. */
+	void setShader (std::shared_ptr<ShaderProgram> shader);
+
+	bool isDrawing () const {
+		return drawing;
+	}
+};
@@ -16,7 +16,11 @@
 
 #pragma once
 
-#include "../Texture.h"
+#include "../../GL.h"
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
 
 /** Defines a rectangular area of a texture. The coordinate system used has its origin in the upper left corner with the x-axis
  * pointing to the right and the y axis pointing downwards.
@@ -24,36 +28,36 @@
  * @author Nathan Sweet */
 class TextureRegion {
 public:
-	Texture texture;
+	std::shared_ptr<Texture> texture;
 	float u, v;
 	float u2, v2;
 	int regionWidth, regionHeight;
 
 	/** Constructs a region with no texture and no coordinates defined. */
-	TextureRegion () {
+	TextureRegion ():u(0),v(0),u2(0),v2(0),regionWidth(0),regionHeight(0) {
 	}
 
 	/** Constructs a region the size of the specified texture. */
-	TextureRegion (const Texture& texture) {
+	TextureRegion (std::shared_ptr<Texture> texture) {
 		this->texture = texture;
-		setRegion(0, 0, texture.getWidth(), texture.getHeight());
+		setRegion(0, 0, texture->getWidth(), texture->getHeight());
 	}
 
 	/** @param width The width of the texture region. May be negative to flip the sprite when drawn.
 	 * @param height The height of the texture region. May be negative to flip the sprite when drawn. */
-	TextureRegion (const Texture& texture, int width, int height) {
+	TextureRegion (std::shared_ptr<Texture> texture, int width, int height) {
 		this->texture = texture;
 		setRegion(0, 0, width, height);
 	}
 
 	/** @param width The width of the texture region. May be negative to flip the sprite when drawn.
 	 * @param height The height of the texture region. May be negative to flip the sprite when drawn. */
-	TextureRegion (const Texture& texture, int x, int y, int width, int height) {
+	TextureRegion (std::shared_ptr<Texture> texture, int x, int y, int width, int height) {
 		this->texture = texture;
 		setRegion(x, y, width, height);
 	}
 
-	TextureRegion (const Texture& texture, float u, float v, float u2, float v2) {
+	TextureRegion (std::shared_ptr<Texture> texture, float u, float v, float u2, float v2) {
 		this->texture = texture;
 		setRegion(u, v, u2, v2);
 	}
@@ -63,6 +67,11 @@ public:
 		setRegion(region);
 	}
 
+	TextureRegion& operator= (const TextureRegion& region) {
+		setRegion(region);
+		return *this;
+	}
+
 	/** Constructs a region with the same texture as the specified region and sets the coordinates relative to the specified region.
 	 * @param width The width of the texture region. May be negative to flip the sprite when drawn.
 	 * @param height The height of the texture region. May be negative to flip the sprite when drawn. */
@@ -71,25 +80,25 @@ public:
 	}
 
 	/** Sets the texture and sets the coordinates to the size of the specified texture. */
-	void setRegion (const Texture& texture) {
+	void setRegion (std::shared_ptr<Texture> texture) {
 		this->texture = texture;
-		setRegion(0, 0, texture.getWidth(), texture.getHeight());
+		setRegion(0, 0, texture->getWidth(), texture->getHeight());
 	}
 
 	/** @param width The width of the texture region. May be negative to flip the sprite when drawn.
 	 * @param height The height of the texture region. May be negative to flip the sprite when drawn. */
 	void setRegion (int x, int y, int width, int height) {
-		float invTexWidth = 1f / texture.getWidth();
-		float invTexHeight = 1f / texture.getHeight();
+		float invTexWidth = 1.0f / texture->getWidth();
+		float invTexHeight = 1.0f / texture->getHeight();
 		setRegion(x * invTexWidth, y * invTexHeight, (x + width) * invTexWidth, (y + height) * invTexHeight);
-		regionWidth = abs(width);
-		regionHeight = abs(height);
+		regionWidth = std::abs(width);
+		regionHeight = std::abs(height);
 	}
 
 	void setRegion (float u, float v, float u2, float v2) {
-		int texWidth = texture.getWidth(), texHeight = texture.getHeight();
-		regionWidth = roundf(abs(u2 - u) * texWidth);
-		regionHeight = roundf(abs(v2 - v) * texHeight);
+		int texWidth = texture->getWidth(), texHeight = texture->getHeight();
+		regionWidth = roundf(std::fabs(u2 - u) * texWidth);
+		regionHeight = roundf(std::fabs(v2 - v) * texHeight);
 
 		// For a 1x1 region, adjust UVs toward pixel center to avoid filtering artifacts on AMD GPUs when drawing very stretched.
 		if (regionWidth == 1 && regionHeight == 1) {
@@ -119,89 +128,89 @@ public:
 		setRegion(region.getRegionX() + x, region.getRegionY() + y, width, height);
 	}
 
-	Texture getTexture () {
+	std::shared_ptr<Texture> getTexture () const {
 		return texture;
 	}
 
-	void setTexture (const TextureRegion& texture) {
+	void setTexture (std::shared_ptr<Texture> texture) {
 		this->texture = texture;
 	}
 
-	float getU () {
+	float getU () const {
 		return u;
 	}
 
 	void setU (float u) {
 		this->u = u;
-		regionWidth = roundf(abs(u2 - u) * texture.getWidth());
+		regionWidth = roundf(std::fabs(u2 - u) * texture->getWidth());
 	}
 
-	float getV () {
+	float getV () const {
 		return v;
 	}
 
 	void setV (float v) {
 		this->v = v;
-		regionHeight = roundf(abs(v2 - v) * texture.getHeight());
+		regionHeight = roundf(std::fabs(v2 - v) * texture->getHeight());
 	}
 
-	float getU2 () {
+	float getU2 () const {
 		return u2;
 	}
 
 	void setU2 (float u2) {
 		this->u2 = u2;
-		regionWidth = roundf(abs(u2 - u) * texture.getWidth());
+		regionWidth = roundf(std::fabs(u2 - u) * texture->getWidth());
 	}
 
-	float getV2 () {
+	float getV2 () const {
 		return v2;
 	}
 
 	void setV2 (float v2) {
 		this->v2 = v2;
-		regionHeight = roundf(abs(v2 - v) * texture.getHeight());
+		regionHeight = roundf(std::fabs(v2 - v) * texture->getHeight());
 	}
 
-	int getRegionX () {
-		return roundf(u * texture.getWidth());
+	int getRegionX () const {
+		return roundf(u * texture->getWidth());
 	}
 
 	void setRegionX (int x) {
-		setU(x / (float)texture.getWidth());
+		setU(x / (float)texture->getWidth());
 	}
 
-	int getRegionY () {
-		return roundf(v * texture.getHeight());
+	int getRegionY () const {
+		return roundf(v * texture->getHeight());
 	}
 
 	void setRegionY (int y) {
-		setV(y / (float)texture.getHeight());
+		setV(y / (float)texture->getHeight());
 	}
 
 	/** Returns the region's width. */
-	int getRegionWidth () {
+	int getRegionWidth () const {
 		return regionWidth;
 	}
 
 	void setRegionWidth (int width) {
 		if (isFlipX()) {
-			setU(u2 + width / (float)texture.getWidth());
+			setU(u2 + width / (float)texture->getWidth());
 		} else {
-			setU2(u + width / (float)texture.getWidth());
+			setU2(u + width / (float)texture->getWidth());
 		}
 	}
 
 	/** Returns the region's height. */
-	int getRegionHeight () {
+	int getRegionHeight () const {
 		return regionHeight;
 	}
 
 	void setRegionHeight (int height) {
 		if (isFlipY()) {
-			setV(v2 + height / (float)texture.getHeight());			
+			setV(v2 + height / (float)texture->getHeight());			
 		} else {
-			setV2(v + height / (float)texture.getHeight());
+			setV2(v + height / (float)texture->getHeight());
 		}
 	}
 
@@ -218,11 +227,11 @@ public:
 		}
 	}
 
-	bool isFlipX () {
+	bool isFlipX () const {
 		return u > u2;
 	}
 
-	bool isFlipY () {
+	bool isFlipY () const {
 		return v > v2;
 	}
 
@@ -232,14 +241,14 @@ public:
 	 * @param yAmount The percentage to offset vertically. This is done in texture space, so up is negative. */
 	void scroll (float xAmount, float yAmount) {
 		if (xAmount != 0) {
-			float width = (u2 - u) * texture.getWidth();
+			float width = (u2 - u) * texture->getWidth();
 			u = fmod((u + xAmount),1);
-			u2 = u + width / texture.getWidth();
+			u2 = u + width / texture->getWidth();
 		}
 		if (yAmount != 0) {
-			float height = (v2 - v) * texture.getHeight();
+			float height = (v2 - v) * texture->getHeight();
 			v = fmod((v + yAmount),1);
-			v2 = v + height / texture.getHeight();
+			v2 = v + height / texture->getHeight();
 		}
 	}
 
@@ -251,7 +260,7 @@ public:
 	 * @param tileWidth a tile's width in pixels
 	 * @param tileHeight a tile's height in pixels
 	 * @return a 2D array of TextureRegions indexed by [row][column]. */
-	void split (int tileWidth, int tileHeight,std::vector<std::vector<TextureRegion>> tiles) {
+	std::vector<std::vector<TextureRegion>> split (int tileWidth, int tileHeight) {
 		int x = getRegionX();
 		int y = getRegionY();
 		int width = regionWidth;
@@ -261,13 +270,14 @@ public:
 		int cols = width / tileWidth;
 
 		int startX = x;
-        tiles(rows, std::vector<int>(cols));
+		std::vector<std::vector<TextureRegion>> tiles(rows, std::vector<TextureRegion>(cols));
 		for (int row = 0; row < rows; row++, y += tileHeight) {
 			x = startX;
 			for (int col = 0; col < cols; col++, x += tileWidth) {
 				tiles[row][col] = TextureRegion(texture, x, y, tileWidth, tileHeight);
 			}
 		}
+		return tiles;
 	}
 
 	/** Helper function to create tiles out of the given {@link Texture} starting from the top left corner going to the right and
@@ -278,8 +288,7 @@ public:
 	 * @param tileWidth a tile's width in pixels
 	 * @param tileHeight a tile's height in pixels
 	 * @return a 2D array of TextureRegions indexed by [row][column]. */
-	static void split (Texture texture, int tileWidth, int tileHeight,
-        std::vector<std::vector<TextureRegion>> tiles) {
-		TextureRegion(texture).split(tileWidth, tileHeight,tiles);
+	static std::vector<std::vector<TextureRegion>> split (std::shared_ptr<Texture> texture, int tileWidth, int tileHeight) {
+		return TextureRegion(texture).split(tileWidth, tileHeight);
 	}
 };
\ No newline at end of file
@@ -0,0 +1,3 @@
+#include "Attribute.h"
+
+std::vector<std::string> Attribute::types;
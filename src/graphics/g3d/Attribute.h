@@ -15,29 +15,38 @@
  ******************************************************************************/
 
 #pragma once
+#include <SDL.h>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
 
 /** Extend this class to implement a material attribute. Register the attribute type by statically calling the
  * {@link #register(String)} method, whose return value should be used to instantiate the attribute. A class can implement
- * multiple types
+ * multiple types. The type is a single bit of a 64 bit mask, so at most 64 types can be registered.
  * @author Xoppa */
 class Attribute{
 protected:
 	/** Call this method to register a custom attribute type, see the wiki for an example. If the alias already exists, then that ID
 	 * will be reused. The alias should be unambiguously and will by default be returned by the call to {@link #toString()}.
 	 * @param alias The alias of the type to register, must be different for each dirrect type, will be used for debugging
-	 * @return the ID of the newly registered type, or the ID of the existing type if the alias was already registered */
-	static long registerType (const std::string& alias) {
-		long result = getAttributeType(alias);
+	 * @return the ID of the newly registered type, or the ID of the existing type if the alias was already registered, 0 if all
+	 *         64 types are taken */
+	static uint64_t registerType (const std::string& alias) {
+		uint64_t result = getAttributeType(alias);
 		if (result > 0) return result;
+		if (types.size() == 64) {
+			SDL_Log("Attribute: cannot register '%s', all 64 attribute types are registered", alias.c_str());
+			return 0;
+		}
 		types.push_back(alias);
-		return (1L << (types.size() - 1));
+		return 1ULL << (types.size() - 1);
 	}
-    
-	Attribute (const long type) {
+
+	/** @param type a registered type, 0 if registering failed, such an attribute is never added to {@link Attributes} */
+	Attribute (const uint64_t type) {
 		this->type = type;
-		this->typeBit = __builtin_ctz(type);
+		this->typeBit = type == 0 ? -1 : __builtin_ctzll(type);
 	}
 
 private:
@@ -45,36 +54,48 @@ private:
 	static std::vector<std::string> types;
     int typeBit;
 public:
+	virtual ~Attribute () {}
+
 	/** @return The ID of the specified attribute type, or zero if not available */
-	static long getAttributeType (const std::string& alias) {
-		for (int i = 0; i < types.size(); i++)
-			if (types[i] == alias) return (1L << i);
+	static uint64_t getAttributeType (const std::string& alias) {
+		for (size_t i = 0; i < types.size(); i++)
+			if (types[i] == alias) return 1ULL << i;
 		return 0;
 	}
 
-	/** @return The alias of the specified attribute type, or null if not available. */
-	static std::string getAttributeAlias (const long type) {
-		int idx = -1;
-		while (type != 0 && ++idx < 63 && (((type >> idx) & 1) == 0))
-			;
-		return (idx >= 0 && idx < types.size()) ? types[idx] : NULL;
+	/** @return The alias of the specified attribute type, or an empty string if not available. */
+	static std::string getAttributeAlias (const uint64_t type) {
+		if (type == 0) return std::string();
+		const size_t idx = __builtin_ctzll(type);
+		return idx < types.size() ? types[idx] : std::string();
 	}
 
 	/** The type of this attribute */
-	long type;
+	uint64_t type;
+
+	/** @return the index of the type bit, the order attributes are kept in by {@link Attributes}, -1 for type 0 */
+	int getTypeBit () const {return typeBit;}
 
 	/** @return An exact copy of this attribute */
-	Attribute copy ();
+	virtual std::shared_ptr<Attribute> copy () const {
+		return std::shared_ptr<Attribute>(new Attribute(*this));
+	}
+
+	/** Compares the type, then the values. Attributes with values must override this and {@link #hashCode()}.
+	 * @return negative, zero or positive if this attribute orders before, the same as or after the other */
+	virtual int compareTo (const Attribute& other) const {
+		return typeBit == other.typeBit ? 0 : typeBit < other.typeBit ? -1 : 1;
+	}
 
-	bool operator== (Attribute& obj) {
-		return obj.hashCode() == hashCode();
+	bool operator== (const Attribute& obj) const {
+		return compareTo(obj) == 0;
 	}
 
-	std::string toString () {
+	std::string toString () const {
 		return getAttributeAlias(type);
 	}
 
-	int hashCode () {
+	virtual int hashCode () const {
 		return 7489 * typeBit;
 	}
-};
\ No newline at end of file
+};
@@ -0,0 +1,52 @@
+#include "Attributes.h"
+
+void Attributes::set (const std::shared_ptr<Attribute>& attribute){
+	if (attribute->type == 0) {
+		SDL_Log("Attributes: attribute of unregistered type ignored");
+		return;
+	}
+	const size_t index = indexOf(attribute->type);
+	if (has(attribute->type)) attributes[index] = attribute;
+	else {
+		attributes.insert(attributes.begin() + index, attribute);
+		mask |= attribute->type;
+	}
+	hashValid = false;
+}
+
+void Attributes::remove (uint64_t mask){
+	for (size_t i = attributes.size(); i-- > 0;) {
+		if ((attributes[i]->type & mask) == 0) continue;
+		attributes.erase(attributes.begin() + i);
+	}
+	this->mask &= ~mask;
+	hashValid = false;
+}
+
+void Attributes::clear (){
+	attributes.clear();
+	mask = 0;
+	hashValid = false;
+}
+
+size_t Attributes::hashCode () const{
+	if (!hashValid) {
+		uint64_t result = mask * 0x9E3779B97F4A7C15ULL;
+		for (const std::shared_ptr<Attribute>& attribute : attributes)
+			result = (result ^ (uint32_t)attribute->hashCode()) * 0x100000001B3ULL;
+		hash = (size_t)(result ^ (result >> 32));
+		hashValid = true;
+	}
+	return hash;
+}
+
+int Attributes::compareTo (const Attributes& other) const{
+	if (this == &other) return 0;
+	if (mask != other.mask) return mask < other.mask ? -1 : 1;
+	for (size_t i = 0; i < attributes.size(); i++) {
+		if (attributes[i] == other.attributes[i]) continue;
+		const int result = attributes[i]->compareTo(*other.attributes[i]);
+		if (result != 0) return result;
+	}
+	return 0;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "Attribute.h"
+
+/** A set of {@link Attribute}s, at most one per type. The attributes are kept sorted by type bit in a contiguous array, so the
+ * attribute of a type is found by counting the bits of the mask below it, in O(1). The mask of the types is kept up to date and
+ * the hash of the content is cached until the set changes, so sets are compared by mask and hash first and the attributes are
+ * only walked when both match.
+ * <p>
+ * Attributes are shared, not copied. An attribute changed in place must be followed by {@link #invalidateHash()}.
+ * @author Xoppa */
+class Attributes{
+	std::vector<std::shared_ptr<Attribute>> attributes;
+	uint64_t mask = 0;
+	mutable size_t hash = 0;
+	mutable bool hashValid = false;
+
+	/** @return the index the attribute of the type has or would have */
+	size_t indexOf (uint64_t type) const {
+		return __builtin_popcountll(mask & (type - 1));
+	}
+public:
+	virtual ~Attributes () {}
+
+	/** Adds the attribute, replacing the one of the same type if any. An attribute of type 0, which failed to register, is
+	 * ignored. */
+	void set (const std::shared_ptr<Attribute>& attribute);
+
+	void set (const std::vector<std::shared_ptr<Attribute>>& attributes) {
+		for (const std::shared_ptr<Attribute>& attribute : attributes) set(attribute);
+	}
+
+	/** @param type a single type
+	 * @return the attribute of the type, or nullptr if there is none */
+	std::shared_ptr<Attribute> get (uint64_t type) const {
+		return has(type) ? attributes[indexOf(type)] : nullptr;
+	}
+
+	/** @return the attribute of the type cast to the class implementing it, or nullptr if there is none */
+	template<class T> std::shared_ptr<T> get (uint64_t type) const {
+		return std::static_pointer_cast<T>(get(type));
+	}
+
+	/** Removes the attributes of every type in the mask. */
+	void remove (uint64_t mask);
+
+	/** @return whether the set has an attribute of every type in the mask */
+	bool has (uint64_t type) const {
+		return type != 0 && (mask & type) == type;
+	}
+
+	/** @return the types of the attributes in the set */
+	uint64_t getMask () const {return mask;}
+
+	size_t size () const {return attributes.size();}
+
+	void clear ();
+
+	/** @return the attributes, sorted by type */
+	const std::vector<std::shared_ptr<Attribute>>& getAll () const {return attributes;}
+
+	/** Forgets the cached hash, must be called after changing an attribute of the set in place. */
+	void invalidateHash () {hashValid = false;}
+
+	/** @return the hash of the types and values, computed once until the set changes */
+	size_t hashCode () const;
+
+	/** Orders sets by mask, then by the attributes in type order, without allocating.
+	 * @return negative, zero or positive if this set orders before, the same as or after the other */
+	int compareTo (const Attributes& other) const;
+
+	/** @return whether both sets have attributes of the same types with the same values */
+	bool equals (const Attributes& other) const {
+		return this == &other || (mask == other.mask && hashCode() == other.hashCode() && compareTo(other) == 0);
+	}
+
+	bool operator== (const Attributes& other) const {return equals(other);}
+
+	bool operator!= (const Attributes& other) const {return !equals(other);}
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include "Attributes.h"
+
+/** The {@link Attributes} describing how a {@link Renderable} is shaded, e.g. its textures and colors. Renderables with equal
+ * materials are rendered together by {@link RenderQueue}.
+ * @author Xoppa */
+class Material : public Attributes{
+public:
+	/** The id of the material, for debugging and lookup, not compared */
+	std::string id;
+
+	Material () {}
+
+	Material (const std::string& id):id(id){}
+
+	Material (const std::string& id, const std::vector<std::shared_ptr<Attribute>>& attributes):id(id){
+		set(attributes);
+	}
+};
@@ -0,0 +1,290 @@
+#include "ModelCache.h"
+#include "../VertexAttribute.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define MODELCACHE_SSE2 1
+#endif
+
+ModelCache::ModelCache(float clusterSize, int maxVertices)
+	:clusterSize(clusterSize),maxVertices(maxVertices){}
+
+ModelCache::ClusterKey ModelCache::createKey (const Entry& entry) const{
+	const Renderable& renderable = entry.renderable;
+	BoundingBox& bounds = const_cast<BoundingBox&>(entry.bounds);
+	VertexAttributes& attributes = renderable.meshPart.mesh->getVertexAttributes();
+	ClusterKey key;
+	key.x = (int)std::floor(bounds.getCenterX() / clusterSize);
+	key.y = (int)std::floor(bounds.getCenterY() / clusterSize);
+	key.z = (int)std::floor(bounds.getCenterZ() / clusterSize);
+	key.shader = renderable.shader;
+	key.material = renderable.material.get();
+	key.vertexFormat = (uint64_t)attributes.getMask() << 16 | (uint64_t)attributes.vertexSize;
+	key.primitiveType = renderable.meshPart.primitiveType;
+	key.pass = renderable.pass;
+	key.blended = renderable.blended;
+	return key;
+}
+
+void ModelCache::addToCluster (int id){
+	Entry& entry = entries[id];
+	Mesh& mesh = *entry.renderable.meshPart.mesh;
+	mesh.calculateBoundingBox(entry.bounds, entry.renderable.meshPart.offset, entry.renderable.meshPart.size,
+		entry.renderable.worldTransform);
+	entry.key = createKey(entry);
+	Cluster& cluster = clusters[entry.key];
+	cluster.entries.push_back(id);
+	cluster.dirty = true;
+}
+
+void ModelCache::removeFromCluster (int id){
+	auto cluster = clusters.find(entries[id].key);
+	if (cluster == clusters.end()) return;
+	std::vector<int>& ids = cluster->second.entries;
+	ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+	cluster->second.dirty = true;
+}
+
+int ModelCache::add (const Renderable& renderable){
+	if (renderable.shader == nullptr || !renderable.meshPart.mesh) {
+		SDL_Log("ModelCache: renderable without shader or mesh ignored");
+		return -1;
+	}
+	int id;
+	if (!freeIds.empty()) {
+		id = freeIds.back();
+		freeIds.pop_back();
+	} else {
+		id = entries.size();
+		entries.emplace_back();
+	}
+	entries[id].renderable.set(renderable);
+	entries[id].alive = true;
+	addToCluster(id);
+	return id;
+}
+
+void ModelCache::remove (int id){
+	if (id < 0 || id >= (int)entries.size() || !entries[id].alive) return;
+	removeFromCluster(id);
+	entries[id].alive = false;
+	entries[id].renderable.meshPart.mesh.reset();
+	entries[id].renderable.material.reset();
+	freeIds.push_back(id);
+}
+
+void ModelCache::setTransform (int id, const Matrix4& worldTransform){
+	if (id < 0 || id >= (int)entries.size() || !entries[id].alive) return;
+	removeFromCluster(id);
+	entries[id].renderable.worldTransform.set(worldTransform);
+	addToCluster(id);
+}
+
+void ModelCache::transform (const float* m, float* vertices, int count, int offset, int stride, int components,
+	bool translate, BoundingBox* bounds){
+	const float tx = translate ? m[12] : 0, ty = translate ? m[13] : 0, tz = translate ? m[14] : 0;
+	float* v = vertices + offset;
+#ifdef MODELCACHE_SSE2
+	if (components == 3) {
+		const __m128 c0 = _mm_setr_ps(m[0], m[1], m[2], 0), c1 = _mm_setr_ps(m[4], m[5], m[6], 0);
+		const __m128 c2 = _mm_setr_ps(m[8], m[9], m[10], 0), c3 = _mm_setr_ps(tx, ty, tz, 0);
+		__m128 min = _mm_set1_ps(std::numeric_limits<float>::infinity());
+		__m128 max = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+		for (int i = 0; i < count; i++, v += stride) {
+			const __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(v[0])), _mm_mul_ps(c1, _mm_set1_ps(v[1]))),
+				_mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(v[2])), c3));
+			min = _mm_min_ps(min, r);
+			max = _mm_max_ps(max, r);
+			_mm_storel_pi((__m64*)v, r);
+			_mm_store_ss(v + 2, _mm_movehl_ps(r, r));
+		}
+		if (bounds != nullptr && count > 0) {
+			float low[4], high[4];
+			_mm_storeu_ps(low, min);
+			_mm_storeu_ps(high, max);
+			bounds->ext(low[0], low[1], low[2]);
+			bounds->ext(high[0], high[1], high[2]);
+		}
+		return;
+	}
+#endif
+	for (int i = 0; i < count; i++, v += stride) {
+		const float x = v[0], y = v[1], z = components == 3 ? v[2] : 0;
+		v[0] = m[0] * x + m[4] * y + m[8] * z + tx;
+		v[1] = m[1] * x + m[5] * y + m[9] * z + ty;
+		const float rz = m[2] * x + m[6] * y + m[10] * z + tz;
+		if (components == 3) v[2] = rz;
+		if (bounds != nullptr) bounds->ext(v[0], v[1], rz);
+	}
+}
+
+void ModelCache::normalize (float* vertices, int count, int offset, int stride){
+	float* v = vertices + offset;
+	for (int i = 0; i < count; i++, v += stride) {
+		const float length2 = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+		if (length2 == 0) continue;
+		const float scale = 1.0f / std::sqrt(length2);
+		v[0] *= scale;
+		v[1] *= scale;
+		v[2] *= scale;
+	}
+}
+
+void ModelCache::append (Entry& entry, std::vector<GLfloat>& vertices, std::vector<GLuint>& indices){
+	const MeshPart& part = entry.renderable.meshPart;
+	Mesh& mesh = *part.mesh;
+	VertexAttributes& attributes = mesh.getVertexAttributes();
+	const int stride = attributes.vertexSize / sizeof(GLfloat);
+	const std::vector<GLfloat>& source = mesh.getVerticesData();
+	const std::vector<GLuint>& sourceIndices = mesh.getIndicesData();
+	const size_t first = vertices.size() / stride;
+
+	if (!sourceIndices.empty()) {
+		//Only the vertices the part uses, each once
+		const size_t numVertices = source.size() / stride;
+		if (remap.size() < numVertices) {
+			remap.resize(numVertices);
+			remapStamps.resize(numVertices, 0);
+		}
+		if (++stamp == 0) {
+			std::fill(remapStamps.begin(), remapStamps.end(), 0);
+			stamp = 1;
+		}
+		for (int i = part.offset; i < part.offset + part.size; i++) {
+			const GLuint index = sourceIndices[i];
+			if (remapStamps[index] != stamp) {
+				remapStamps[index] = stamp;
+				remap[index] = vertices.size() / stride;
+				vertices.insert(vertices.end(), source.begin() + index * stride, source.begin() + (index + 1) * stride);
+			}
+			indices.push_back(remap[index]);
+		}
+	} else {
+		vertices.insert(vertices.end(), source.begin() + part.offset * stride, source.begin() + (part.offset + part.size) * stride);
+		for (int i = 0; i < part.size; i++) indices.push_back(first + i);
+	}
+
+	const int count = vertices.size() / stride - first;
+	float* appended = vertices.data() + first * stride;
+	const std::vector<float>& world = entry.renderable.worldTransform.val;
+	const int position = attributes.findByUsage(POSITION);
+	if (position != -1) transform(world.data(), appended, count, attributes.get(position).offset / 4, stride,
+		std::min(3, attributes.get(position).numComponents), true, nullptr);
+
+	//Normals by the inverse transpose so non-uniform scales keep them perpendicular, tangents by the matrix itself
+	const int normal = attributes.findByUsage(NORMAL);
+	if (normal != -1 && attributes.get(normal).numComponents == 3) {
+		Matrix4 normalMatrix(entry.renderable.worldTransform);
+		normalMatrix.inv().tra();
+		transform(normalMatrix.val.data(), appended, count, attributes.get(normal).offset / 4, stride, 3, false, nullptr);
+		normalize(appended, count, attributes.get(normal).offset / 4, stride);
+	}
+	for (int usage : {TANGENT, BINORMAL}) {
+		const int index = attributes.findByUsage(usage);
+		if (index == -1 || attributes.get(index).numComponents < 3) continue;
+		transform(world.data(), appended, count, attributes.get(index).offset / 4, stride, 3, false, nullptr);
+		normalize(appended, count, attributes.get(index).offset / 4, stride);
+	}
+}
+
+void ModelCache::flush (const ClusterKey& key, const Renderable& source, std::vector<GLfloat>& vertices,
+	std::vector<GLuint>& indices, Cluster& cluster){
+	if (indices.empty()) return;
+	VertexAttributes& attributes = source.meshPart.mesh->getVertexAttributes();
+	const int numVertices = vertices.size() * sizeof(GLfloat) / attributes.vertexSize;
+	std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(true, true, numVertices, indices.size(), attributes);
+	mesh->setVertices(vertices);
+	mesh->setIndices(indices);
+
+	cluster.renderables.emplace_back();
+	Renderable& merged = cluster.renderables.back();
+	merged.meshPart.set("", mesh, 0, indices.size(), key.primitiveType);
+	BoundingBox bounds;
+	mesh->calculateBoundingBox(bounds);
+	bounds.getCenter(merged.meshPart.center);
+	bounds.getDimensions(merged.meshPart.halfExtents).scl(0.5f);
+	merged.meshPart.radius = merged.meshPart.halfExtents.len();
+	merged.shader = source.shader;
+	merged.material = source.material;
+	merged.blended = source.blended;
+	merged.pass = source.pass;
+	vertices.clear();
+	indices.clear();
+}
+
+void ModelCache::buildCluster (const ClusterKey& key, Cluster& cluster){
+	cluster.renderables.clear();
+	cluster.bounds.inf();
+	for (int id : cluster.entries) cluster.bounds.ext(entries[id].bounds);
+	if (!isList(key.primitiveType)) {
+		for (int id : cluster.entries) {
+			cluster.renderables.emplace_back();
+			cluster.renderables.back().set(entries[id].renderable);
+		}
+		return;
+	}
+
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	const Renderable* first = nullptr;
+	for (int id : cluster.entries) {
+		Entry& entry = entries[id];
+		Mesh& mesh = *entry.renderable.meshPart.mesh;
+		const int stride = mesh.getVertexAttributes().vertexSize / sizeof(GLfloat);
+		//At most as many vertices as indices, and no more than the mesh has
+		const int needed = std::min(entry.renderable.meshPart.size, mesh.getNumVertices());
+		if (needed > maxVertices) {
+			SDL_Log("ModelCache: a part of %d vertices exceeds the %d of a merged mesh, it is not merged", needed, maxVertices);
+			cluster.renderables.emplace_back();
+			cluster.renderables.back().set(entry.renderable);
+			continue;
+		}
+		if (first != nullptr && (int)vertices.size() / stride + needed > maxVertices) flush(key, *first, vertices, indices, cluster);
+		if (vertices.empty()) first = &entry.renderable;
+		append(entry, vertices, indices);
+	}
+	if (first != nullptr) flush(key, *first, vertices, indices, cluster);
+}
+
+void ModelCache::build (){
+	rebuiltCount = 0;
+	for (auto cluster = clusters.begin(); cluster != clusters.end();) {
+		if (cluster->second.entries.empty()) {
+			cluster = clusters.erase(cluster);
+			continue;
+		}
+		if (cluster->second.dirty) {
+			buildCluster(cluster->first, cluster->second);
+			cluster->second.dirty = false;
+			rebuiltCount++;
+		}
+		++cluster;
+	}
+}
+
+void ModelCache::clear (){
+	entries.clear();
+	freeIds.clear();
+	clusters.clear();
+}
+
+void ModelCache::getRenderables (std::vector<const Renderable*>& out) const{
+	for (const auto& cluster : clusters)
+		for (const Renderable& renderable : cluster.second.renderables) out.push_back(&renderable);
+}
+
+void ModelCache::getRenderables (std::vector<const Renderable*>& out, Frustum& frustum){
+	for (auto& cluster : clusters) {
+		if (cluster.second.renderables.empty() || !frustum.boundsInFrustum(cluster.second.bounds)) continue;
+		for (const Renderable& renderable : cluster.second.renderables) out.push_back(&renderable);
+	}
+}
+
+int ModelCache::getRenderableCount () const{
+	int count = 0;
+	for (const auto& cluster : clusters) count += cluster.second.renderables.size();
+	return count;
+}
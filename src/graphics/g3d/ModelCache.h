@@ -0,0 +1,132 @@
+#pragma once
+#include "Renderable.h"
+#include "../../math/Frustum.h"
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+/** Merges static {@link Renderable}s into a few large meshes, so thousands of small mesh parts cost a few draws. Renderables
+ * are grouped by what they are rendered with, i.e. shader, material instance, vertex attributes, primitive type, pass and
+ * blending, and by the cell of a spatial grid their bounds' center lies in. Each group, a cluster, gets its vertices
+ * transformed into world space and appended into shared meshes, so the merged renderables have an identity transform and
+ * clusters can still be culled against the frustum one by one.
+ * <p>
+ * A merged mesh holds at most maxVertices vertices, a cluster with more is split into several meshes. The default keeps every
+ * mesh addressable by 16 bit indices, a single part with more is kept as it is. Strips and fans can't be appended to each
+ * other, renderables drawing them are kept as they are.
+ * <p>
+ * Renderables are added once and keep their id until removed. {@link #build()} only rebuilds the clusters changed since the
+ * last build, so moving or removing a few renderables doesn't rebuild the whole level. The source meshes must keep their
+ * vertices in memory until the renderables using them are built. */
+class ModelCache{
+public:
+	/** the most vertices 16 bit indices can address */
+	static const int MAX_VERTICES_16 = 65536;
+private:
+	struct ClusterKey{
+		int x, y, z;
+		Shader* shader;
+		Material* material;
+		uint64_t vertexFormat;
+		int primitiveType;
+		int pass;
+		bool blended;
+
+		bool operator< (const ClusterKey& other) const {
+			return std::tie(x, y, z, shader, material, vertexFormat, primitiveType, pass, blended) <
+				std::tie(other.x, other.y, other.z, other.shader, other.material, other.vertexFormat, other.primitiveType,
+				other.pass, other.blended);
+		}
+	};
+
+	struct Entry{
+		Renderable renderable;
+		ClusterKey key;
+		BoundingBox bounds;
+		bool alive = false;
+	};
+
+	struct Cluster{
+		std::vector<int> entries;
+		/** the merged renderables */
+		std::vector<Renderable> renderables;
+		BoundingBox bounds;
+		bool dirty = true;
+	};
+
+	std::vector<Entry> entries;
+	std::vector<int> freeIds;
+	std::map<ClusterKey, Cluster> clusters;
+	float clusterSize;
+	int maxVertices;
+	int rebuiltCount = 0;
+
+	/** the merged index of each source vertex, valid where the stamp matches, reused across parts */
+	std::vector<GLuint> remap;
+	std::vector<unsigned int> remapStamps;
+	unsigned int stamp = 0;
+
+	ClusterKey createKey (const Entry& entry) const;
+
+	void addToCluster (int id);
+
+	void removeFromCluster (int id);
+
+	void buildCluster (const ClusterKey& key, Cluster& cluster);
+
+	/** Appends the vertices of the entry's part to the merged vertices, transformed, and its indices. */
+	void append (Entry& entry, std::vector<GLfloat>& vertices, std::vector<GLuint>& indices);
+
+	static void flush (const ClusterKey& key, const Renderable& source, std::vector<GLfloat>& vertices,
+		std::vector<GLuint>& indices, Cluster& cluster);
+
+	static bool isList (int primitiveType) {
+		return primitiveType == GL_TRIANGLES || primitiveType == GL_LINES || primitiveType == GL_POINTS;
+	}
+public:
+	/** @param clusterSize the size of the grid cells renderables are clustered by, in world units
+	 * @param maxVertices the most vertices of a merged mesh */
+	ModelCache(float clusterSize = 64, int maxVertices = MAX_VERTICES_16);
+
+	/** Adds the renderable, copying it. It must have a shader and a mesh part of an indexed or non-indexed mesh.
+	 * @return the id of the renderable in the cache */
+	int add (const Renderable& renderable);
+
+	/** Removes the renderable, the id may be reused by a later {@link #add}. */
+	void remove (int id);
+
+	/** Moves the renderable, its cluster and the one it moves to are rebuilt by the next {@link #build()}. */
+	void setTransform (int id, const Matrix4& worldTransform);
+
+	/** Rebuilds the clusters changed since the last build. */
+	void build ();
+
+	void clear ();
+
+	/** Adds the merged renderables of every cluster, call {@link #build()} first. */
+	void getRenderables (std::vector<const Renderable*>& out) const;
+
+	/** Adds the merged renderables of the clusters whose bounds are in the frustum. */
+	void getRenderables (std::vector<const Renderable*>& out, Frustum& frustum);
+
+	int getClusterCount () const {return clusters.size();}
+
+	/** @return the number of merged renderables */
+	int getRenderableCount () const;
+
+	/** @return the number of clusters rebuilt by the last {@link #build()} */
+	int getRebuiltCount () const {return rebuiltCount;}
+
+	/** Transforms count points of the interleaved vertices in place, with the translation or without it for directions, and
+	 * extends the bounds by the results if given. Uses SSE2 where available.
+	 * @param matrix the 16 floats of a column major matrix
+	 * @param offset the offset of the first component in floats
+	 * @param stride the floats per vertex
+	 * @param components the components per point, 2 or 3 */
+	static void transform (const float* matrix, float* vertices, int count, int offset, int stride, int components,
+		bool translate, BoundingBox* bounds);
+
+	/** Normalizes count 3 component directions of the interleaved vertices in place. */
+	static void normalize (float* vertices, int count, int offset, int stride);
+};
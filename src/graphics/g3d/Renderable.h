@@ -0,0 +1,42 @@
+#pragma once
+#include "../../math/Matrix4.h"
+#include "model/MeshPart.h"
+#include "Material.h"
+
+class Shader;
+
+/** A single draw: a {@link MeshPart} rendered with a {@link Shader} at a world transform. Renderables are usually queued in a
+ * {@link RenderQueue}, which orders them by the fields below before handing them to their shaders.
+ * @author badlogic, Xoppa */
+class Renderable{
+public:
+	/** Used to specify the transformations (like translation, scale and rotation) to apply to the shape. In other words: it is
+	 * used to transform the vertices from model space into world space. **/
+	Matrix4 worldTransform;
+	/** The {@link MeshPart} that contains the shape to render **/
+	MeshPart meshPart;
+	/** The {@link Shader} to be used to render this Renderable, must not be null when queued. The shader must outlive the
+	 * renderable. **/
+	Shader* shader = nullptr;
+	/** The {@link Material} to be used to render this Renderable, may be null. Renderables with equal materials are rendered
+	 * together. **/
+	std::shared_ptr<Material> material;
+	/** Whether the renderable is blended with what is behind it. Blended renderables are rendered after the opaque ones of
+	 * their pass, back to front. **/
+	bool blended = false;
+	/** The pass, 0 to 7, passes are rendered in ascending order, e.g. 0 for the scene and 1 for overlays. **/
+	int pass = 0;
+	/** User defined data, not used by the library. **/
+	void* userData = nullptr;
+
+	Renderable& set (const Renderable& renderable) {
+		worldTransform.set(renderable.worldTransform);
+		meshPart.set(renderable.meshPart);
+		shader = renderable.shader;
+		material = renderable.material;
+		blended = renderable.blended;
+		pass = renderable.pass;
+		userData = renderable.userData;
+		return *this;
+	}
+};
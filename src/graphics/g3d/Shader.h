@@ -17,10 +17,9 @@
 #pragma once
 #include "../../Camera.h"
 #include "../glutils/ShaderProgram.h"
+#include "utils/RenderContext.h"
 
-import com.badlogic.gdx.graphics.g3d.utils.BaseShaderProvider;
-import com.badlogic.gdx.graphics.g3d.utils.RenderContext;
-import com.badlogic.gdx.graphics.g3d.utils.ShaderProvider;
+class Renderable;
 
 /** Interface which is used to render one or more {@link Renderable}s.</p>
  * 
@@ -51,6 +50,9 @@ import com.badlogic.gdx.graphics.g3d.utils.ShaderProvider;
  * example, disposed (unloads for memory) the used {@link ShaderProgram}.</p>
  * @author Xoppa */
 class Shader{
+public:
+	virtual ~Shader () {}
+
 	/** Initializes the Shader, must be called before the Shader can be used. This typically compiles a {@link ShaderProgram},
 	 * fetches uniform locations and performs other preparations for usage of the Shader. */
 	virtual void init () = 0;
@@ -71,7 +73,7 @@ class Shader{
 	 * @param camera The camera to use when rendering
 	 * @param context The context to be used, which must be exclusive available for the shader until the call to the {@link #end()}
 	 *           method. */
-	virtual void begin (const Camera& camera,const RenderContext& context) = 0;
+	virtual void begin (const Camera& camera,RenderContext& context) = 0;
 
 	/** Renders the {@link Renderable}, must be called between {@link #begin(Camera, RenderContext)} and {@link #end()}. The Shader
 	 * instance might not be able to render every type of {@link Renderable}s. Use the {@link #canRender(Renderable)} method to
@@ -84,4 +86,4 @@ class Shader{
 	 * method, which must be preceded by a call to {@link #begin(Camera, RenderContext)}. After a call to this method an call to
 	 * the {@link #render(Renderable)} method will fail until the {@link #begin(Camera, RenderContext)} is called. */
 	virtual void end () = 0;
-};
\ No newline at end of file
+};
@@ -18,6 +18,7 @@
 
 #include "../../Mesh.h"
 #include "../../VertexAttributes.h"
+#include "../../VertexAttribute.h"
 #include "../../glutils/ShaderProgram.h"
 #include "../../../math/Vector3.h"
 #include "../../../math/collision/BoundingBox.h"
@@ -0,0 +1,53 @@
+#pragma once
+#include "TextureBinder.h"
+
+/** Manages the GL state shaders render with: the texture units, blending, depth testing, the depth mask and face culling. The
+ * state is set through {@link GLStateCache}, so setting what is already set costs no GL call. {@link #begin()} and
+ * {@link #end()} surround the rendering, {@link #end()} leaves GL in its default state for code not using the context. */
+class RenderContext{
+    std::shared_ptr<TextureBinder> textureBinder;
+public:
+    RenderContext():textureBinder(std::make_shared<TextureBinder>()){}
+
+    RenderContext(const std::shared_ptr<TextureBinder>& textureBinder):textureBinder(textureBinder){}
+
+    void begin () {
+        textureBinder->begin();
+    }
+
+    /** Restores the defaults: depth writes on, no blending, no culling and no depth test. */
+    void end () {
+        GLStateCache& cache = GLStateCache::get();
+        cache.depthMask(true);
+        cache.setEnabled(GL_BLEND, false);
+        cache.setEnabled(GL_CULL_FACE, false);
+        cache.setEnabled(GL_DEPTH_TEST, false);
+        textureBinder->end();
+    }
+
+    void setDepthMask (bool depthMask) {
+        GLStateCache::get().depthMask(depthMask);
+    }
+
+    /** @param depthFunction the depth function, e.g. GL_LEQUAL, or 0 to disable the depth test */
+    void setDepthTest (GLenum depthFunction) {
+        GLStateCache& cache = GLStateCache::get();
+        cache.setEnabled(GL_DEPTH_TEST, depthFunction != 0);
+        if (depthFunction != 0) cache.depthFunc(depthFunction);
+    }
+
+    void setBlending (bool enabled, GLenum sFactor, GLenum dFactor) {
+        GLStateCache& cache = GLStateCache::get();
+        cache.setEnabled(GL_BLEND, enabled);
+        if (enabled) cache.blendFunc(sFactor, dFactor);
+    }
+
+    /** @param face the faces to cull, e.g. GL_BACK, or 0 to disable culling */
+    void setCullFace (GLenum face) {
+        GLStateCache& cache = GLStateCache::get();
+        cache.setEnabled(GL_CULL_FACE, face != 0);
+        if (face != 0) cache.cullFace(face);
+    }
+
+    TextureBinder& getTextureBinder () {return *textureBinder;}
+};
@@ -0,0 +1,120 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void RenderQueue::add (const Renderable& renderable){
+	if (renderable.shader == nullptr) {
+		SDL_Log("RenderQueue: renderable without shader ignored");
+		return;
+	}
+	renderables.push_back(&renderable);
+	sorted = false;
+}
+
+uint64_t RenderQueue::computeKey (const Renderable& renderable, const Camera& camera){
+	const std::vector<float>& m = renderable.worldTransform.val;
+	const Vector3& c = renderable.meshPart.center;
+	const float x = m[Matrix4::M00] * c.x + m[Matrix4::M01] * c.y + m[Matrix4::M02] * c.z + m[Matrix4::M03];
+	const float y = m[Matrix4::M10] * c.x + m[Matrix4::M11] * c.y + m[Matrix4::M12] * c.z + m[Matrix4::M13];
+	const float z = m[Matrix4::M20] * c.x + m[Matrix4::M21] * c.y + m[Matrix4::M22] * c.z + m[Matrix4::M23];
+	const float distance = std::min(1.0f, std::sqrt(Vector3::dst2(x, y, z, camera.position.x, camera.position.y,
+		camera.position.z)) / camera.far);
+
+	//Ids past the bits they get wrap around, the order is then less optimal but still correct
+	const uint64_t shader = id(shaderIds, (const Shader*)renderable.shader) & ((1u << SHADER_BITS) - 1);
+	const size_t materialHash = renderable.material ? renderable.material->hashCode() : 0;
+	const uint64_t material = id(materialIds, materialHash) & ((1u << MATERIAL_BITS) - 1);
+	const uint64_t mesh = id(meshIds, (const Mesh*)renderable.meshPart.mesh.get());
+	uint64_t key = (uint64_t)(renderable.pass & 7) << 61;
+	if (!renderable.blended) {
+		const uint64_t depth = (uint64_t)(distance * ((1u << OPAQUE_DEPTH_BITS) - 1));
+		key |= shader << 50 | material << 34 | (mesh & ((1u << OPAQUE_MESH_BITS) - 1)) << 20 | depth;
+	} else {
+		const uint64_t depth = (uint64_t)((1.0f - distance) * ((1u << BLENDED_DEPTH_BITS) - 1));
+		key |= (uint64_t)1 << 60 | depth << 36 | shader << 26 | material << 10 | (mesh & ((1u << BLENDED_MESH_BITS) - 1));
+	}
+	return key;
+}
+
+void RenderQueue::radixSort (){
+	const size_t count = keys.size();
+	keysTmp.resize(count);
+	indicesTmp.resize(count);
+	//All eight histograms in one pass over the keys
+	uint32_t histograms[8][256];
+	memset(histograms, 0, sizeof(histograms));
+	for (size_t i = 0; i < count; i++) {
+		const uint64_t key = keys[i];
+		for (int byte = 0; byte < 8; byte++) histograms[byte][(key >> (byte * 8)) & 0xFF]++;
+	}
+
+	for (int byte = 0; byte < 8; byte++) {
+		uint32_t* histogram = histograms[byte];
+		//A byte shared by every key doesn't change the order
+		if (histogram[(keys[0] >> (byte * 8)) & 0xFF] == count) continue;
+		uint32_t offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++) {
+			const uint32_t bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketCount;
+		}
+		for (size_t i = 0; i < count; i++) {
+			const uint32_t target = histogram[(keys[i] >> (byte * 8)) & 0xFF]++;
+			keysTmp[target] = keys[i];
+			indicesTmp[target] = indices[i];
+		}
+		keys.swap(keysTmp);
+		indices.swap(indicesTmp);
+	}
+}
+
+void RenderQueue::sort (const Camera& camera){
+	const size_t count = renderables.size();
+	keys.resize(count);
+	indices.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		keys[i] = computeKey(*renderables[i], camera);
+		indices[i] = i;
+	}
+	if (count > 1) radixSort();
+	sorted = true;
+}
+
+void RenderQueue::render (const Camera& camera, RenderContext& context){
+	if (!sorted) sort(camera);
+	shaderSwitches = materialSwitches = meshSwitches = 0;
+	context.begin();
+	Shader* shader = nullptr;
+	const Renderable* previous = nullptr;
+	for (size_t i = 0; i < renderables.size(); i++) {
+		const Renderable& renderable = get(i);
+		if (renderable.shader != shader) {
+			if (shader != nullptr) shader->end();
+			shader = renderable.shader;
+			shader->begin(camera, context);
+			shaderSwitches++;
+		}
+		if (previous == nullptr || (previous->material != renderable.material && (!previous->material || !renderable.material ||
+			!previous->material->equals(*renderable.material)))) materialSwitches++;
+		if (previous == nullptr || previous->meshPart.mesh != renderable.meshPart.mesh) meshSwitches++;
+		shader->render(renderable);
+		previous = &renderable;
+	}
+	if (shader != nullptr) shader->end();
+	context.end();
+	clear();
+}
+
+void RenderQueue::clear (){
+	renderables.clear();
+	keys.clear();
+	indices.clear();
+	sorted = false;
+}
+
+void RenderQueue::resetIds (){
+	shaderIds.clear();
+	materialIds.clear();
+	meshIds.clear();
+}
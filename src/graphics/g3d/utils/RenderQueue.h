@@ -0,0 +1,80 @@
+#pragma once
+#include "../Renderable.h"
+#include "../Shader.h"
+#include "../../../Camera.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/** Collects the {@link Renderable}s of a frame and renders them in an order that minimizes state changes: by pass, opaque
+ * before blended, then opaque renderables by shader, material and mesh, front to back within each, and blended ones back to
+ * front. Each renderable gets a 64 bit sort key and the keys are radix sorted, in linear time.
+ * <p>
+ * Key layout, from the most significant bit: pass (3 bits), blended (1), then for opaque renderables shader (10), material
+ * (16), mesh (14) and depth (20), and for blended ones inverted depth (24), shader (10), material (16) and mesh (10). Depth is
+ * the distance from {@link Camera#position} to the center of the mesh part, relative to {@link Camera#far}. Shaders, materials
+ * and meshes are numbered in the order the queue first sees them, the numbers are kept across frames so the order is stable.
+ * <p>
+ * The queue keeps pointers, queued renderables must stay alive and unchanged until {@link #render} or {@link #clear()}. */
+class RenderQueue{
+	static const int SHADER_BITS = 10;
+	static const int MATERIAL_BITS = 16;
+	static const int OPAQUE_MESH_BITS = 14, BLENDED_MESH_BITS = 10;
+	static const int OPAQUE_DEPTH_BITS = 20, BLENDED_DEPTH_BITS = 24;
+
+	std::vector<const Renderable*> renderables;
+	std::vector<uint64_t> keys, keysTmp;
+	std::vector<uint32_t> indices, indicesTmp;
+	bool sorted = false;
+
+	std::unordered_map<const Shader*, uint32_t> shaderIds;
+	/** by material hash, equal materials in different objects share an id */
+	std::unordered_map<size_t, uint32_t> materialIds;
+	std::unordered_map<const Mesh*, uint32_t> meshIds;
+
+	int shaderSwitches = 0, materialSwitches = 0, meshSwitches = 0;
+
+	template<class K> static uint32_t id (std::unordered_map<K, uint32_t>& ids, const K& key) {
+		auto found = ids.find(key);
+		if (found != ids.end()) return found->second;
+		const uint32_t id = ids.size();
+		ids.emplace(key, id);
+		return id;
+	}
+
+	uint64_t computeKey (const Renderable& renderable, const Camera& camera);
+
+	/** Sorts the indices by the keys, least significant byte first, skipping bytes all keys share. */
+	void radixSort ();
+public:
+	/** Queues the renderable, it must have a shader. */
+	void add (const Renderable& renderable);
+
+	/** Computes the keys from the camera and sorts the queue, {@link #get(int)} then returns the renderables in order. */
+	void sort (const Camera& camera);
+
+	/** Sorts the queue if needed, hands the renderables to their shaders in order, then clears the queue. */
+	void render (const Camera& camera, RenderContext& context);
+
+	void clear ();
+
+	int size () const {return renderables.size();}
+
+	/** @return the renderable at the index, in sorted order after {@link #sort} */
+	const Renderable& get (int index) const {return *renderables[sorted ? indices[index] : index];}
+
+	/** @return the sort key of the renderable at the index in sorted order, valid after {@link #sort} */
+	uint64_t getKey (int index) const {return keys[index];}
+
+	/** Forgets the numbers given to shaders, materials and meshes, e.g. after a level change. */
+	void resetIds ();
+
+	/** @return the number of times the shader changed during the last {@link #render} */
+	int getShaderSwitches () const {return shaderSwitches;}
+
+	/** @return the number of times the material changed during the last {@link #render} */
+	int getMaterialSwitches () const {return materialSwitches;}
+
+	/** @return the number of times the mesh changed during the last {@link #render} */
+	int getMeshSwitches () const {return meshSwitches;}
+};
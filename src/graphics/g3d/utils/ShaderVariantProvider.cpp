@@ -0,0 +1,43 @@
+#include "ShaderVariantProvider.h"
+#include "../Attribute.h"
+
+ShaderVariantProvider::ShaderVariantProvider(const std::string& vertexPath, const std::string& fragmentPath,
+    const std::string& app, bool deferred){
+    vertexSource = preprocessor.load(vertexPath);
+    fragmentSource = preprocessor.load(fragmentPath);
+    this->app = app;
+    this->deferred = deferred;
+}
+
+std::shared_ptr<ShaderProgram> ShaderVariantProvider::get (uint64_t materialMask, uint64_t vertexMask){
+    const ShaderVariantKey key = {materialMask, vertexMask};
+    auto variant = variants.find(key);
+    if (variant != variants.end()) return variant->second;
+
+    const std::string defines = createDefines(materialMask, vertexMask);
+    std::shared_ptr<ShaderProgram> shaderProgram = std::make_shared<ShaderProgram>(
+        ShaderPreprocessor::insertDefines(vertexSource, defines), ShaderPreprocessor::insertDefines(fragmentSource, defines),
+        app, deferred);
+    if (!deferred && !shaderProgram->isCompiled())
+        SDL_Log("ShaderVariantProvider: permutation failed to compile:\n%s", defines.c_str());
+    variants[key] = shaderProgram;
+    return shaderProgram;
+}
+
+std::string ShaderVariantProvider::createDefines (uint64_t materialMask, uint64_t vertexMask){
+    std::stringstream defines;
+    for (int bit = 0; bit < 64; bit++) {
+        if ((materialMask & (1ULL << bit)) == 0) continue;
+        const std::string alias = Attribute::getAttributeAlias(1ULL << bit);
+        if (!alias.empty()) defines << "#define " << alias << "Flag\n";
+    }
+    if (vertexMask & POSITION) defines << "#define positionFlag\n";
+    if (vertexMask & (COLOR_UNPACKED | COLOR_PACKED)) defines << "#define colorFlag\n";
+    if (vertexMask & NORMAL) defines << "#define normalFlag\n";
+    if (vertexMask & TEXTURE_COORDINATES) defines << "#define texCoord0Flag\n";
+    if (vertexMask & GENERIC) defines << "#define genericFlag\n";
+    if (vertexMask & BONE_WEIGHT) defines << "#define boneWeightFlag\n";
+    if (vertexMask & TANGENT) defines << "#define tangentFlag\n";
+    if (vertexMask & BINORMAL) defines << "#define binormalFlag\n";
+    return defines.str();
+}
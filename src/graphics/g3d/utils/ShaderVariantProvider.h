@@ -0,0 +1,72 @@
+#pragma once
+#include "../../glutils/ShaderProgram.h"
+#include "../../glutils/ShaderPreprocessor.h"
+#include "../../VertexAttributes.h"
+#include "../../VertexAttribute.h"
+#include "../Attributes.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+/** Identifies a shader permutation: the {@link Attribute} types of the material and the usages of the vertex attributes. */
+struct ShaderVariantKey{
+    uint64_t materialMask;
+    uint64_t vertexMask;
+
+    bool operator== (const ShaderVariantKey& other) const {
+        return materialMask == other.materialMask && vertexMask == other.vertexMask;
+    }
+};
+
+struct ShaderVariantKeyHash{
+    size_t operator() (const ShaderVariantKey& key) const {
+        uint64_t hash = key.materialMask * 0x9E3779B97F4A7C15ULL ^ (key.vertexMask + 0x632BE59BD9B4E019ULL);
+        return (size_t)(hash ^ (hash >> 32));
+    }
+};
+
+/** Builds one {@link ShaderProgram} per combination of material attributes and vertex attributes from a single uber shader. The
+ * sources are loaded once with their includes resolved. A permutation gets a <code>#define &lt;alias&gt;Flag</code> per material
+ * attribute type, e.g. <code>diffuseTextureFlag</code>, and per vertex attribute usage, e.g. <code>normalFlag</code>, inserted
+ * after the #version line. Each permutation is compiled once, after that {@link #get} is a single hash lookup. */
+class ShaderVariantProvider{
+    ShaderPreprocessor preprocessor;
+    std::string vertexSource;
+    std::string fragmentSource;
+    std::string app;
+    bool deferred;
+    std::unordered_map<ShaderVariantKey,std::shared_ptr<ShaderProgram>,ShaderVariantKeyHash> variants;
+public:
+    /** @param vertexPath path of the vertex shader
+     * @param fragmentPath path of the fragment shader
+     * @param app the application the programs are managed under
+     * @param deferred whether programs are compiled without waiting, see {@link ShaderProgram#isReady()} */
+    ShaderVariantProvider(const std::string& vertexPath, const std::string& fragmentPath, const std::string& app,
+        bool deferred = false);
+
+    /** @return the program for the permutation, compiled on first request. Check {@link ShaderProgram#isCompiled()}, a failed
+     * permutation is cached as well so it isn't compiled again every frame. */
+    std::shared_ptr<ShaderProgram> get (uint64_t materialMask, uint64_t vertexMask);
+
+    std::shared_ptr<ShaderProgram> get (uint64_t materialMask, VertexAttributes& vertexAttributes) {
+        return get(materialMask, (uint64_t)vertexAttributes.getMask());
+    }
+
+    /** @return the program for the types of the material's attributes and the vertex attributes */
+    std::shared_ptr<ShaderProgram> get (const Attributes& material, VertexAttributes& vertexAttributes) {
+        return get(material.getMask(), (uint64_t)vertexAttributes.getMask());
+    }
+
+    /** @return the defines selecting the permutation */
+    static std::string createDefines (uint64_t materialMask, uint64_t vertexMask);
+
+    /** @return the number of compiled permutations */
+    int size () {
+        return variants.size();
+    }
+
+    /** Releases every compiled permutation still held only by this provider. */
+    void clear () {
+        variants.clear();
+    }
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include "../../../GL.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/** Assigns textures to a range of texture units so the textures used repeatedly stay bound. A texture already held by a unit is
+ * reused without any GL call, otherwise it replaces the texture of the unit used least recently. Binds go through
+ * {@link GLStateCache}, so the binder also finds textures bound by someone else, e.g. a previous binder.
+ * <p>
+ * Textures bound since {@link #begin()} are never replaced by the binder as long as there are free units, a shader binding more
+ * textures than units replaces its own oldest ones. */
+class TextureBinder{
+    int offset;
+    int count;
+    /** the stamp of the last bind of each unit, 0 if unused since begin() */
+    std::vector<unsigned int> stamps;
+    unsigned int stamp = 0;
+    int bindCount = 0;
+    int reuseCount = 0;
+public:
+    /** @param offset the first unit used
+     * @param count the number of units used, -1 for every unit from the offset on */
+    TextureBinder(int offset = 0, int count = -1):offset(offset),count(count){}
+
+    /** Prepares the binder for a new set of binds, the textures stay bound. */
+    void begin () {
+        if (count < 0) count = std::max(1, GLStateCache::get().getMaxTextureUnits() - offset);
+        stamps.assign(count, 0);
+        stamp = 0;
+    }
+
+    void end () {}
+
+    /** Binds the texture to a unit, reusing the unit holding it if any. Must be called between {@link #begin()} and
+     * {@link #end()}.
+     * @return the unit the texture is bound to, to set on the sampler uniform */
+    int bind (Texture& texture) {
+        GLStateCache& cache = GLStateCache::get();
+        const GLuint handle = texture.getTextureObjectHandle();
+        int oldest = 0;
+        for (int i = 0; i < count; i++) {
+            if (cache.getBoundTexture(offset + i, texture.getTarget()) == handle) {
+                reuseCount++;
+                stamps[i] = ++stamp;
+                //Binds nothing, but records the use for the residency of the texture
+                texture.bind(offset + i);
+                return offset + i;
+            }
+            if (stamps[i] < stamps[oldest]) oldest = i;
+        }
+        bindCount++;
+        stamps[oldest] = ++stamp;
+        texture.bind(offset + oldest);
+        return offset + oldest;
+    }
+
+    int bind (const std::shared_ptr<Texture>& texture) {return bind(*texture);}
+
+    /** @return the number of binds that needed a GL call since the last {@link #resetCounts()} */
+    int getBindCount () const {return bindCount;}
+
+    /** @return the number of binds of textures already bound since the last {@link #resetCounts()} */
+    int getReuseCount () const {return reuseCount;}
+
+    void resetCounts () {bindCount = reuseCount = 0;}
+};
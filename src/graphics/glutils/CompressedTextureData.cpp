@@ -0,0 +1,456 @@
+#include "../../GL.h"
+#include "CompressedTextureData.h"
+#include "TextureDecoder.h"
+#include <algorithm>
+#include <cstring>
+
+static const unsigned char KTX_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+static const unsigned char KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+static const int ASTC_BLOCKS[GDX_ASTC_FORMAT_COUNT][2] = {
+    {4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6}, {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}
+};
+
+static Uint32 readUint32 (const unsigned char* data, bool swap = false) {
+    Uint32 value = data[0] | (data[1] << 8) | (data[2] << 16) | ((Uint32)data[3] << 24);
+    if (swap) value = (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+    return value;
+}
+
+static Uint64 readUint64 (const unsigned char* data) {
+    return readUint32(data) | ((Uint64)readUint32(data + 4) << 32);
+}
+
+static Uint32 fourCC (const char* code) {
+    return code[0] | (code[1] << 8) | (code[2] << 16) | ((Uint32)code[3] << 24);
+}
+
+static int astcIndex (GLenum internalFormat) {
+    if (internalFormat >= GL_COMPRESSED_RGBA_ASTC_4x4_KHR && internalFormat < GL_COMPRESSED_RGBA_ASTC_4x4_KHR + GDX_ASTC_FORMAT_COUNT)
+        return internalFormat - GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+    if (internalFormat >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR
+        && internalFormat < GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + GDX_ASTC_FORMAT_COUNT)
+        return internalFormat - GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR;
+    return -1;
+}
+
+static bool isSRGB (GLenum internalFormat) {
+    switch (internalFormat) {
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM: case GL_COMPRESSED_SRGB8_ETC2:
+    case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2: case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+        return true;
+    default:
+        return internalFormat >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR
+            && internalFormat < GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + GDX_ASTC_FORMAT_COUNT;
+    }
+}
+
+/** Maps a Vulkan format of a KTX2 file to the GL formats. @return false if the format is not supported */
+static bool fromVkFormat (Uint32 vkFormat, CompressedTextureData& out) {
+    out.format = 0;
+    out.type = 0;
+    switch (vkFormat) {
+    case 23: out.internalFormat = GL_RGB8; out.format = GL_RGB; out.type = GL_UNSIGNED_BYTE; return true;
+    case 29: out.internalFormat = GL_SRGB8; out.format = GL_RGB; out.type = GL_UNSIGNED_BYTE; return true;
+    case 37: out.internalFormat = GL_RGBA8; out.format = GL_RGBA; out.type = GL_UNSIGNED_BYTE; return true;
+    case 43: out.internalFormat = GL_SRGB8_ALPHA8; out.format = GL_RGBA; out.type = GL_UNSIGNED_BYTE; return true;
+    case 131: out.internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT; return true;
+    case 132: out.internalFormat = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT; return true;
+    case 133: out.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; return true;
+    case 134: out.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; return true;
+    case 135: out.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; return true;
+    case 136: out.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; return true;
+    case 137: out.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; return true;
+    case 138: out.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; return true;
+    case 139: out.internalFormat = GL_COMPRESSED_RED_RGTC1; return true;
+    case 140: out.internalFormat = GL_COMPRESSED_SIGNED_RED_RGTC1; return true;
+    case 141: out.internalFormat = GL_COMPRESSED_RG_RGTC2; return true;
+    case 142: out.internalFormat = GL_COMPRESSED_SIGNED_RG_RGTC2; return true;
+    case 143: out.internalFormat = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT; return true;
+    case 144: out.internalFormat = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT; return true;
+    case 145: out.internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM; return true;
+    case 146: out.internalFormat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; return true;
+    case 147: out.internalFormat = GL_COMPRESSED_RGB8_ETC2; return true;
+    case 148: out.internalFormat = GL_COMPRESSED_SRGB8_ETC2; return true;
+    case 149: out.internalFormat = GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2; return true;
+    case 150: out.internalFormat = GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2; return true;
+    case 151: out.internalFormat = GL_COMPRESSED_RGBA8_ETC2_EAC; return true;
+    case 152: out.internalFormat = GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC; return true;
+    case 153: out.internalFormat = GL_COMPRESSED_R11_EAC; return true;
+    case 154: out.internalFormat = GL_COMPRESSED_SIGNED_R11_EAC; return true;
+    case 155: out.internalFormat = GL_COMPRESSED_RG11_EAC; return true;
+    case 156: out.internalFormat = GL_COMPRESSED_SIGNED_RG11_EAC; return true;
+    default:
+        //ASTC LDR formats alternate between UNORM and SRGB
+        if (vkFormat >= 157 && vkFormat < 157 + 2 * GDX_ASTC_FORMAT_COUNT) {
+            const int index = (vkFormat - 157) / 2;
+            out.internalFormat = ((vkFormat - 157) & 1) ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + index
+                : GL_COMPRESSED_RGBA_ASTC_4x4_KHR + index;
+            return true;
+        }
+        return false;
+    }
+}
+
+/** Maps a DXGI format of a DDS file with the DX10 header. @return false if the format is not supported */
+static bool fromDXGIFormat (Uint32 dxgiFormat, CompressedTextureData& out) {
+    out.format = 0;
+    out.type = 0;
+    switch (dxgiFormat) {
+    case 28: out.internalFormat = GL_RGBA8; out.format = GL_RGBA; out.type = GL_UNSIGNED_BYTE; return true;
+    case 29: out.internalFormat = GL_SRGB8_ALPHA8; out.format = GL_RGBA; out.type = GL_UNSIGNED_BYTE; return true;
+    case 71: out.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; return true;
+    case 72: out.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; return true;
+    case 74: out.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; return true;
+    case 75: out.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; return true;
+    case 77: out.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; return true;
+    case 78: out.internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; return true;
+    case 80: out.internalFormat = GL_COMPRESSED_RED_RGTC1; return true;
+    case 81: out.internalFormat = GL_COMPRESSED_SIGNED_RED_RGTC1; return true;
+    case 83: out.internalFormat = GL_COMPRESSED_RG_RGTC2; return true;
+    case 84: out.internalFormat = GL_COMPRESSED_SIGNED_RG_RGTC2; return true;
+    case 95: out.internalFormat = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT; return true;
+    case 96: out.internalFormat = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT; return true;
+    case 98: out.internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM; return true;
+    case 99: out.internalFormat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; return true;
+    default: return false;
+    }
+}
+
+/** @return the bytes per pixel of uncompressed data, 0 if the format or type is not known */
+static int pixelSize (GLenum format, GLenum type) {
+    switch (type) {
+    case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_5_5_5_1:
+        return 2;
+    case GL_UNSIGNED_INT_2_10_10_10_REV: case GL_UNSIGNED_INT_10F_11F_11F_REV: case GL_UNSIGNED_INT_5_9_9_9_REV:
+        return 4;
+    }
+    int components;
+    switch (format) {
+    case GL_RED: case GL_ALPHA: case GL_LUMINANCE: components = 1; break;
+    case GL_RG: case GL_LUMINANCE_ALPHA: components = 2; break;
+    case GL_RGB: components = 3; break;
+    case GL_RGBA: components = 4; break;
+    default: return 0;
+    }
+    switch (type) {
+    case GL_UNSIGNED_BYTE: case GL_BYTE: return components;
+    case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return components * 2;
+    case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: return components * 4;
+    default: return 0;
+    }
+}
+
+/** @return the size in bytes of an uncompressed level whose rows are padded to the alignment */
+static size_t uncompressedLevelSize (int pixelSize, int width, int height, int alignment) {
+    const size_t rowSize = ((size_t)width * pixelSize + alignment - 1) / alignment * alignment;
+    return rowSize * height;
+}
+
+bool CompressedTextureData::getBlockSize (GLenum internalFormat, int& blockWidth, int& blockHeight, int& blockBytes){
+    blockWidth = blockHeight = 4;
+    switch (internalFormat) {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RED_RGTC1: case GL_COMPRESSED_SIGNED_RED_RGTC1:
+    case GL_ETC1_RGB8_OES: case GL_COMPRESSED_RGB8_ETC2: case GL_COMPRESSED_SRGB8_ETC2:
+    case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2: case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+    case GL_COMPRESSED_R11_EAC: case GL_COMPRESSED_SIGNED_R11_EAC:
+        blockBytes = 8;
+        return true;
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RG_RGTC2: case GL_COMPRESSED_SIGNED_RG_RGTC2:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM: case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+    case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT: case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+    case GL_COMPRESSED_RGBA8_ETC2_EAC: case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+    case GL_COMPRESSED_RG11_EAC: case GL_COMPRESSED_SIGNED_RG11_EAC:
+        blockBytes = 16;
+        return true;
+    default: {
+        const int index = astcIndex(internalFormat);
+        if (index < 0) return false;
+        blockWidth = ASTC_BLOCKS[index][0];
+        blockHeight = ASTC_BLOCKS[index][1];
+        blockBytes = 16;
+        return true;
+    }
+    }
+}
+
+size_t CompressedTextureData::getLevelSize (GLenum internalFormat, int width, int height){
+    int blockWidth, blockHeight, blockBytes;
+    if (!getBlockSize(internalFormat, blockWidth, blockHeight, blockBytes)) return 0;
+    return (size_t)((width + blockWidth - 1) / blockWidth) * ((height + blockHeight - 1) / blockHeight) * blockBytes;
+}
+
+bool CompressedTextureData::parseKTX (const unsigned char* data, size_t size, CompressedTextureData& out){
+    if (size < 64 || memcmp(data, KTX_IDENTIFIER, 12) != 0) return false;
+    const Uint32 endianness = readUint32(data + 12);
+    if (endianness != 0x04030201 && endianness != 0x01020304) return false;
+    const bool swap = endianness == 0x01020304;
+
+    out.type = readUint32(data + 16, swap);
+    out.format = readUint32(data + 24, swap);
+    out.internalFormat = readUint32(data + 28, swap);
+    out.width = readUint32(data + 36, swap);
+    out.height = std::max<Uint32>(1, readUint32(data + 40, swap));
+    const Uint32 depth = readUint32(data + 44, swap), arrayElements = readUint32(data + 48, swap);
+    const Uint32 faces = readUint32(data + 52, swap), mipLevels = std::max<Uint32>(1, readUint32(data + 56, swap));
+    if (depth > 1 || arrayElements > 0 || faces != 1) {
+        SDL_Log("CompressedTextureData: only 2D KTX textures are supported");
+        return false;
+    }
+    if (swap && out.format != 0 && out.type != GL_UNSIGNED_BYTE) {
+        SDL_Log("CompressedTextureData: big endian KTX data with multi-byte texels is not supported");
+        return false;
+    }
+    const int texelSize = out.isCompressed() ? 0 : pixelSize(out.format, out.type);
+    if (!out.isCompressed() && texelSize == 0) {
+        SDL_Log("CompressedTextureData: unsupported KTX format 0x%04x type 0x%04x", out.format, out.type);
+        return false;
+    }
+    //KTX 1 pads the rows of uncompressed levels to 4 bytes
+    out.unpackAlignment = 4;
+
+    size_t offset = 64 + readUint32(data + 60, swap);
+    out.levels.clear();
+    for (Uint32 level = 0; level < mipLevels; level++) {
+        if (offset + 4 > size) return false;
+        const Uint32 imageSize = readUint32(data + offset, swap);
+        offset += 4;
+        if (offset + imageSize > size) return false;
+        CompressedTextureLevel mip = {std::max(1, out.width >> level), std::max(1, out.height >> level), data + offset, imageSize};
+        const size_t expected = out.isCompressed() ? getLevelSize(out.internalFormat, mip.width, mip.height)
+            : uncompressedLevelSize(texelSize, mip.width, mip.height, 4);
+        if (imageSize != expected) {
+            SDL_Log("CompressedTextureData: KTX level %u has %u bytes, expected %zu", level, imageSize, expected);
+            return false;
+        }
+        out.levels.push_back(mip);
+        offset += (imageSize + 3) & ~3u;
+    }
+    return true;
+}
+
+bool CompressedTextureData::parseKTX2 (const unsigned char* data, size_t size, CompressedTextureData& out){
+    if (size < 80 || memcmp(data, KTX2_IDENTIFIER, 12) != 0) return false;
+    const Uint32 vkFormat = readUint32(data + 12);
+    out.width = readUint32(data + 20);
+    out.height = std::max<Uint32>(1, readUint32(data + 24));
+    const Uint32 depth = readUint32(data + 28), layers = readUint32(data + 32), faces = readUint32(data + 36);
+    const Uint32 levelCount = std::max<Uint32>(1, readUint32(data + 40)), supercompression = readUint32(data + 44);
+    if (depth > 1 || layers > 0 || faces != 1) {
+        SDL_Log("CompressedTextureData: only 2D KTX2 textures are supported");
+        return false;
+    }
+    if (supercompression != 0 || vkFormat == 0) {
+        SDL_Log("CompressedTextureData: supercompressed or Basis Universal KTX2 files are not supported");
+        return false;
+    }
+    if (!fromVkFormat(vkFormat, out)) {
+        SDL_Log("CompressedTextureData: unsupported KTX2 format %u", vkFormat);
+        return false;
+    }
+
+    out.unpackAlignment = 1;
+
+    if (80 + (size_t)levelCount * 24 > size) return false;
+    out.levels.clear();
+    for (Uint32 level = 0; level < levelCount; level++) {
+        const unsigned char* index = data + 80 + level * 24;
+        const Uint64 offset = readUint64(index), length = readUint64(index + 8);
+        if (offset > size || length > size - offset) return false;
+        CompressedTextureLevel mip = {std::max(1, out.width >> level), std::max(1, out.height >> level), data + offset,
+            (size_t)length};
+        const size_t expected = out.isCompressed() ? getLevelSize(out.internalFormat, mip.width, mip.height)
+            : uncompressedLevelSize(pixelSize(out.format, out.type), mip.width, mip.height, 1);
+        if (length != expected) {
+            SDL_Log("CompressedTextureData: KTX2 level %u has %llu bytes, expected %zu", level, (unsigned long long)length,
+                expected);
+            return false;
+        }
+        out.levels.push_back(mip);
+    }
+    return true;
+}
+
+bool CompressedTextureData::parseDDS (const unsigned char* data, size_t size, CompressedTextureData& out){
+    if (size < 128 || readUint32(data) != fourCC("DDS ") || readUint32(data + 4) != 124) return false;
+    const Uint32 flags = readUint32(data + 8);
+    out.height = std::max<Uint32>(1, readUint32(data + 12));
+    out.width = readUint32(data + 16);
+    const Uint32 mipLevels = (flags & 0x20000) ? std::max<Uint32>(1, readUint32(data + 28)) : 1;
+    const Uint32 pixelFlags = readUint32(data + 80), code = readUint32(data + 84);
+    if (readUint32(data + 112) & (0x200 | 0x200000)) {
+        SDL_Log("CompressedTextureData: DDS cube maps and volumes are not supported");
+        return false;
+    }
+
+    size_t offset = 128;
+    out.unpackAlignment = 1;
+    out.format = 0;
+    out.type = 0;
+    if ((pixelFlags & 0x4) && code == fourCC("DX10")) {
+        if (size < 148) return false;
+        const Uint32 dxgiFormat = readUint32(data + 128), dimension = readUint32(data + 132);
+        if (dimension != 3 || (readUint32(data + 136) & 0x4) || readUint32(data + 140) > 1) {
+            SDL_Log("CompressedTextureData: only 2D DDS textures are supported");
+            return false;
+        }
+        if (!fromDXGIFormat(dxgiFormat, out)) {
+            SDL_Log("CompressedTextureData: unsupported DXGI format %u", dxgiFormat);
+            return false;
+        }
+        offset = 148;
+    } else if (pixelFlags & 0x4) {
+        if (code == fourCC("DXT1")) out.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        else if (code == fourCC("DXT3")) out.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+        else if (code == fourCC("DXT5")) out.internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        else if (code == fourCC("ATI1") || code == fourCC("BC4U")) out.internalFormat = GL_COMPRESSED_RED_RGTC1;
+        else if (code == fourCC("ATI2") || code == fourCC("BC5U")) out.internalFormat = GL_COMPRESSED_RG_RGTC2;
+        else {
+            SDL_Log("CompressedTextureData: unsupported DDS FourCC 0x%08x", code);
+            return false;
+        }
+    } else if ((pixelFlags & 0x40) && readUint32(data + 88) == 32 && readUint32(data + 92) == 0xFF
+        && readUint32(data + 96) == 0xFF00 && readUint32(data + 100) == 0xFF0000) {
+        out.internalFormat = GL_RGBA8;
+        out.format = GL_RGBA;
+        out.type = GL_UNSIGNED_BYTE;
+    } else {
+        SDL_Log("CompressedTextureData: only RGBA8 is supported among uncompressed DDS layouts");
+        return false;
+    }
+
+    out.levels.clear();
+    for (Uint32 level = 0; level < mipLevels; level++) {
+        const int width = std::max(1, out.width >> level), height = std::max(1, out.height >> level);
+        const size_t length = out.isCompressed() ? getLevelSize(out.internalFormat, width, height) : (size_t)width * height * 4;
+        if (offset + length > size) return false;
+        out.levels.push_back({width, height, data + offset, length});
+        offset += length;
+    }
+    return true;
+}
+
+std::shared_ptr<CompressedTextureData> CompressedTextureData::load (const std::string& path){
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+    if (!file->isValid()) {
+        SDL_Log("CompressedTextureData: cannot read %s", path.c_str());
+        return nullptr;
+    }
+
+    std::shared_ptr<CompressedTextureData> textureData = std::make_shared<CompressedTextureData>();
+    const unsigned char* data = file->data();
+    const size_t size = file->size();
+    bool parsed = false;
+    if (size >= 12 && memcmp(data, KTX_IDENTIFIER, 12) == 0) parsed = parseKTX(data, size, *textureData);
+    else if (size >= 12 && memcmp(data, KTX2_IDENTIFIER, 12) == 0) parsed = parseKTX2(data, size, *textureData);
+    else if (size >= 4 && readUint32(data) == fourCC("DDS ")) parsed = parseDDS(data, size, *textureData);
+    else SDL_Log("CompressedTextureData: %s is neither KTX, KTX2 nor DDS", path.c_str());
+
+    if (!parsed) {
+        SDL_Log("CompressedTextureData: cannot parse %s", path.c_str());
+        return nullptr;
+    }
+    textureData->file = file;
+    return textureData;
+}
+
+bool CompressedTextureData::isFormatSupported (GLenum internalFormat){
+    static std::vector<GLint> reported;
+    static bool queried = false;
+    if (!queried) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+        reported.resize(count);
+        if (count > 0) glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, reported.data());
+        queried = true;
+    }
+    if (std::find(reported.begin(), reported.end(), (GLint)internalFormat) != reported.end()) return true;
+
+    switch (internalFormat) {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        return SDL_GL_ExtensionSupported("GL_EXT_texture_compression_s3tc")
+            || SDL_GL_ExtensionSupported("GL_EXT_texture_compression_dxt1");
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        return SDL_GL_ExtensionSupported("GL_EXT_texture_compression_s3tc");
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        return SDL_GL_ExtensionSupported("GL_EXT_texture_compression_s3tc_srgb")
+            || (SDL_GL_ExtensionSupported("GL_EXT_texture_compression_s3tc") && SDL_GL_ExtensionSupported("GL_EXT_texture_sRGB"));
+    case GL_COMPRESSED_RED_RGTC1: case GL_COMPRESSED_SIGNED_RED_RGTC1:
+    case GL_COMPRESSED_RG_RGTC2: case GL_COMPRESSED_SIGNED_RG_RGTC2:
+        return SDL_GL_ExtensionSupported("GL_ARB_texture_compression_rgtc")
+            || SDL_GL_ExtensionSupported("GL_EXT_texture_compression_rgtc");
+    case GL_COMPRESSED_RGBA_BPTC_UNORM: case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+    case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT: case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+        return SDL_GL_ExtensionSupported("GL_ARB_texture_compression_bptc")
+            || SDL_GL_ExtensionSupported("GL_EXT_texture_compression_bptc");
+    case GL_ETC1_RGB8_OES:
+        return SDL_GL_ExtensionSupported("GL_OES_compressed_ETC1_RGB8_texture");
+    case GL_COMPRESSED_RGB8_ETC2: case GL_COMPRESSED_SRGB8_ETC2:
+    case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2: case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+    case GL_COMPRESSED_RGBA8_ETC2_EAC: case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+    case GL_COMPRESSED_R11_EAC: case GL_COMPRESSED_SIGNED_R11_EAC:
+    case GL_COMPRESSED_RG11_EAC: case GL_COMPRESSED_SIGNED_RG11_EAC:
+        #ifdef DESKTOP
+            return SDL_GL_ExtensionSupported("GL_ARB_ES3_compatibility");
+        #else
+            return true; //mandatory in OpenGL ES 3.0
+        #endif
+    default:
+        if (astcIndex(internalFormat) >= 0) return SDL_GL_ExtensionSupported("GL_KHR_texture_compression_astc_ldr");
+        return false;
+    }
+}
+
+bool CompressedTextureData::upload (GLenum target){
+    if (levels.empty()) return false;
+    if (!isCompressed()) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+        for (int i = 0; i < levels.size(); i++)
+            glTexImage2D(target, i, internalFormat, levels[i].width, levels[i].height, 0, format, type, levels[i].data);
+    } else {
+        GLenum uploadFormat = internalFormat;
+        //ETC2 decoders accept ETC1 data as is
+        if (uploadFormat == GL_ETC1_RGB8_OES && !isFormatSupported(uploadFormat) && isFormatSupported(GL_COMPRESSED_RGB8_ETC2))
+            uploadFormat = GL_COMPRESSED_RGB8_ETC2;
+
+        if (isFormatSupported(uploadFormat)) {
+            for (int i = 0; i < levels.size(); i++)
+                glCompressedTexImage2D(target, i, uploadFormat, levels[i].width, levels[i].height, 0, levels[i].size,
+                    levels[i].data);
+        } else if (TextureDecoder::canDecode(internalFormat)) {
+            SDL_Log("CompressedTextureData: format 0x%04x not supported by the driver, decoding on the CPU", internalFormat);
+            const GLenum decodedFormat = isSRGB(internalFormat) ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+            std::vector<unsigned char> rgba;
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            for (int i = 0; i < levels.size(); i++) {
+                if (!TextureDecoder::decode(internalFormat, levels[i].data, levels[i].size, levels[i].width, levels[i].height, rgba))
+                    return false;
+                glTexImage2D(target, i, decodedFormat, levels[i].width, levels[i].height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+            }
+        } else {
+            SDL_Log("CompressedTextureData: format 0x%04x is neither supported by the driver nor decodable", internalFormat);
+            return false;
+        }
+    }
+    //Files may stop before 1x1, the texture is complete with the levels it has
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels.size() - 1);
+    return true;
+}
+
+std::shared_ptr<Texture> CompressedTextureData::createTexture (GLenum minFilter, GLenum magFilter, GLenum uWrap, GLenum vWrap){
+    GLuint handle = 0;
+    glGenTextures(1, &handle);
+    GLStateCache::get().bindTexture(GL_TEXTURE_2D, handle);
+    if (!upload(GL_TEXTURE_2D)) {
+        GLStateCache::get().deleteTextures(1, &handle);
+        return nullptr;
+    }
+    return std::make_shared<Texture>(GL_TEXTURE_2D, handle, width, height, minFilter, magFilter, uWrap, vWrap, levels.size() > 1);
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "../../GL.h"
+#include "../../utils/MappedFile.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+//Compressed formats from extensions, not every GL header defines them
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_COMPRESSED_RED_RGTC1
+#define GL_COMPRESSED_RED_RGTC1 0x8DBB
+#define GL_COMPRESSED_SIGNED_RED_RGTC1 0x8DBC
+#define GL_COMPRESSED_RG_RGTC2 0x8DBD
+#define GL_COMPRESSED_SIGNED_RG_RGTC2 0x8DBE
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#define GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT 0x8E8E
+#define GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT 0x8E8F
+#endif
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_R11_EAC 0x9270
+#define GL_COMPRESSED_SIGNED_R11_EAC 0x9271
+#define GL_COMPRESSED_RG11_EAC 0x9272
+#define GL_COMPRESSED_SIGNED_RG11_EAC 0x9273
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#define GL_COMPRESSED_SRGB8_ETC2 0x9275
+#define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2 0x9276
+#define GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2 0x9277
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#define GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC 0x9279
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+/** the 14 ASTC block sizes follow in order: 4x4, 5x4, 5x5, 6x5, 6x6, 8x5, 8x6, 8x8, 10x5, 10x6, 10x8, 10x10, 12x10, 12x12 */
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR 0x93D0
+#endif
+#define GDX_ASTC_FORMAT_COUNT 14
+
+/** One mip level of a {@link CompressedTextureData}, pointing into the file content. */
+struct CompressedTextureLevel{
+    int width;
+    int height;
+    const unsigned char* data;
+    size_t size;
+};
+
+/** Texture data read from a KTX, KTX2 or DDS container. The levels reference the memory mapped file directly, nothing is copied
+ * until upload. {@link #upload} sends compressed levels as they are if the driver reports the format, otherwise it decodes them
+ * to RGBA8 on the CPU with the {@link TextureDecoder}. Only 2D textures are read, cube maps, arrays and 3D textures are rejected.
+ * The parse functions need no GL context. */
+class CompressedTextureData{
+    std::shared_ptr<MappedFile> file;
+public:
+    /** the GL internal format, a compressed format or a sized uncompressed one such as GL_RGBA8 */
+    GLenum internalFormat = 0;
+    /** format and type of uncompressed data, 0 for compressed formats */
+    GLenum format = 0;
+    GLenum type = 0;
+    /** the row alignment of uncompressed levels, 4 in KTX 1 files, 1 otherwise */
+    int unpackAlignment = 1;
+    int width = 0;
+    int height = 0;
+    /** levels, starting with the largest */
+    std::vector<CompressedTextureLevel> levels;
+
+    /** @return whether the data uses a block compressed format */
+    bool isCompressed () const {return format == 0;}
+
+    /** Maps the file and parses it according to its signature.
+     * @return the data, or nullptr if the file can't be read or isn't supported */
+    static std::shared_ptr<CompressedTextureData> load (const std::string& path);
+
+    /** Parses a KTX 1.1 container. @return false if the data isn't a supported KTX file */
+    static bool parseKTX (const unsigned char* data, size_t size, CompressedTextureData& out);
+
+    /** Parses a KTX 2.0 container without supercompression. @return false if the data isn't a supported KTX2 file */
+    static bool parseKTX2 (const unsigned char* data, size_t size, CompressedTextureData& out);
+
+    /** Parses a DDS container, with or without the DX10 header. @return false if the data isn't a supported DDS file */
+    static bool parseDDS (const unsigned char* data, size_t size, CompressedTextureData& out);
+
+    /** Gets the block layout of a compressed format.
+     * @return false if the format is not a known compressed format */
+    static bool getBlockSize (GLenum internalFormat, int& blockWidth, int& blockHeight, int& blockBytes);
+
+    /** @return the size in bytes of a level of the given format */
+    static size_t getLevelSize (GLenum internalFormat, int width, int height);
+
+    /** @return whether the current context accepts the compressed format in glCompressedTexImage2D, based on
+     * GL_COMPRESSED_TEXTURE_FORMATS and the reported extensions */
+    static bool isFormatSupported (GLenum internalFormat);
+
+    /** Uploads every level to the bound texture, decoding on the CPU if the format isn't supported and can be decoded.
+     * @return false if nothing could be uploaded */
+    bool upload (GLenum target);
+
+    /** Creates a texture holding the data, using all the levels in the file.
+     * @return the texture, or nullptr if the upload failed */
+    std::shared_ptr<Texture> createTexture (GLenum minFilter, GLenum magFilter, GLenum uWrap, GLenum vWrap);
+};
@@ -0,0 +1,230 @@
+#include "DamageTracker.h"
+#include "GLStateCache.h"
+#include <algorithm>
+#include <cstring>
+
+/** the number of frames of damage kept for the buffer age, older back buffers are fully repainted */
+static const int MAX_HISTORY = 4;
+
+DamageTracker::Rect DamageTracker::Rect::merge (const Rect& other) const {
+    const int x0 = std::min(x, other.x), y0 = std::min(y, other.y);
+    const int x1 = std::max(x + width, other.x + other.width), y1 = std::max(y + height, other.y + other.height);
+    return Rect{x0, y0, x1 - x0, y1 - y0};
+}
+
+bool DamageTracker::Rect::touches (const Rect& other) const {
+    return x <= other.x + other.width && other.x <= x + width && y <= other.y + other.height && other.y <= y + height;
+}
+
+DamageTracker::~DamageTracker(){
+    disposeCopy();
+}
+
+#ifndef DESKTOP
+static bool hasExtension (const char* extensions, const char* name){
+    const size_t length = strlen(name);
+    for (const char* start = extensions; (start = strstr(start, name)) != nullptr; start += length) {
+        //Whole names only, one may be the prefix of another
+        if ((start == extensions || start[-1] == ' ') && (start[length] == ' ' || start[length] == '\0')) return true;
+    }
+    return false;
+}
+#endif
+
+void DamageTracker::init (SDL_Window* window){
+    int drawableWidth, drawableHeight;
+    SDL_GL_GetDrawableSize(window, &drawableWidth, &drawableHeight);
+    resize(drawableWidth, drawableHeight);
+
+    method = Method::FULL;
+#ifndef DESKTOP
+    display = eglGetCurrentDisplay();
+    surface = eglGetCurrentSurface(EGL_DRAW);
+    const char* extensions = display != EGL_NO_DISPLAY ? eglQueryString(display, EGL_EXTENSIONS) : nullptr;
+    if (extensions && surface != EGL_NO_SURFACE) {
+        if (hasExtension(extensions, "EGL_KHR_partial_update"))
+            setDamageRegion = (PFNEGLSETDAMAGEREGIONKHRPROC)eglGetProcAddress("eglSetDamageRegionKHR");
+        if (hasExtension(extensions, "EGL_KHR_swap_buffers_with_damage"))
+            swapWithDamage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+        else if (hasExtension(extensions, "EGL_EXT_swap_buffers_with_damage"))
+            swapWithDamage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+        if (setDamageRegion || hasExtension(extensions, "EGL_EXT_buffer_age")) method = Method::BUFFER_AGE;
+    }
+#endif
+    if (method == Method::FULL) {
+        GLint samples = 0;
+        glGetIntegerv(GL_SAMPLES, &samples);
+        if (samples == 0)
+            method = Method::PRESERVED_COPY;
+        else
+            SDL_Log("DamageTracker: multisampled window without buffer age, frames are fully repainted");
+    }
+    SDL_Log("DamageTracker: %s", method == Method::BUFFER_AGE ? "buffer age" :
+        method == Method::PRESERVED_COPY ? "preserved copy" : "full repaint");
+}
+
+void DamageTracker::resize (int width, int height){
+    if (this->width != width || this->height != height) {
+        this->width = width;
+        this->height = height;
+        disposeCopy();
+    }
+    history.clear();
+    damageAll();
+}
+
+void DamageTracker::addDamage (int x, int y, int width, int height){
+    if (fullDamage) return;
+    const int x0 = std::max(x, 0), y0 = std::max(y, 0);
+    const int x1 = std::min(x + width, this->width), y1 = std::min(y + height, this->height);
+    if (x1 <= x0 || y1 <= y0) return;
+    damage.push_back(Rect{x0, y0, x1 - x0, y1 - y0});
+    mergeDamage();
+
+    long long area = 0;
+    for (const Rect& rect : damage)
+        area += rect.area();
+    if (area >= fullThreshold * (long long)this->width * this->height) damageAll();
+}
+
+void DamageTracker::mergeDamage (){
+    //Overlapping or touching rectangles are merged first, so those left are disjoint and their areas add up to the damage
+    while (damage.size() > 1) {
+        int bestI = 0, bestJ = 1;
+        long long bestCost = -1;
+        bool touching = false;
+        for (int i = 0, n = damage.size(); i < n && !touching; i++) {
+            for (int j = i + 1; j < n; j++) {
+                if (damage[i].touches(damage[j])) {
+                    bestI = i;
+                    bestJ = j;
+                    touching = true;
+                    break;
+                }
+                const long long cost = (long long)damage[i].merge(damage[j]).area() - damage[i].area() - damage[j].area();
+                if (bestCost == -1 || cost < bestCost) {
+                    bestCost = cost;
+                    bestI = i;
+                    bestJ = j;
+                }
+            }
+        }
+        //Then the pair adding the least area, while there are too many
+        if (!touching && (int)damage.size() <= maxRects) break;
+        damage[bestI] = damage[bestI].merge(damage[bestJ]);
+        damage.erase(damage.begin() + bestJ);
+    }
+}
+
+void DamageTracker::damageAll (){
+    fullDamage = true;
+    damage.clear();
+}
+
+void DamageTracker::createCopy (){
+    glGenRenderbuffers(1, &copyRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, copyRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenFramebuffers(1, &copyFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, copyFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, copyRenderbuffer);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "DamageTracker: copy framebuffer incomplete (0x%x), repainting fully", status);
+        disposeCopy();
+        method = Method::FULL;
+    }
+}
+
+void DamageTracker::disposeCopy (){
+    if (copyFramebuffer) glDeleteFramebuffers(1, &copyFramebuffer);
+    if (copyRenderbuffer) glDeleteRenderbuffers(1, &copyRenderbuffer);
+    copyFramebuffer = copyRenderbuffer = 0;
+    copyValid = false;
+}
+
+const DamageTracker::Rect& DamageTracker::beginFrame (){
+    bool repaintAll = fullDamage || method == Method::FULL;
+#ifndef DESKTOP
+    int age = 0;
+    if (method == Method::BUFFER_AGE) {
+        //Must be queried before the damage region is set
+        if (!eglQuerySurface(display, surface, EGL_BUFFER_AGE_EXT, &bufferAge)) bufferAge = 0;
+        age = bufferAge;
+        if (age <= 0 || age - 1 > (int)history.size()) repaintAll = true;
+    }
+#endif
+    //Blits are scissored as well
+    GLStateCache::get().setEnabled(GL_SCISSOR_TEST, false);
+    if (method == Method::PRESERVED_COPY) {
+        if (!copyValid)
+            repaintAll = true;
+        else if (!repaintAll) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, copyFramebuffer);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+    }
+
+    if (repaintAll)
+        repaint = Rect{0, 0, width, height};
+    else {
+        repaint = damage[0];
+        for (const Rect& rect : damage)
+            repaint = repaint.merge(rect);
+#ifndef DESKTOP
+        //The back buffer misses the damage of the frames drawn since it was presented
+        for (int i = 0; i < age - 1; i++)
+            for (const Rect& rect : history[i])
+                repaint = repaint.merge(rect);
+        if (setDamageRegion) {
+            EGLint region[] = {repaint.x, repaint.y, repaint.width, repaint.height};
+            setDamageRegion(display, surface, region, 1);
+        }
+#endif
+        GLStateCache::get().setEnabled(GL_SCISSOR_TEST, true);
+        glScissor(repaint.x, repaint.y, repaint.width, repaint.height);
+    }
+    repaintedPixels = (long long)repaint.width * repaint.height;
+    return repaint;
+}
+
+void DamageTracker::endFrame (SDL_Window* window){
+    GLStateCache::get().setEnabled(GL_SCISSOR_TEST, false);
+    if (method == Method::PRESERVED_COPY) {
+        if (!copyRenderbuffer) createCopy();
+        if (copyFramebuffer) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, copyFramebuffer);
+            const int x0 = repaint.x, y0 = repaint.y, x1 = repaint.x + repaint.width, y1 = repaint.y + repaint.height;
+            glBlitFramebuffer(x0, y0, x1, y1, x0, y0, x1, y1, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            copyValid = true;
+        }
+    }
+
+#ifndef DESKTOP
+    if (swapWithDamage && !fullDamage) {
+        //Relative to the last presented frame, so only this frame's damage
+        std::vector<EGLint> rects;
+        rects.reserve(damage.size() * 4);
+        for (const Rect& rect : damage) {
+            rects.push_back(rect.x);
+            rects.push_back(rect.y);
+            rects.push_back(rect.width);
+            rects.push_back(rect.height);
+        }
+        swapWithDamage(display, surface, rects.data(), damage.size());
+    } else
+#endif
+    SDL_GL_SwapWindow(window);
+
+    if (method == Method::BUFFER_AGE) {
+        history.push_front(fullDamage ? std::vector<Rect>{Rect{0, 0, width, height}} : damage);
+        if ((int)history.size() > MAX_HISTORY) history.pop_back();
+    }
+    damage.clear();
+    fullDamage = false;
+}
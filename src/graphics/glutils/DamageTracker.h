@@ -0,0 +1,154 @@
+#pragma once
+#include "../../GL.h"
+#ifndef DESKTOP
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+#endif
+#include <vector>
+#include <deque>
+
+/** Tracks the regions of the window which changed since the last frame, so a mostly static application redraws only those
+ * and not the whole window each vsync, see {@link Configuration#partialRedraw}.
+ * <p>
+ * Rendering code reports the changed rectangles with {@link #addDamage(int, int, int, int)}, in window pixels with the origin
+ * at the bottom left as for <code>glScissor</code>. The rectangles are clipped to the window and merged: overlapping or
+ * adjacent ones into their bounding box until none are left, then the pair adding the least area while there are more than
+ * {@link #setMaxRects(int) max rects}. Once they cover most of the window the whole window is damaged.
+ * <p>
+ * A frame is drawn between {@link #beginFrame()} and {@link #endFrame(SDL_Window*)}. The scissor box is set to the bounding
+ * box of the region to repaint, so the render call can draw everything and only the pixels inside are touched. Render code
+ * setting its own scissor box must keep it inside that region. The content outside must still be in the back buffer, which is
+ * guaranteed in one of these ways, the first available is used:
+ * <ul>
+ * <li>With <code>EGL_KHR_partial_update</code> or <code>EGL_EXT_buffer_age</code> the age of the back buffer tells which frame
+ * it holds, the damage of the frames drawn since then is repainted as well. <code>EGL_KHR_partial_update</code> additionally
+ * lets tilers load and store only the repainted region.</li>
+ * <li>Otherwise the last frame is kept in a renderbuffer: it is copied into the back buffer before drawing and the repainted
+ * region is copied back after. This costs a full window copy per drawn frame, still far less than drawing a complex UI, but
+ * no partial update. It is not possible with a multisampled window, which is then always fully repainted.</li>
+ * </ul>
+ * The frame is presented with <code>eglSwapBuffersWithDamageKHR</code> or <code>EXT</code> when available, so the compositor
+ * also only updates the damage, otherwise with <code>SDL_GL_SwapWindow</code>. The EGL paths need an EGL context, so they are
+ * not used on desktop builds.
+ * <p>
+ * Without damage nothing needs to be drawn nor swapped, the application loop then waits for events instead, see
+ * {@link #hasDamage()}. */
+class DamageTracker{
+public:
+    /** A rectangle in window pixels, the origin at the bottom left. */
+    struct Rect{
+        int x, y, width, height;
+
+        int area () const {return width * height;}
+
+        bool isEmpty () const {return width <= 0 || height <= 0;}
+
+        /** @return the bounding box of this rectangle and the other one */
+        Rect merge (const Rect& other) const;
+
+        /** @return whether the rectangles overlap or share an edge or corner */
+        bool touches (const Rect& other) const;
+    };
+
+    /** How the content outside the repainted region is kept. */
+    enum class Method{
+        /** every frame is fully repainted */
+        FULL,
+        /** the back buffer age reported by EGL */
+        BUFFER_AGE,
+        /** a copy of the last frame in a renderbuffer */
+        PRESERVED_COPY
+    };
+private:
+    int width = 0, height = 0;
+    int maxRects = 4;
+    float fullThreshold = 0.7f;
+    Method method = Method::FULL;
+
+    std::vector<Rect> damage;
+    bool fullDamage = true;
+    /** the damage of the previously drawn frames, newest first, for the buffer age */
+    std::deque<std::vector<Rect>> history;
+    Rect repaint = Rect{0, 0, 0, 0};
+    long long repaintedPixels = 0;
+
+    GLuint copyRenderbuffer = 0, copyFramebuffer = 0;
+    bool copyValid = false;
+
+#ifndef DESKTOP
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLSurface surface = EGL_NO_SURFACE;
+    PFNEGLSETDAMAGEREGIONKHRPROC setDamageRegion = nullptr;
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC swapWithDamage = nullptr;
+    /** the age of the current back buffer, 0 when its content is undefined */
+    EGLint bufferAge = 0;
+#endif
+
+    /** Merges the rectangles until none overlap or touch, then until there are at most maxRects. */
+    void mergeDamage ();
+    void createCopy ();
+    void disposeCopy ();
+public:
+    DamageTracker(){}
+    ~DamageTracker();
+
+    DamageTracker (const DamageTracker&) = delete;
+    DamageTracker& operator= (const DamageTracker&) = delete;
+
+    /** Chooses the way the content is preserved from the extensions of the current context, the window must be current. */
+    void init (SDL_Window* window);
+
+    /** Sets the size of the drawable in pixels, which damages the whole window. */
+    void resize (int width, int height);
+
+    /** Reports a changed rectangle, in window pixels with the origin at the bottom left. */
+    void addDamage (int x, int y, int width, int height);
+
+    void addDamage (const Rect& rect) {
+        addDamage(rect.x, rect.y, rect.width, rect.height);
+    }
+
+    /** Damages the whole window, e.g. when it was exposed or the whole scene changed. */
+    void damageAll ();
+
+    /** @return whether anything was damaged since the last frame, otherwise nothing needs to be drawn */
+    bool hasDamage () const {
+        return fullDamage || !damage.empty();
+    }
+
+    bool isFullDamage () const {
+        return fullDamage;
+    }
+
+    /** @return the merged damage of the current frame, empty when the whole window is damaged */
+    const std::vector<Rect>& getDamage () const {
+        return damage;
+    }
+
+    /** Sets the maximum number of rectangles the damage is merged into. Default is 4. */
+    void setMaxRects (int maxRects) {
+        this->maxRects = maxRects < 1 ? 1 : maxRects;
+    }
+
+    /** Sets the fraction of the window area above which the whole window is damaged, since repainting a few pixels more is
+     * cheaper than the scissoring and copies. Default is 0.7. */
+    void setFullThreshold (float fullThreshold) {
+        this->fullThreshold = fullThreshold;
+    }
+
+    Method getMethod () const {
+        return method;
+    }
+
+    /** Prepares the back buffer and sets the scissor box to the region to repaint, which contains the damage.
+     * @return the region to repaint */
+    const Rect& beginFrame ();
+
+    /** Resets the scissor test, preserves the frame if needed, presents it and clears the damage. */
+    void endFrame (SDL_Window* window);
+
+    /** @return the number of pixels repainted by the last frame */
+    long long getRepaintedPixels () const {
+        return repaintedPixels;
+    }
+};
@@ -0,0 +1,149 @@
+#include "FrameBuffer.h"
+#include "GLStateCache.h"
+
+/** Sets the format and type of the pixel transfer matching the internal color format. @return the bytes per pixel */
+static int transferFormat (GLenum internalFormat, GLenum& format, GLenum& type){
+    switch (internalFormat) {
+    case GL_RGB8: format = GL_RGB; type = GL_UNSIGNED_BYTE; return 4;
+    case GL_RGB565: format = GL_RGB; type = GL_UNSIGNED_SHORT_5_6_5; return 2;
+    case GL_RGBA4: format = GL_RGBA; type = GL_UNSIGNED_SHORT_4_4_4_4; return 2;
+    case GL_RGB5_A1: format = GL_RGBA; type = GL_UNSIGNED_SHORT_5_5_5_1; return 2;
+    default: format = GL_RGBA; type = GL_UNSIGNED_BYTE; return 4;
+    }
+}
+
+FrameBuffer::FrameBuffer(const Format& format):format(format){
+    if (format.width <= 0 || format.height <= 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FrameBuffer: invalid size %dx%d", format.width, format.height);
+        return;
+    }
+    GLint previous = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+    if (!build()) dispose();
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+}
+
+GLuint FrameBuffer::attachRenderbuffer (GLenum attachment, GLenum internalFormat, int samples, int width, int height){
+    GLuint renderbuffer;
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    if (samples > 0)
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, internalFormat, width, height);
+    else
+        glRenderbufferStorage(GL_RENDERBUFFER, internalFormat, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, renderbuffer);
+    return renderbuffer;
+}
+
+bool FrameBuffer::build (){
+    samples = format.samples;
+    if (samples > 0) {
+        GLint maxSamples = 0;
+        glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+        if (samples > maxSamples) samples = maxSamples;
+    }
+    const int width = format.width, height = format.height;
+
+    GLenum pixelFormat, pixelType;
+    transferFormat(format.colorFormat, pixelFormat, pixelType);
+    GLuint texture;
+    glGenTextures(1, &texture);
+    GLStateCache::get().bindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, format.colorFormat, width, height, 0, pixelFormat, pixelType, nullptr);
+    colorTexture = std::make_shared<Texture>(GL_TEXTURE_2D, texture, width, height, GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE,
+        GL_CLAMP_TO_EDGE, false);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status == GL_FRAMEBUFFER_COMPLETE && samples > 0) {
+        //Rendered to instead, the texture only receives the resolved colors
+        glGenFramebuffers(1, &multisampleFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, multisampleFramebuffer);
+        multisampleColorBuffer = attachRenderbuffer(GL_COLOR_ATTACHMENT0, format.colorFormat, samples, width, height);
+    }
+    //Separate stencil formats are barely supported, a stencil comes with a depth buffer
+    if (format.stencil)
+        depthStencilBuffer = attachRenderbuffer(GL_DEPTH_STENCIL_ATTACHMENT, GL_DEPTH24_STENCIL8, samples, width, height);
+    else if (format.depth)
+        depthStencilBuffer = attachRenderbuffer(GL_DEPTH_ATTACHMENT, GL_DEPTH_COMPONENT24, samples, width, height);
+    if (status == GL_FRAMEBUFFER_COMPLETE) status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "FrameBuffer: %dx%d format 0x%x with %d samples is incomplete (0x%x)",
+            width, height, format.colorFormat, samples, status);
+        return false;
+    }
+    return true;
+}
+
+void FrameBuffer::dispose (){
+    if (bound) end();
+    if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+    if (multisampleFramebuffer) glDeleteFramebuffers(1, &multisampleFramebuffer);
+    if (multisampleColorBuffer) glDeleteRenderbuffers(1, &multisampleColorBuffer);
+    if (depthStencilBuffer) glDeleteRenderbuffers(1, &depthStencilBuffer);
+    framebuffer = multisampleFramebuffer = multisampleColorBuffer = depthStencilBuffer = 0;
+    colorTexture.reset();
+}
+
+void FrameBuffer::bind (){
+    glBindFramebuffer(GL_FRAMEBUFFER, getFramebufferHandle());
+}
+
+void FrameBuffer::unbind (){
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void FrameBuffer::begin (){
+    if (bound) {
+        SDL_Log("FrameBuffer: begin called twice without end");
+        return;
+    }
+    if (!isValid()) return;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    GLStateCache& cache = GLStateCache::get();
+    previousScissor = cache.isEnabled(GL_SCISSOR_TEST);
+    cache.setEnabled(GL_SCISSOR_TEST, false);
+    bind();
+    glViewport(0, 0, format.width, format.height);
+    bound = true;
+}
+
+void FrameBuffer::end (){
+    if (!bound) return;
+    bound = false;
+    if (multisampleFramebuffer) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, multisampleFramebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+        glBlitFramebuffer(0, 0, format.width, format.height, 0, 0, format.width, format.height, GL_COLOR_BUFFER_BIT,
+            GL_NEAREST);
+    }
+#ifndef DESKTOP
+    //Tilers then don't store what is never read again
+    GLenum discard[2];
+    int count = 0;
+    if (multisampleFramebuffer) discard[count++] = GL_COLOR_ATTACHMENT0;
+    if (depthStencilBuffer) discard[count++] = format.stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+    if (count > 0) {
+        bind();
+        glInvalidateFramebuffer(GL_FRAMEBUFFER, count, discard);
+    }
+#endif
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    GLStateCache::get().setEnabled(GL_SCISSOR_TEST, previousScissor);
+}
+
+size_t FrameBuffer::getBytes () const {
+    if (!isValid()) return 0;
+    GLenum pixelFormat, pixelType;
+    const size_t pixels = (size_t)format.width * format.height;
+    const size_t colorBytes = pixels * transferFormat(format.colorFormat, pixelFormat, pixelType);
+    size_t bytes = colorBytes;
+    if (multisampleColorBuffer) bytes += colorBytes * samples;
+    if (depthStencilBuffer) bytes += pixels * 4 * (samples > 0 ? samples : 1);
+    return bytes;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include "../../GL.h"
+#include "../Texture.h"
+#include <memory>
+
+/** Encapsulates an OpenGL framebuffer object rendering into a color texture, with optional depth and stencil renderbuffers.
+ * <p>
+ * With samples, the frame buffer renders into multisampled renderbuffers instead, which {@link #end()} resolves into the color
+ * texture, so the texture is always the one to sample.
+ * <p>
+ * Rendering happens between {@link #begin()} and {@link #end()}: begin binds the frame buffer and sets the viewport to its size,
+ * end restores the frame buffer, the viewport and the scissor test which were set before, so frame buffers can be nested. The
+ * scissor test is disabled in between, a scissor box in window coordinates, e.g. of the {@link DamageTracker}, is meaningless
+ * in the texture.
+ * <p>
+ * The texture's origin is the bottom left, so a {@link TextureRegion} of it must be flipped vertically to be drawn upright by a
+ * {@link SpriteBatch}. A FrameBuffer must be disposed when it is no longer used, see {@link FrameBufferPool} to reuse them.
+ * @author mzechner */
+class FrameBuffer{
+public:
+    /** The size and attachments of a frame buffer, also the key frame buffers are pooled by. */
+    struct Format{
+        int width = 0, height = 0;
+        /** the internal format of the color texture: GL_RGBA8, GL_RGB8, GL_RGB565, GL_RGBA4 or GL_RGB5_A1 */
+        GLenum colorFormat = GL_RGBA8;
+        bool depth = false, stencil = false;
+        /** the number of samples, 0 for no multisampling */
+        int samples = 0;
+
+        Format(){}
+        Format(int width, int height, GLenum colorFormat = GL_RGBA8, bool depth = false, bool stencil = false, int samples = 0)
+            :width(width),height(height),colorFormat(colorFormat),depth(depth),stencil(stencil),samples(samples){}
+
+        bool operator== (const Format& other) const {
+            return width == other.width && height == other.height && colorFormat == other.colorFormat
+                && depth == other.depth && stencil == other.stencil && samples == other.samples;
+        }
+
+        bool operator!= (const Format& other) const {
+            return !(*this == other);
+        }
+    };
+private:
+    /** as requested, also when fewer samples are supported */
+    Format format;
+    /** the samples used */
+    int samples = 0;
+    GLuint framebuffer = 0;
+    GLuint depthStencilBuffer = 0;
+    /** the frame buffer rendered to with samples, resolved into framebuffer */
+    GLuint multisampleFramebuffer = 0, multisampleColorBuffer = 0;
+    std::shared_ptr<Texture> colorTexture;
+
+    /** what {@link #begin()} replaced */
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4] = {0, 0, 0, 0};
+    bool previousScissor = false;
+    bool bound = false;
+
+    /** Creates a renderbuffer with the storage, attached to the bound frame buffer. */
+    static GLuint attachRenderbuffer (GLenum attachment, GLenum internalFormat, int samples, int width, int height);
+
+    bool build ();
+public:
+    /** Creates the frame buffer, check {@link #isValid()} as the GL implementation may not support the combination. */
+    FrameBuffer(const Format& format);
+
+    FrameBuffer(GLenum colorFormat, int width, int height, bool hasDepth, bool hasStencil = false)
+        :FrameBuffer(Format(width, height, colorFormat, hasDepth, hasStencil)){}
+
+    ~FrameBuffer(){dispose();}
+
+    FrameBuffer (const FrameBuffer&) = delete;
+    FrameBuffer& operator= (const FrameBuffer&) = delete;
+
+    /** Releases the GL objects, the color texture is released once no one else references it. */
+    void dispose ();
+
+    /** @return whether the frame buffer was created complete */
+    bool isValid () const {
+        return framebuffer != 0;
+    }
+
+    /** Binds the frame buffer, sets the viewport to its size and disables the scissor test. */
+    void begin ();
+
+    /** Resolves the samples into the color texture, then restores what {@link #begin()} replaced. */
+    void end ();
+
+    /** Binds the frame buffer rendered to, without changing the viewport. */
+    void bind ();
+
+    /** Binds the default frame buffer. */
+    static void unbind ();
+
+    std::shared_ptr<Texture> getColorBufferTexture () const {
+        return colorTexture;
+    }
+
+    const Format& getFormat () const {
+        return format;
+    }
+
+    /** @return the number of samples used, the requested ones clamped to GL_MAX_SAMPLES */
+    int getSamples () const {
+        return samples;
+    }
+
+    int getWidth () const {
+        return format.width;
+    }
+
+    int getHeight () const {
+        return format.height;
+    }
+
+    /** @return the GL frame buffer object rendered to */
+    GLuint getFramebufferHandle () const {
+        return multisampleFramebuffer ? multisampleFramebuffer : framebuffer;
+    }
+
+    /** @return the size of the GL objects in bytes, an estimate */
+    size_t getBytes () const;
+};
@@ -0,0 +1,43 @@
+#include "FrameBufferPool.h"
+#include <algorithm>
+
+std::shared_ptr<FrameBuffer> FrameBufferPool::obtain (const FrameBuffer::Format& format){
+    //The most recently freed is the most likely to still be in a cache
+    for (int i = freeBuffers.size() - 1; i >= 0; i--) {
+        if (freeBuffers[i].frameBuffer->getFormat() != format) continue;
+        std::shared_ptr<FrameBuffer> frameBuffer = freeBuffers[i].frameBuffer;
+        freeBuffers.erase(freeBuffers.begin() + i);
+        reused++;
+        return frameBuffer;
+    }
+    std::shared_ptr<FrameBuffer> frameBuffer = std::make_shared<FrameBuffer>(format);
+    if (!frameBuffer->isValid()) return nullptr;
+    created++;
+    return frameBuffer;
+}
+
+void FrameBufferPool::free (std::shared_ptr<FrameBuffer> frameBuffer){
+    if (!frameBuffer || !frameBuffer->isValid()) return;
+    freeBuffers.push_back(Entry{frameBuffer, Texture::getFrame()});
+    if ((int)freeBuffers.size() > maxFree) freeBuffers.erase(freeBuffers.begin(), freeBuffers.end() - maxFree);
+}
+
+void FrameBufferPool::trim (unsigned int maxIdleFrames){
+    const unsigned int frame = Texture::getFrame();
+    freeBuffers.erase(std::remove_if(freeBuffers.begin(), freeBuffers.end(), [&](const Entry& entry){
+        return frame - entry.freedFrame > maxIdleFrames;
+    }), freeBuffers.end());
+}
+
+void FrameBufferPool::setMaxFree (int maxFree){
+    this->maxFree = std::max(0, maxFree);
+    if ((int)freeBuffers.size() > this->maxFree)
+        freeBuffers.erase(freeBuffers.begin(), freeBuffers.end() - this->maxFree);
+}
+
+size_t FrameBufferPool::getFreeBytes () const {
+    size_t bytes = 0;
+    for (const Entry& entry : freeBuffers)
+        bytes += entry.frameBuffer->getBytes();
+    return bytes;
+}
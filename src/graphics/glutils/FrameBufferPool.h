@@ -0,0 +1,62 @@
+#pragma once
+#include "FrameBuffer.h"
+#include <memory>
+#include <vector>
+
+/** Recycles {@link FrameBuffer}s by format, so offscreen passes and cached layers don't create and delete GL objects each
+ * time they need a render target. {@link #obtain(const FrameBuffer::Format&)} returns a free frame buffer of the same size and
+ * attachments, or creates one, and {@link #free(std::shared_ptr<FrameBuffer>)} gives it back. The content of an obtained frame
+ * buffer is undefined.
+ * <p>
+ * Free frame buffers cost memory: beyond {@link #setMaxFree(int) max free} the one freed longest ago is disposed, and
+ * {@link #trim(unsigned int)} disposes those unused for a number of frames, counted by {@link Texture#getFrame()}. */
+class FrameBufferPool{
+    struct Entry{
+        std::shared_ptr<FrameBuffer> frameBuffer;
+        unsigned int freedFrame;
+    };
+
+    /** oldest first */
+    std::vector<Entry> freeBuffers;
+    int maxFree;
+    int created = 0, reused = 0;
+public:
+    FrameBufferPool(int maxFree = 8):maxFree(maxFree){}
+
+    FrameBufferPool (const FrameBufferPool&) = delete;
+    FrameBufferPool& operator= (const FrameBufferPool&) = delete;
+
+    /** @return a frame buffer of the format, nullptr if it can't be created */
+    std::shared_ptr<FrameBuffer> obtain (const FrameBuffer::Format& format);
+
+    /** Returns the frame buffer to the pool, it must not be used anymore. */
+    void free (std::shared_ptr<FrameBuffer> frameBuffer);
+
+    /** Disposes the free frame buffers which were not obtained again for more than maxIdleFrames. */
+    void trim (unsigned int maxIdleFrames);
+
+    /** Disposes all free frame buffers. */
+    void clear () {
+        freeBuffers.clear();
+    }
+
+    /** Sets the number of free frame buffers kept. Default is 8. */
+    void setMaxFree (int maxFree);
+
+    int getFree () const {
+        return freeBuffers.size();
+    }
+
+    /** @return the bytes of GL memory held by the free frame buffers, an estimate */
+    size_t getFreeBytes () const;
+
+    /** @return the number of frame buffers created by {@link #obtain(const FrameBuffer::Format&)} */
+    int getCreated () const {
+        return created;
+    }
+
+    /** @return the number of frame buffers {@link #obtain(const FrameBuffer::Format&)} returned from the pool */
+    int getReused () const {
+        return reused;
+    }
+};
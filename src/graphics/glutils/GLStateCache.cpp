@@ -0,0 +1,53 @@
+#include "GLStateCache.h"
+
+GLStateCache& GLStateCache::get (){
+    static GLStateCache cache;
+    return cache;
+}
+
+void GLStateCache::invalidate (){
+    program = arrayBuffer = elementArrayBuffer = vertexArray = activeUnit = UNKNOWN;
+    units.clear();
+    for (int i = 0; i < CAPABILITIES; i++) capabilities[i] = -1;
+    blendSrc = blendDst = blendSrcAlpha = blendDstAlpha = depthFunction = cullFaceMode = UNKNOWN;
+    depthMaskEnabled = -1;
+}
+
+void GLStateCache::deleteTextures (GLsizei count, const GLuint* textures){
+    glDeleteTextures(count, textures);
+    for (GLsizei i = 0; i < count; i++)
+        for (TextureUnit& unit : units)
+            for (int target = 0; target < TEXTURE_TARGETS; target++)
+                if (unit.textures[target] == textures[i]) unit.textures[target] = 0;
+}
+
+void GLStateCache::deleteBuffers (GLsizei count, const GLuint* buffers){
+    glDeleteBuffers(count, buffers);
+    for (GLsizei i = 0; i < count; i++) {
+        if (arrayBuffer == buffers[i]) arrayBuffer = 0;
+        if (elementArrayBuffer == buffers[i]) elementArrayBuffer = 0;
+    }
+}
+
+void GLStateCache::deleteVertexArrays (GLsizei count, const GLuint* vertexArrays){
+    glDeleteVertexArrays(count, vertexArrays);
+    for (GLsizei i = 0; i < count; i++) {
+        if (vertexArray == vertexArrays[i]) {
+            vertexArray = 0;
+            elementArrayBuffer = UNKNOWN;
+        }
+    }
+}
+
+void GLStateCache::deleteProgram (GLuint program){
+    if (this->program == program) useProgram(0);
+    glDeleteProgram(program);
+}
+
+int GLStateCache::getMaxTextureUnits (){
+    if (maxTextureUnits == 0) {
+        glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &maxTextureUnits);
+        if (maxTextureUnits <= 0) maxTextureUnits = 8;
+    }
+    return maxTextureUnits;
+}
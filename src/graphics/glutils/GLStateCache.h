@@ -0,0 +1,246 @@
+#pragma once
+//Only the GL headers, GL.h includes Texture.h which binds through the cache
+#ifdef DESKTOP
+	#include <GL/glew.h>
+#else
+    #include <GLES3/gl3.h>
+#endif
+#include <vector>
+
+/** Shadows the GL state the library changes most, so binding what is already bound costs no GL call: the program, the array,
+ * element array and vertex array bindings, the active texture unit and the 2D, cube map, 3D and array textures of each unit,
+ * the capabilities blend, depth test, cull face, scissor test, stencil test and polygon offset fill, and the blend function,
+ * depth function, depth mask and cull face mode.
+ * <p>
+ * There is one GL context, so there is one cache, see {@link #get()}. Every change of the shadowed state must go through it,
+ * otherwise the cache and GL disagree; code calling GL directly, e.g. another library, must call {@link #invalidate()}
+ * afterwards. Deleting objects must be reported as GL resets the bindings of deleted objects to 0. State the cache doesn't
+ * know yet, at start or after {@link #invalidate()}, is always set.
+ * <p>
+ * Each request is counted as issued or skipped, see {@link #getStats()}. */
+class GLStateCache{
+public:
+    struct Stats{
+        /** the number of requests passed to GL */
+        unsigned int issued = 0;
+        /** the number of requests for state already set */
+        unsigned int skipped = 0;
+    };
+private:
+    static const GLuint UNKNOWN = 0xFFFFFFFF;
+    static const int TEXTURE_TARGETS = 4;
+    static const int CAPABILITIES = 6;
+
+    struct TextureUnit{
+        GLuint textures[TEXTURE_TARGETS];
+    };
+
+    GLuint program;
+    GLuint arrayBuffer, elementArrayBuffer, vertexArray;
+    GLuint activeUnit;
+    std::vector<TextureUnit> units;
+    int capabilities[CAPABILITIES];
+    GLenum blendSrc, blendDst, blendSrcAlpha, blendDstAlpha, depthFunction, cullFaceMode;
+    int depthMaskEnabled;
+    int maxTextureUnits = 0;
+    Stats stats;
+
+    static int textureTargetIndex (GLenum target) {
+        switch (target) {
+        case GL_TEXTURE_2D: return 0;
+        case GL_TEXTURE_CUBE_MAP: return 1;
+        case GL_TEXTURE_3D: return 2;
+        case GL_TEXTURE_2D_ARRAY: return 3;
+        default: return -1;
+        }
+    }
+
+    static int capabilityIndex (GLenum capability) {
+        switch (capability) {
+        case GL_BLEND: return 0;
+        case GL_DEPTH_TEST: return 1;
+        case GL_CULL_FACE: return 2;
+        case GL_SCISSOR_TEST: return 3;
+        case GL_STENCIL_TEST: return 4;
+        case GL_POLYGON_OFFSET_FILL: return 5;
+        default: return -1;
+        }
+    }
+
+    /** @return whether the value differs and was updated, counting the request */
+    bool change (GLuint& current, GLuint value) {
+        if (current == value) {
+            stats.skipped++;
+            return false;
+        }
+        current = value;
+        stats.issued++;
+        return true;
+    }
+
+    TextureUnit& unit (int index) {
+        if (index >= (int)units.size()) {
+            TextureUnit unknown;
+            for (int i = 0; i < TEXTURE_TARGETS; i++) unknown.textures[i] = UNKNOWN;
+            units.resize(index + 1, unknown);
+        }
+        return units[index];
+    }
+
+    GLStateCache(){
+        invalidate();
+    }
+public:
+    /** @return the cache of the GL context */
+    static GLStateCache& get ();
+
+    /** Forgets the shadowed state, e.g. after context loss or GL calls made outside the library. */
+    void invalidate ();
+
+    void useProgram (GLuint program) {
+        if (change(this->program, program)) glUseProgram(program);
+    }
+
+    GLuint getProgram () const {return program;}
+
+    /** Binds the buffer, only GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are cached, other targets are always bound. */
+    void bindBuffer (GLenum target, GLuint buffer) {
+        if (target == GL_ARRAY_BUFFER) {
+            if (change(arrayBuffer, buffer)) glBindBuffer(target, buffer);
+        } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+            if (change(elementArrayBuffer, buffer)) glBindBuffer(target, buffer);
+        } else {
+            stats.issued++;
+            glBindBuffer(target, buffer);
+        }
+    }
+
+    /** Binds the vertex array. The element array binding belongs to the vertex array, so it becomes unknown when it changes. */
+    void bindVertexArray (GLuint vertexArray) {
+        if (change(this->vertexArray, vertexArray)) {
+            glBindVertexArray(vertexArray);
+            elementArrayBuffer = UNKNOWN;
+        }
+    }
+
+    /** @param unit the index of the unit, not GL_TEXTURE0 + unit */
+    void activeTexture (int unit) {
+        if (change(activeUnit, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    int getActiveTexture () const {return activeUnit;}
+
+    /** Binds the texture to the active unit. */
+    void bindTexture (GLenum target, GLuint texture) {
+        const int index = textureTargetIndex(target);
+        if (index == -1 || activeUnit == UNKNOWN) {
+            stats.issued++;
+            glBindTexture(target, texture);
+            if (index != -1) invalidateTextures();
+            return;
+        }
+        if (change(unit(activeUnit).textures[index], texture)) glBindTexture(target, texture);
+    }
+
+    /** Binds the texture to the unit, changing the active unit only if the unit doesn't already hold the texture. */
+    void bindTexture (int unit, GLenum target, GLuint texture) {
+        const int index = textureTargetIndex(target);
+        if (index != -1 && this->unit(unit).textures[index] == texture) {
+            stats.skipped++;
+            return;
+        }
+        activeTexture(unit);
+        bindTexture(target, texture);
+    }
+
+    /** @return the texture bound to the target of the unit, or 0xFFFFFFFF if unknown */
+    GLuint getBoundTexture (int unit, GLenum target) {
+        const int index = textureTargetIndex(target);
+        return index == -1 ? UNKNOWN : this->unit(unit).textures[index];
+    }
+
+    /** Forgets the texture bindings, e.g. after binding textures directly. */
+    void invalidateTextures () {
+        units.clear();
+    }
+
+    /** Enables or disables the capability, only the capabilities listed in the class documentation are cached. */
+    void setEnabled (GLenum capability, bool enabled) {
+        const int index = capabilityIndex(capability);
+        if (index != -1) {
+            if (capabilities[index] == (int)enabled) {
+                stats.skipped++;
+                return;
+            }
+            capabilities[index] = enabled;
+        }
+        stats.issued++;
+        if (enabled) glEnable(capability);
+        else glDisable(capability);
+    }
+
+    /** @return whether the capability is enabled, queried from GL only while the cache doesn't know it */
+    bool isEnabled (GLenum capability) {
+        const int index = capabilityIndex(capability);
+        if (index == -1) return glIsEnabled(capability);
+        if (capabilities[index] == -1) capabilities[index] = glIsEnabled(capability) ? 1 : 0;
+        return capabilities[index] == 1;
+    }
+
+    void blendFunc (GLenum src, GLenum dst) {
+        blendFuncSeparate(src, dst, src, dst);
+    }
+
+    /** Sets different blend factors for the alpha channel, e.g. to keep the coverage of a layer rendered to a texture. */
+    void blendFuncSeparate (GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
+        if (blendSrc == srcRGB && blendDst == dstRGB && blendSrcAlpha == srcAlpha && blendDstAlpha == dstAlpha) {
+            stats.skipped++;
+            return;
+        }
+        blendSrc = srcRGB;
+        blendDst = dstRGB;
+        blendSrcAlpha = srcAlpha;
+        blendDstAlpha = dstAlpha;
+        stats.issued++;
+        if (srcRGB == srcAlpha && dstRGB == dstAlpha)
+            glBlendFunc(srcRGB, dstRGB);
+        else
+            glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+    }
+
+    void depthFunc (GLenum function) {
+        if (change(depthFunction, function)) glDepthFunc(function);
+    }
+
+    void depthMask (bool enabled) {
+        if (depthMaskEnabled == (int)enabled) {
+            stats.skipped++;
+            return;
+        }
+        depthMaskEnabled = enabled;
+        stats.issued++;
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+
+    void cullFace (GLenum face) {
+        if (change(cullFaceMode, face)) glCullFace(face);
+    }
+
+    /** Deletes the textures and resets the units holding them to 0, as GL does. */
+    void deleteTextures (GLsizei count, const GLuint* textures);
+
+    /** Deletes the buffers and resets their bindings to 0, as GL does. */
+    void deleteBuffers (GLsizei count, const GLuint* buffers);
+
+    void deleteVertexArrays (GLsizei count, const GLuint* vertexArrays);
+
+    /** Deletes the program, unbinding it first if it is in use so its name isn't reused while bound. */
+    void deleteProgram (GLuint program);
+
+    /** @return GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS */
+    int getMaxTextureUnits ();
+
+    const Stats& getStats () const {return stats;}
+
+    void resetStats () {stats = Stats();}
+};
@@ -1,95 +1,74 @@
 #include "IndexData.h"
+#include "GLStateCache.h"
 
 void IndexData::createBufferObject(){
     glGenBuffers(1,&bufferHandle);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferHandle);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.capacity(), NULL, usage);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    //Storage for the maximum, later uploads only replace data
+    GLStateCache::get().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferHandle);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.capacity() * sizeof(GLuint), NULL, usage);
+    allocatedIndices = buffer.capacity();
+}
+
+void IndexData::upload(){
+    GLStateCache::get().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferHandle);
+    if (buffer.size() > allocatedIndices || (type != INDEX_BUFFER_OBJECT_SUB_DATA && dirtyBegin == 0 && dirtyEnd >= buffer.size())) {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.size() * sizeof(GLuint), buffer.data(), usage);
+        allocatedIndices = buffer.size();
+    } else if (dirtyBegin < dirtyEnd) {
+        dirtyEnd = std::min(dirtyEnd, buffer.size());
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, dirtyBegin * sizeof(GLuint), (dirtyEnd - dirtyBegin) * sizeof(GLuint),
+            buffer.data() + dirtyBegin);
+    }
+    isDirty = false;
 }
 
 IndexData::IndexData(int type,bool isStatic,const std::vector<GLuint>& data){
-    isDirty = false;isBound = false;isDirect = false;
+    isDirty = true;isBound = false;isDirect = true;
     this->type = INDEX_BUFFER_OBJECT;
     usage = isStatic ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
     buffer = data;
-    isDirect = true;
+    markDirty(0, buffer.size());
     glGenBuffers(1, &bufferHandle);
 }
 IndexData::IndexData (int type,int maxIndices):IndexData(type,true,maxIndices){}
 IndexData::IndexData (int type,bool isStatic, int maxIndices){
-        isDirty = false;isBound = false;isDirect = false;
+        isDirty = true;isBound = false;isDirect = type != INDEX_ARRAY;
         this->type = type;
         usage = isStatic ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
+        //Empty until indices are set
+        buffer.reserve(maxIndices);
         
         switch(type){
-            case INDEX_ARRAY: 
-                buffer = std::vector<GLuint>(maxIndices); 
-            break;
             case INDEX_BUFFER_OBJECT:
-                buffer = std::vector<GLuint>(maxIndices * 2);
-                isDirect = true;
                 glGenBuffers(1, &bufferHandle);
             break;
             case INDEX_BUFFER_OBJECT_SUB_DATA:
-                isDirect = true;
-                buffer = std::vector<GLuint>();
                 createBufferObject();
             break;
         }
 }
 
-std::vector<GLuint>& IndexData::getBuffer() {isDirty = true; return buffer;}
+std::vector<GLuint>& IndexData::getBuffer() {markDirty(0, buffer.size()); return buffer;}
 
 void IndexData::setIndices (const std::vector<GLuint>& indices, int offset, int count){
-        int counter = 0;
-        for(int i = offset;i < offset+count;i++)
-            buffer[counter++] = indices[i];
-        setIndices(offset,count);
-}
-
-void IndexData::setIndices (int offset,int count){
-    isDirty = true;
-    switch(type){
-        case INDEX_ARRAY:
-            buffer = std::vector<GLuint>(offset,offset+count);
-        break;
-        case INDEX_BUFFER_OBJECT:
-            if (isBound) {
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.size() * sizeof(GLuint), buffer.data(), usage);
-                isDirty = false;
-            }
-        break;
-        case INDEX_BUFFER_OBJECT_SUB_DATA:
-            if (isBound) {
-                glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, buffer.size() * sizeof(GLuint), buffer.data());
-                isDirty = false;
-            }
-        break;
-    }
+    buffer.assign(indices.begin() + offset, indices.begin() + offset + count);
+    markDirty(0, buffer.size());
+    bufferChanged();
 }
 
 void IndexData::updateIndices (int targetOffset, const std::vector<GLuint>& indices, int offset, int count){
-    isDirty = true;
-    for(int i = offset;i < offset+count;i++)
-            buffer[targetOffset++] = indices[i];
-    switch(type){
-        case INDEX_BUFFER_OBJECT:
-            if (isBound) {
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.size() * sizeof(GLuint), buffer.data(), usage);
-                isDirty = false;
-            }
-        break;
-        case INDEX_BUFFER_OBJECT_SUB_DATA:
-            if (isBound) {
-                glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, buffer.size() * sizeof(GLuint), buffer.data());
-                isDirty = false;
-            }
-        break;
+    if (targetOffset < 0 || targetOffset + count > (int)buffer.size()) {
+        SDL_Log("IndexOutOfBoundsException(targetOffset = %i, count = %i, size = %i)",targetOffset,count,(int)buffer.size());
+        return;
     }
+    std::copy(indices.begin() + offset, indices.begin() + offset + count, buffer.begin() + targetOffset);
+    markDirty(targetOffset, targetOffset + count);
+    bufferChanged();
 }
 
 void IndexData::invalidate(){
-    isDirty = true;
+    markDirty(0, buffer.size());
+    allocatedIndices = 0;
     switch(type){
         case INDEX_BUFFER_OBJECT:
             glGenBuffers(1,&bufferHandle);
@@ -105,37 +84,33 @@ void IndexData::bind(){
         case INDEX_BUFFER_OBJECT:
             if (bufferHandle == 0) SDL_Log("No buffer allocated!");
 
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferHandle);
-            if (isDirty) {
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.size() * sizeof(GLuint), buffer.data(), usage);
-                isDirty = false;
-            }
+            GLStateCache::get().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferHandle);
+            if (isDirty) upload();
             isBound = true;
         break;
         case INDEX_BUFFER_OBJECT_SUB_DATA:
             if (bufferHandle == 0) SDL_Log("IndexBufferObject cannot be used after it has been disposed.");
 
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferHandle);
-            if (isDirty) {
-                glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, buffer.size() * sizeof(GLuint), buffer.data());
-                isDirty = false;
-            }
+            GLStateCache::get().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferHandle);
+            if (isDirty) upload();
             isBound = true;
         break;
+        default:
+            //Client side indices are only read from memory while no buffer is bound
+            GLStateCache::get().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        break;
     }
 }
 
 void IndexData::unbind(){
-    if(type != INDEX_ARRAY){
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    //The buffer stays bound, binding 0 after every draw only to bind a buffer again for the next one is a wasted call
+    if(type != INDEX_ARRAY)
 		isBound = false;
-    }
 }
 
 IndexData::~IndexData(){
     if(type != INDEX_ARRAY){
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glDeleteBuffers(1,&bufferHandle);
+        GLStateCache::get().deleteBuffers(1,&bufferHandle);
         bufferHandle = 0;
     }
 }
@@ -17,6 +17,7 @@
 #pragma once
 #include "../../GL.h"
 #include <vector>
+#include <algorithm>
 
 #define INDEX_ARRAY 1
 #define INDEX_BUFFER_OBJECT 2
@@ -25,12 +26,34 @@
 /** An IndexData instance holds index data. Can be either a plain short buffer or an OpenGL buffer object.
  * @author mzechner */
 class IndexData{
-    GLuint bufferHandle;
+    GLuint bufferHandle = 0;
     bool isDirty,isBound,isDirect;
     std::vector<GLuint> buffer;
     int type,usage;
+    /** the indices the GL buffer has storage for */
+    size_t allocatedIndices = 0;
+    /** the range of indices changed since the last upload */
+    size_t dirtyBegin = 0,dirtyEnd = 0;
     
     void createBufferObject();
+
+    void markDirty (size_t begin, size_t end) {
+        if (!isDirty) {
+            dirtyBegin = begin;
+            dirtyEnd = end;
+        } else {
+            dirtyBegin = std::min(dirtyBegin, begin);
+            dirtyEnd = std::max(dirtyEnd, end);
+        }
+        isDirty = true;
+    }
+
+    /** Uploads the changed range, or the whole buffer if it no longer fits the GL storage. */
+    void upload();
+
+    void bufferChanged() {
+        if (isBound && type != INDEX_ARRAY) upload();
+    }
 public:
     friend std::ostream& operator<<(std::ostream& os, IndexData &v)  
     {  
@@ -77,9 +100,7 @@ public:
 	 * indices. This can be called in between calls to {@link #bind()} and {@link #unbind()}. The index data will be updated
 	 * instantly.
 	 * @param indices the index data to copy */
-	void setIndices (const std::vector<GLuint>& indices) {buffer = indices; setIndices(0,0);}
-    
-    void setIndices(int offset,int count);
+	void setIndices (const std::vector<GLuint>& indices) {setIndices(indices, 0, indices.size());}
 
 	/** Update (a portion of) the indices.
 	 * @param targetOffset offset in indices buffer
@@ -96,6 +117,12 @@ public:
 	 * @return the underlying short buffer. */
 	std::vector<GLuint>& getBuffer();
 
+	/** @return the indices, without marking them as changed */
+	const std::vector<GLuint>& getData () const {return buffer;}
+
+	/** @return whether the indices are held in a GL buffer, otherwise they are read from memory on each draw */
+	bool isBufferObject () const {return type != INDEX_ARRAY;}
+
 	/** Binds this IndexBufferObject for rendering with glDrawElements. */
 	void bind();
 
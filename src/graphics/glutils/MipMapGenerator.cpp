@@ -0,0 +1,247 @@
+#include "../../GL.h"
+#include "MipMapGenerator.h"
+#include "../../utils/ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define MIPMAP_SSE2 1
+#endif
+
+//Levels are kept as 4 linear floats per texel, whatever the channel count, so every tap is one vector operation
+static const int TEXEL = 4;
+static const double PI = 3.14159265358979323846;
+
+/** The source texels contributing to one destination texel, with their weights. */
+struct FilterTaps{
+    std::vector<int> first;
+    std::vector<int> count;
+    std::vector<int> offset;
+    std::vector<float> weights;
+};
+
+static double sinc (double x) {
+    if (std::fabs(x) < 1e-6) return 1;
+    x *= PI;
+    return std::sin(x) / x;
+}
+
+static double besselI0 (double x) {
+    double sum = 1, term = 1;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+static double filterRadius (MipMapFilter filter) {
+    return filter == MIPMAP_FILTER_BOX ? 0.5 : 3;
+}
+
+static double filterWeight (MipMapFilter filter, double x) {
+    const double radius = filterRadius(filter);
+    if (std::fabs(x) >= radius) return 0;
+    switch (filter) {
+    case MIPMAP_FILTER_KAISER: {
+        const double alpha = 4, t = x / radius;
+        return sinc(x) * besselI0(alpha * std::sqrt(1 - t * t)) / besselI0(alpha);
+    }
+    case MIPMAP_FILTER_LANCZOS:
+        return sinc(x) * sinc(x / radius);
+    default:
+        return 1;
+    }
+}
+
+/** Computes the taps resampling srcSize texels to dstSize, scaling the filter to the ratio so non power of two sizes are
+ * filtered correctly. Taps past the edges are folded onto the edge texel. */
+static FilterTaps computeTaps (int srcSize, int dstSize, MipMapFilter filter) {
+    FilterTaps taps;
+    const double scale = srcSize / (double)dstSize;
+    const double support = filterRadius(filter) * scale;
+    std::vector<double> weights;
+    for (int i = 0; i < dstSize; i++) {
+        const double center = (i + 0.5) * scale;
+        const int first = std::max(0, (int)std::floor(center - support));
+        const int last = std::min(srcSize - 1, (int)std::ceil(center + support));
+        weights.assign(last - first + 1, 0);
+        double sum = 0;
+        for (int j = (int)std::floor(center - support); j <= (int)std::ceil(center + support); j++) {
+            double weight;
+            if (filter == MIPMAP_FILTER_BOX) //exact coverage of the texel by the footprint
+                weight = std::max(0.0, std::min(j + 1.0, center + support) - std::max((double)j, center - support));
+            else weight = filterWeight(filter, (j + 0.5 - center) / scale);
+            weights[std::min(last, std::max(first, j)) - first] += weight;
+            sum += weight;
+        }
+        taps.first.push_back(first);
+        taps.count.push_back(weights.size());
+        taps.offset.push_back(taps.weights.size());
+        for (double weight : weights) taps.weights.push_back(sum != 0 ? weight / sum : 0);
+    }
+    return taps;
+}
+
+/** Filters rows [begin, end) of the source horizontally into the destination, which has the destination width. */
+static void filterRows (const float* src, int srcWidth, float* dst, int dstWidth, const FilterTaps& taps, int begin, int end) {
+    for (int y = begin; y < end; y++) {
+        const float* srcRow = src + (size_t)y * srcWidth * TEXEL;
+        float* dstRow = dst + (size_t)y * dstWidth * TEXEL;
+        for (int x = 0; x < dstWidth; x++) {
+            const float* texel = srcRow + taps.first[x] * TEXEL;
+            const float* weight = taps.weights.data() + taps.offset[x];
+            const int count = taps.count[x];
+#ifdef MIPMAP_SSE2
+            __m128 sum = _mm_setzero_ps();
+            for (int i = 0; i < count; i++)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weight[i]), _mm_loadu_ps(texel + i * TEXEL)));
+            _mm_storeu_ps(dstRow + x * TEXEL, sum);
+#else
+            float sum[TEXEL] = {0, 0, 0, 0};
+            for (int i = 0; i < count; i++)
+                for (int c = 0; c < TEXEL; c++) sum[c] += weight[i] * texel[i * TEXEL + c];
+            memcpy(dstRow + x * TEXEL, sum, sizeof(sum));
+#endif
+        }
+    }
+}
+
+/** Filters rows [begin, end) of the destination vertically from the horizontally filtered source, a whole row at a time. */
+static void filterColumns (const float* src, float* dst, int width, const FilterTaps& taps, int begin, int end) {
+    const int rowFloats = width * TEXEL;
+    for (int y = begin; y < end; y++) {
+        float* dstRow = dst + (size_t)y * rowFloats;
+        std::fill(dstRow, dstRow + rowFloats, 0.0f);
+        for (int i = 0; i < taps.count[y]; i++) {
+            const float* srcRow = src + (size_t)(taps.first[y] + i) * rowFloats;
+            const float weight = taps.weights[taps.offset[y] + i];
+            int x = 0;
+#ifdef MIPMAP_SSE2
+            const __m128 weights = _mm_set1_ps(weight);
+            for (; x + 4 <= rowFloats; x += 4)
+                _mm_storeu_ps(dstRow + x, _mm_add_ps(_mm_loadu_ps(dstRow + x), _mm_mul_ps(weights, _mm_loadu_ps(srcRow + x))));
+#endif
+            for (; x < rowFloats; x++) dstRow[x] += weight * srcRow[x];
+        }
+    }
+}
+
+static float srgbToLinear (int value) {
+    const double c = value / 255.0;
+    return (float)(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+}
+
+/** linear values halfway between consecutive sRGB codes, so encoding rounds exactly */
+static const std::vector<float>& srgbThresholds () {
+    //Initialized once even when first called from several workers
+    static const std::vector<float> thresholds = []{
+        std::vector<float> values;
+        for (int i = 0; i < 255; i++) values.push_back((srgbToLinear(i) + srgbToLinear(i + 1)) / 2);
+        return values;
+    }();
+    return thresholds;
+}
+
+static void quantize (const float* src, MipMapLevel& level, int channels, bool srgb, int begin, int end) {
+    const std::vector<float>& thresholds = srgbThresholds();
+    const int colorChannels = channels == 4 ? 3 : channels;
+    for (int y = begin; y < end; y++) {
+        const float* texel = src + (size_t)y * level.width * TEXEL;
+        unsigned char* out = level.pixels.data() + (size_t)y * level.width * channels;
+        for (int x = 0; x < level.width; x++, texel += TEXEL, out += channels) {
+            for (int c = 0; c < channels; c++) {
+                const float value = std::min(1.0f, std::max(0.0f, texel[c]));
+                if (srgb && c < colorChannels)
+                    out[c] = std::upper_bound(thresholds.begin(), thresholds.end(), value) - thresholds.begin();
+                else out[c] = (unsigned char)(value * 255 + 0.5f);
+            }
+        }
+    }
+}
+
+std::vector<MipMapLevel> MipMapGenerator::generateMipChain (const unsigned char* pixels, int width, int height, int channels,
+    MipMapFilter filter, bool srgb, ThreadPool* pool){
+    std::vector<MipMapLevel> levels;
+    if (width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+        SDL_Log("MipMapGenerator: cannot generate mip maps for a %dx%d image with %d channels", width, height, channels);
+        return levels;
+    }
+    if (pool == nullptr) pool = &ThreadPool::getShared();
+
+    MipMapLevel base;
+    base.width = width;
+    base.height = height;
+    base.pixels.assign(pixels, pixels + (size_t)width * height * channels);
+    levels.push_back(base);
+
+    float toLinear[256], toFloat[256];
+    for (int i = 0; i < 256; i++) {
+        toLinear[i] = srgbToLinear(i);
+        toFloat[i] = i / 255.0f;
+    }
+    const int colorChannels = channels == 4 ? 3 : channels;
+    std::vector<float> current((size_t)width * height * TEXEL, 0.0f);
+    for (size_t i = 0; i < (size_t)width * height; i++)
+        for (int c = 0; c < channels; c++)
+            current[i * TEXEL + c] = (srgb && c < colorChannels ? toLinear : toFloat)[pixels[i * channels + c]];
+
+    std::vector<float> horizontal, next;
+    while (width > 1 || height > 1) {
+        const int nextWidth = std::max(1, width / 2), nextHeight = std::max(1, height / 2);
+        const FilterTaps columns = computeTaps(width, nextWidth, filter);
+        const FilterTaps rows = computeTaps(height, nextHeight, filter);
+
+        horizontal.resize((size_t)nextWidth * height * TEXEL);
+        pool->parallelFor(0, height, 16, [&](int begin, int end){
+            filterRows(current.data(), width, horizontal.data(), nextWidth, columns, begin, end);
+        });
+        next.resize((size_t)nextWidth * nextHeight * TEXEL);
+        pool->parallelFor(0, nextHeight, 16, [&](int begin, int end){
+            filterColumns(horizontal.data(), next.data(), nextWidth, rows, begin, end);
+        });
+
+        MipMapLevel level;
+        level.width = nextWidth;
+        level.height = nextHeight;
+        level.pixels.resize((size_t)nextWidth * nextHeight * channels);
+        pool->parallelFor(0, nextHeight, 32, [&](int begin, int end){
+            quantize(next.data(), level, channels, srgb, begin, end);
+        });
+        levels.push_back(std::move(level));
+
+        current.swap(next);
+        width = nextWidth;
+        height = nextHeight;
+    }
+    return levels;
+}
+
+void MipMapGenerator::uploadMipChain (int target, const std::vector<MipMapLevel>& levels, int format){
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (int i = 0; i < levels.size(); i++)
+        glTexImage2D(target, i, format, levels[i].width, levels[i].height, 0, format, GL_UNSIGNED_BYTE, levels[i].pixels.data());
+}
+
+void MipMapGenerator::generateMipMapCPU (int target, SDL2::Surface data, int textureWidth, int textureHeight,int format){
+    const int channels = format == GL_RGBA ? 4 : 3;
+    //Surface rows may be padded, the generator expects them packed
+    std::vector<unsigned char> pixels((size_t)data->w * data->h * channels);
+    for (int y = 0; y < data->h; y++)
+        memcpy(pixels.data() + (size_t)y * data->w * channels, (unsigned char*)data->pixels + (size_t)y * data->pitch,
+            (size_t)data->w * channels);
+    uploadMipChain(target, generateMipChain(pixels.data(), data->w, data->h, channels, MIPMAP_FILTER_KAISER, true), format);
+}
+
+bool MipMapGenerator::hasHardwareMipMaps (){
+    static int supported = -1;
+    if (supported == -1) {
+        const char* version = (const char*)glGetString(GL_VERSION);
+        supported = (version != NULL && atoi(version) >= 3) || SDL_GL_ExtensionSupported("GL_ARB_framebuffer_object")
+            || SDL_GL_ExtensionSupported("GL_EXT_framebuffer_object");
+    }
+    return supported == 1;
+}
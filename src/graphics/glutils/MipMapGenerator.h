@@ -16,6 +16,26 @@
 
 #pragma once
 #include "../../GL.h"
+#include <vector>
+
+class ThreadPool;
+
+/** One level of a mip chain generated on the CPU, tightly packed rows of 8 bit channels. */
+struct MipMapLevel{
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+};
+
+/** The reconstruction filter used when downsampling on the CPU. */
+enum MipMapFilter{
+    /** averages the covered texels, fast but blurry and prone to aliasing */
+    MIPMAP_FILTER_BOX,
+    /** Kaiser windowed sinc with a radius of 3, sharp with little ringing */
+    MIPMAP_FILTER_KAISER,
+    /** Lanczos windowed sinc with a radius of 3, sharpest */
+    MIPMAP_FILTER_LANCZOS
+};
 
 class MipMapGenerator {
 	static void generateMipMapGLES20 (int target, SDL2::Surface data,int format) {
@@ -25,30 +45,32 @@ class MipMapGenerator {
 	}
 
 	static void generateMipMapDesktop (int target, SDL2::Surface data, int textureWidth, int textureHeight,int format) {
-		//if (Gdx.graphics.supportsExtension("GL_ARB_framebuffer_object")
-		//	|| Gdx.graphics.supportsExtension("GL_EXT_framebuffer_object") || Gdx.gl30 != null) {
+		if (hasHardwareMipMaps()) {
 			glTexImage2D(target, 0, format, data->w, data->h, 0,format, GL_UNSIGNED_BYTE, data->pixels);
 			glGenerateMipmap(target);
-		//} else generateMipMapCPU(target, data, textureWidth, textureHeight);
+		} else generateMipMapCPU(target, data, textureWidth, textureHeight, format);
 	}
 
-	static void generateMipMapCPU (int target, SDL2::Surface data, int textureWidth, int textureHeight,int format) {
-		glTexImage2D(target, 0, format, data->w, data->h, 0,format, GL_UNSIGNED_BYTE, data->pixels);
-		if (textureWidth != textureHeight){
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"texture width and height must be square when using mipmapping.");
-			return;
-        }
-		int width = data->w / 2;
-		int height = data->h / 2;
-		int level = 1;
-		while (width > 0 && height > 0) {
-			glTexImage2D(target, level, format, data->w, data->h, 0,format, GL_UNSIGNED_BYTE, data->pixels);
-			width = data->w / 2;
-			height = data->h / 2;
-			level++;
-		}
-	}
+	static void generateMipMapCPU (int target, SDL2::Surface data, int textureWidth, int textureHeight,int format);
+
+	/** @return whether glGenerateMipmap is available: OpenGL 3.0 or a framebuffer object extension */
+	static bool hasHardwareMipMaps ();
 public:
+	/** Generates the complete mip chain down to 1x1 on the CPU. Any size works, including non power of two and non square
+	 * images; each level is half the size of the previous one, rounded down, and is filtered from the previous level kept at
+	 * float precision. Rows are split across the threads of the pool.
+	 * @param pixels tightly packed rows of 8 bit channels
+	 * @param channels 1 to 4, the fourth is treated as alpha
+	 * @param filter the downsampling filter
+	 * @param srgb whether the color channels are sRGB encoded, so they are filtered in linear space. Alpha is always linear.
+	 * @param pool the threads to use, nullptr for {@link ThreadPool#getShared()}
+	 * @return the levels, starting with a copy of the base level */
+	static std::vector<MipMapLevel> generateMipChain (const unsigned char* pixels, int width, int height, int channels,
+		MipMapFilter filter, bool srgb, ThreadPool* pool = nullptr);
+
+	/** Uploads the levels to the bound texture. */
+	static void uploadMipChain (int target, const std::vector<MipMapLevel>& levels, int format);
+
     static void generateMipMap (SDL2::Surface data, int textureWidth, int textureHeight) {
 		generateMipMap(GL_TEXTURE_2D, data, textureWidth, textureHeight,true);
 	}
@@ -79,4 +101,4 @@ public:
             generateMipMapGLES20(target, data,format);
         #endif
 	}
-};
\ No newline at end of file
+};
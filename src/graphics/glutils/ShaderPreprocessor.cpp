@@ -0,0 +1,95 @@
+#include "ShaderPreprocessor.h"
+
+static std::string directoryOf (const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+ShaderPreprocessor::ShaderPreprocessor(const std::string& basePath){
+    this->basePath = basePath;
+    if (!this->basePath.empty() && this->basePath.back() != '/' && this->basePath.back() != '\\')
+        this->basePath += '/';
+}
+
+bool ShaderPreprocessor::read (const std::string& path, std::string& out){
+    auto cached = files.find(path);
+    if (cached != files.end()) {
+        out = cached->second;
+        return true;
+    }
+    char* content = file_read(path.c_str());
+    if (content == NULL) return false;
+    out = content;
+    free(content);
+    files[path] = out;
+    return true;
+}
+
+std::string ShaderPreprocessor::load (const std::string& path){
+    std::string source;
+    if (!read(path, source) && !read(basePath + path, source)) {
+        SDL_Log("ShaderPreprocessor: cannot read %s", path.c_str());
+        return std::string();
+    }
+    std::string out;
+    std::set<std::string> included;
+    included.insert(path);
+    expand(source, directoryOf(path), out, included, 0);
+    return out;
+}
+
+std::string ShaderPreprocessor::process (const std::string& source, const std::string& path){
+    std::string out;
+    std::set<std::string> included;
+    if (!path.empty()) included.insert(path);
+    expand(source, directoryOf(path), out, included, 0);
+    return out;
+}
+
+void ShaderPreprocessor::expand (const std::string& source, const std::string& directory, std::string& out,
+    std::set<std::string>& included, int depth){
+    out.reserve(out.size() + source.size());
+    size_t lineStart = 0;
+    while (lineStart < source.size()) {
+        size_t lineEnd = source.find('\n', lineStart);
+        if (lineEnd == std::string::npos) lineEnd = source.size();
+
+        size_t first = source.find_first_not_of(" \t", lineStart);
+        if (first != std::string::npos && first < lineEnd && source.compare(first, 8, "#include") == 0) {
+            size_t open = source.find_first_of("\"<", first + 8);
+            size_t close = open < lineEnd ? source.find_first_of("\">", open + 1) : std::string::npos;
+            if (open >= lineEnd || close == std::string::npos || close >= lineEnd) {
+                SDL_Log("ShaderPreprocessor: malformed include: %s", source.substr(first, lineEnd - first).c_str());
+            } else if (depth >= MAX_INCLUDE_DEPTH) {
+                SDL_Log("ShaderPreprocessor: includes nested too deep in %s", directory.c_str());
+            } else {
+                std::string name = source.substr(open + 1, close - open - 1);
+                std::string path = directory + name;
+                std::string content;
+                if (!read(path, content)) {
+                    path = basePath + name;
+                    if (!read(path, content)) {
+                        SDL_Log("ShaderPreprocessor: cannot resolve include %s", name.c_str());
+                        path.clear();
+                    }
+                }
+                if (!path.empty() && included.insert(path).second) {
+                    expand(content, directoryOf(path), out, included, depth + 1);
+                    if (!out.empty() && out.back() != '\n') out += '\n';
+                }
+            }
+        } else {
+            out.append(source, lineStart, lineEnd - lineStart);
+            if (lineEnd < source.size()) out += '\n';
+        }
+        lineStart = lineEnd + 1;
+    }
+}
+
+std::string ShaderPreprocessor::insertDefines (const std::string& source, const std::string& defines){
+    size_t version = source.find("#version");
+    if (version == std::string::npos) return defines + source;
+    size_t lineEnd = source.find('\n', version);
+    if (lineEnd == std::string::npos) return source + "\n" + defines;
+    return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "../../GL.h"
+#include <string>
+#include <set>
+#include <unordered_map>
+
+/** Resolves <code>#include "file"</code> directives in shader sources. Paths are relative to the including file, then to the base
+ * path. A file is included at most once per source, so include guards are not needed, and every file is read from disk only once
+ * per preprocessor. GLSL ES can't name files in <code>#line</code>, so line numbers in compile errors refer to the expanded
+ * source. */
+class ShaderPreprocessor{
+    std::string basePath;
+    std::unordered_map<std::string,std::string> files;
+
+    static const int MAX_INCLUDE_DEPTH = 32;
+
+    bool read (const std::string& path, std::string& out);
+    void expand (const std::string& source, const std::string& directory, std::string& out, std::set<std::string>& included,
+        int depth);
+public:
+    /** @param basePath the directory include paths are also resolved against, may be empty */
+    ShaderPreprocessor(const std::string& basePath = "");
+
+    /** @return the file at the given path with its includes resolved, or an empty string if it can't be read */
+    std::string load (const std::string& path);
+
+    /** @param source the shader source
+     * @param path the path of the source, used to resolve relative includes, may be empty
+     * @return the source with its includes resolved */
+    std::string process (const std::string& source, const std::string& path = "");
+
+    /** Drops the cached files, e.g. to pick up edited shaders. */
+    void clearCache () {
+        files.clear();
+    }
+
+    /** @return the source with the defines inserted after its #version directive, or at the start if it has none */
+    static std::string insertDefines (const std::string& source, const std::string& defines);
+};
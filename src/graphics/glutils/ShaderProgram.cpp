@@ -1,11 +1,32 @@
 #include "ShaderProgram.h"
+#include "GLStateCache.h"
+#include <cstring>
+#include <algorithm>
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+#ifndef APIENTRY
+    #ifdef GL_APIENTRY
+        #define APIENTRY GL_APIENTRY
+    #else
+        #define APIENTRY
+    #endif
+#endif
 
 //Initialize
 bool ShaderProgram::pedantic = true;
 std::string ShaderProgram::prependVertexCode;
 std::string ShaderProgram::prependFragmentCode;
 
-std::map<std::string, std::vector<ShaderProgram>> ShaderProgram::shaders = std::map<std::string, std::vector<ShaderProgram>>();
+std::map<std::string, std::vector<ShaderProgram*>> ShaderProgram::shaders;
+std::map<std::string,int> ShaderProgram::uniformBlockBindings;
+std::shared_ptr<ShaderProgramCache> ShaderProgram::binaryCache;
+std::vector<ShaderProgram*> ShaderProgram::pendingPrograms;
+int ShaderProgram::parallelCompile = -1;
+UniformStats ShaderProgram::frameUniformStats;
+UniformStats ShaderProgram::lastFrameUniformStats;
 
 const std::string ShaderProgram::POSITION_ATTRIBUTE = "a_position";
 const std::string ShaderProgram::NORMAL_ATTRIBUTE = "a_normal";
@@ -15,7 +36,10 @@ const std::string ShaderProgram::TANGENT_ATTRIBUTE = "a_tangent";
 const std::string ShaderProgram::BINORMAL_ATTRIBUTE = "a_binormal";
 const std::string ShaderProgram::BONEWEIGHT_ATTRIBUTE = "a_boneWeight";
 
-ShaderProgram::ShaderProgram (const std::string& vertexShader,const std::string& fragmentShader,const std::string& app) {
+ShaderProgram::ShaderProgram (const std::string& vertexShader,const std::string& fragmentShader,const std::string& app)
+    :ShaderProgram(vertexShader, fragmentShader, app, false){}
+
+ShaderProgram::ShaderProgram (const std::string& vertexShader,const std::string& fragmentShader,const std::string& app, bool deferred) {
         std::stringstream vs,fs;
 		if (prependVertexCode.length() > 0) vs<< prependVertexCode; 
         vs << vertexShader;
@@ -26,20 +50,204 @@ ShaderProgram::ShaderProgram (const std::string& vertexShader,const std::string&
 		fragmentShaderSource = fs.str();
 		log = "";
         refCount = 0;
+		this->app = app;
+
+		if (loadProgramBinary()) {
+			addManagedShader(app, this);
+			return;
+		}
+
+		if (deferred) {
+			submitShaders();
+			pending = true;
+			pendingPrograms.push_back(this);
+			return;
+		}
 
 		compileShaders(vertexShaderSource, fragmentShaderSource);
 		if (isCompiled()) {
 			fetchAttributes();
 			fetchUniforms();
-			addManagedShader(app, *this);
+			fetchUniformBlocks();
+			saveProgramBinary();
+			addManagedShader(app, this);
 		}
 	}
     
 	ShaderProgram::~ShaderProgram() {
-		glUseProgram(0);
+		if (pending) pendingPrograms.erase(std::remove(pendingPrograms.begin(), pendingPrograms.end(), this), pendingPrograms.end());
+		auto managed = shaders.find(app);
+		if (managed != shaders.end())
+			managed->second.erase(std::remove(managed->second.begin(), managed->second.end(), this), managed->second.end());
 		glDeleteShader(vertexShaderHandle);
 		glDeleteShader(fragmentShaderHandle);
-		glDeleteProgram(program);
+		GLStateCache::get().deleteProgram(program);
+	}
+    
+    bool ShaderProgram::hasParallelCompile () {
+		if (parallelCompile == -1) {
+			typedef void (APIENTRY *MaxShaderCompilerThreads)(GLuint count);
+			MaxShaderCompilerThreads maxThreads = NULL;
+			if (SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile"))
+				maxThreads = (MaxShaderCompilerThreads)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsKHR");
+			else if (SDL_GL_ExtensionSupported("GL_ARB_parallel_shader_compile"))
+				maxThreads = (MaxShaderCompilerThreads)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsARB");
+			parallelCompile = maxThreads != NULL ? 1 : 0;
+			//Let the driver pick the number of compiler threads
+			if (maxThreads != NULL) maxThreads(0xFFFFFFFF);
+		}
+		return parallelCompile == 1;
+	}
+    
+    void ShaderProgram::submitShaders () {
+		hasParallelCompile();
+		const GLchar* vertexSource = vertexShaderSource.c_str();
+		const GLchar* fragmentSource = fragmentShaderSource.c_str();
+		vertexShaderHandle = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(vertexShaderHandle, 1, &vertexSource, NULL);
+		glCompileShader(vertexShaderHandle);
+		fragmentShaderHandle = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(fragmentShaderHandle, 1, &fragmentSource, NULL);
+		glCompileShader(fragmentShaderHandle);
+
+		//Linking right away lets the driver continue in the background, the status is only queried in finishPending
+		program = createProgram();
+		if (program == -1) return;
+		glAttachShader(program, vertexShaderHandle);
+		glAttachShader(program, fragmentShaderHandle);
+		if (binaryCache) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glLinkProgram(program);
+	}
+    
+    bool ShaderProgram::isReady () {
+		if (!pending) return true;
+		if (program != -1 && hasParallelCompile()) {
+			GLint completed = GL_FALSE;
+			glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &completed);
+			if (completed == GL_FALSE) return false;
+		}
+		finishPending();
+		return true;
+	}
+    
+    void ShaderProgram::finishCompilation () {
+		if (pending) finishPending();
+	}
+    
+    void ShaderProgram::setOnReady (std::function<void(ShaderProgram&)> callback) {
+		if (pending) onReady = callback;
+		else if (callback) callback(*this);
+	}
+    
+    void ShaderProgram::updatePending () {
+		std::vector<ShaderProgram*> polled = pendingPrograms;
+		for (ShaderProgram* shaderProgram : polled)
+			shaderProgram->isReady();
+	}
+    
+    void ShaderProgram::finishPending () {
+		pending = false;
+		pendingPrograms.erase(std::remove(pendingPrograms.begin(), pendingPrograms.end(), this), pendingPrograms.end());
+
+		_compiled = program != -1;
+		const int handles[] = {vertexShaderHandle, fragmentShaderHandle};
+		for (int handle : handles) {
+			GLint status = GL_FALSE;
+			glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
+			if (status == GL_FALSE) {
+				GLint logLength = 0;
+				glGetShaderiv(handle, GL_INFO_LOG_LENGTH, &logLength);
+				std::vector<GLchar> cLog(logLength + 1);
+				glGetShaderInfoLog(handle, logLength, NULL, cLog.data());
+				SDL_Log("%s SHADER FAIL LOG: %s", handle == vertexShaderHandle ? "VERTEX" : "FRAGMENT", cLog.data());
+				log += cLog.data();
+				_compiled = false;
+			}
+		}
+		if (_compiled) {
+			GLint status = GL_FALSE;
+			glGetProgramiv(program, GL_LINK_STATUS, &status);
+			if (status == GL_FALSE) {
+				GLint logLength = 0;
+				glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+				std::vector<GLchar> cLog(logLength + 1);
+				glGetProgramInfoLog(program, logLength, NULL, cLog.data());
+				SDL_Log("PROGRAM LINK FAIL LOG: %s", cLog.data());
+				log += cLog.data();
+				_compiled = false;
+			}
+		}
+
+		if (_compiled) {
+			fetchAttributes();
+			fetchUniforms();
+			fetchUniformBlocks();
+			saveProgramBinary();
+			addManagedShader(app, this);
+		}
+		if (onReady) onReady(*this);
+	}
+    
+    bool ShaderProgram::loadProgramBinary () {
+		if (!binaryCache || !ShaderProgramCache::isSupported()) return false;
+		if (binaryKey.empty()) binaryKey = binaryCache->keyFor(vertexShaderSource, fragmentShaderSource);
+
+		ShaderProgramBinary entry;
+		if (!binaryCache->load(binaryKey, vertexShaderSource, fragmentShaderSource, entry)) return false;
+
+		int handle = createProgram();
+		if (handle == -1) return false;
+		glProgramBinary(handle, entry.format, entry.binary.data(), entry.binary.size());
+		GLint status = GL_FALSE;
+		glGetProgramiv(handle, GL_LINK_STATUS, &status);
+		if (status == GL_FALSE) {
+			//The driver may reject binaries of an older build even if the version string didn't change
+			SDL_Log("ShaderProgram: cached binary %s rejected, recompiling", binaryKey.c_str());
+			GLStateCache::get().deleteProgram(handle);
+			binaryCache->remove(binaryKey);
+			return false;
+		}
+
+		program = handle;
+		vertexShaderHandle = 0;
+		fragmentShaderHandle = 0;
+		_compiled = true;
+
+		attributes.clear(); attributeTypes.clear(); attributeSizes.clear(); attributeNames.clear();
+		for (const ShaderProgramBinary::Variable& attribute : entry.attributes) {
+			attributes[attribute.name] = attribute.location;
+			attributeTypes[attribute.name] = attribute.type;
+			attributeSizes[attribute.name] = attribute.size;
+			attributeNames.push_back(attribute.name);
+		}
+		uniforms.clear(); uniformTypes.clear(); uniformSizes.clear(); uniformNames.clear();
+		for (const ShaderProgramBinary::Variable& uniform : entry.uniforms) {
+			uniforms[uniform.name] = uniform.location;
+			uniformTypes[uniform.name] = uniform.type;
+			uniformSizes[uniform.name] = uniform.size;
+			uniformNames.push_back(uniform.name);
+		}
+		buildUniformShadows();
+		fetchUniformBlocks();
+		return true;
+	}
+    
+    void ShaderProgram::saveProgramBinary () {
+		if (!binaryCache || !_compiled || !ShaderProgramCache::isSupported()) return;
+		if (binaryKey.empty()) binaryKey = binaryCache->keyFor(vertexShaderSource, fragmentShaderSource);
+
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) return;
+
+		ShaderProgramBinary entry;
+		entry.binary.resize(length);
+		glGetProgramBinary(program, length, NULL, &entry.format, entry.binary.data());
+		for (const std::string& name : attributeNames)
+			entry.attributes.push_back({name, attributes[name], attributeTypes[name], attributeSizes[name]});
+		for (const std::string& name : uniformNames)
+			entry.uniforms.push_back({name, uniforms[name], uniformTypes[name], uniformSizes[name]});
+		binaryCache->store(binaryKey, vertexShaderSource, fragmentShaderSource, entry);
 	}
     
     void ShaderProgram::compileShaders (const std::string& vertexShader,const std::string& fragmentShader) {
@@ -65,6 +273,7 @@ ShaderProgram::ShaderProgram (const std::string& vertexShader,const std::string&
 
 		glAttachShader(program, vertexShaderHandle);
 		glAttachShader(program, fragmentShaderHandle);
+		if (binaryCache) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 		glLinkProgram(program);
 
 		GLint params;
@@ -156,8 +365,74 @@ ShaderProgram::ShaderProgram (const std::string& vertexShader,const std::string&
 			uniformSizes[name] = sizes;
 			uniformNames[i] = name;
 		}
+        buildUniformShadows();
 	}
     
+    void ShaderProgram::fetchUniformBlocks () {
+        uniformBlocks.clear();
+        GLint params = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &params);
+		int numBlocks = params;
+
+        const GLsizei bufSize = 256;
+        GLchar names[bufSize];
+        for (int i = 0; i < numBlocks; i++) {
+            GLsizei length;
+            glGetActiveUniformBlockName(program, i, bufSize, &length, names);
+            std::string name(names);
+            uniformBlocks[name] = i;
+            
+            auto binding = uniformBlockBindings.find(name);
+            if (binding != uniformBlockBindings.end()) glUniformBlockBinding(program, i, binding->second);
+        }
+    }
+    
+    bool ShaderProgram::bindUniformBlock (const std::string& name, int binding) {
+        checkManaged();
+        auto block = uniformBlocks.find(name);
+        if (block == uniformBlocks.end()) {
+            if (pedantic) SDL_Log("no uniform block with name '%s' in shader",name.c_str());
+            return false;
+        }
+        glUniformBlockBinding(program, block->second, binding);
+        return true;
+    }
+    
+    void ShaderProgram::buildUniformShadows () {
+        uniformShadows.clear();
+        shadowIndexByLocation.clear();
+        shadowIndexByLargeLocation.clear();
+        uniformHandles.clear();
+        for (const std::string& name : uniformNames) {
+            int location = uniforms[name];
+            if (location < 0) continue; // uniforms inside blocks have no location
+            int index = uniformShadows.size();
+            UniformShadow shadow;
+            shadow.location = location;
+            uniformShadows.push_back(shadow);
+            uniformHandles[name] = index;
+            
+            //Array uniforms are reported as "name[0]", accept the plain name too and map every element location.
+            std::vector<int> locations(1, location);
+            size_t bracket = name.rfind("[0]");
+            if (bracket != std::string::npos && bracket + 3 == name.size()) {
+                std::string base = name.substr(0, bracket);
+                uniformHandles[base] = index;
+                for (int i = 1; i < uniformSizes[name]; i++)
+                    locations.push_back(glGetUniformLocation(program, (base + "[" + std::to_string(i) + "]").c_str()));
+            }
+            for (int l : locations) {
+                if (l < 0) continue;
+                if (l > MAX_SHADOWED_LOCATION) {
+                    shadowIndexByLargeLocation[l] = index;
+                    continue;
+                }
+                if (l >= shadowIndexByLocation.size()) shadowIndexByLocation.resize(l + 1, -1);
+                shadowIndexByLocation[l] = index;
+            }
+        }
+    }
+    
 	void ShaderProgram::setAttributef (const std::string& name, float value1, float value2, float value3, float value4) {
 		int location = fetchAttributeLocation(name);
 		glVertexAttrib4f(location, value1, value2, value3, value4);
@@ -205,11 +480,11 @@ ShaderProgram::ShaderProgram (const std::string& vertexShader,const std::string&
     
 	void ShaderProgram::begin () {
 		checkManaged();
-		glUseProgram(program);
+		GLStateCache::get().useProgram(program);
 	}
     
 	void ShaderProgram::end () {
-		glUseProgram(0);
+		//Left in use, the next begin() of the same program is then free
 	}
     
     int ShaderProgram::fetchUniformLocation (const std::string& name, bool pedantic) {
@@ -249,159 +524,304 @@ ShaderProgram::ShaderProgram (const std::string& vertexShader,const std::string&
     
 	void ShaderProgram::setUniformMatrix4fv (int location, float* values,int length) {
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniformMatrix4fv(location, length / 16, false, values);
 	}
     
 	void ShaderProgram::setUniformMatrix4fv (const std::string& name, std::vector<float>& buffer, int count, bool transpose) {
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniformMatrix4fv(location, count, transpose, buffer.data());
 	}
     
 	void ShaderProgram::setUniformMatrix3fv (const std::string& name, const std::vector<float>& buffer, int count, bool transpose) {
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniformMatrix3fv(location, count, transpose, buffer.data());
 	}
     
 	void ShaderProgram::setUniform4fv (int location, float* values,int length) {
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniform4fv(location, length / 4, values);
 	}
     
 	void ShaderProgram::setUniform4fv (const std::string& name, float* values, int length) {
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniform4fv(location, length / 4, values);
 	}
     
 	void ShaderProgram::setUniform3fv (int location, float* values,int length) {
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniform3fv(location, length / 3, values);
 	}
     
 	void ShaderProgram::setUniform3fv (const std::string& name, float* values, int length) {
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniform3fv(location, length / 3, values);
 	}
     
 	void ShaderProgram::setUniform2fv (int location, float* values, int length) {
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniform2fv(location, length / 2, values);
 	}
     
 	void ShaderProgram::setUniform2fv (const std::string& name, float* values, int length) {
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniform2fv(location, length / 2, values);
 	}
     
 	void ShaderProgram::setUniform1fv (int location, float* values, int length) {
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniform1fv(location, length, values);
 	}
     
 	void ShaderProgram::setUniform1fv (const std::string& name, float* values,int length) {
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniform1fv(location, length, values);
 	}
     
 	void ShaderProgram::setUniformf (int location, float value1, float value2, float value3, float value4) {
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniform4f(location, value1, value2, value3, value4);
 	}
     
 	void ShaderProgram::setUniformf (int location, float value1, float value2, float value3) {		
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniform3f(location, value1, value2, value3);
 	}
     
 	void ShaderProgram::setUniformf (int location, float value1, float value2) {		
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniform2f(location, value1, value2);
 	}
     
 	void ShaderProgram::setUniformf (const std::string& name, float value1, float value2, float value3, float value4) {		
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniform4f(location, value1, value2, value3, value4);
 	}
     
 	void ShaderProgram::setUniformf (const std::string& name, float value1, float value2, float value3) {		
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniform3f(location, value1, value2, value3);
 	}
     
 	void ShaderProgram::setUniformf (const std::string& name, float value1, float value2) {		
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniform2f(location, value1, value2);
 	}
     
 	void ShaderProgram::setUniformf (int location, float value) {		
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniform1f(location, value);
 	}
     
 	void ShaderProgram::setUniformf (const std::string& name, float value) {		
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniform1f(location, value);
 	}
     
 	void ShaderProgram::setUniformi (int location, int value1, int value2, int value3, int value4) {
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniform4i(location, value1, value2, value3, value4);
 	}
     
 	void ShaderProgram::setUniformi (const std::string& name, int value1, int value2, int value3, int value4) {
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniform4i(location, value1, value2, value3, value4);
 	}
     
 	void ShaderProgram::setUniformi (int location, int value1, int value2, int value3) {
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniform3i(location, value1, value2, value3);
 	}
     
 	void ShaderProgram::setUniformi (const std::string& name, int value) {
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniform1i(location, value);
 	}
     
 	void ShaderProgram::setUniformi (int location, int value) {
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniform1i(location, value);
 	}
     
 	void ShaderProgram::setUniformi (const std::string& name, int value1, int value2) {
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniform2i(location, value1, value2);
 	}
     
 	void ShaderProgram::setUniformi (int location, int value1, int value2) {
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniform2i(location, value1, value2);
 	}
     
 	void ShaderProgram::setUniformi (const std::string& name, int value1, int value2, int value3) {
 		checkManaged();
 		int location = fetchUniformLocation(name);
+		forgetUniformShadow(location);
 		glUniform3i(location, value1, value2, value3);
 	}
     
     void ShaderProgram::setUniformMatrix (int location, const Matrix4& matrix, bool transpose) {
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniformMatrix4fv(location, 1, transpose, matrix.val.data());
 	}
     
 	void ShaderProgram::setUniformMatrix (int location, const Matrix3& matrix, bool transpose) {
 		checkManaged();
+		forgetUniformShadow(location);
 		glUniformMatrix3fv(location, 1, transpose, matrix.val.data());
+	}
+    
+    UniformHandle ShaderProgram::fetchUniformHandle (const std::string& name) {
+        UniformHandle handle;
+        auto search = uniformHandles.find(name);
+        if (search != uniformHandles.end()) handle.index = search->second;
+        else if (pedantic) SDL_Log("no uniform with name '%s' in shader",name.c_str());
+        return handle;
+    }
+    
+    void ShaderProgram::invalidateUniformShadows () {
+        for (UniformShadow& shadow : uniformShadows)
+            shadow.valid = false;
+    }
+    
+    bool ShaderProgram::updateUniformShadow (const UniformHandle& handle, const void* value, size_t bytes) {
+        checkManaged();
+        if (!handle.isValid() || handle.index >= uniformShadows.size()) return false;
+        UniformShadow& shadow = uniformShadows[handle.index];
+        if (shadow.valid && shadow.value.size() == bytes && memcmp(shadow.value.data(), value, bytes) == 0) {
+            frameUniformStats.skipped++;
+            return false;
+        }
+        shadow.value.resize(bytes);
+        memcpy(shadow.value.data(), value, bytes);
+        shadow.valid = true;
+        frameUniformStats.submitted++;
+        return true;
+    }
+    
+	void ShaderProgram::setUniformi (const UniformHandle& handle, int value) {
+        if (updateUniformShadow(handle, &value, sizeof(value)))
+            glUniform1i(uniformShadows[handle.index].location, value);
+	}
+    
+	void ShaderProgram::setUniformi (const UniformHandle& handle, int value1, int value2) {
+        const int values[] = {value1, value2};
+        if (updateUniformShadow(handle, values, sizeof(values)))
+            glUniform2i(uniformShadows[handle.index].location, value1, value2);
+	}
+    
+	void ShaderProgram::setUniformi (const UniformHandle& handle, int value1, int value2, int value3) {
+        const int values[] = {value1, value2, value3};
+        if (updateUniformShadow(handle, values, sizeof(values)))
+            glUniform3i(uniformShadows[handle.index].location, value1, value2, value3);
+	}
+    
+	void ShaderProgram::setUniformi (const UniformHandle& handle, int value1, int value2, int value3, int value4) {
+        const int values[] = {value1, value2, value3, value4};
+        if (updateUniformShadow(handle, values, sizeof(values)))
+            glUniform4i(uniformShadows[handle.index].location, value1, value2, value3, value4);
+	}
+    
+	void ShaderProgram::setUniformf (const UniformHandle& handle, float value) {
+        if (updateUniformShadow(handle, &value, sizeof(value)))
+            glUniform1f(uniformShadows[handle.index].location, value);
+	}
+    
+	void ShaderProgram::setUniformf (const UniformHandle& handle, float value1, float value2) {
+        const float values[] = {value1, value2};
+        if (updateUniformShadow(handle, values, sizeof(values)))
+            glUniform2f(uniformShadows[handle.index].location, value1, value2);
+	}
+    
+	void ShaderProgram::setUniformf (const UniformHandle& handle, float value1, float value2, float value3) {
+        const float values[] = {value1, value2, value3};
+        if (updateUniformShadow(handle, values, sizeof(values)))
+            glUniform3f(uniformShadows[handle.index].location, value1, value2, value3);
+	}
+    
+	void ShaderProgram::setUniformf (const UniformHandle& handle, float value1, float value2, float value3, float value4) {
+        const float values[] = {value1, value2, value3, value4};
+        if (updateUniformShadow(handle, values, sizeof(values)))
+            glUniform4f(uniformShadows[handle.index].location, value1, value2, value3, value4);
+	}
+    
+	void ShaderProgram::setUniform1fv (const UniformHandle& handle, const float* values, int length) {
+        if (updateUniformShadow(handle, values, length * sizeof(float)))
+            glUniform1fv(uniformShadows[handle.index].location, length, values);
+	}
+    
+	void ShaderProgram::setUniform2fv (const UniformHandle& handle, const float* values, int length) {
+        if (updateUniformShadow(handle, values, length * sizeof(float)))
+            glUniform2fv(uniformShadows[handle.index].location, length / 2, values);
+	}
+    
+	void ShaderProgram::setUniform3fv (const UniformHandle& handle, const float* values, int length) {
+        if (updateUniformShadow(handle, values, length * sizeof(float)))
+            glUniform3fv(uniformShadows[handle.index].location, length / 3, values);
+	}
+    
+	void ShaderProgram::setUniform4fv (const UniformHandle& handle, const float* values, int length) {
+        if (updateUniformShadow(handle, values, length * sizeof(float)))
+            glUniform4fv(uniformShadows[handle.index].location, length / 4, values);
+	}
+    
+	void ShaderProgram::setUniformMatrix4fv (const UniformHandle& handle, const float* values, int length) {
+        if (updateUniformShadow(handle, values, length * sizeof(float)))
+            glUniformMatrix4fv(uniformShadows[handle.index].location, length / 16, false, values);
+	}
+    
+	void ShaderProgram::setUniformMatrix (const UniformHandle& handle, const Matrix4& matrix, bool transpose) {
+        //The transpose flag is part of the uploaded state, shadow it in front of the values.
+        float values[17];
+        values[0] = transpose ? 1.0f : 0.0f;
+        memcpy(values + 1, matrix.val.data(), 16 * sizeof(float));
+        if (updateUniformShadow(handle, values, sizeof(values)))
+            glUniformMatrix4fv(uniformShadows[handle.index].location, 1, transpose, matrix.val.data());
+	}
+    
+	void ShaderProgram::setUniformMatrix (const UniformHandle& handle, const Matrix3& matrix, bool transpose) {
+        float values[10];
+        values[0] = transpose ? 1.0f : 0.0f;
+        memcpy(values + 1, matrix.val.data(), 9 * sizeof(float));
+        if (updateUniformShadow(handle, values, sizeof(values)))
+            glUniformMatrix3fv(uniformShadows[handle.index].location, 1, transpose, matrix.val.data());
 	}
\ No newline at end of file
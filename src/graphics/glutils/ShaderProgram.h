@@ -21,7 +21,10 @@
 #include "../../math/Vector3.h"
 #include "../../math/Matrix3.h"
 #include "../../math/Matrix4.h"
+#include "ShaderProgramCache.h"
 #include <limits>
+#include <memory>
+#include <functional>
 #include <vector>
 #include <map>
 
@@ -29,9 +32,24 @@ class Vector3;
 class Vector2;
 class Matrix3;
 class Matrix4;
+
+/** A uniform resolved once through {@link ShaderProgram#fetchUniformHandle(std::string)}. Setting a value through a handle needs
+ * no name lookup, and the GL call is skipped when the value is bitwise identical to the one last uploaded to that program. A
+ * handle is only valid for the program that returned it. */
+struct UniformHandle{
+    int index = -1;
+    bool isValid () const {return index >= 0;}
+};
+
+/** Number of uniform updates requested through {@link UniformHandle}s, split in those that reached GL and those that were
+ * skipped because the program already held the value. */
+struct UniformStats{
+    int submitted = 0;
+    int skipped = 0;
+};
+
 class ShaderProgram
 {
-    std::vector<ShaderProgram> managedResources = std::vector<ShaderProgram>();
 protected:
     int createProgram ();
 public:
@@ -62,13 +80,58 @@ public:
 	/** code that is always added to every fragment shader code, typically used to inject a #version line. Note that this is added
 	 * as-is, you should include a newline (`\n`) if needed. */
 	static std::string prependFragmentCode;
+
+	/** Sets the cache linked programs are saved to and restored from, or nullptr (the default) to always compile from source.
+	 * Set it before the first {@link ShaderProgram} is created. Programs restored from the cache have no shader objects, only the
+	 * program handle. */
+	static void setBinaryCache (std::shared_ptr<ShaderProgramCache> cache) {
+		binaryCache = cache;
+	}
+
+	static std::shared_ptr<ShaderProgramCache> getBinaryCache () {
+		return binaryCache;
+	}
     
     /** @return whether this ShaderProgram compiled successfully. */
 	bool isCompiled () {
 		return _compiled;
 	}
 ShaderProgram(){}
+ShaderProgram (const ShaderProgram&) = delete;
+ShaderProgram& operator= (const ShaderProgram&) = delete;
 ShaderProgram (const std::string& vertexShader,const std::string& fragmentShader,const std::string& app);
+
+	/** Constructs a new ShaderProgram, optionally without waiting for the driver. A deferred program only submits the compile and
+	 * link commands, so many programs can be created back to back while the driver compiles them, in parallel if
+	 * GL_KHR_parallel_shader_compile is available. Poll {@link #isReady()} or register {@link #setOnReady} and render with a
+	 * placeholder until then, see {@link #readyOr}.
+	 * @param deferred whether to return before the compilation completed */
+	ShaderProgram (const std::string& vertexShader,const std::string& fragmentShader,const std::string& app, bool deferred);
+
+	/** @return whether the compilation finished, successfully or not, check {@link #isCompiled()} for the outcome. Never blocks
+	 * if GL_KHR_parallel_shader_compile is available, otherwise the first call waits for the driver. */
+	bool isReady ();
+
+	/** Blocks until the compilation finished. */
+	void finishCompilation ();
+
+	/** Sets the function called once the compilation finished, from {@link #isReady()} or {@link #updatePending()} on the GL
+	 * thread. It is called right away if the program is already finished. */
+	void setOnReady (std::function<void(ShaderProgram&)> callback);
+
+	/** @return this program if it finished compiling successfully, the placeholder otherwise */
+	ShaderProgram* readyOr (ShaderProgram* placeholder) {
+		return isReady() && _compiled ? this : placeholder;
+	}
+
+	/** Polls every pending deferred program and finishes those the driver completed, firing their callbacks. Called once per
+	 * frame by the application. */
+	static void updatePending ();
+
+	/** @return the number of deferred programs still compiling */
+	static int getNumPending () {
+		return pendingPrograms.size();
+	}
     
 int fetchUniformLocation (const std::string& name, bool pedantic);
 
@@ -266,6 +329,80 @@ int fetchUniformLocation (const std::string& name, bool pedantic);
 		setUniformf(location, values.r, values.g, values.b, values.a);
 	}
 
+	/** Resolves the uniform with the given name into a handle. Do this once, e.g. after construction, and use the handle for
+	 * every subsequent update; the handle overloads of the setters below compare against a shadow copy of the last uploaded value
+	 * and skip the GL call when nothing changed.
+	 * 
+	 * @param name the name of the uniform, array uniforms may be given with or without the trailing "[0]"
+	 * @return the handle, invalid if the uniform is not active in this program */
+	UniformHandle fetchUniformHandle (const std::string& name);
+
+	/** Sets the uniform behind the handle. The {@link ShaderProgram} must be bound for this to work. */
+	void setUniformi (const UniformHandle& handle, int value);
+
+	void setUniformi (const UniformHandle& handle, int value1, int value2);
+
+	void setUniformi (const UniformHandle& handle, int value1, int value2, int value3);
+
+	void setUniformi (const UniformHandle& handle, int value1, int value2, int value3, int value4);
+
+	void setUniformf (const UniformHandle& handle, float value);
+
+	void setUniformf (const UniformHandle& handle, float value1, float value2);
+
+	void setUniformf (const UniformHandle& handle, float value1, float value2, float value3);
+
+	void setUniformf (const UniformHandle& handle, float value1, float value2, float value3, float value4);
+
+	void setUniformf (const UniformHandle& handle, const Vector2& values) {
+		setUniformf(handle, values.x, values.y);
+	}
+
+	void setUniformf (const UniformHandle& handle, const Vector3& values) {
+		setUniformf(handle, values.x, values.y, values.z);
+	}
+
+	void setUniformf (const UniformHandle& handle, const Color& values) {
+		setUniformf(handle, values.r, values.g, values.b, values.a);
+	}
+
+	void setUniform1fv (const UniformHandle& handle, const float* values, int length);
+
+	void setUniform2fv (const UniformHandle& handle, const float* values, int length);
+
+	void setUniform3fv (const UniformHandle& handle, const float* values, int length);
+
+	void setUniform4fv (const UniformHandle& handle, const float* values, int length);
+
+	void setUniformMatrix (const UniformHandle& handle, const Matrix4& matrix) {
+		setUniformMatrix(handle, matrix, false);
+	}
+
+	void setUniformMatrix (const UniformHandle& handle, const Matrix4& matrix, bool transpose);
+
+	void setUniformMatrix (const UniformHandle& handle, const Matrix3& matrix) {
+		setUniformMatrix(handle, matrix, false);
+	}
+
+	void setUniformMatrix (const UniformHandle& handle, const Matrix3& matrix, bool transpose);
+
+	void setUniformMatrix4fv (const UniformHandle& handle, const float* values, int length);
+
+	/** Forgets the shadowed uniform values of this program, so the next update through a handle always reaches GL. Only needed when
+	 * uniforms of this program were changed with raw GL calls. */
+	void invalidateUniformShadows ();
+
+	/** @return the uniform updates requested through handles during the last completed frame, across all programs */
+	static const UniformStats& getUniformStats () {
+		return lastFrameUniformStats;
+	}
+
+	/** Closes the uniform statistics of the current frame, called by the application after each rendered frame. */
+	static void endFrameUniformStats () {
+		lastFrameUniformStats = frameUniformStats;
+		frameUniformStats = UniformStats();
+	}
+
 	/** Sets the vertex attribute with the given name. The {@link ShaderProgram} must be bound for this to work.
 	 * 
 	 * @param name the attribute name
@@ -297,7 +434,7 @@ int fetchUniformLocation (const std::string& name, bool pedantic);
 	void begin ();
 
 	/** Disables this shader. Must be called when one is done with the shader. Don't mix it with dispose, that will release the
-	 * shader resources. */
+	 * shader resources. The program stays in use in GL until another one begins, so beginning it again costs no GL call. */
 	void end ();
 
 	/** Disposes all resources associated with this shader. Must be called when the shader is no longer used. */
@@ -320,10 +457,10 @@ int fetchUniformLocation (const std::string& name, bool pedantic);
 	/** Invalidates all shaders so the next time they are used new handles are generated
 	 * @param app */
 	static void invalidateAllShaderPrograms (const std::string& app) {
-		std::vector<ShaderProgram> shaderArray = shaders[app];
+		std::vector<ShaderProgram*>& shaderArray = shaders[app];
 		for (int i = 0; i < shaderArray.size(); i++) {
-			shaderArray[i].invalidated = true;
-			shaderArray[i].checkManaged();
+			shaderArray[i]->invalidated = true;
+			shaderArray[i]->checkManaged();
 		}
 	}
 
@@ -414,6 +551,31 @@ int fetchUniformLocation (const std::string& name, bool pedantic);
 		return 0;
 	}
 
+	/** @param name the name of the uniform block
+	 * @return whether the uniform block is active in the shader */
+	bool hasUniformBlock (const std::string& name) {
+		return uniformBlocks.count(name);
+	}
+
+	/** Assigns the uniform block with the given name of this program to a buffer binding point, see {@link UniformBuffer}.
+	 * @return false if the block isn't active in this program */
+	bool bindUniformBlock (const std::string& name, int binding);
+
+	/** Registers the binding point of the uniform block with the given name for all programs. The binding is applied to every
+	 * program linked from now on, so blocks shared across programs (camera, lights, ...) are declared once and their buffers bound
+	 * once per frame. */
+	static void setUniformBlockBinding (const std::string& name, int binding) {
+		uniformBlockBindings[name] = binding;
+	}
+
+	/** @return the uniform blocks */
+	std::vector<std::string> getUniformBlocks () {
+		std::vector<std::string> names;
+		for (auto const& block : uniformBlocks)
+			names.push_back(block.first);
+		return names;
+	}
+
 	/** @return the attributes */
 	std::vector<std::string> getAttributes () {
 		return attributeNames;
@@ -435,13 +597,42 @@ int fetchUniformLocation (const std::string& name, bool pedantic);
     }
 private:
 	/** the list of currently available shaders **/
-	static std::map<std::string, std::vector<ShaderProgram>> shaders;
+	static std::map<std::string, std::vector<ShaderProgram*>> shaders;
 
 	/** the log **/
 	std::string log;
 
 	/** whether this program compiled successfully **/
-	bool _compiled;
+	bool _compiled = false;
+
+	/** application the program is managed under **/
+	std::string app;
+
+	/** whether the deferred compilation has not been finished yet **/
+	bool pending = false;
+
+	/** called when the deferred compilation finished **/
+	std::function<void(ShaderProgram&)> onReady;
+
+	/** deferred programs not yet finished **/
+	static std::vector<ShaderProgram*> pendingPrograms;
+
+	/** whether GL_KHR_parallel_shader_compile is available, -1 if not queried yet **/
+	static int parallelCompile;
+
+	static bool hasParallelCompile ();
+
+	/** Submits the compile and link commands without querying their status. */
+	void submitShaders ();
+
+	/** Checks the status of the submitted shaders, fetches the program tables and fires the callback. */
+	void finishPending ();
+
+	/** cache of linked program binaries, may be nullptr **/
+	static std::shared_ptr<ShaderProgramCache> binaryCache;
+
+	/** key of this program in the binary cache **/
+	std::string binaryKey;
 
 	/** uniform lookup **/
 	std::map<std::string,int> uniforms;
@@ -455,6 +646,35 @@ private:
 	/** uniform names **/
 	std::vector<std::string> uniformNames;
 
+	/** last uploaded value of a uniform, see {@link UniformHandle} **/
+	struct UniformShadow{
+		int location = -1;
+		bool valid = false;
+		std::vector<unsigned char> value;
+	};
+
+	/** uniform shadows, indexed by {@link UniformHandle#index} **/
+	std::vector<UniformShadow> uniformShadows;
+
+	/** shadow index per uniform location, -1 if the location has none **/
+	std::vector<int> shadowIndexByLocation;
+
+	/** shadow index of the locations above {@link #MAX_SHADOWED_LOCATION}, which some drivers hand out sparsely **/
+	std::map<int, int> shadowIndexByLargeLocation;
+
+	/** handle lookup **/
+	std::map<std::string,int> uniformHandles;
+
+	/** uniform statistics of the current and of the last completed frame **/
+	static UniformStats frameUniformStats;
+	static UniformStats lastFrameUniformStats;
+
+	/** uniform block indices **/
+	std::map<std::string,int> uniformBlocks;
+
+	/** binding points applied to the uniform blocks of every program at link time **/
+	static std::map<std::string,int> uniformBlockBindings;
+
 	/** attribute lookup **/
 	std::map<std::string,int> attributes;
 
@@ -468,13 +688,13 @@ private:
 	std::vector<std::string> attributeNames;
 
 	/** program handle **/
-	int program;
+	int program = 0;
 
 	/** vertex shader handle **/
-	int vertexShaderHandle;
+	int vertexShaderHandle = 0;
 
 	/** fragment shader handle **/
-	int fragmentShaderHandle;
+	int fragmentShaderHandle = 0;
 
 	/** matrix float buffer **/
 	//Matrix4* matrix;
@@ -486,23 +706,46 @@ private:
 	std::string fragmentShaderSource;
 
 	/** whether this shader was invalidated **/
-	bool invalidated;
+	bool invalidated = false;
 
 	/** reference count **/
-    int refCount;
+    int refCount = 0;
     
     void compileShaders (const std::string& vertexShader,const std::string& fragmentShader);
+
+	/** Restores the program from the binary cache, including the attribute and uniform tables. @return false on a cache miss or if
+	 * the driver rejected the binary, in which case the program must be compiled from source */
+	bool loadProgramBinary ();
+
+	/** Saves the linked program to the binary cache. */
+	void saveProgramBinary ();
     
     void fetchUniforms ();
 
+	void fetchUniformBlocks ();
+
+	/** the largest location indexed directly for shadow invalidation, larger ones are looked up in a map **/
+	static const int MAX_SHADOWED_LOCATION = 4095;
+
+	void buildUniformShadows ();
+
+	/** Compares the value against the shadow of the handle and stores it. @return whether the value must be sent to GL */
+	bool updateUniformShadow (const UniformHandle& handle, const void* value, size_t bytes);
+
+	/** Marks the shadow of the uniform at the given location stale, used by the setters that bypass handles. */
+	void forgetUniformShadow (int location) {
+		if (location >= 0 && location < shadowIndexByLocation.size()) {
+			if (shadowIndexByLocation[location] >= 0) uniformShadows[shadowIndexByLocation[location]].valid = false;
+		} else if (location > MAX_SHADOWED_LOCATION) {
+			auto found = shadowIndexByLargeLocation.find(location);
+			if (found != shadowIndexByLargeLocation.end()) uniformShadows[found->second].valid = false;
+		}
+	}
+
 	void fetchAttributes ();
     
-    void addManagedShader (const std::string& app, const ShaderProgram& shaderProgram) {
-        auto search = shaders.find(app);
-        if(search == shaders.end()) managedResources = std::vector<ShaderProgram>();
-        else managedResources = shaders[search->first];
-		managedResources.push_back(shaderProgram);
-		shaders[app] = managedResources;
+    void addManagedShader (const std::string& app, ShaderProgram* shaderProgram) {
+		shaders[app].push_back(shaderProgram);
 	}
     
     int loadShader (int type,const std::string& source);
@@ -520,8 +763,14 @@ private:
 	}
     
     void checkManaged () {
+		if (pending) finishCompilation();
 		if (invalidated) {
-			compileShaders(vertexShaderSource, fragmentShaderSource);
+			if (!loadProgramBinary()) {
+				compileShaders(vertexShaderSource, fragmentShaderSource);
+				invalidateUniformShadows();
+				fetchUniformBlocks();
+				saveProgramBinary();
+			}
 			invalidated = false;
 		}
 	}
@@ -0,0 +1,181 @@
+#include "ShaderProgramCache.h"
+#include <cstdio>
+#include <cstring>
+
+//Entry layout: magic, version, vertex and fragment source lengths, source checksum, format, binary length, binary, attribute
+//table, uniform table. All integers are 32 bit.
+static const Uint32 CACHE_MAGIC = 0x50534447; // "GDSP"
+static const Uint32 CACHE_VERSION = 2;
+//Program binaries are at most a few megabytes, a larger entry is corrupt
+static const Uint32 MAX_BINARY_SIZE = 64 * 1024 * 1024;
+
+static Uint64 fnv1a (Uint64 hash, const std::string& data) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/** djb2, independent of the FNV-1a of the key, so a key collision is caught by the checksum */
+static Uint32 djb2 (Uint32 hash, const std::string& data) {
+    for (unsigned char c : data) hash = (hash * 33) ^ c;
+    return hash;
+}
+
+static Uint32 sourceChecksum (const std::string& vertexSource, const std::string& fragmentSource) {
+    return djb2(djb2(5381, vertexSource) * 33, fragmentSource);
+}
+
+static void writeInt (std::vector<unsigned char>& out, Uint32 value) {
+    unsigned char bytes[4] = {(unsigned char)value, (unsigned char)(value >> 8), (unsigned char)(value >> 16), (unsigned char)(value >> 24)};
+    out.insert(out.end(), bytes, bytes + 4);
+}
+
+static void writeVariables (std::vector<unsigned char>& out, const std::vector<ShaderProgramBinary::Variable>& variables) {
+    writeInt(out, variables.size());
+    for (const ShaderProgramBinary::Variable& variable : variables) {
+        writeInt(out, variable.name.size());
+        out.insert(out.end(), variable.name.begin(), variable.name.end());
+        writeInt(out, variable.location);
+        writeInt(out, variable.type);
+        writeInt(out, variable.size);
+    }
+}
+
+/** Bounds checked reader over an entry read into memory. */
+class EntryReader{
+    const std::vector<unsigned char>& data;
+    size_t position = 0;
+public:
+    bool failed = false;
+
+    EntryReader(const std::vector<unsigned char>& data):data(data){}
+
+    Uint32 readInt () {
+        if (position + 4 > data.size()) {failed = true; return 0;}
+        Uint32 value = data[position] | (data[position + 1] << 8) | (data[position + 2] << 16) | ((Uint32)data[position + 3] << 24);
+        position += 4;
+        return value;
+    }
+
+    void readBytes (void* out, size_t length) {
+        if (position + length > data.size()) {failed = true; return;}
+        memcpy(out, data.data() + position, length);
+        position += length;
+    }
+
+    size_t remaining () const {
+        return data.size() - position;
+    }
+
+    void readVariables (std::vector<ShaderProgramBinary::Variable>& out) {
+        Uint32 count = readInt();
+        for (Uint32 i = 0; i < count && !failed; i++) {
+            ShaderProgramBinary::Variable variable;
+            Uint32 length = readInt();
+            if (failed || position + length > data.size()) {failed = true; return;}
+            variable.name.assign((const char*)data.data() + position, length);
+            position += length;
+            variable.location = readInt();
+            variable.type = readInt();
+            variable.size = readInt();
+            out.push_back(variable);
+        }
+    }
+};
+
+ShaderProgramCache::ShaderProgramCache(const std::string& directory){
+    this->directory = directory;
+    if (!this->directory.empty() && this->directory.back() != '/' && this->directory.back() != '\\')
+        this->directory += '/';
+}
+
+bool ShaderProgramCache::isSupported (){
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+std::string ShaderProgramCache::keyFor (const std::string& vertexSource, const std::string& fragmentSource){
+    if (driver.empty()) {
+        const GLubyte* vendor = glGetString(GL_VENDOR);
+        const GLubyte* renderer = glGetString(GL_RENDERER);
+        const GLubyte* version = glGetString(GL_VERSION);
+        std::stringstream ss;
+        ss << (vendor ? (const char*)vendor : "") << '|' << (renderer ? (const char*)renderer : "") << '|'
+            << (version ? (const char*)version : "");
+        driver = ss.str();
+    }
+    Uint64 hash = 14695981039346656037ULL;
+    hash = fnv1a(hash, driver);
+    hash = fnv1a(hash, std::string(1, '\0'));
+    hash = fnv1a(hash, vertexSource);
+    hash = fnv1a(hash, std::string(1, '\0'));
+    hash = fnv1a(hash, fragmentSource);
+
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", (unsigned long long)hash);
+    return std::string(key);
+}
+
+bool ShaderProgramCache::load (const std::string& key, const std::string& vertexSource, const std::string& fragmentSource,
+    ShaderProgramBinary& out){
+    SDL2::RWops file(SDL_RWFromFile(pathFor(key).c_str(), "rb"));
+    if (!file) return false;
+    Sint64 size = SDL_RWsize(file.get());
+    if (size <= 0 || size > MAX_BINARY_SIZE + 1024 * 1024) return false;
+    std::vector<unsigned char> data(size);
+    if (SDL_RWread(file.get(), data.data(), 1, size) != (size_t)size) return false;
+
+    EntryReader reader(data);
+    if (reader.readInt() != CACHE_MAGIC || reader.readInt() != CACHE_VERSION) return false;
+    const Uint32 vertexLength = reader.readInt(), fragmentLength = reader.readInt(), checksum = reader.readInt();
+    if (vertexLength != vertexSource.size() || fragmentLength != fragmentSource.size()
+        || checksum != sourceChecksum(vertexSource, fragmentSource)) {
+        SDL_Log("ShaderProgramCache: entry %s belongs to other sources", key.c_str());
+        return false;
+    }
+    out.format = reader.readInt();
+    const Uint32 binarySize = reader.readInt();
+    if (reader.failed || binarySize > reader.remaining() || binarySize > MAX_BINARY_SIZE) {
+        SDL_Log("ShaderProgramCache: entry %s is corrupt", key.c_str());
+        return false;
+    }
+    out.binary.resize(binarySize);
+    reader.readBytes(out.binary.data(), out.binary.size());
+    reader.readVariables(out.attributes);
+    reader.readVariables(out.uniforms);
+    if (reader.failed) {
+        SDL_Log("ShaderProgramCache: entry %s is truncated", key.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ShaderProgramCache::store (const std::string& key, const std::string& vertexSource, const std::string& fragmentSource,
+    const ShaderProgramBinary& entry){
+    std::vector<unsigned char> data;
+    data.reserve(entry.binary.size() + 1024);
+    writeInt(data, CACHE_MAGIC);
+    writeInt(data, CACHE_VERSION);
+    writeInt(data, vertexSource.size());
+    writeInt(data, fragmentSource.size());
+    writeInt(data, sourceChecksum(vertexSource, fragmentSource));
+    writeInt(data, entry.format);
+    writeInt(data, entry.binary.size());
+    data.insert(data.end(), entry.binary.begin(), entry.binary.end());
+    writeVariables(data, entry.attributes);
+    writeVariables(data, entry.uniforms);
+
+    SDL2::RWops file(SDL_RWFromFile(pathFor(key).c_str(), "wb"));
+    if (!file) {
+        SDL_Log("ShaderProgramCache: cannot write %s: %s", pathFor(key).c_str(), SDL_GetError());
+        return false;
+    }
+    return SDL_RWwrite(file.get(), data.data(), 1, data.size()) == data.size();
+}
+
+void ShaderProgramCache::remove (const std::string& key){
+    ::remove(pathFor(key).c_str());
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "../../GL.h"
+#include <string>
+#include <vector>
+
+/** A linked program as stored by the {@link ShaderProgramCache}: the driver's program binary plus the reflected attribute and
+ * uniform tables, so a cached program needs no GL queries besides the link status. */
+struct ShaderProgramBinary{
+    struct Variable{
+        std::string name;
+        int location;
+        int type;
+        int size;
+    };
+    GLenum format = 0;
+    std::vector<unsigned char> binary;
+    std::vector<Variable> attributes;
+    std::vector<Variable> uniforms;
+};
+
+/** On-disk cache of linked shader programs, used by {@link ShaderProgram} once set through
+ * {@link ShaderProgram#setBinaryCache}. Entries are keyed by a hash of the final vertex and fragment sources (including the
+ * prepended code) and of the GL vendor, renderer and version strings, so a driver update never reuses stale binaries. Binaries
+ * are written with glGetProgramBinary and reloaded with glProgramBinary; when the driver rejects one, the program is compiled
+ * from source again and the entry is replaced.
+ * <p>
+ * Requires OpenGL ES 3.0 or GL_ARB_get_program_binary with at least one binary format, which Mesa's software rasterizer
+ * provides as well. */
+class ShaderProgramCache{
+    std::string directory;
+    std::string driver;
+
+    std::string pathFor (const std::string& key) {
+        return directory + key + ".bin";
+    }
+public:
+    /** @param directory where the entries are stored, must exist and be writable, e.g. from SDL_GetPrefPath */
+    ShaderProgramCache(const std::string& directory);
+
+    /** @return whether the current context can save and restore program binaries */
+    static bool isSupported ();
+
+    /** @return the key of the program with the given final sources on the current driver */
+    std::string keyFor (const std::string& vertexSource, const std::string& fragmentSource);
+
+    /** Reads the entry with the given key, checking it was stored for the same sources, as the keys of different sources may
+     * collide.
+     * @return false if there is no readable entry of the sources */
+    bool load (const std::string& key, const std::string& vertexSource, const std::string& fragmentSource,
+        ShaderProgramBinary& out);
+
+    /** Writes the entry with the given key, replacing an existing one, along with the lengths and a checksum of the sources. */
+    bool store (const std::string& key, const std::string& vertexSource, const std::string& fragmentSource,
+        const ShaderProgramBinary& entry);
+
+    /** Deletes the entry with the given key, e.g. after the driver rejected its binary. */
+    void remove (const std::string& key);
+};
@@ -0,0 +1,335 @@
+#include "ShapeRenderer.h"
+#include "../VertexAttribute.h"
+#include "../../math/MathUtils.h"
+
+namespace {
+    float* putVertex (float* out, float x, float y, float z, float color){
+        out[0] = x;
+        out[1] = y;
+        out[2] = z;
+        out[3] = color;
+        return out + 4;
+    }
+}
+
+ShapeRenderer::ShapeRenderer(int maxVertices, std::shared_ptr<ShaderProgram> shader)
+    :maxVertices(std::max(6, maxVertices)){
+    const std::vector<VertexAttribute> attributes = {VertexAttribute(POSITION, 3, ShaderProgram::POSITION_ATTRIBUTE),
+        VertexAttribute(COLOR_PACKED, 4, GL_UNSIGNED_BYTE, true, ShaderProgram::COLOR_ATTRIBUTE)};
+    const GLenum primitiveTypes[3] = {GL_POINTS, GL_LINES, GL_TRIANGLES};
+    for (int i = 0; i < 3; i++) {
+        batches[i].primitiveType = primitiveTypes[i];
+        batches[i].mesh = std::make_unique<Mesh>(true, false, false, this->maxVertices, 0, VertexAttributes(attributes));
+        batches[i].vertices.reserve((size_t)this->maxVertices * VERTEX_SIZE);
+    }
+
+    GLint viewport[4] = {0, 0, 0, 0};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    projectionMatrix.setToOrtho2D(0, 0, viewport[2], viewport[3]);
+
+    this->shader = shader ? shader : createDefaultShader();
+    projModelViewHandle = this->shader->fetchUniformHandle("u_projModelView");
+}
+
+std::shared_ptr<ShaderProgram> ShapeRenderer::createDefaultShader (){
+    const std::string vertexShader = "attribute vec4 " + ShaderProgram::POSITION_ATTRIBUTE + ";\n"
+        "attribute vec4 " + ShaderProgram::COLOR_ATTRIBUTE + ";\n"
+        "uniform mat4 u_projModelView;\n"
+        "varying vec4 v_col;\n"
+        "void main() {\n"
+        "   gl_Position = u_projModelView * " + ShaderProgram::POSITION_ATTRIBUTE + ";\n"
+        "   v_col = " + ShaderProgram::COLOR_ATTRIBUTE + ";\n"
+        //Packed colors lose the lowest alpha bit, see NumberUtils::intToFloatColor
+        "   v_col.a *= 255.0 / 254.0;\n"
+        "   gl_PointSize = 1.0;\n"
+        "}\n";
+    const std::string fragmentShader = "#ifdef GL_ES\n"
+        "precision mediump float;\n"
+        "#endif\n"
+        "varying vec4 v_col;\n"
+        "void main() {\n"
+        "   gl_FragColor = v_col;\n"
+        "}";
+    std::shared_ptr<ShaderProgram> shader = std::make_shared<ShaderProgram>(vertexShader, fragmentShader, "ShapeRenderer");
+    if (!shader->isCompiled()) SDL_Log("ShapeRenderer: default shader failed to compile");
+    return shader;
+}
+
+void ShapeRenderer::setProjectionMatrix (const Matrix4& matrix){
+    if (drawing) {
+        SDL_Log("ShapeRenderer: Can't set the matrix within begin/end.");
+        return;
+    }
+    projectionMatrix.set(matrix);
+}
+
+void ShapeRenderer::setTransformMatrix (const Matrix4& matrix){
+    if (drawing) {
+        SDL_Log("ShapeRenderer: Can't set the matrix within begin/end.");
+        return;
+    }
+    transformMatrix.set(matrix);
+}
+
+void ShapeRenderer::begin (ShapeType type){
+    if (drawing) {
+        SDL_Log("ShapeRenderer: Call end() before beginning a new shape batch.");
+        return;
+    }
+    shapeType = type;
+    renderCalls = 0;
+    combinedMatrix.set(projectionMatrix).mul(transformMatrix);
+    shader->begin();
+    shader->setUniformMatrix(projModelViewHandle, combinedMatrix);
+    drawing = true;
+}
+
+void ShapeRenderer::end (){
+    if (!drawing) {
+        SDL_Log("ShapeRenderer: begin must be called before end.");
+        return;
+    }
+    flush();
+    shader->end();
+    drawing = false;
+}
+
+void ShapeRenderer::flush (){
+    //Filled shapes first, outlines and points stay visible on top of them
+    flush(getBatch(GL_TRIANGLES));
+    flush(getBatch(GL_LINES));
+    flush(getBatch(GL_POINTS));
+}
+
+void ShapeRenderer::flush (Batch& batch){
+    if (batch.vertices.empty()) return;
+    const int count = batch.vertices.size() / VERTEX_SIZE;
+    //Replacing the whole buffer lets the driver orphan the storage of the previous frame
+    batch.mesh->setVertices(batch.vertices, 0, batch.vertices.size());
+    batch.mesh->render(*shader, batch.primitiveType, 0, count);
+    batch.vertices.clear();
+    renderCalls++;
+}
+
+float* ShapeRenderer::reserve (GLenum primitiveType, int vertexCount){
+    if (!drawing) {
+        SDL_Log("ShapeRenderer: begin must be called before drawing shapes.");
+        return nullptr;
+    }
+    Batch& batch = getBatch(primitiveType);
+    if ((int)batch.vertices.size() / VERTEX_SIZE + vertexCount > maxVertices) flush(batch);
+    const size_t size = batch.vertices.size();
+    batch.vertices.resize(size + (size_t)vertexCount * VERTEX_SIZE);
+    return batch.vertices.data() + size;
+}
+
+void ShapeRenderer::addLine (float x, float y, float z, float x2, float y2, float z2, float color, float color2){
+    float* out = reserve(shapeType == Point ? GL_POINTS : GL_LINES, 2);
+    if (!out) return;
+    out = putVertex(out, x, y, z, color);
+    putVertex(out, x2, y2, z2, color2);
+}
+
+void ShapeRenderer::addTriangle (float x1, float y1, float z1, float x2, float y2, float z2, float x3, float y3, float z3,
+    float color){
+    if (shapeType != Filled) {
+        addLine(x1, y1, z1, x2, y2, z2, color, color);
+        addLine(x2, y2, z2, x3, y3, z3, color, color);
+        addLine(x3, y3, z3, x1, y1, z1, color, color);
+        return;
+    }
+    float* out = reserve(GL_TRIANGLES, 3);
+    if (!out) return;
+    out = putVertex(out, x1, y1, z1, color);
+    out = putVertex(out, x2, y2, z2, color);
+    putVertex(out, x3, y3, z3, color);
+}
+
+void ShapeRenderer::addQuad (const Vector3& corner1, const Vector3& corner2, const Vector3& corner3, const Vector3& corner4){
+    if (shapeType != Filled) {
+        line(corner1, corner2);
+        line(corner2, corner3);
+        line(corner3, corner4);
+        line(corner4, corner1);
+        return;
+    }
+    addTriangle(corner1.x, corner1.y, corner1.z, corner2.x, corner2.y, corner2.z, corner3.x, corner3.y, corner3.z, colorPacked);
+    addTriangle(corner3.x, corner3.y, corner3.z, corner4.x, corner4.y, corner4.z, corner1.x, corner1.y, corner1.z, colorPacked);
+}
+
+void ShapeRenderer::addBox (const Vector3* corners){
+    if (shapeType != Filled) {
+        //The 12 edges join the corners differing in one coordinate
+        for (int corner = 0; corner < 8; corner++)
+            for (int bit = 1; bit < 8; bit <<= 1)
+                if (!(corner & bit)) line(corners[corner], corners[corner | bit]);
+        return;
+    }
+    //The faces at min x, max x, min y, max y, min z and max z
+    addQuad(corners[0], corners[1], corners[3], corners[2]);
+    addQuad(corners[4], corners[6], corners[7], corners[5]);
+    addQuad(corners[0], corners[4], corners[5], corners[1]);
+    addQuad(corners[2], corners[3], corners[7], corners[6]);
+    addQuad(corners[0], corners[2], corners[6], corners[4]);
+    addQuad(corners[1], corners[5], corners[7], corners[3]);
+}
+
+void ShapeRenderer::point (float x, float y, float z){
+    float* out = reserve(GL_POINTS, 1);
+    if (out) putVertex(out, x, y, z, colorPacked);
+}
+
+void ShapeRenderer::curve (float x1, float y1, float cx1, float cy1, float cx2, float cy2, float x2, float y2, int segments){
+    segments = std::max(1, segments);
+    float lastX = x1, lastY = y1;
+    for (int i = 1; i <= segments; i++) {
+        const float t = (float)i / segments, u = 1 - t;
+        const float a = u * u * u, b = 3 * u * u * t, c = 3 * u * t * t, d = t * t * t;
+        const float x = a * x1 + b * cx1 + c * cx2 + d * x2;
+        const float y = a * y1 + b * cy1 + c * cy2 + d * y2;
+        line(lastX, lastY, x, y);
+        lastX = x;
+        lastY = y;
+    }
+}
+
+void ShapeRenderer::triangle (float x1, float y1, float x2, float y2, float x3, float y3){
+    addTriangle(x1, y1, 0, x2, y2, 0, x3, y3, 0, colorPacked);
+}
+
+void ShapeRenderer::rect (float x, float y, float width, float height){
+    addQuad(Vector3(x, y, 0), Vector3(x + width, y, 0), Vector3(x + width, y + height, 0), Vector3(x, y + height, 0));
+}
+
+void ShapeRenderer::rect (float x, float y, float originX, float originY, float width, float height, float scaleX,
+    float scaleY, float degrees){
+    const float cos = MathUtils::cosDeg(degrees), sin = MathUtils::sinDeg(degrees);
+    //The corners relative to the origin, scaled, rotated and moved back
+    const float left = -originX * scaleX, right = (width - originX) * scaleX;
+    const float bottom = -originY * scaleY, top = (height - originY) * scaleY;
+    const float worldOriginX = x + originX, worldOriginY = y + originY;
+    addQuad(Vector3(cos * left - sin * bottom + worldOriginX, sin * left + cos * bottom + worldOriginY, 0),
+        Vector3(cos * right - sin * bottom + worldOriginX, sin * right + cos * bottom + worldOriginY, 0),
+        Vector3(cos * right - sin * top + worldOriginX, sin * right + cos * top + worldOriginY, 0),
+        Vector3(cos * left - sin * top + worldOriginX, sin * left + cos * top + worldOriginY, 0));
+}
+
+void ShapeRenderer::rectLine (float x1, float y1, float x2, float y2, float width){
+    const float length = std::sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+    if (length == 0) return;
+    //Half the width along the normal of the line
+    const float tx = -(y2 - y1) / length * width * 0.5f, ty = (x2 - x1) / length * width * 0.5f;
+    addQuad(Vector3(x1 + tx, y1 + ty, 0), Vector3(x1 - tx, y1 - ty, 0), Vector3(x2 - tx, y2 - ty, 0),
+        Vector3(x2 + tx, y2 + ty, 0));
+}
+
+void ShapeRenderer::box (float x, float y, float z, float width, float height, float depth){
+    const Vector3 corners[8] = {Vector3(x, y, z - depth), Vector3(x, y, z), Vector3(x, y + height, z - depth),
+        Vector3(x, y + height, z), Vector3(x + width, y, z - depth), Vector3(x + width, y, z),
+        Vector3(x + width, y + height, z - depth), Vector3(x + width, y + height, z)};
+    addBox(corners);
+}
+
+void ShapeRenderer::box (const BoundingBox& bounds){
+    const Vector3& min = bounds.min;
+    const Vector3& max = bounds.max;
+    const Vector3 corners[8] = {Vector3(min.x, min.y, min.z), Vector3(min.x, min.y, max.z), Vector3(min.x, max.y, min.z),
+        Vector3(min.x, max.y, max.z), Vector3(max.x, min.y, min.z), Vector3(max.x, min.y, max.z),
+        Vector3(max.x, max.y, min.z), Vector3(max.x, max.y, max.z)};
+    addBox(corners);
+}
+
+void ShapeRenderer::frustum (const Frustum& frustum){
+    const std::vector<Vector3>& points = frustum.planePoints;
+    for (int i = 0; i < 4; i++) {
+        line(points[i], points[(i + 1) % 4]);
+        line(points[i + 4], points[(i + 1) % 4 + 4]);
+        line(points[i], points[i + 4]);
+    }
+}
+
+void ShapeRenderer::ray (const Ray& ray, float length){
+    const Vector3& origin = ray.origin;
+    const Vector3& direction = ray.direction;
+    line(origin.x, origin.y, origin.z, origin.x + direction.x * length, origin.y + direction.y * length,
+        origin.z + direction.z * length);
+}
+
+void ShapeRenderer::plane (const Plane& plane, float size){
+    const Vector3& normal = plane.normal;
+    //The point of the plane closest to the origin and two axes along the plane
+    const float cx = -normal.x * plane.d, cy = -normal.y * plane.d, cz = -normal.z * plane.d;
+    const bool vertical = std::fabs(normal.y) > 0.99f;
+    const float ax = vertical ? 1 : 0, ay = vertical ? 0 : 1;
+    //u = normal x axis, v = normal x u
+    float ux = normal.y * 0 - normal.z * ay, uy = normal.z * ax - normal.x * 0, uz = normal.x * ay - normal.y * ax;
+    const float uLength = std::sqrt(ux * ux + uy * uy + uz * uz);
+    if (uLength == 0) return;
+    const float half = size * 0.5f;
+    ux *= half / uLength;
+    uy *= half / uLength;
+    uz *= half / uLength;
+    const float vx = normal.y * uz - normal.z * uy, vy = normal.z * ux - normal.x * uz, vz = normal.x * uy - normal.y * ux;
+    addQuad(Vector3(cx - ux - vx, cy - uy - vy, cz - uz - vz), Vector3(cx + ux - vx, cy + uy - vy, cz + uz - vz),
+        Vector3(cx + ux + vx, cy + uy + vy, cz + uz + vz), Vector3(cx - ux + vx, cy - uy + vy, cz - uz + vz));
+    line(cx, cy, cz, cx + normal.x * half, cy + normal.y * half, cz + normal.z * half);
+}
+
+void ShapeRenderer::x (float x, float y, float size){
+    line(x - size, y - size, x + size, y + size);
+    line(x - size, y + size, x + size, y - size);
+}
+
+void ShapeRenderer::circle (float x, float y, float radius, int segments){
+    arc(x, y, radius, 0, 360, segments);
+}
+
+void ShapeRenderer::ellipse (float x, float y, float width, float height, int segments){
+    segments = std::max(1, segments);
+    const float angle = 2 * MathUtils::PI / segments;
+    const float cx = x + width * 0.5f, cy = y + height * 0.5f;
+    float lastX = cx + width * 0.5f, lastY = cy;
+    for (int i = 1; i <= segments; i++) {
+        const float nextX = cx + width * 0.5f * std::cos(i * angle), nextY = cy + height * 0.5f * std::sin(i * angle);
+        if (shapeType == Filled) addTriangle(cx, cy, 0, lastX, lastY, 0, nextX, nextY, 0, colorPacked);
+        else line(lastX, lastY, nextX, nextY);
+        lastX = nextX;
+        lastY = nextY;
+    }
+}
+
+void ShapeRenderer::arc (float x, float y, float radius, float start, float degrees, int segments){
+    segments = std::max(1, segments);
+    const bool closed = degrees >= 360;
+    //Rotates the radius by the angle of a segment each step
+    const float theta = 2 * MathUtils::PI * (degrees / 360.0f) / segments;
+    const float cos = std::cos(theta), sin = std::sin(theta);
+    float cx = radius * MathUtils::cosDeg(start), cy = radius * MathUtils::sinDeg(start);
+    if (shapeType != Filled && !closed) line(x, y, x + cx, y + cy);
+    for (int i = 0; i < segments; i++) {
+        const float nextX = cos * cx - sin * cy, nextY = sin * cx + cos * cy;
+        if (shapeType == Filled) addTriangle(x, y, 0, x + cx, y + cy, 0, x + nextX, y + nextY, 0, colorPacked);
+        else line(x + cx, y + cy, x + nextX, y + nextY);
+        cx = nextX;
+        cy = nextY;
+    }
+    if (shapeType != Filled && !closed) line(x + cx, y + cy, x, y);
+}
+
+void ShapeRenderer::polygon (const std::vector<float>& vertices){
+    if (vertices.size() < 6) {
+        SDL_Log("ShapeRenderer: Polygons must contain at least 3 points.");
+        return;
+    }
+    for (size_t i = 0, n = vertices.size() & ~(size_t)1; i < n; i += 2)
+        line(vertices[i], vertices[i + 1], vertices[(i + 2) % n], vertices[(i + 3) % n]);
+}
+
+void ShapeRenderer::polyline (const std::vector<float>& vertices){
+    if (vertices.size() < 4) {
+        SDL_Log("ShapeRenderer: Polylines must contain at least 2 points.");
+        return;
+    }
+    for (size_t i = 0; i + 3 < vertices.size(); i += 2)
+        line(vertices[i], vertices[i + 1], vertices[i + 2], vertices[i + 3]);
+}
@@ -0,0 +1,250 @@
+#pragma once
+#include "../../GL.h"
+#include "../Color.h"
+#include "../Mesh.h"
+#include "ShaderProgram.h"
+#include "../../math/Matrix4.h"
+#include "../../math/Vector2.h"
+#include "../../math/Vector3.h"
+#include "../../math/Plane.h"
+#include "../../math/Frustum.h"
+#include "../../math/collision/BoundingBox.h"
+#include "../../math/collision/Ray.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+/** Renders points, lines, shape outlines and filled shapes, in 2D and 3D, mostly for debugging.
+ * <p>
+ * Shapes are accumulated between {@link #begin()} and {@link #end()} in one vertex array per primitive type (points, lines and
+ * triangles) with packed colors, and each array is uploaded to its own dynamic {@link Mesh} once, at {@link #end()}, then
+ * drawn with a single call: triangles first, then lines, then points. Switching the {@link ShapeType} with {@link #set} costs
+ * nothing, an array only flushes early when it holds maxVertices vertices.
+ * <p>
+ * The shape type decides whether shapes are outlined (Line) or filled (Filled), Point draws the vertices of the outlines as
+ * points. Circles, arcs and ellipses without a segment count get one adapted to their size. The default projection is an
+ * orthographic one of the viewport, use {@link #setProjectionMatrix} with a camera's combined matrix for 3D.
+ * @author mzechner
+ * @author stbachmann
+ * @author Nathan Sweet */
+class ShapeRenderer{
+public:
+    /** Shape types to be used with {@link #begin(ShapeType)}.
+     * @author mzechner, stbachmann */
+    enum ShapeType{
+        Point = GL_POINTS, Line = GL_LINES, Filled = GL_TRIANGLES
+    };
+
+    /** Number of render calls since the last {@link #begin()}. **/
+    int renderCalls = 0;
+private:
+    /** x, y, z and the packed color */
+    static const int VERTEX_SIZE = 4;
+
+    struct Batch{
+        GLenum primitiveType;
+        std::unique_ptr<Mesh> mesh;
+        std::vector<GLfloat> vertices;
+    };
+
+    /** the points, lines and triangles */
+    Batch batches[3];
+    const int maxVertices;
+    ShapeType shapeType = Line;
+    bool drawing = false;
+
+    Matrix4 projectionMatrix;
+    Matrix4 transformMatrix;
+    Matrix4 combinedMatrix;
+
+    std::shared_ptr<ShaderProgram> shader;
+    UniformHandle projModelViewHandle;
+
+    Color color = Color(1, 1, 1, 1);
+    float colorPacked = Color::toFloatBits(1.0f, 1.0f, 1.0f, 1.0f);
+
+    Batch& getBatch (GLenum primitiveType) {
+        return batches[primitiveType == GL_POINTS ? 0 : primitiveType == GL_LINES ? 1 : 2];
+    }
+
+    /** @return where to write the vertices, the batch is flushed first if they do not fit */
+    float* reserve (GLenum primitiveType, int vertexCount);
+
+    void flush (Batch& batch);
+
+    /** Adds the line, or its two points. */
+    void addLine (float x, float y, float z, float x2, float y2, float z2, float color, float color2);
+
+    void addTriangle (float x1, float y1, float z1, float x2, float y2, float z2, float x3, float y3, float z3, float color);
+
+    /** Outlines or fills the quad with the corners in order. */
+    void addQuad (const Vector3& corner1, const Vector3& corner2, const Vector3& corner3, const Vector3& corner4);
+
+    /** Outlines or fills the box with the corners 000, 001, ..., 111 of {@link BoundingBox}. */
+    void addBox (const Vector3* corners);
+
+    static int getSegments (float radius) {
+        return std::max(1, (int)(6 * std::cbrt(radius)));
+    }
+public:
+    /** Creates a renderer holding up to 5000 vertices of each primitive type between flushes. */
+    ShapeRenderer():ShapeRenderer(5000){}
+
+    ShapeRenderer(int maxVertices):ShapeRenderer(maxVertices, nullptr){}
+
+    /** @param shader the shader, nullptr to create one with {@link #createDefaultShader()} */
+    ShapeRenderer(int maxVertices, std::shared_ptr<ShaderProgram> shader);
+
+    ShapeRenderer (const ShapeRenderer&) = delete;
+    ShapeRenderer& operator= (const ShapeRenderer&) = delete;
+
+    /** @return a shader with a_position, a_color and the u_projModelView uniform */
+    static std::shared_ptr<ShaderProgram> createDefaultShader ();
+
+    /** Sets the color to be used by the next shapes drawn. */
+    void setColor (const Color& color) {
+        this->color.set(color);
+        colorPacked = this->color.toFloatBits();
+    }
+
+    void setColor (float r, float g, float b, float a) {
+        color.set(r, g, b, a);
+        colorPacked = color.toFloatBits();
+    }
+
+    const Color& getColor () const {
+        return color;
+    }
+
+    /** Sets the projection matrix to be used for rendering. Usually this will be set to {@link Camera#combined}. */
+    void setProjectionMatrix (const Matrix4& matrix);
+
+    const Matrix4& getProjectionMatrix () const {
+        return projectionMatrix;
+    }
+
+    void setTransformMatrix (const Matrix4& matrix);
+
+    const Matrix4& getTransformMatrix () const {
+        return transformMatrix;
+    }
+
+    /** Starts a new batch of shapes, outlined. */
+    void begin () {
+        begin(Line);
+    }
+
+    /** Starts a new batch of shapes of the type. */
+    void begin (ShapeType type);
+
+    /** Changes the type of the next shapes, the shapes drawn so far are kept. */
+    void set (ShapeType type) {
+        shapeType = type;
+    }
+
+    ShapeType getCurrentType () const {
+        return shapeType;
+    }
+
+    bool isDrawing () const {
+        return drawing;
+    }
+
+    /** Uploads and draws the shapes. */
+    void end ();
+
+    /** Uploads and draws the shapes drawn so far. */
+    void flush ();
+
+    /** Draws a point using {@link ShapeType#Point}, {@link ShapeType#Line} or {@link ShapeType#Filled}. */
+    void point (float x, float y, float z);
+
+    /** Draws a line, or its end points using {@link ShapeType#Point}. */
+    void line (float x, float y, float z, float x2, float y2, float z2) {
+        addLine(x, y, z, x2, y2, z2, colorPacked, colorPacked);
+    }
+
+    void line (const Vector3& v0, const Vector3& v1) {
+        line(v0.x, v0.y, v0.z, v1.x, v1.y, v1.z);
+    }
+
+    void line (float x, float y, float x2, float y2) {
+        line(x, y, 0, x2, y2, 0);
+    }
+
+    void line (const Vector2& v0, const Vector2& v1) {
+        line(v0.x, v0.y, 0, v1.x, v1.y, 0);
+    }
+
+    /** Draws a line whose color goes from c1 to c2. */
+    void line (float x, float y, float z, float x2, float y2, float z2, const Color& c1, const Color& c2) {
+        addLine(x, y, z, x2, y2, z2, Color::toFloatBits(c1.r, c1.g, c1.b, c1.a), Color::toFloatBits(c2.r, c2.g, c2.b, c2.a));
+    }
+
+    /** Draws a curve using {@link ShapeType#Line}. */
+    void curve (float x1, float y1, float cx1, float cy1, float cx2, float cy2, float x2, float y2, int segments);
+
+    /** Draws a triangle in outline ({@link ShapeType#Line}) or filled ({@link ShapeType#Filled}). */
+    void triangle (float x1, float y1, float x2, float y2, float x3, float y3);
+
+    /** Draws a rectangle in the x/y plane using {@link ShapeType#Line} or {@link ShapeType#Filled}. */
+    void rect (float x, float y, float width, float height);
+
+    /** Draws a rectangle in the x/y plane, scaled by scaleX, scaleY and rotated counter clockwise by degrees around originX,
+     * originY. */
+    void rect (float x, float y, float originX, float originY, float width, float height, float scaleX, float scaleY,
+        float degrees);
+
+    /** Draws a line as a rectangle of the width using {@link ShapeType#Line} or {@link ShapeType#Filled}. */
+    void rectLine (float x1, float y1, float x2, float y2, float width);
+
+    /** Draws a cube using {@link ShapeType#Line} or {@link ShapeType#Filled}. The x, y and z specify the bottom, left, front
+     * corner of the box, the depth goes towards negative z. */
+    void box (float x, float y, float z, float width, float height, float depth);
+
+    /** Draws the bounds. */
+    void box (const BoundingBox& bounds);
+
+    /** Draws the near and far rectangles of the frustum and the edges joining them. */
+    void frustum (const Frustum& frustum);
+
+    /** Draws the ray from its origin up to the length. */
+    void ray (const Ray& ray, float length);
+
+    /** Draws a square of the size on the plane, centered on the point of the plane closest to the origin, and its normal. */
+    void plane (const Plane& plane, float size);
+
+    /** Draws a cross of the size centered on the point. */
+    void x (float x, float y, float size);
+
+    /** Calls {@link #circle(float, float, float, int)} with a number of segments adapted to the radius. */
+    void circle (float x, float y, float radius) {
+        circle(x, y, radius, getSegments(radius));
+    }
+
+    /** Draws a circle in the x/y plane using {@link ShapeType#Line} or {@link ShapeType#Filled}. */
+    void circle (float x, float y, float radius, int segments);
+
+    /** Calls {@link #ellipse(float, float, float, float, int)} with a number of segments adapted to the size. */
+    void ellipse (float x, float y, float width, float height) {
+        ellipse(x, y, width, height, getSegments(std::max(width, height) * 0.5f));
+    }
+
+    /** Draws an ellipse in the x/y plane, x, y being its bottom left corner. */
+    void ellipse (float x, float y, float width, float height, int segments);
+
+    /** Calls {@link #arc(float, float, float, float, float, int)} with a number of segments adapted to the radius. */
+    void arc (float x, float y, float radius, float start, float degrees) {
+        arc(x, y, radius, start, degrees, std::max(1, (int)(getSegments(radius) * degrees / 360.0f)));
+    }
+
+    /** Draws an arc using {@link ShapeType#Line} or {@link ShapeType#Filled}, from start counter clockwise, in degrees. */
+    void arc (float x, float y, float radius, float start, float degrees, int segments);
+
+    /** Draws a closed polygon, x and y pairs, using {@link ShapeType#Line}. */
+    void polygon (const std::vector<float>& vertices);
+
+    /** Draws a polyline, x and y pairs, using {@link ShapeType#Line}. */
+    void polyline (const std::vector<float>& vertices);
+};
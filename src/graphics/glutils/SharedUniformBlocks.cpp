@@ -0,0 +1,140 @@
+#include "SharedUniformBlocks.h"
+
+const std::string SharedUniformBlocks::CAMERA_BLOCK =
+    "layout(std140) uniform CameraBlock {\n"
+    "    mat4 u_projTrans;\n"
+    "    mat4 u_projection;\n"
+    "    mat4 u_view;\n"
+    "    vec4 u_cameraPosition;\n"
+    "    vec4 u_cameraDirection;\n"
+    "    vec4 u_viewport;\n"
+    "};\n";
+
+const std::string SharedUniformBlocks::LIGHTS_BLOCK =
+    "layout(std140) uniform LightsBlock {\n"
+    "    vec4 u_ambientLight;\n"
+    "    ivec4 u_lightCounts;\n"
+    "    vec4 u_dirLights[" + std::to_string(MAX_DIRECTIONAL_LIGHTS * 2) + "];\n"
+    "    vec4 u_pointLights[" + std::to_string(MAX_POINT_LIGHTS * 2) + "];\n"
+    "};\n";
+
+const std::string SharedUniformBlocks::FRAME_BLOCK =
+    "layout(std140) uniform FrameBlock {\n"
+    "    vec4 u_time;\n"
+    "};\n";
+
+const std::string SharedUniformBlocks::OBJECT_BLOCK =
+    "layout(std140) uniform ObjectBlock {\n"
+    "    mat4 u_worldTrans;\n"
+    "    mat3 u_normalMatrix;\n"
+    "};\n";
+
+//Block sizes in bytes, matching the declarations above.
+static const int CAMERA_BLOCK_SIZE = 3 * 64 + 3 * 16;
+static const int LIGHTS_BLOCK_SIZE = 2 * 16 + (SharedUniformBlocks::MAX_DIRECTIONAL_LIGHTS + SharedUniformBlocks::MAX_POINT_LIGHTS) * 32;
+static const int FRAME_BLOCK_SIZE = 16;
+
+SharedUniformBlocks::SharedUniformBlocks(int objectRingSize):
+        cameraBuffer(CAMERA_BLOCK_SIZE, false),lightsBuffer(LIGHTS_BLOCK_SIZE, false),frameBuffer(FRAME_BLOCK_SIZE, false),
+        objectRing(objectRingSize){
+    ShaderProgram::setUniformBlockBinding("CameraBlock", CAMERA_BINDING);
+    ShaderProgram::setUniformBlockBinding("LightsBlock", LIGHTS_BINDING);
+    ShaderProgram::setUniformBlockBinding("FrameBlock", FRAME_BINDING);
+    ShaderProgram::setUniformBlockBinding("ObjectBlock", OBJECT_BINDING);
+}
+
+void SharedUniformBlocks::setCamera (const Camera& camera){
+    projection.set(camera.projection);
+    view.set(camera.view);
+    combined.set(camera.combined);
+    cameraPosition.set(camera.position);
+    cameraDirection.set(camera.direction);
+    viewport[0] = camera.viewportWidth;
+    viewport[1] = camera.viewportHeight;
+    viewport[2] = camera.near;
+    viewport[3] = camera.far;
+    cameraDirty = true;
+}
+
+void SharedUniformBlocks::clearLights (){
+    directionalDirections.clear();
+    directionalColors.clear();
+    pointPositions.clear();
+    pointColors.clear();
+    pointIntensities.clear();
+    lightsDirty = true;
+}
+
+bool SharedUniformBlocks::addDirectionalLight (const Color& color, const Vector3& direction){
+    if (directionalColors.size() >= MAX_DIRECTIONAL_LIGHTS) return false;
+    directionalColors.push_back(color);
+    directionalDirections.push_back(direction);
+    lightsDirty = true;
+    return true;
+}
+
+bool SharedUniformBlocks::addPointLight (const Color& color, const Vector3& position, float intensity){
+    if (pointColors.size() >= MAX_POINT_LIGHTS) return false;
+    pointColors.push_back(color);
+    pointPositions.push_back(position);
+    pointIntensities.push_back(intensity);
+    lightsDirty = true;
+    return true;
+}
+
+void SharedUniformBlocks::update (){
+    if (cameraDirty) {
+        writer.reset()
+            .putMatrix4(combined)
+            .putMatrix4(projection)
+            .putMatrix4(view)
+            .putVector4(cameraPosition.x, cameraPosition.y, cameraPosition.z, 1)
+            .putVector4(cameraDirection.x, cameraDirection.y, cameraDirection.z, 0)
+            .putVector4(viewport[0], viewport[1], viewport[2], viewport[3]);
+        cameraBuffer.setData(writer.bytes(), writer.size());
+        cameraDirty = false;
+    }
+
+    if (lightsDirty) {
+        writer.reset()
+            .putColor(ambientLight)
+            .putInt(directionalColors.size()).putInt(pointColors.size()).putInt(0).putInt(0);
+        for (int i = 0; i < directionalColors.size(); i++) {
+            const Vector3& direction = directionalDirections[i];
+            writer.putVector4(direction.x, direction.y, direction.z, 0).putColor(directionalColors[i]);
+        }
+        writer.padTo(2 * 16 + MAX_DIRECTIONAL_LIGHTS * 32);
+        for (int i = 0; i < pointColors.size(); i++) {
+            const Vector3& position = pointPositions[i];
+            writer.putVector4(position.x, position.y, position.z, pointIntensities[i]).putColor(pointColors[i]);
+        }
+        writer.padTo(LIGHTS_BLOCK_SIZE);
+        lightsBuffer.setData(writer.bytes(), writer.size());
+        lightsDirty = false;
+    }
+
+    writer.reset().putVector4(time, deltaTime, frameIndex, 0);
+    frameBuffer.setData(writer.bytes(), writer.size());
+
+    cameraBuffer.bindBase(CAMERA_BINDING);
+    lightsBuffer.bindBase(LIGHTS_BINDING);
+    frameBuffer.bindBase(FRAME_BINDING);
+}
+
+void SharedUniformBlocks::setObject (const Matrix4& worldTransform){
+    //Normal matrix: inverse transpose of the upper 3x3, which is the cofactor matrix divided by the determinant.
+    const std::vector<float>& m = worldTransform.val;
+    float a = m[Matrix4::M00], b = m[Matrix4::M01], c = m[Matrix4::M02];
+    float d = m[Matrix4::M10], e = m[Matrix4::M11], f = m[Matrix4::M12];
+    float g = m[Matrix4::M20], h = m[Matrix4::M21], i = m[Matrix4::M22];
+    float c00 = e * i - f * h, c01 = f * g - d * i, c02 = d * h - e * g;
+    float det = a * c00 + b * c01 + c * c02;
+    float invDet = det != 0 ? 1.0f / det : 0.0f;
+
+    //std140 stores a mat3 as three vec4 columns; column j of the result is row j of the inverse.
+    writer.reset().putMatrix4(worldTransform)
+        .putVector4(c00 * invDet, (c * h - b * i) * invDet, (b * f - c * e) * invDet, 0)
+        .putVector4(c01 * invDet, (a * i - c * g) * invDet, (c * d - a * f) * invDet, 0)
+        .putVector4(c02 * invDet, (b * g - a * h) * invDet, (a * e - b * d) * invDet, 0);
+    objectRing.push(OBJECT_BINDING, writer);
+}
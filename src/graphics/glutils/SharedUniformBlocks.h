@@ -0,0 +1,89 @@
+#pragma once
+#include "UniformBuffer.h"
+#include "ShaderProgram.h"
+#include "../../Camera.h"
+#include <string>
+
+/** The uniform blocks shared by every {@link ShaderProgram}: camera, lights and per-frame data are kept in uniform buffers bound to
+ * fixed binding points, written once per frame and read by all programs without any per-program upload. Object data, which
+ * changes per draw, goes through a {@link UniformBufferRing} bound to {@link #OBJECT_BINDING}.
+ * <p>
+ * Declare the blocks in the shaders with the GLSL snippets below, e.g. by appending them to
+ * {@link ShaderProgram#prependVertexCode} after the #version line. Constructing an instance registers the binding points, so
+ * programs linked afterwards pick them up automatically.
+ * <p>
+ * Requires OpenGL ES 3.0 or OpenGL 3.1. */
+class SharedUniformBlocks{
+    UniformBuffer cameraBuffer, lightsBuffer, frameBuffer;
+    UniformBufferRing objectRing;
+    Std140Writer writer;
+
+    Matrix4 projection, view, combined;
+    Vector3 cameraPosition, cameraDirection;
+    float viewport[4] = {0, 0, 0, 0};
+    bool cameraDirty = true;
+
+    Color ambientLight = Color(0, 0, 0, 1);
+    std::vector<Vector3> directionalDirections, pointPositions;
+    std::vector<Color> directionalColors, pointColors;
+    std::vector<float> pointIntensities;
+    bool lightsDirty = true;
+
+    float time = 0, deltaTime = 0;
+    int frameIndex = 0;
+public:
+    static const int CAMERA_BINDING = 0;
+    static const int LIGHTS_BINDING = 1;
+    static const int FRAME_BINDING = 2;
+    static const int OBJECT_BINDING = 3;
+
+    static const int MAX_DIRECTIONAL_LIGHTS = 4;
+    static const int MAX_POINT_LIGHTS = 8;
+
+    /** GLSL declaration of the camera block: u_projTrans (the combined matrix), u_projection, u_view, u_cameraPosition,
+     * u_cameraDirection and u_viewport (width, height, near, far). */
+    static const std::string CAMERA_BLOCK;
+    /** GLSL declaration of the lights block: u_ambientLight, u_lightCounts (directional, point), u_dirLights[] as (direction,
+     * color) pairs and u_pointLights[] as (position, color) pairs, the point light intensity is stored in the position's w. */
+    static const std::string LIGHTS_BLOCK;
+    /** GLSL declaration of the frame block: u_time (seconds, delta, frame index). */
+    static const std::string FRAME_BLOCK;
+    /** GLSL declaration of the per-draw object block: u_worldTrans and u_normalMatrix. */
+    static const std::string OBJECT_BLOCK;
+
+    /** @param objectRingSize capacity of the per-draw ring in bytes, should hold a frame worth of {@link #setObject} calls */
+    SharedUniformBlocks(int objectRingSize);
+    SharedUniformBlocks():SharedUniformBlocks(256 * 1024){}
+
+    /** Takes the matrices and position of the camera, call after {@link Camera#update()}. */
+    void setCamera (const Camera& camera);
+
+    void setAmbientLight (const Color& color) {
+        ambientLight.set(color);
+        lightsDirty = true;
+    }
+
+    /** Removes all directional and point lights. */
+    void clearLights ();
+
+    /** @return false if {@link #MAX_DIRECTIONAL_LIGHTS} are already set */
+    bool addDirectionalLight (const Color& color, const Vector3& direction);
+
+    /** @return false if {@link #MAX_POINT_LIGHTS} are already set */
+    bool addPointLight (const Color& color, const Vector3& position, float intensity);
+
+    /** Advances the frame data, call once per frame. */
+    void setFrame (float time, float deltaTime) {
+        this->time = time;
+        this->deltaTime = deltaTime;
+        frameIndex++;
+    }
+
+    /** Uploads the blocks that changed since the last call and binds the buffers to their binding points. Call once per frame,
+     * after setting camera, lights and frame and before the first draw. */
+    void update ();
+
+    /** Writes the per-draw object data into the ring and binds it to {@link #OBJECT_BINDING}, call right before the draw.
+     * @param worldTransform the world transform of the object, the normal matrix is derived from it */
+    void setObject (const Matrix4& worldTransform);
+};
@@ -0,0 +1,278 @@
+#include "../../GL.h"
+#include "TextureDecoder.h"
+#include "CompressedTextureData.h"
+#include <algorithm>
+#include <cstring>
+
+static const int ETC_MODIFIERS[8][4] = {
+    {2, 8, -2, -8}, {5, 17, -5, -17}, {9, 29, -9, -29}, {13, 42, -13, -42},
+    {18, 60, -18, -60}, {24, 80, -24, -80}, {33, 106, -33, -106}, {47, 183, -47, -183}
+};
+
+static const int ETC_DISTANCES[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+static const int EAC_MODIFIERS[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12}, {-3, -6, -8, -12, 2, 5, 7, 11}, {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10}, {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9}, {-2, -4, -8, -10, 1, 3, 7, 9}, {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9}, {-1, -2, -3, -10, 0, 1, 2, 9}, {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8}
+};
+
+static inline unsigned char clampByte (int value) {
+    return (unsigned char)std::min(255, std::max(0, value));
+}
+
+static inline int extend4 (int value) {return value * 17;}
+static inline int extend5 (int value) {return (value << 3) | (value >> 2);}
+static inline int extend6 (int value) {return (value << 2) | (value >> 4);}
+static inline int extend7 (int value) {return (value << 1) | (value >> 6);}
+
+static inline int signed3 (int value) {
+    return value >= 4 ? value - 8 : value;
+}
+
+static inline void setTexel (unsigned char* out, int x, int y, int r, int g, int b, int a) {
+    unsigned char* texel = out + (y * 4 + x) * 4;
+    texel[0] = clampByte(r);
+    texel[1] = clampByte(g);
+    texel[2] = clampByte(b);
+    texel[3] = clampByte(a);
+}
+
+void TextureDecoder::decodeBC1Block (const unsigned char* block, unsigned char* out, bool fourColors){
+    const int c0 = block[0] | (block[1] << 8), c1 = block[2] | (block[3] << 8);
+    int colors[4][4] = {
+        {extend5(c0 >> 11), extend6((c0 >> 5) & 63), extend5(c0 & 31), 255},
+        {extend5(c1 >> 11), extend6((c1 >> 5) & 63), extend5(c1 & 31), 255}
+    };
+    for (int c = 0; c < 3; c++) {
+        if (fourColors || c0 > c1) {
+            colors[2][c] = (2 * colors[0][c] + colors[1][c] + 1) / 3;
+            colors[3][c] = (colors[0][c] + 2 * colors[1][c] + 1) / 3;
+        } else {
+            colors[2][c] = (colors[0][c] + colors[1][c]) / 2;
+            colors[3][c] = 0;
+        }
+    }
+    colors[2][3] = 255;
+    colors[3][3] = (fourColors || c0 > c1) ? 255 : 0;
+
+    const Uint32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((Uint32)block[7] << 24);
+    for (int i = 0; i < 16; i++) {
+        const int* color = colors[(indices >> (2 * i)) & 3];
+        setTexel(out, i & 3, i >> 2, color[0], color[1], color[2], color[3]);
+    }
+}
+
+void TextureDecoder::decodeBC4Block (const unsigned char* block, unsigned char* out, int channel){
+    int values[8] = {block[0], block[1]};
+    if (values[0] > values[1]) {
+        for (int k = 1; k < 7; k++) values[k + 1] = ((7 - k) * values[0] + k * values[1] + 3) / 7;
+    } else {
+        for (int k = 1; k < 5; k++) values[k + 1] = ((5 - k) * values[0] + k * values[1] + 2) / 5;
+        values[6] = 0;
+        values[7] = 255;
+    }
+    Uint64 indices = 0;
+    for (int i = 0; i < 6; i++) indices |= (Uint64)block[2 + i] << (8 * i);
+    for (int i = 0; i < 16; i++)
+        out[i * 4 + channel] = values[(indices >> (3 * i)) & 7];
+}
+
+void TextureDecoder::decodeETC2Block (const unsigned char* block, unsigned char* out, bool etc1, bool punchthrough){
+    Uint64 v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | block[i];
+    //Punchthrough blocks have no individual mode, the bit tells whether the block is opaque instead
+    const bool differential = punchthrough || ((v >> 33) & 1);
+    const bool opaque = !punchthrough || ((v >> 33) & 1);
+
+    int base[2][3];
+    if (!differential) {
+        base[0][0] = extend4((v >> 60) & 15); base[1][0] = extend4((v >> 56) & 15);
+        base[0][1] = extend4((v >> 52) & 15); base[1][1] = extend4((v >> 48) & 15);
+        base[0][2] = extend4((v >> 44) & 15); base[1][2] = extend4((v >> 40) & 15);
+    } else {
+        const int r = (v >> 59) & 31, g = (v >> 51) & 31, b = (v >> 43) & 31;
+        const int r2 = r + signed3((v >> 56) & 7), g2 = g + signed3((v >> 48) & 7), b2 = b + signed3((v >> 40) & 7);
+        if (!etc1 && (r2 < 0 || r2 > 31)) {
+            //T mode
+            int paint[4][3];
+            const int c1[3] = {extend4((int)(((v >> 59) & 3) << 2 | ((v >> 56) & 3))), extend4((v >> 52) & 15), extend4((v >> 48) & 15)};
+            const int c2[3] = {extend4((v >> 44) & 15), extend4((v >> 40) & 15), extend4((v >> 36) & 15)};
+            const int distance = ETC_DISTANCES[((v >> 34) & 3) << 1 | ((v >> 32) & 1)];
+            for (int c = 0; c < 3; c++) {
+                paint[0][c] = c1[c];
+                paint[1][c] = c2[c] + distance;
+                paint[2][c] = c2[c];
+                paint[3][c] = c2[c] - distance;
+            }
+            for (int i = 0; i < 16; i++) {
+                const int index = (int)(((v >> (16 + i)) & 1) << 1 | ((v >> i) & 1));
+                if (!opaque && index == 2) setTexel(out, i >> 2, i & 3, 0, 0, 0, 0);
+                else setTexel(out, i >> 2, i & 3, paint[index][0], paint[index][1], paint[index][2], 255);
+            }
+            return;
+        }
+        if (!etc1 && (g2 < 0 || g2 > 31)) {
+            //H mode
+            const int r1 = (v >> 59) & 15, g1 = (int)(((v >> 56) & 7) << 1 | ((v >> 52) & 1));
+            const int b1 = (int)(((v >> 51) & 1) << 3 | ((v >> 48) & 3) << 1 | ((v >> 47) & 1));
+            const int rh2 = (v >> 43) & 15, gh2 = (v >> 39) & 15, bh2 = (v >> 35) & 15;
+            const int ordering = ((r1 << 8) | (g1 << 4) | b1) >= ((rh2 << 8) | (gh2 << 4) | bh2) ? 1 : 0;
+            const int distance = ETC_DISTANCES[((v >> 34) & 1) << 2 | ((v >> 32) & 1) << 1 | ordering];
+            const int c1[3] = {extend4(r1), extend4(g1), extend4(b1)};
+            const int c2[3] = {extend4(rh2), extend4(gh2), extend4(bh2)};
+            int paint[4][3];
+            for (int c = 0; c < 3; c++) {
+                paint[0][c] = c1[c] + distance;
+                paint[1][c] = c1[c] - distance;
+                paint[2][c] = c2[c] + distance;
+                paint[3][c] = c2[c] - distance;
+            }
+            for (int i = 0; i < 16; i++) {
+                const int index = (int)(((v >> (16 + i)) & 1) << 1 | ((v >> i) & 1));
+                if (!opaque && index == 2) setTexel(out, i >> 2, i & 3, 0, 0, 0, 0);
+                else setTexel(out, i >> 2, i & 3, paint[index][0], paint[index][1], paint[index][2], 255);
+            }
+            return;
+        }
+        if (!etc1 && (b2 < 0 || b2 > 31)) {
+            //Planar mode
+            const int o[3] = {extend6((v >> 57) & 63), extend7((int)(((v >> 56) & 1) << 6 | ((v >> 49) & 63))),
+                extend6((int)(((v >> 48) & 1) << 5 | ((v >> 43) & 3) << 3 | ((v >> 39) & 7)))};
+            const int h[3] = {extend6((int)(((v >> 34) & 31) << 1 | ((v >> 32) & 1))), extend7((v >> 25) & 127),
+                extend6((v >> 19) & 63)};
+            const int vertical[3] = {extend6((v >> 13) & 63), extend7((v >> 6) & 127), extend6(v & 63)};
+            for (int y = 0; y < 4; y++)
+                for (int x = 0; x < 4; x++) {
+                    int color[3];
+                    for (int c = 0; c < 3; c++)
+                        color[c] = (x * (h[c] - o[c]) + y * (vertical[c] - o[c]) + 4 * o[c] + 2) >> 2;
+                    setTexel(out, x, y, color[0], color[1], color[2], 255);
+                }
+            return;
+        }
+        base[0][0] = extend5(r); base[1][0] = extend5(r2);
+        base[0][1] = extend5(g); base[1][1] = extend5(g2);
+        base[0][2] = extend5(b); base[1][2] = extend5(b2);
+    }
+
+    const int tables[2] = {(int)((v >> 37) & 7), (int)((v >> 34) & 7)};
+    const bool flip = (v >> 32) & 1;
+    for (int i = 0; i < 16; i++) {
+        const int x = i >> 2, y = i & 3;
+        const int sub = flip ? (y >= 2) : (x >= 2);
+        const int index = (int)(((v >> (16 + i)) & 1) << 1 | ((v >> i) & 1));
+        if (!opaque && index == 2) {
+            setTexel(out, x, y, 0, 0, 0, 0);
+            continue;
+        }
+        const int modifier = (!opaque && index == 0) ? 0 : ETC_MODIFIERS[tables[sub]][index];
+        setTexel(out, x, y, base[sub][0] + modifier, base[sub][1] + modifier, base[sub][2] + modifier, 255);
+    }
+}
+
+void TextureDecoder::decodeEACBlock (const unsigned char* block, unsigned char* out, int channel, bool elevenBit){
+    const int base = block[0], multiplier = block[1] >> 4;
+    const int* modifiers = EAC_MODIFIERS[block[1] & 15];
+    Uint64 indices = 0;
+    for (int i = 2; i < 8; i++) indices = (indices << 8) | block[i];
+    for (int i = 0; i < 16; i++) {
+        const int modifier = modifiers[(indices >> (45 - 3 * i)) & 7];
+        int value;
+        if (elevenBit) {
+            const int value11 = std::min(2047, std::max(0, base * 8 + 4 + (multiplier == 0 ? modifier : modifier * multiplier * 8)));
+            value = (value11 * 255 + 1023) / 2047;
+        } else value = base + modifier * multiplier;
+        //EAC texels are ordered by columns like ETC
+        out[((i & 3) * 4 + (i >> 2)) * 4 + channel] = clampByte(value);
+    }
+}
+
+bool TextureDecoder::canDecode (GLenum internalFormat){
+    switch (internalFormat) {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RED_RGTC1: case GL_COMPRESSED_RG_RGTC2:
+    case GL_ETC1_RGB8_OES: case GL_COMPRESSED_RGB8_ETC2: case GL_COMPRESSED_SRGB8_ETC2:
+    case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2: case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+    case GL_COMPRESSED_RGBA8_ETC2_EAC: case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+    case GL_COMPRESSED_R11_EAC: case GL_COMPRESSED_RG11_EAC:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool TextureDecoder::decode (GLenum internalFormat, const unsigned char* data, size_t size, int width, int height,
+    std::vector<unsigned char>& rgba){
+    int blockWidth, blockHeight, blockBytes;
+    if (!canDecode(internalFormat) || !CompressedTextureData::getBlockSize(internalFormat, blockWidth, blockHeight, blockBytes))
+        return false;
+    if (size < CompressedTextureData::getLevelSize(internalFormat, width, height)) return false;
+
+    rgba.resize((size_t)width * height * 4);
+    unsigned char texels[64];
+    const int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++, data += blockBytes) {
+            for (int i = 0; i < 16; i++) {
+                texels[i * 4] = texels[i * 4 + 1] = texels[i * 4 + 2] = 0;
+                texels[i * 4 + 3] = 255;
+            }
+            switch (internalFormat) {
+            case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+                decodeBC1Block(data, texels, false);
+                for (int i = 0; i < 16; i++) texels[i * 4 + 3] = 255;
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+                decodeBC1Block(data, texels, false);
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+                decodeBC1Block(data + 8, texels, true);
+                for (int i = 0; i < 16; i++) texels[i * 4 + 3] = ((data[i / 2] >> (4 * (i & 1))) & 15) * 17;
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+                decodeBC1Block(data + 8, texels, true);
+                decodeBC4Block(data, texels, 3);
+                break;
+            case GL_COMPRESSED_RED_RGTC1:
+                decodeBC4Block(data, texels, 0);
+                break;
+            case GL_COMPRESSED_RG_RGTC2:
+                decodeBC4Block(data, texels, 0);
+                decodeBC4Block(data + 8, texels, 1);
+                break;
+            case GL_ETC1_RGB8_OES:
+                decodeETC2Block(data, texels, true, false);
+                break;
+            case GL_COMPRESSED_RGB8_ETC2: case GL_COMPRESSED_SRGB8_ETC2:
+                decodeETC2Block(data, texels, false, false);
+                break;
+            case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2: case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+                decodeETC2Block(data, texels, false, true);
+                break;
+            case GL_COMPRESSED_RGBA8_ETC2_EAC: case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+                decodeETC2Block(data + 8, texels, false, false);
+                decodeEACBlock(data, texels, 3, false);
+                break;
+            case GL_COMPRESSED_R11_EAC:
+                decodeEACBlock(data, texels, 0, true);
+                break;
+            case GL_COMPRESSED_RG11_EAC:
+                decodeEACBlock(data, texels, 0, true);
+                decodeEACBlock(data + 8, texels, 1, true);
+                break;
+            }
+
+            const int copyWidth = std::min(4, width - bx * 4), copyHeight = std::min(4, height - by * 4);
+            for (int y = 0; y < copyHeight; y++)
+                memcpy(rgba.data() + ((size_t)(by * 4 + y) * width + bx * 4) * 4, texels + y * 16, copyWidth * 4);
+        }
+    }
+    return true;
+}
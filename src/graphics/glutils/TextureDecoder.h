@@ -0,0 +1,23 @@
+#pragma once
+#include "../../GL.h"
+#include <vector>
+
+/** Decodes block compressed texture data to RGBA8 on the CPU, the fallback for formats the driver doesn't support. Handles BC1
+ * to BC5 (S3TC and RGTC, unsigned), ETC1, ETC2 RGB, RGBA and punchthrough alpha, and unsigned EAC R11/RG11. BC6H, BC7 and ASTC
+ * can't be decoded. Needs no GL context. */
+class TextureDecoder{
+    static void decodeBC1Block (const unsigned char* block, unsigned char* out, bool fourColors);
+    static void decodeBC4Block (const unsigned char* block, unsigned char* out, int channel);
+    static void decodeETC2Block (const unsigned char* block, unsigned char* out, bool etc1, bool punchthrough);
+    static void decodeEACBlock (const unsigned char* block, unsigned char* out, int channel, bool elevenBit);
+public:
+    /** @return whether the format can be decoded */
+    static bool canDecode (GLenum internalFormat);
+
+    /** Decodes one level.
+     * @param data the compressed level, as large as {@link CompressedTextureData#getLevelSize}
+     * @param rgba receives width * height RGBA8 texels, rows tightly packed
+     * @return false if the format can't be decoded or the data is too short */
+    static bool decode (GLenum internalFormat, const unsigned char* data, size_t size, int width, int height,
+        std::vector<unsigned char>& rgba);
+};
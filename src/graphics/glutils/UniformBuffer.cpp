@@ -0,0 +1,86 @@
+#include "UniformBuffer.h"
+
+UniformBuffer::UniformBuffer(int size, bool isStatic){
+    this->size = size;
+    usage = isStatic ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
+    glGenBuffers(1, &handle);
+    glBindBuffer(GL_UNIFORM_BUFFER, handle);
+    glBufferData(GL_UNIFORM_BUFFER, size, NULL, usage);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+UniformBuffer::~UniformBuffer(){
+    if (handle != 0) {
+        glDeleteBuffers(1, &handle);
+        handle = 0;
+    }
+}
+
+void UniformBuffer::orphan (){
+    glBindBuffer(GL_UNIFORM_BUFFER, handle);
+    glBufferData(GL_UNIFORM_BUFFER, size, NULL, usage);
+}
+
+void UniformBuffer::setData (const void* data, int bytes){
+    if (bytes > size) {
+        SDL_Log("UniformBuffer: %i bytes exceed the capacity of %i bytes", bytes, size);
+        bytes = size;
+    }
+    orphan();
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, bytes, data);
+}
+
+void UniformBuffer::setSubData (int offset, const void* data, int bytes){
+    if (offset + bytes > size) {
+        SDL_Log("UniformBuffer: write of %i bytes at %i exceeds the capacity of %i bytes", bytes, offset, size);
+        return;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, handle);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, bytes, data);
+}
+
+void UniformBuffer::bindBase (int binding){
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, handle);
+}
+
+void UniformBuffer::bindRange (int binding, int offset, int bytes){
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, handle, offset, bytes);
+}
+
+int UniformBuffer::getOffsetAlignment (){
+    static int alignment = 0;
+    if (alignment == 0) {
+        GLint value = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &value);
+        alignment = value > 0 ? value : 256;
+    }
+    return alignment;
+}
+
+UniformBufferRing::UniformBufferRing(int size):buffer(size, false){
+    alignment = UniformBuffer::getOffsetAlignment();
+}
+
+int UniformBufferRing::push (int binding, const void* data, int bytes){
+    if (bytes > buffer.getSize()) {
+        SDL_Log("UniformBufferRing: %i bytes exceed the capacity of %i bytes", bytes, buffer.getSize());
+        return -1;
+    }
+    int offset = (head + alignment - 1) / alignment * alignment;
+    if (offset + bytes > buffer.getSize()) {
+        buffer.orphan();
+        offset = 0;
+    } else glBindBuffer(GL_UNIFORM_BUFFER, buffer.getHandle());
+
+    //The range was never handed to a draw since the last orphan, no need to synchronize.
+    void* target = glMapBufferRange(GL_UNIFORM_BUFFER, offset, bytes,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (target != NULL) {
+        memcpy(target, data, bytes);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+    } else glBufferSubData(GL_UNIFORM_BUFFER, offset, bytes, data);
+
+    head = offset + bytes;
+    buffer.bindRange(binding, offset, bytes);
+    return offset;
+}
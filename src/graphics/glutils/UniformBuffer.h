@@ -0,0 +1,209 @@
+#pragma once
+#include "../../GL.h"
+#include "../Color.h"
+#include "../../math/Vector2.h"
+#include "../../math/Vector3.h"
+#include "../../math/Matrix3.h"
+#include "../../math/Matrix4.h"
+#include <vector>
+#include <cstring>
+
+/** Writes values into a byte buffer following the std140 layout rules, so the result can be uploaded as is to a
+ * <code>layout(std140)</code> uniform block. Scalars align to 4 bytes, vec2 to 8, vec3 and vec4 to 16 (a vec3 only occupies 12
+ * bytes, so a following float packs into its last slot), matrices are stored as vec4 columns and every array element is padded
+ * to a 16 byte stride. Call {@link #put} in the same order as the members are declared in the block. */
+class Std140Writer{
+    std::vector<unsigned char> data;
+    int position = 0;
+
+    unsigned char* reserve (int alignment, int size) {
+        position = (position + alignment - 1) & ~(alignment - 1);
+        if (position + size > data.size()) data.resize(position + size);
+        unsigned char* out = data.data() + position;
+        position += size;
+        return out;
+    }
+public:
+    Std140Writer(){}
+
+    /** Starts over, keeping the allocated storage. */
+    Std140Writer& reset () {
+        position = 0;
+        data.clear();
+        return *this;
+    }
+
+    /** Pads to the next 16 byte boundary, as required before and after a struct member. */
+    Std140Writer& align () {
+        position = (position + 15) & ~15;
+        if (position > data.size()) data.resize(position);
+        return *this;
+    }
+
+    Std140Writer& putFloat (float value) {
+        memcpy(reserve(4, 4), &value, 4);
+        return *this;
+    }
+
+    Std140Writer& putInt (int value) {
+        memcpy(reserve(4, 4), &value, 4);
+        return *this;
+    }
+
+    Std140Writer& putVector2 (float x, float y) {
+        const float values[] = {x, y};
+        memcpy(reserve(8, 8), values, 8);
+        return *this;
+    }
+
+    Std140Writer& putVector2 (const Vector2& value) {
+        return putVector2(value.x, value.y);
+    }
+
+    Std140Writer& putVector3 (float x, float y, float z) {
+        const float values[] = {x, y, z};
+        memcpy(reserve(16, 12), values, 12);
+        return *this;
+    }
+
+    Std140Writer& putVector3 (const Vector3& value) {
+        return putVector3(value.x, value.y, value.z);
+    }
+
+    Std140Writer& putVector4 (float x, float y, float z, float w) {
+        const float values[] = {x, y, z, w};
+        memcpy(reserve(16, 16), values, 16);
+        return *this;
+    }
+
+    /** Writes the color as a vec4 (r, g, b, a). */
+    Std140Writer& putColor (const Color& color) {
+        return putVector4(color.r, color.g, color.b, color.a);
+    }
+
+    Std140Writer& putMatrix4 (const Matrix4& matrix) {
+        memcpy(reserve(16, 64), matrix.val.data(), 64);
+        return *this;
+    }
+
+    /** Writes the matrix as a mat3, which std140 stores as three vec4 columns. */
+    Std140Writer& putMatrix3 (const Matrix3& matrix) {
+        unsigned char* out = reserve(16, 48);
+        memset(out, 0, 48);
+        for (int column = 0; column < 3; column++)
+            memcpy(out + column * 16, matrix.val.data() + column * 3, 12);
+        return *this;
+    }
+
+    /** Writes a float[count]; each element takes a 16 byte slot. */
+    Std140Writer& putFloatArray (const float* values, int count) {
+        for (int i = 0; i < count; i++) {
+            unsigned char* out = reserve(16, 16);
+            memset(out, 0, 16);
+            memcpy(out, values + i, 4);
+        }
+        return *this;
+    }
+
+    /** Writes a vec3[count]; each element takes a 16 byte slot. */
+    Std140Writer& putVector3Array (const std::vector<Vector3>& values) {
+        for (const Vector3& value : values) {
+            putVector3(value);
+            align();
+        }
+        return *this;
+    }
+
+    /** Writes a vec4[count] holding the colors. */
+    Std140Writer& putColorArray (const std::vector<Color>& values) {
+        for (const Color& value : values)
+            putColor(value);
+        return *this;
+    }
+
+    /** Writes a mat4[count]. */
+    Std140Writer& putMatrix4Array (const std::vector<Matrix4>& values) {
+        for (const Matrix4& value : values)
+            putMatrix4(value);
+        return *this;
+    }
+
+    /** Writes zeroes up to the given byte offset, used to skip unused array elements. */
+    Std140Writer& padTo (int offset) {
+        if (offset > data.size()) data.resize(offset);
+        if (offset > position) position = offset;
+        return *this;
+    }
+
+    /** @return the size of the block written so far, rounded up to 16 bytes as the block size always is. */
+    int size () const {
+        return (position + 15) & ~15;
+    }
+
+    /** @return the written bytes, valid for {@link #size()} bytes. */
+    const unsigned char* bytes () {
+        if (data.size() < size()) data.resize(size());
+        return data.data();
+    }
+};
+
+/** A GL_UNIFORM_BUFFER object backing one or more uniform blocks. Requires OpenGL ES 3.0 or OpenGL 3.1. */
+class UniformBuffer{
+    GLuint handle = 0;
+    int size;
+    GLenum usage;
+public:
+    /** @param size the capacity in bytes
+     * @param isStatic whether the content rarely changes, selects GL_STATIC_DRAW over GL_DYNAMIC_DRAW */
+    UniformBuffer(int size, bool isStatic);
+    ~UniformBuffer();
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator= (const UniformBuffer&) = delete;
+
+    /** Replaces the content, orphaning the previous storage so the driver doesn't wait for draws still reading it.
+     * @param data the new content
+     * @param bytes the number of bytes, at most the capacity */
+    void setData (const void* data, int bytes);
+
+    /** Detaches the current storage and allocates fresh storage of the same size, the old one lives on until the draws using it
+     * complete. */
+    void orphan ();
+
+    /** Updates part of the content in place. */
+    void setSubData (int offset, const void* data, int bytes);
+
+    /** Binds the whole buffer to the indexed binding point, where every program with a block using that binding reads it. */
+    void bindBase (int binding);
+
+    /** Binds a range of the buffer to the indexed binding point. The offset must be a multiple of
+     * {@link #getOffsetAlignment()}. */
+    void bindRange (int binding, int offset, int bytes);
+
+    GLuint getHandle () {return handle;}
+    int getSize () {return size;}
+
+    /** @return GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, queried once */
+    static int getOffsetAlignment ();
+};
+
+/** A uniform buffer used as a ring of per-draw slots, e.g. for object transforms. Each {@link #push} writes the data behind the
+ * previous one and binds that range, so consecutive draws never wait on each other. When the ring is full the storage is orphaned
+ * and writing restarts at the beginning, leaving the old storage to the draws still using it. */
+class UniformBufferRing{
+    UniformBuffer buffer;
+    int head = 0;
+    int alignment;
+public:
+    /** @param size the capacity of the ring in bytes, should hold at least one frame of draws */
+    UniformBufferRing(int size);
+
+    /** Writes the data into the next free slot and binds it to the binding point. The data must fit in the ring.
+     * @return the offset the data was written to, -1 if the data is larger than the ring */
+    int push (int binding, const void* data, int bytes);
+
+    int push (int binding, Std140Writer& writer) {
+        return push(binding, writer.bytes(), writer.size());
+    }
+
+    UniformBuffer& getBuffer () {return buffer;}
+};
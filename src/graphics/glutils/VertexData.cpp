@@ -1,5 +1,6 @@
 #include "VertexData.h"
 #include "../VertexAttribute.h"
+#include "GLStateCache.h"
 
 VertexData::VertexData (int type,int numVertices,const std::vector<VertexAttribute>& attributes):
 		VertexData(type,true, numVertices,VertexAttributes(attributes)){
@@ -9,13 +10,13 @@ VertexData::VertexData (int type,bool isStatic, int numVertices, const VertexAtt
         this->type = type;
 		this->isStatic = isStatic;
 		this->attributes = attributes;
-        buffer = std::vector<GLfloat>(attributes.vertexSize * numVertices);
+        //Empty until vertices are set, vertexSize is in bytes
+        buffer.reserve(attributes.vertexSize / sizeof(GLfloat) * numVertices);
         usage = isStatic ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
         
         switch(type){
             case VERTEX_BUFFER_OBJECT:
                 glGenBuffers(1,&bufferHandle);
-                setBuffer(buffer, true, attributes);
             break;
             case VERTEX_BUFFER_OBJECT_WITH_VAO:
                 glGenBuffers(1,&bufferHandle);
@@ -23,10 +24,29 @@ VertexData::VertexData (int type,bool isStatic, int numVertices, const VertexAtt
             break;
             case VERTEX_BUFFER_OBJECT_SUB_DATA:
                 isDirect = true;
+                glGenBuffers(1,&bufferHandle);
+                //Storage for the maximum, later uploads only replace data
+                GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, bufferHandle);
+                glBufferData(GL_ARRAY_BUFFER, buffer.capacity() * sizeof(GLfloat), NULL, usage);
+                allocatedFloats = buffer.capacity();
             break;
         }
 	}
 
+void VertexData::upload (){
+    GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, bufferHandle);
+    if (buffer.size() > allocatedFloats || (type != VERTEX_BUFFER_OBJECT_SUB_DATA && dirtyBegin == 0 && dirtyEnd >= buffer.size())) {
+        //Respecifying the whole store lets the driver orphan the old one instead of waiting for draws still reading it
+        glBufferData(GL_ARRAY_BUFFER, buffer.size() * sizeof(GLfloat), buffer.data(), usage);
+        allocatedFloats = buffer.size();
+    } else if (dirtyBegin < dirtyEnd) {
+        dirtyEnd = std::min(dirtyEnd, buffer.size());
+        glBufferSubData(GL_ARRAY_BUFFER, dirtyBegin * sizeof(GLfloat), (dirtyEnd - dirtyBegin) * sizeof(GLfloat),
+            buffer.data() + dirtyBegin);
+    }
+    isDirty = false;
+}
+
 void VertexData::bindAttributes (ShaderProgram& shader,const std::vector<int>&  locations) {
 		bool stillValid = this->cachedLocations.size() != 0;
 		const int numAttributes = attributes.size();
@@ -47,7 +67,7 @@ void VertexData::bindAttributes (ShaderProgram& shader,const std::vector<int>&
 		}
 
 		if (!stillValid) {
-			glBindBuffer(GL_ARRAY_BUFFER, bufferHandle);
+			GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, bufferHandle);
 			unbindAttributes(shader);
 			this->cachedLocations.clear();
 
@@ -70,40 +90,19 @@ void VertexData::bindAttributes (ShaderProgram& shader,const std::vector<int>&
 }
 
 void VertexData::setVertices (const std::vector<GLfloat>& vertices, int offset, int count){
-    isDirty = true;
-    int counter = 0;
-    switch(type){
-        case VERTEX_ARRAY:
-            buffer = std::vector<GLfloat>(vertices[offset],vertices[offset+count]);
-        break;
-        case VERTEX_BUFFER_OBJECT:
-            for(int i = offset;i < offset+count;i++) buffer[counter++] = vertices[i];
-        break;
-        case VERTEX_BUFFER_OBJECT_WITH_VAO:case VERTEX_BUFFER_OBJECT_SUB_DATA:
-            for(int i = offset;i < offset+count;i++) buffer[counter++] = vertices[i];
-            bufferChanged();
-        break;
-    }
+    buffer.assign(vertices.begin() + offset, vertices.begin() + offset + count);
+    markDirty(0, buffer.size());
+    bufferChanged();
 }
 
 void VertexData::updateVertices (int targetOffset,const std::vector<GLfloat>& vertices, int sourceOffset, int count){
-    isDirty = true;
-    switch(type){
-        case VERTEX_ARRAY: case VERTEX_BUFFER_OBJECT:
-            for(int i = sourceOffset;i < sourceOffset+count;i++) buffer[targetOffset++] = vertices[i];
-        break;
-        case VERTEX_BUFFER_OBJECT_WITH_VAO:
-            for(int i = sourceOffset;i < sourceOffset+count;i++) buffer[targetOffset++] = vertices[i];
-            bufferChanged();
-        break;
-        case VERTEX_BUFFER_OBJECT_SUB_DATA:
-            if (isDirect) {
-                for(int i = sourceOffset;i < sourceOffset+count;i++)
-                    buffer[targetOffset++] = vertices[i];
-            } else SDL_Log("Buffer must be allocated direct."); // Should never happen
-            bufferChanged();
-        break;
+    if (targetOffset < 0 || targetOffset + count > (int)buffer.size()) {
+        SDL_Log("IndexOutOfBoundsException(targetOffset = %i, count = %i, size = %i)",targetOffset,count,(int)buffer.size());
+        return;
     }
+    std::copy(vertices.begin() + sourceOffset, vertices.begin() + sourceOffset + count, buffer.begin() + targetOffset);
+    markDirty(targetOffset, targetOffset + count);
+    bufferChanged();
 }
 
 void VertexData::setAllVertexAttributes(ShaderProgram& shader,const std::vector<int>& locations){
@@ -135,32 +134,21 @@ void VertexData::disableAllVertexAttributes(ShaderProgram& shader,const std::vec
 void VertexData::bind (ShaderProgram& shader,const std::vector<int>& locations){
     switch(type){
         case VERTEX_ARRAY:
+            //Attributes of other types would be set on a bound vertex array or read from a bound buffer
+            GLStateCache::get().bindVertexArray(0);
+            GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, 0);
             setAllVertexAttributes(shader,locations);
         break;
-        case VERTEX_BUFFER_OBJECT:
-            glBindBuffer(GL_ARRAY_BUFFER, bufferHandle);
-            if (isDirty) {
-                glBufferData(GL_ARRAY_BUFFER, buffer.size() * sizeof(GLfloat), buffer.data(), usage);
-                isDirty = false;
-            }
+        case VERTEX_BUFFER_OBJECT: case VERTEX_BUFFER_OBJECT_SUB_DATA:
+            GLStateCache::get().bindVertexArray(0);
+            GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, bufferHandle);
+            if (isDirty) upload();
             setAllVertexAttributes(shader,locations);
         break;
         case VERTEX_BUFFER_OBJECT_WITH_VAO:
-            glBindVertexArray(vaoHandle);
+            GLStateCache::get().bindVertexArray(vaoHandle);
             bindAttributes(shader, locations);
-            if (isDirty) {
-                glBindBuffer(GL_ARRAY_BUFFER, bufferHandle);
-                glBufferData(GL_ARRAY_BUFFER, buffer.size() * sizeof(GLfloat), buffer.data(), usage);
-                isDirty = false;
-            }
-        break;
-        case VERTEX_BUFFER_OBJECT_SUB_DATA:
-            glBindBuffer(GL_ARRAY_BUFFER, bufferHandle);
-            if (isDirty) {
-                glBufferData(GL_ARRAY_BUFFER, buffer.size() * sizeof(GLfloat), buffer.data(), usage);
-                isDirty = false;
-            }
-            setAllVertexAttributes(shader,locations);
+            if (isDirty) upload();
         break;
     }
     isBound = true;
@@ -169,37 +157,37 @@ void VertexData::bind (ShaderProgram& shader,const std::vector<int>& locations){
 void VertexData::unbind(ShaderProgram& shader,const std::vector<int>& locations){
     if(type != VERTEX_BUFFER_OBJECT_WITH_VAO)
         disableAllVertexAttributes(shader,locations);
-    if(type == VERTEX_BUFFER_OBJECT || type == VERTEX_BUFFER_OBJECT_SUB_DATA)
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    //The buffer stays bound, the next bind of any type sets what it needs
     isBound = false;
 }
 
 void VertexData::invalidate(){
-    isDirty = true;
+    markDirty(0, buffer.size());
+    allocatedFloats = 0;
     if(type != VERTEX_ARRAY)
         glGenBuffers(1,&bufferHandle);
     switch(type){
         case VERTEX_BUFFER_OBJECT_WITH_VAO:
             glGenVertexArrays(1,&vaoHandle);
+            cachedLocations.clear();
         break;
         case VERTEX_BUFFER_OBJECT_SUB_DATA:
-            glBindBuffer(GL_ARRAY_BUFFER, bufferHandle);
-            glBufferData(GL_ARRAY_BUFFER, buffer.capacity(), NULL, usage);
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            GLStateCache::get().bindBuffer(GL_ARRAY_BUFFER, bufferHandle);
+            glBufferData(GL_ARRAY_BUFFER, buffer.capacity() * sizeof(GLfloat), NULL, usage);
+            allocatedFloats = buffer.capacity();
         break;
     }
 }
 
-VertexData::~VertexData(){SDL_Log("VERTEX DATA DESTROY!");
+VertexData::~VertexData(){
     if(type == VERTEX_BUFFER_OBJECT || type == VERTEX_BUFFER_OBJECT_SUB_DATA ||
         type == VERTEX_BUFFER_OBJECT_WITH_VAO){
-            glBindBuffer(GL_ARRAY_BUFFER, 0);
-            glDeleteBuffers(1,&bufferHandle);
+            GLStateCache::get().deleteBuffers(1,&bufferHandle);
             bufferHandle = 0;
         }
     if(type == VERTEX_BUFFER_OBJECT_WITH_VAO){
         if (vaoHandle != -1) {
-			glDeleteVertexArrays(1,tmpHandle.data());
+			GLStateCache::get().deleteVertexArrays(1,&vaoHandle);
 			vaoHandle = -1;
 		}
     }
@@ -23,6 +23,7 @@
 
 #include "../../GL.h"
 #include <vector>
+#include <algorithm>
 #include "../VertexAttributes.h"
 #include "ShaderProgram.h"
 
@@ -33,8 +34,12 @@
 class VertexAttributes;
 class VertexData{
 private:
-	bool isDirty = true,isBound = false,isStatic = true,isDirect,ownsBuffer;
-	GLuint bufferHandle,vaoHandle = -1;
+	bool isDirty = true,isBound = false,isStatic = true,isDirect = false,ownsBuffer = true;
+	GLuint bufferHandle = 0,vaoHandle = -1;
+	/** the floats the GL buffer has storage for */
+	size_t allocatedFloats = 0;
+	/** the range of floats changed since the last upload */
+	size_t dirtyBegin = 0,dirtyEnd = 0;
 	int usage,type;
     VertexAttributes attributes = VertexAttributes();
     std::vector<GLfloat> buffer;
@@ -50,14 +55,22 @@ private:
         return os;  
     } 
     
-	void bufferChanged () {
-		if (isBound) {
-            if(type == VERTEX_BUFFER_OBJECT_SUB_DATA) 
-                glBufferSubData(GL_ARRAY_BUFFER, 0, buffer.capacity(), buffer.data());
-			else
-                glBufferData(GL_ARRAY_BUFFER, buffer.size() * sizeof(GLfloat), buffer.data(), usage);
-			isDirty = false;
+	void markDirty (size_t begin, size_t end) {
+		if (!isDirty) {
+			dirtyBegin = begin;
+			dirtyEnd = end;
+		} else {
+			dirtyBegin = std::min(dirtyBegin, begin);
+			dirtyEnd = std::max(dirtyEnd, end);
 		}
+		isDirty = true;
+	}
+
+	/** Uploads the changed range, or the whole buffer if it no longer fits the GL storage. */
+	void upload ();
+
+	void bufferChanged () {
+		if (isBound && type != VERTEX_ARRAY) upload();
 	}
     
     void unbindAttributes (ShaderProgram& shaderProgram) {
@@ -124,10 +137,10 @@ public:
 	VertexData (int type,bool isStatic, int numVertices, const VertexAttributes& attributes);
     
 	/** @return the number of vertices this VertexData stores */
-	int getNumVertices (){return buffer.size() / attributes.vertexSize;}
+	int getNumVertices (){return buffer.size() * sizeof(GLfloat) / attributes.vertexSize;}
 
 	/** @return the number of vertices this VertedData can store */
-	int getNumMaxVertices (){return buffer.capacity() / attributes.vertexSize;}
+	int getNumMaxVertices (){return buffer.capacity() * sizeof(GLfloat) / attributes.vertexSize;}
 
 	/** @return the {@link VertexAttributes} as specified during construction. */
 	VertexAttributes& getAttributes (){return attributes;}
@@ -142,7 +155,7 @@ public:
 	 * @param count the number of floats to copy */
 	void setVertices (const std::vector<GLfloat>& vertices, int offset, int count);
 
-	/** Update (a portion of) the vertices. Does not resize the backing buffer.
+	/** Update (a portion of) the vertices. Does not resize the backing buffer. Only the updated range is uploaded.
 	 * @param vertices the vertex data
 	 * @param sourceOffset the offset to start copying the data from
 	 * @param count the number of floats to copy */
@@ -152,7 +165,10 @@ public:
 	 * bind. If you need immediate uploading use {@link #setVertices(float[], int, int)}; Any modifications made to the Buffer
 	 * *after* the call to bind will not automatically be uploaded.
 	 * @return the underlying FloatBuffer holding the vertex data. */
-	std::vector<GLfloat>& getBuffer (){isDirty = true; return buffer;}
+	std::vector<GLfloat>& getBuffer (){markDirty(0, buffer.size()); return buffer;}
+
+	/** @return the vertices, without marking them as changed */
+	const std::vector<GLfloat>& getData () const {return buffer;}
 
 	/** Binds this VertexData for rendering via glDrawArrays or glDrawElements. */
 	void bind (ShaderProgram& shader) {bind(shader,std::vector<int>());}
@@ -0,0 +1,44 @@
+#include "TiledMap.h"
+#include <algorithm>
+
+TiledMapTileLayer::TiledMapTileLayer(int width, int height, Source source)
+	:width(std::max(0, width)),height(std::max(0, height)),source(source){
+	blocksX = (this->width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	blocksY = (this->height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	blocks.resize((size_t)blocksX * blocksY);
+	blockModifications.resize(blocks.size());
+}
+
+std::vector<uint32_t>& TiledMapTileLayer::getBlock (int x, int y){
+	std::vector<uint32_t>& block = blocks[(size_t)(y / BLOCK_SIZE) * blocksX + x / BLOCK_SIZE];
+	if (block.empty()) {
+		block.resize(BLOCK_SIZE * BLOCK_SIZE, 0);
+		const int blockX = x / BLOCK_SIZE * BLOCK_SIZE, blockY = y / BLOCK_SIZE * BLOCK_SIZE;
+		const int blockWidth = std::min(width - blockX, (int)BLOCK_SIZE), blockHeight = std::min(height - blockY, (int)BLOCK_SIZE);
+		if (source) {
+			std::vector<uint32_t> cells((size_t)blockWidth * blockHeight);
+			source(blockX, blockY, blockWidth, blockHeight, cells.data());
+			for (int row = 0; row < blockHeight; row++)
+				std::copy(cells.begin() + (size_t)row * blockWidth, cells.begin() + (size_t)(row + 1) * blockWidth,
+					block.begin() + (size_t)row * BLOCK_SIZE);
+		}
+		loadedBlocks++;
+	}
+	return block;
+}
+
+void TiledMapTileLayer::setCell (int x, int y, uint32_t cell){
+	if (x < 0 || y < 0 || x >= width || y >= height) return;
+	getBlock(x, y)[(y % BLOCK_SIZE) * BLOCK_SIZE + x % BLOCK_SIZE] = cell;
+	blockModifications[(size_t)(y / BLOCK_SIZE) * blocksX + x / BLOCK_SIZE] = ++modificationCount;
+}
+
+unsigned int TiledMapTileLayer::getModificationCount (int x, int y, int width, int height) const{
+	const int firstX = std::max(0, x) / BLOCK_SIZE, lastX = std::min(this->width, x + width) - 1;
+	const int firstY = std::max(0, y) / BLOCK_SIZE, lastY = std::min(this->height, y + height) - 1;
+	unsigned int count = 0;
+	for (int blockY = firstY; lastY >= 0 && blockY <= lastY / BLOCK_SIZE; blockY++)
+		for (int blockX = firstX; lastX >= 0 && blockX <= lastX / BLOCK_SIZE; blockX++)
+			count = std::max(count, blockModifications[(size_t)blockY * blocksX + blockX]);
+	return count;
+}
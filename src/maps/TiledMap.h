@@ -0,0 +1,164 @@
+#pragma once
+#include "../graphics/g2d/TextureRegion.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** A tile of a {@link TiledMapTileSet}, a region of the tile set's image, or a sequence of other tiles shown one after the other
+ * if it is animated. */
+class TiledMapTile{
+public:
+	struct Frame{
+		const TiledMapTile* tile;
+		/** in milliseconds */
+		int duration;
+	};
+
+	/** the global id of the tile in the map */
+	uint32_t id = 0;
+	TextureRegion region;
+	/** the offset the tile is drawn at, in pixels */
+	float offsetX = 0, offsetY = 0;
+	std::vector<Frame> frames;
+	/** the sum of the frame durations, in milliseconds */
+	int animationDuration = 0;
+
+	bool isAnimated () const {
+		return !frames.empty() && animationDuration > 0;
+	}
+
+	/** @return the tile shown at the time, this tile if it isn't animated */
+	const TiledMapTile& getFrame (unsigned long timeMillis) const {
+		if (!isAnimated()) return *this;
+		int time = timeMillis % animationDuration;
+		for (const Frame& frame : frames) {
+			if (time < frame.duration) return *frame.tile;
+			time -= frame.duration;
+		}
+		return *frames.back().tile;
+	}
+};
+
+/** The tiles sharing a range of global ids, usually the regions of one image. */
+class TiledMapTileSet{
+public:
+	std::string name;
+	/** the global id of the first tile */
+	uint32_t firstGid = 1;
+	/** the tiles by local id, nullptr where the set has no tile */
+	std::vector<std::shared_ptr<TiledMapTile>> tiles;
+
+	/** @return the tile with the local id, created if the set has none yet */
+	TiledMapTile& getOrCreate (int localId) {
+		if (localId >= (int)tiles.size()) tiles.resize(localId + 1);
+		if (!tiles[localId]) {
+			tiles[localId] = std::make_shared<TiledMapTile>();
+			tiles[localId]->id = firstGid + localId;
+		}
+		return *tiles[localId];
+	}
+};
+
+/** A layer of tiles, holding the global id of the tile of each cell, with the flip flags of the TMX format in the high bits. Cell
+ * 0,0 is the top left one, as in TMX.
+ * <p>
+ * The cells are stored in square blocks which are decoded from the layer's {@link Source} when a cell of the block is first read
+ * or written, so huge maps only hold the blocks that were looked at. A layer without source starts empty. Each block remembers
+ * when it was last written, see {@link #getModificationCount(int, int, int, int)}, so renderers can rebuild just what changed. */
+class TiledMapTileLayer{
+public:
+	static const uint32_t FLIPPED_HORIZONTALLY = 0x80000000;
+	static const uint32_t FLIPPED_VERTICALLY = 0x40000000;
+	static const uint32_t FLIPPED_DIAGONALLY = 0x20000000;
+	static const uint32_t GID_MASK = 0x1FFFFFFF;
+	/** the width and height of the blocks cells are decoded in */
+	static const int BLOCK_SIZE = 64;
+
+	/** Decodes the cells of the rectangle x, y, width, height, which lies within the layer, into out, row by row. */
+	typedef std::function<void(int x, int y, int width, int height, uint32_t* out)> Source;
+
+	std::string name;
+	bool visible = true;
+	float opacity = 1;
+	/** the offset the layer is drawn at, in pixels */
+	float offsetX = 0, offsetY = 0;
+private:
+	int width, height;
+	int blocksX, blocksY;
+	Source source;
+	std::vector<std::vector<uint32_t>> blocks;
+	std::vector<unsigned int> blockModifications;
+	unsigned int modificationCount = 0;
+	int loadedBlocks = 0;
+
+	std::vector<uint32_t>& getBlock (int x, int y);
+public:
+	/** @param width the width in tiles
+	 * @param height the height in tiles */
+	TiledMapTileLayer(int width, int height, Source source = nullptr);
+
+	int getWidth () const {
+		return width;
+	}
+
+	int getHeight () const {
+		return height;
+	}
+
+	/** @return the global id and flip flags of the cell, 0 if empty or outside of the layer */
+	uint32_t getCell (int x, int y) {
+		if (x < 0 || y < 0 || x >= width || y >= height) return 0;
+		return getBlock(x, y)[(y % BLOCK_SIZE) * BLOCK_SIZE + x % BLOCK_SIZE];
+	}
+
+	void setCell (int x, int y, uint32_t cell);
+
+	/** @return when a cell within the rectangle was last set, 0 if none was, comparable with earlier calls */
+	unsigned int getModificationCount (int x, int y, int width, int height) const;
+
+	/** @return the number of blocks decoded so far */
+	int getLoadedBlocks () const {
+		return loadedBlocks;
+	}
+};
+
+/** A map of tiles in layers, loaded by {@link TmxMapLoader}. The tile width and height are those of the grid, tiles can be
+ * larger. */
+class TiledMap{
+public:
+	enum Orientation{
+		ORTHOGONAL, ISOMETRIC
+	};
+
+	Orientation orientation = ORTHOGONAL;
+	/** the size in tiles */
+	int width = 0, height = 0;
+	/** the size of a tile of the grid in pixels */
+	int tileWidth = 0, tileHeight = 0;
+	std::vector<std::shared_ptr<TiledMapTileLayer>> layers;
+private:
+	std::vector<std::shared_ptr<TiledMapTileSet>> tileSets;
+	std::vector<const TiledMapTile*> tilesByGid;
+public:
+	/** Adds the tile set and indexes its tiles, add tiles to a set before adding the set. */
+	void addTileSet (std::shared_ptr<TiledMapTileSet> tileSet) {
+		tileSets.push_back(tileSet);
+		for (const std::shared_ptr<TiledMapTile>& tile : tileSet->tiles) {
+			if (!tile) continue;
+			if (tile->id >= tilesByGid.size()) tilesByGid.resize(tile->id + 1, nullptr);
+			tilesByGid[tile->id] = tile.get();
+		}
+	}
+
+	const std::vector<std::shared_ptr<TiledMapTileSet>>& getTileSets () const {
+		return tileSets;
+	}
+
+	/** @return the tile of the global id, the flip flags are ignored, or nullptr */
+	const TiledMapTile* getTile (uint32_t gid) const {
+		gid &= TiledMapTileLayer::GID_MASK;
+		return gid < tilesByGid.size() ? tilesByGid[gid] : nullptr;
+	}
+};
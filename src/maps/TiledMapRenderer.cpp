@@ -0,0 +1,293 @@
+#include "TiledMapRenderer.h"
+#include "../graphics/VertexAttribute.h"
+#include "../graphics/g2d/SpriteBatch.h"
+#include <algorithm>
+#include <cmath>
+
+TiledMapRenderer::TiledMapRenderer(std::shared_ptr<TiledMap> map, int chunkSize, int maxChunks, float unitScale,
+	std::shared_ptr<ShaderProgram> shader)
+	:map(map),chunkSize(std::max(1, chunkSize)),maxChunks(std::max(1, maxChunks)),unitScale(unitScale){
+	for (const std::shared_ptr<TiledMapTileSet>& tileSet : map->getTileSets()) {
+		for (const std::shared_ptr<TiledMapTile>& tile : tileSet->tiles) {
+			if (!tile) continue;
+			overhangX = std::max(overhangX, tile->region.regionWidth - map->tileWidth + std::fabs(tile->offsetX));
+			overhangY = std::max(overhangY, tile->region.regionHeight - map->tileHeight + std::fabs(tile->offsetY));
+		}
+	}
+	overhangX *= unitScale;
+	overhangY *= unitScale;
+
+	const int quads = this->chunkSize * this->chunkSize;
+	vertices.resize((size_t)quads * SpriteBatch::SPRITE_SIZE);
+	indices.resize((size_t)quads * 6);
+	for (GLuint i = 0, j = 0; i < indices.size(); i += 6, j += 4) {
+		indices[i] = j;
+		indices[i + 1] = j + 1;
+		indices[i + 2] = j + 2;
+		indices[i + 3] = j + 2;
+		indices[i + 4] = j + 3;
+		indices[i + 5] = j;
+	}
+
+	GLint viewport[4] = {0, 0, 0, 0};
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	setView(Matrix4().setToOrtho2D(0, 0, viewport[2], viewport[3]), 0, 0, viewport[2], viewport[3]);
+
+	this->shader = shader ? shader : SpriteBatch::createDefaultShader();
+	projTransHandle = this->shader->fetchUniformHandle("u_projTrans");
+	textureHandle = this->shader->fetchUniformHandle("u_texture");
+}
+
+void TiledMapRenderer::setView (const OrthographicCamera& camera){
+	//The bounds of the view rotated by the up vector
+	const float width = camera.viewportWidth * camera.zoom;
+	const float height = camera.viewportHeight * camera.zoom;
+	const float w = width * std::fabs(camera.up.y) + height * std::fabs(camera.up.x);
+	const float h = height * std::fabs(camera.up.y) + width * std::fabs(camera.up.x);
+	setView(camera.combined, camera.position.x - w / 2, camera.position.y - h / 2, w, h);
+}
+
+void TiledMapRenderer::setView (const Matrix4& projection, float x, float y, float width, float height){
+	projectionMatrix.set(projection);
+	viewX = x;
+	viewY = y;
+	viewWidth = width;
+	viewHeight = height;
+}
+
+void TiledMapRenderer::getCellPosition (const TiledMapTileLayer& layer, int column, int row, float& x, float& y) const{
+	const float tileWidth = map->tileWidth * unitScale, tileHeight = map->tileHeight * unitScale;
+	if (map->orientation == TiledMap::ISOMETRIC) {
+		//Cell 0,0 is the top corner of the diamond
+		x = (column - row + layer.getHeight() - 1) * tileWidth * 0.5f;
+		y = (layer.getWidth() + layer.getHeight() - 2 - column - row) * tileHeight * 0.5f;
+	} else {
+		x = column * tileWidth;
+		y = (layer.getHeight() - 1 - row) * tileHeight;
+	}
+	x += layer.offsetX * unitScale;
+	y += layer.offsetY * unitScale;
+}
+
+void TiledMapRenderer::putTile (float* out, const TiledMapTile& tile, uint32_t flags, float x, float y, float color) const{
+	const TextureRegion& region = tile.region;
+	x += tile.offsetX * unitScale;
+	y += tile.offsetY * unitScale;
+	const float x2 = x + region.regionWidth * unitScale;
+	const float y2 = y + region.regionHeight * unitScale;
+
+	//The texture coordinates of the corners bottom left, top left, top right and bottom right
+	float u[4] = {region.u, region.u, region.u2, region.u2};
+	float v[4] = {region.v2, region.v, region.v, region.v2};
+	//TMX flips the diagonal first, then horizontally and vertically
+	if (flags & TiledMapTileLayer::FLIPPED_DIAGONALLY) {
+		std::swap(u[0], u[2]);
+		std::swap(v[0], v[2]);
+	}
+	if (flags & TiledMapTileLayer::FLIPPED_HORIZONTALLY) {
+		std::swap(u[0], u[3]);
+		std::swap(v[0], v[3]);
+		std::swap(u[1], u[2]);
+		std::swap(v[1], v[2]);
+	}
+	if (flags & TiledMapTileLayer::FLIPPED_VERTICALLY) {
+		std::swap(u[0], u[1]);
+		std::swap(v[0], v[1]);
+		std::swap(u[2], u[3]);
+		std::swap(v[2], v[3]);
+	}
+
+	const float positions[8] = {x, y, x, y2, x2, y2, x2, y};
+	for (int i = 0; i < 4; i++) {
+		*out++ = positions[i * 2];
+		*out++ = positions[i * 2 + 1];
+		*out++ = color;
+		*out++ = u[i];
+		*out++ = v[i];
+	}
+}
+
+void TiledMapRenderer::buildChunk (Chunk& chunk, TiledMapTileLayer& layer, int chunkX, int chunkY){
+	const int firstColumn = chunkX * chunkSize, firstRow = chunkY * chunkSize;
+	const int columns = std::min(chunkSize, layer.getWidth() - firstColumn);
+	const int rows = std::min(chunkSize, layer.getHeight() - firstRow);
+	const float color = Color::toFloatBits(1.0f, 1.0f, 1.0f, layer.opacity);
+	const unsigned long time = (unsigned long)animationTime;
+
+	chunk.textures.clear();
+	chunk.counts.clear();
+	chunk.animatedTiles.clear();
+	chunk.modificationCount = layer.getModificationCount(firstColumn, firstRow, chunkSize, chunkSize);
+	chunk.opacity = layer.opacity;
+
+	//Rows from the top, isometric diagonals from the top corner, so tiles further down overlap those behind them
+	int quads = 0;
+	const int diagonals = map->orientation == TiledMap::ISOMETRIC ? columns + rows - 1 : rows;
+	for (int diagonal = 0; diagonal < diagonals; diagonal++) {
+		const int first = map->orientation == TiledMap::ISOMETRIC ? std::max(0, diagonal - rows + 1) : 0;
+		const int last = map->orientation == TiledMap::ISOMETRIC ? std::min(columns - 1, diagonal) : columns - 1;
+		for (int column = first; column <= last; column++) {
+			const int row = map->orientation == TiledMap::ISOMETRIC ? diagonal - column : diagonal;
+			const uint32_t cell = layer.getCell(firstColumn + column, firstRow + row);
+			const TiledMapTile* tile = map->getTile(cell);
+			if (!tile) continue;
+			const TiledMapTile& shown = tile->getFrame(time);
+			if (!shown.region.texture) continue;
+
+			float x, y;
+			getCellPosition(layer, firstColumn + column, firstRow + row, x, y);
+			const uint32_t flags = cell & ~TiledMapTileLayer::GID_MASK;
+			putTile(vertices.data() + (size_t)quads * SpriteBatch::SPRITE_SIZE, shown, flags, x, y, color);
+			if (tile->isAnimated()) chunk.animatedTiles.push_back({quads, tile, &shown, flags, x, y});
+
+			if (chunk.textures.empty() || chunk.textures.back() != shown.region.texture) {
+				chunk.textures.push_back(shown.region.texture);
+				chunk.counts.push_back(0);
+			}
+			chunk.counts.back()++;
+			quads++;
+		}
+	}
+
+	if (quads == 0) {
+		chunk.mesh = nullptr;
+		return;
+	}
+	chunk.mesh = std::make_unique<Mesh>(true, true, true, quads * 4, quads * 6,
+		VertexAttributes(SpriteBatch::createAttributes()));
+	chunk.mesh->setVertices(vertices, 0, quads * SpriteBatch::SPRITE_SIZE);
+	chunk.mesh->setIndices(indices, 0, quads * 6);
+	builtChunks++;
+}
+
+bool TiledMapRenderer::updateAnimatedTiles (Chunk& chunk){
+	const unsigned long time = (unsigned long)animationTime;
+	const float color = Color::toFloatBits(1.0f, 1.0f, 1.0f, chunk.opacity);
+	for (AnimatedTile& animated : chunk.animatedTiles) {
+		const TiledMapTile& shown = animated.tile->getFrame(time);
+		if (&shown == animated.shown || !shown.region.texture) continue;
+		//A frame of another texture splits the runs
+		if (shown.region.texture != animated.shown->region.texture) return false;
+		animated.shown = &shown;
+		//Only the quad is uploaded again, on the next bind
+		putTile(vertices.data(), shown, animated.flags, animated.x, animated.y, color);
+		chunk.mesh->updateVertices(animated.quad * SpriteBatch::SPRITE_SIZE, vertices, 0, SpriteBatch::SPRITE_SIZE);
+	}
+	return true;
+}
+
+void TiledMapRenderer::render (){
+	std::vector<int> visible;
+	for (int i = 0, n = map->layers.size(); i < n; i++)
+		if (map->layers[i]->visible) visible.push_back(i);
+	render(visible);
+}
+
+void TiledMapRenderer::render (const std::vector<int>& layers){
+	renderCalls = 0;
+	builtChunks = 0;
+	drawnChunks = 0;
+	frame++;
+
+	GLStateCache& cache = GLStateCache::get();
+	cache.setEnabled(GL_BLEND, true);
+	cache.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	cache.depthMask(false);
+	shader->begin();
+	shader->setUniformMatrix(projTransHandle, projectionMatrix);
+	shader->setUniformi(textureHandle, 0);
+
+	for (int index : layers)
+		if (index >= 0 && index < (int)map->layers.size()) renderLayer(index);
+
+	shader->end();
+	cache.depthMask(true);
+	releaseChunks();
+}
+
+void TiledMapRenderer::renderLayer (int index){
+	TiledMapTileLayer& layer = *map->layers[index];
+	if (layer.getWidth() == 0 || layer.getHeight() == 0 || map->tileWidth <= 0 || map->tileHeight <= 0) return;
+	const float tileWidth = map->tileWidth * unitScale, tileHeight = map->tileHeight * unitScale;
+	const bool isometric = map->orientation == TiledMap::ISOMETRIC;
+
+	//The view, grown by the overhang of large tiles, in cells
+	const float left = viewX - overhangX - layer.offsetX * unitScale, right = viewX + viewWidth + overhangX - layer.offsetX * unitScale;
+	const float bottom = viewY - overhangY - layer.offsetY * unitScale, top = viewY + viewHeight - layer.offsetY * unitScale;
+	float minColumn, maxColumn, minRow, maxRow;
+	if (isometric) {
+		//Columns grow down right and rows down left, the corners of the view bound them
+		const float diagonalLeft = left / (tileWidth * 0.5f) - (layer.getHeight() - 1);
+		const float diagonalRight = right / (tileWidth * 0.5f) - (layer.getHeight() - 1);
+		const float sumTop = (layer.getWidth() + layer.getHeight() - 2) - top / (tileHeight * 0.5f);
+		const float sumBottom = (layer.getWidth() + layer.getHeight() - 2) - bottom / (tileHeight * 0.5f);
+		minColumn = (diagonalLeft + sumTop) * 0.5f - 2;
+		maxColumn = (diagonalRight + sumBottom) * 0.5f + 1;
+		minRow = (sumTop - diagonalRight) * 0.5f - 1;
+		maxRow = (sumBottom - diagonalLeft) * 0.5f + 1;
+	} else {
+		minColumn = left / tileWidth - 1;
+		maxColumn = right / tileWidth;
+		minRow = layer.getHeight() - top / tileHeight - 1;
+		maxRow = layer.getHeight() - bottom / tileHeight;
+	}
+	const int lastChunkX = (layer.getWidth() - 1) / chunkSize, lastChunkY = (layer.getHeight() - 1) / chunkSize;
+	const int firstX = std::max(0, (int)std::floor(minColumn / chunkSize));
+	const int lastX = std::min(lastChunkX, (int)std::floor(maxColumn / chunkSize));
+	const int firstY = std::max(0, (int)std::floor(minRow / chunkSize));
+	const int lastY = std::min(lastChunkY, (int)std::floor(maxRow / chunkSize));
+
+	const float opacity = layer.opacity;
+	const int diagonals = isometric ? lastX - firstX + lastY - firstY + 1 : lastY - firstY + 1;
+	for (int diagonal = 0; diagonal < diagonals; diagonal++) {
+		const int first = isometric ? std::max(firstX, firstX + diagonal - (lastY - firstY)) : firstX;
+		const int last = isometric ? std::min(lastX, firstX + diagonal) : lastX;
+		for (int chunkX = first; chunkX <= last; chunkX++) {
+			const int chunkY = isometric ? firstY + diagonal - (chunkX - firstX) : firstY + diagonal;
+			if (isometric) {
+				//The bounds of the diamond of the chunk
+				const int column = chunkX * chunkSize, row = chunkY * chunkSize;
+				const float chunkLeft = (column - (row + chunkSize - 1) + layer.getHeight() - 1) * tileWidth * 0.5f;
+				const float chunkRight = (column + chunkSize - 1 - row + layer.getHeight() - 1) * tileWidth * 0.5f + tileWidth;
+				const float chunkBottom = (layer.getWidth() + layer.getHeight() - 2 - (column + row + 2 * chunkSize - 2))
+					* tileHeight * 0.5f;
+				const float chunkTop = (layer.getWidth() + layer.getHeight() - 2 - (column + row)) * tileHeight * 0.5f + tileHeight;
+				if (chunkRight < left || chunkLeft > right || chunkTop < bottom || chunkBottom > top) continue;
+			}
+
+			std::unique_ptr<Chunk>& chunk = chunks[getKey(index, chunkX, chunkY)];
+			const int column = chunkX * chunkSize, row = chunkY * chunkSize;
+			if (!chunk) {
+				chunk = std::make_unique<Chunk>();
+				buildChunk(*chunk, layer, chunkX, chunkY);
+			} else if (chunk->opacity != opacity
+				|| chunk->modificationCount != layer.getModificationCount(column, row, chunkSize, chunkSize)) {
+				buildChunk(*chunk, layer, chunkX, chunkY);
+			}
+			chunk->lastDrawn = frame;
+			if (!chunk->mesh) continue;
+
+			if (!updateAnimatedTiles(*chunk)) buildChunk(*chunk, layer, chunkX, chunkY);
+			chunk->mesh->bind(*shader);
+			for (int i = 0, offset = 0, n = chunk->counts.size(); i < n; offset += chunk->counts[i++]) {
+				chunk->textures[i]->bind(0);
+				chunk->mesh->render(*shader, GL_TRIANGLES, offset * 6, chunk->counts[i] * 6, false);
+				renderCalls++;
+				totalRenderCalls++;
+			}
+			chunk->mesh->unbind(*shader);
+			drawnChunks++;
+		}
+	}
+}
+
+void TiledMapRenderer::releaseChunks (){
+	if ((int)chunks.size() <= maxChunks) return;
+	std::vector<std::pair<unsigned long, uint64_t>> unused;
+	for (const auto& chunk : chunks)
+		if (chunk.second->lastDrawn != frame) unused.push_back({chunk.second->lastDrawn, chunk.first});
+	const size_t count = std::min(unused.size(), chunks.size() - (size_t)maxChunks);
+	std::partial_sort(unused.begin(), unused.begin() + count, unused.end());
+	for (size_t i = 0; i < count; i++)
+		chunks.erase(unused[i].second);
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include "TiledMap.h"
+#include "../OrthographicCamera.h"
+#include "../graphics/Mesh.h"
+#include "../graphics/glutils/ShaderProgram.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/** Renders the tile layers of an orthogonal or isometric {@link TiledMap}.
+ * <p>
+ * Layers are split into square chunks of tiles, each baked once into a static {@link Mesh} in the vertex format of
+ * {@link SpriteBatch}, with the runs of tiles sharing a texture, so a chunk costs one draw call per texture and no vertex work
+ * while the camera moves. Only the chunks overlapping the view set with {@link #setView} are drawn, built the first time they
+ * are seen and kept in a cache of at most maxChunks chunks, the least recently drawn are released first. A chunk is rebuilt
+ * when cells of its {@link TiledMapTileLayer} blocks are set or the opacity of its layer changes, animated tiles only rewrite
+ * their own vertices when their frame changes, see {@link #update(float)}.
+ * <p>
+ * Chunks are drawn top to bottom, tiles larger than the grid overlap the tiles above them, but not always those of the
+ * neighbouring chunk drawn later. */
+class TiledMapRenderer{
+public:
+	/** Number of render calls since the last {@link #render()}. **/
+	int renderCalls = 0;
+
+	/** Number of rendering calls, ever. Will not be reset unless set manually. **/
+	int totalRenderCalls = 0;
+private:
+	struct AnimatedTile{
+		/** the quad of the tile in the chunk */
+		int quad;
+		const TiledMapTile* tile;
+		/** the frame in the vertices */
+		const TiledMapTile* shown;
+		uint32_t flags;
+		float x, y;
+	};
+
+	struct Chunk{
+		std::unique_ptr<Mesh> mesh;
+		/** the runs of tiles sharing a texture, and the tiles in each */
+		std::vector<std::shared_ptr<Texture>> textures;
+		std::vector<int> counts;
+		std::vector<AnimatedTile> animatedTiles;
+		unsigned int modificationCount;
+		float opacity;
+		unsigned long lastDrawn;
+	};
+
+	std::shared_ptr<TiledMap> map;
+	const int chunkSize;
+	const int maxChunks;
+	const float unitScale;
+	/** how far tiles may reach past their cell, left or right and up or down */
+	float overhangX = 0, overhangY = 0;
+
+	std::unordered_map<uint64_t, std::unique_ptr<Chunk>> chunks;
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+
+	Matrix4 projectionMatrix;
+	float viewX = 0, viewY = 0, viewWidth = 0, viewHeight = 0;
+
+	std::shared_ptr<ShaderProgram> shader;
+	UniformHandle projTransHandle, textureHandle;
+
+	unsigned long frame = 0;
+	double animationTime = 0;
+	int builtChunks = 0, drawnChunks = 0;
+
+	static uint64_t getKey (int layer, int chunkX, int chunkY) {
+		return (uint64_t)layer << 42 | (uint64_t)chunkY << 21 | (uint64_t)chunkX;
+	}
+
+	/** @return the bottom left corner of the cell of the layer */
+	void getCellPosition (const TiledMapTileLayer& layer, int column, int row, float& x, float& y) const;
+
+	/** Writes the quad of the tile with its bottom left corner at x, y, flipped as the flags of the cell say. */
+	void putTile (float* out, const TiledMapTile& tile, uint32_t flags, float x, float y, float color) const;
+
+	void buildChunk (Chunk& chunk, TiledMapTileLayer& layer, int chunkX, int chunkY);
+
+	/** Rewrites the animated tiles whose frame changed.
+	 * @return false if the chunk must be built again, as a frame has another texture */
+	bool updateAnimatedTiles (Chunk& chunk);
+
+	void renderLayer (int index);
+
+	/** Releases the least recently drawn chunks above the limit. */
+	void releaseChunks ();
+public:
+	/** @param chunkSize the width and height of the chunks in tiles
+	 * @param maxChunks the most chunks kept built, over all layers
+	 * @param unitScale the size of a pixel of the map in world units
+	 * @param shader the shader, nullptr to create one with {@link SpriteBatch#createDefaultShader()} */
+	TiledMapRenderer(std::shared_ptr<TiledMap> map, int chunkSize = 32, int maxChunks = 256, float unitScale = 1,
+		std::shared_ptr<ShaderProgram> shader = nullptr);
+
+	TiledMapRenderer (const TiledMapRenderer&) = delete;
+	TiledMapRenderer& operator= (const TiledMapRenderer&) = delete;
+
+	const std::shared_ptr<TiledMap>& getMap () const {
+		return map;
+	}
+
+	/** Draws what the camera sees, with its combined matrix. */
+	void setView (const OrthographicCamera& camera);
+
+	/** Draws the area x, y, width, height of the world, in world units, with the projection. */
+	void setView (const Matrix4& projection, float x, float y, float width, float height);
+
+	/** Advances the animated tiles.
+	 * @param delta the time since the last update in seconds */
+	void update (float delta) {
+		animationTime += delta * 1000.0;
+	}
+
+	/** Renders the visible layers. */
+	void render ();
+
+	/** Renders the layers with the indices, visible or not, in that order. */
+	void render (const std::vector<int>& layers);
+
+	/** Releases every chunk, they are built again when seen. Use after changing tiles or tile sets outside of
+	 * {@link TiledMapTileLayer#setCell}. */
+	void invalidate () {
+		chunks.clear();
+	}
+
+	/** @return the number of chunks built during the last render */
+	int getBuiltChunks () const {
+		return builtChunks;
+	}
+
+	/** @return the number of chunks drawn during the last render */
+	int getDrawnChunks () const {
+		return drawnChunks;
+	}
+
+	/** @return the number of chunks built and kept */
+	int getCachedChunks () const {
+		return chunks.size();
+	}
+};
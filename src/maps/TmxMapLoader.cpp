@@ -0,0 +1,309 @@
+#include "TmxMapLoader.h"
+#include "../graphics/Texture.h"
+#include "../utils/MappedFile.h"
+#include "../utils/XmlReader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+namespace {
+	struct LoadContext{
+		const TmxMapLoader::Parameters& parameters;
+		std::map<std::string, std::shared_ptr<Texture>> textures;
+	};
+
+	std::string getDirectory (const std::string& path){
+		const size_t slash = path.find_last_of("/\\");
+		return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+	}
+
+	bool isSpace (char c){
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+
+	std::shared_ptr<Texture> loadTexture (LoadContext& context, const std::string& path){
+		auto loaded = context.textures.find(path);
+		if (loaded != context.textures.end()) return loaded->second;
+		const TmxMapLoader::Parameters& parameters = context.parameters;
+		std::shared_ptr<Texture> texture = std::make_shared<Texture>(path, parameters.textureMinFilter, parameters.textureMagFilter,
+			GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, parameters.generateMipMaps);
+		if (texture->getTextureObjectHandle() == 0 || texture->getWidth() <= 0) {
+			SDL_Log("TmxMapLoader: cannot load the image %s", path.c_str());
+			texture = nullptr;
+		}
+		context.textures[path] = texture;
+		return texture;
+	}
+
+	void loadTileSet (LoadContext& context, TiledMap& map, const XmlReader::Element& element, uint32_t firstGid,
+		const std::string& directory){
+		std::shared_ptr<TiledMapTileSet> tileSet = std::make_shared<TiledMapTileSet>();
+		tileSet->name = element.getAttribute("name");
+		tileSet->firstGid = firstGid;
+		const int tileWidth = element.getIntAttribute("tilewidth", map.tileWidth);
+		const int tileHeight = element.getIntAttribute("tileheight", map.tileHeight);
+		const int spacing = element.getIntAttribute("spacing", 0);
+		const int margin = element.getIntAttribute("margin", 0);
+		float offsetX = 0, offsetY = 0;
+		if (const XmlReader::Element* offset = element.getChildByName("tileoffset")) {
+			offsetX = offset->getFloatAttribute("x", 0);
+			//TMX offsets point down
+			offsetY = -offset->getFloatAttribute("y", 0);
+		}
+
+		//A single image split into a grid of tiles
+		if (const XmlReader::Element* image = element.getChildByName("image")) {
+			std::shared_ptr<Texture> texture = loadTexture(context, directory + image->getAttribute("source"));
+			if (texture && tileWidth > 0 && tileHeight > 0) {
+				const int imageWidth = image->getIntAttribute("width", texture->getWidth());
+				const int imageHeight = image->getIntAttribute("height", texture->getHeight());
+				const int columns = element.getIntAttribute("columns",
+					(imageWidth - 2 * margin + spacing) / (tileWidth + spacing));
+				const int rows = (imageHeight - 2 * margin + spacing) / (tileHeight + spacing);
+				const int tileCount = element.getIntAttribute("tilecount", columns * rows);
+				for (int id = 0; columns > 0 && id < tileCount; id++) {
+					TiledMapTile& tile = tileSet->getOrCreate(id);
+					tile.region = TextureRegion(texture, margin + id % columns * (tileWidth + spacing),
+						margin + id / columns * (tileHeight + spacing), tileWidth, tileHeight);
+					tile.offsetX = offsetX;
+					tile.offsetY = offsetY;
+				}
+			}
+		}
+
+		for (const XmlReader::Element* tileElement : element.getChildrenByName("tile")) {
+			TiledMapTile& tile = tileSet->getOrCreate(tileElement->getIntAttribute("id", 0));
+			//A tile of an image collection
+			if (const XmlReader::Element* image = tileElement->getChildByName("image")) {
+				std::shared_ptr<Texture> texture = loadTexture(context, directory + image->getAttribute("source"));
+				if (texture) tile.region = TextureRegion(texture);
+				tile.offsetX = offsetX;
+				tile.offsetY = offsetY;
+			}
+			if (const XmlReader::Element* animation = tileElement->getChildByName("animation")) {
+				for (const XmlReader::Element* frame : animation->getChildrenByName("frame")) {
+					const int duration = std::max(0, frame->getIntAttribute("duration", 0));
+					tile.frames.push_back({&tileSet->getOrCreate(frame->getIntAttribute("tileid", 0)), duration});
+					tile.animationDuration += duration;
+				}
+			}
+		}
+		map.addTileSet(tileSet);
+	}
+
+	int getBase64Value (char c){
+		if (c >= 'A' && c <= 'Z') return c - 'A';
+		if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+		if (c >= '0' && c <= '9') return c - '0' + 52;
+		if (c == '+') return 62;
+		if (c == '/') return 63;
+		//Padding
+		return 0;
+	}
+
+	/** Decodes count bytes, starting with the byte at offset of the decoded data, from base64 text without whitespace. */
+	void decodeBase64 (const char* text, size_t length, size_t offset, size_t count, unsigned char* out){
+		//Every 4 characters hold 3 bytes, start at the group holding the first byte
+		size_t group = offset / 3;
+		size_t skip = offset % 3;
+		while (count > 0 && group * 4 + 4 <= length) {
+			const char* chars = text + group * 4;
+			const int a = getBase64Value(chars[0]), b = getBase64Value(chars[1]);
+			const int c = getBase64Value(chars[2]), d = getBase64Value(chars[3]);
+			const unsigned char bytes[3] = {(unsigned char)((a << 2) | (b >> 4)), (unsigned char)((b << 4) | (c >> 2)),
+				(unsigned char)((c << 6) | (d & 0x3F))};
+			for (; skip < 3 && count > 0; skip++, count--)
+				*out++ = bytes[skip];
+			skip = 0;
+			group++;
+		}
+		//Truncated data reads as empty cells
+		for (; count > 0; count--)
+			*out++ = 0;
+	}
+
+	/** The offsets of the rows of CSV tile data, found by counting the separators on first use. */
+	struct CsvIndex{
+		std::vector<size_t> rows;
+		bool built = false;
+	};
+
+	TiledMapTileLayer::Source createBase64Source (std::shared_ptr<MappedFile> file, const XmlReader::Element& data,
+		int layerWidth){
+		const char* text = data.getRawText();
+		size_t length = data.getRawTextLength();
+		while (length > 0 && isSpace(*text)) {
+			text++;
+			length--;
+		}
+		while (length > 0 && isSpace(text[length - 1])) length--;
+
+		//Data wrapped over several lines is copied without whitespace to keep offsets computable
+		std::shared_ptr<std::string> stripped;
+		for (size_t i = 0; i < length; i++) {
+			if (!isSpace(text[i])) continue;
+			stripped = std::make_shared<std::string>();
+			stripped->reserve(length);
+			for (size_t j = 0; j < length; j++)
+				if (!isSpace(text[j])) *stripped += text[j];
+			text = stripped->data();
+			length = stripped->size();
+			file = nullptr;
+			break;
+		}
+
+		return [file, stripped, text, length, layerWidth](int x, int y, int width, int height, uint32_t* out) {
+			std::vector<unsigned char> bytes((size_t)width * 4);
+			for (int row = 0; row < height; row++) {
+				decodeBase64(text, length, ((size_t)(y + row) * layerWidth + x) * 4, bytes.size(), bytes.data());
+				for (int column = 0; column < width; column++) {
+					const unsigned char* cell = &bytes[column * 4];
+					*out++ = cell[0] | (uint32_t)cell[1] << 8 | (uint32_t)cell[2] << 16 | (uint32_t)cell[3] << 24;
+				}
+			}
+		};
+	}
+
+	TiledMapTileLayer::Source createCsvSource (std::shared_ptr<MappedFile> file, const XmlReader::Element& data,
+		int layerWidth, int layerHeight){
+		const char* text = data.getRawText();
+		const size_t length = data.getRawTextLength();
+		std::shared_ptr<CsvIndex> index = std::make_shared<CsvIndex>();
+		return [file, text, length, layerWidth, layerHeight, index](int x, int y, int width, int height, uint32_t* out) {
+			if (!index->built) {
+				index->rows.reserve(layerHeight);
+				index->rows.push_back(0);
+				size_t values = 0;
+				for (const char* comma = text; (int)index->rows.size() < layerHeight; comma++) {
+					comma = (const char*)memchr(comma, ',', length - (comma - text));
+					if (!comma) break;
+					if (++values % layerWidth == 0) index->rows.push_back(comma + 1 - text);
+				}
+				index->built = true;
+			}
+			for (int row = y; row < y + height; row++) {
+				size_t position = row < (int)index->rows.size() ? index->rows[row] : length;
+				for (int column = 0; column < x && position < length; column++) {
+					const char* comma = (const char*)memchr(text + position, ',', length - position);
+					position = comma ? comma + 1 - text : length;
+				}
+				for (int column = 0; column < width; column++) {
+					while (position < length && (isSpace(text[position]) || text[position] == ',')) position++;
+					uint32_t cell = 0;
+					for (; position < length && text[position] >= '0' && text[position] <= '9'; position++)
+						cell = cell * 10 + (text[position] - '0');
+					*out++ = cell;
+				}
+			}
+		};
+	}
+
+	std::shared_ptr<TiledMapTileLayer> loadTileLayer (const std::shared_ptr<MappedFile>& file, const TiledMap& map,
+		const XmlReader::Element& element){
+		const int width = element.getIntAttribute("width", map.width);
+		const int height = element.getIntAttribute("height", map.height);
+		const std::string name = element.getAttribute("name");
+		TiledMapTileLayer::Source source;
+		if (const XmlReader::Element* data = element.getChildByName("data")) {
+			const std::string encoding = data->getAttribute("encoding");
+			const std::string compression = data->getAttribute("compression");
+			if (data->getChildByName("chunk"))
+				SDL_Log("TmxMapLoader: layer %s is infinite, which is not supported", name.c_str());
+			else if (!compression.empty())
+				SDL_Log("TmxMapLoader: layer %s uses %s compression, which is not supported", name.c_str(), compression.c_str());
+			else if (encoding == "base64")
+				source = createBase64Source(file, *data, width);
+			else if (encoding == "csv")
+				source = createCsvSource(file, *data, width, height);
+			else if (encoding.empty()) {
+				//XML elements, there is no offset to decode them lazily
+				std::shared_ptr<std::vector<uint32_t>> cells = std::make_shared<std::vector<uint32_t>>();
+				for (const XmlReader::Element* tile : data->getChildrenByName("tile"))
+					cells->push_back(strtoul(tile->getAttribute("gid", "0").c_str(), nullptr, 10));
+				cells->resize((size_t)width * height, 0);
+				source = [cells, width](int x, int y, int blockWidth, int blockHeight, uint32_t* out) {
+					for (int row = y; row < y + blockHeight; row++)
+						out = std::copy(cells->begin() + (size_t)row * width + x, cells->begin() + (size_t)row * width + x + blockWidth,
+							out);
+				};
+			} else
+				SDL_Log("TmxMapLoader: layer %s uses the unknown encoding %s", name.c_str(), encoding.c_str());
+		}
+
+		std::shared_ptr<TiledMapTileLayer> layer = std::make_shared<TiledMapTileLayer>(width, height, source);
+		layer->name = name;
+		return layer;
+	}
+
+	void loadLayers (const std::shared_ptr<MappedFile>& file, TiledMap& map, const XmlReader::Element& parent, bool visible,
+		float opacity, float offsetX, float offsetY){
+		for (int i = 0; i < parent.getChildCount(); i++) {
+			const XmlReader::Element& element = *parent.getChild(i);
+			const bool layerVisible = visible && element.getIntAttribute("visible", 1) != 0;
+			const float layerOpacity = opacity * element.getFloatAttribute("opacity", 1);
+			const float layerOffsetX = offsetX + element.getFloatAttribute("offsetx", 0);
+			//TMX offsets point down
+			const float layerOffsetY = offsetY - element.getFloatAttribute("offsety", 0);
+			if (element.getName() == "group") {
+				loadLayers(file, map, element, layerVisible, layerOpacity, layerOffsetX, layerOffsetY);
+			} else if (element.getName() == "layer") {
+				std::shared_ptr<TiledMapTileLayer> layer = loadTileLayer(file, map, element);
+				layer->visible = layerVisible;
+				layer->opacity = layerOpacity;
+				layer->offsetX = layerOffsetX;
+				layer->offsetY = layerOffsetY;
+				map.layers.push_back(layer);
+			} else if (element.getName() == "objectgroup" || element.getName() == "imagelayer") {
+				SDL_Log("TmxMapLoader: skipping %s %s", element.getName().c_str(), element.getAttribute("name").c_str());
+			}
+		}
+	}
+}
+
+std::shared_ptr<TiledMap> TmxMapLoader::load (const std::string& path, const Parameters& parameters){
+	std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(path);
+	if (!file->isValid()) {
+		SDL_Log("TmxMapLoader: cannot read %s", path.c_str());
+		return nullptr;
+	}
+	std::unique_ptr<XmlReader::Element> root = XmlReader::parse((const char*)file->data(), file->size());
+	if (!root || root->getName() != "map") {
+		SDL_Log("TmxMapLoader: %s is not a TMX map", path.c_str());
+		return nullptr;
+	}
+
+	std::shared_ptr<TiledMap> map = std::make_shared<TiledMap>();
+	const std::string orientation = root->getAttribute("orientation", "orthogonal");
+	if (orientation == "isometric") map->orientation = TiledMap::ISOMETRIC;
+	else if (orientation != "orthogonal")
+		SDL_Log("TmxMapLoader: %s orientation of %s is not supported, using orthogonal", orientation.c_str(), path.c_str());
+	if (root->getIntAttribute("infinite", 0) != 0) SDL_Log("TmxMapLoader: %s is infinite, which is not supported", path.c_str());
+	map->width = root->getIntAttribute("width", 0);
+	map->height = root->getIntAttribute("height", 0);
+	map->tileWidth = root->getIntAttribute("tilewidth", 0);
+	map->tileHeight = root->getIntAttribute("tileheight", 0);
+
+	LoadContext context{parameters, {}};
+	const std::string directory = getDirectory(path);
+	for (const XmlReader::Element* tileSet : root->getChildrenByName("tileset")) {
+		const uint32_t firstGid = tileSet->getIntAttribute("firstgid", 1);
+		if (!tileSet->hasAttribute("source")) {
+			loadTileSet(context, *map, *tileSet, firstGid, directory);
+			continue;
+		}
+		//An external tile set, its image paths are relative to the TSX file
+		const std::string tileSetPath = directory + tileSet->getAttribute("source");
+		MappedFile tileSetFile(tileSetPath);
+		std::unique_ptr<XmlReader::Element> tileSetRoot = tileSetFile.isValid()
+			? XmlReader::parse((const char*)tileSetFile.data(), tileSetFile.size()) : nullptr;
+		if (!tileSetRoot || tileSetRoot->getName() != "tileset") {
+			SDL_Log("TmxMapLoader: cannot load the tile set %s", tileSetPath.c_str());
+			continue;
+		}
+		loadTileSet(context, *map, *tileSetRoot, firstGid, getDirectory(tileSetPath));
+	}
+
+	loadLayers(file, *map, *root, true, 1, 0, 0);
+	return map;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "TiledMap.h"
+#include "../GL.h"
+#include <memory>
+#include <string>
+
+/** Loads {@link TiledMap}s from the TMX format of the Tiled editor, with embedded or external (TSX) tile sets and tile
+ * animations. Orthogonal and isometric maps are supported, tile layers in CSV, uncompressed base64 or XML encoding.
+ * <p>
+ * The map file is memory mapped and kept open by its layers, which decode the cells of a block only when it is first accessed,
+ * see {@link TiledMapTileLayer}: base64 data is decoded at the offsets of the rows of the block, CSV data is indexed by row once,
+ * on the first access, and only the rows of the block are parsed. Compressed data (zlib, gzip, zstd) and infinite maps are not
+ * supported, such layers are loaded empty and reported through SDL_Log, as are object and image layers, which are skipped. */
+class TmxMapLoader{
+public:
+	struct Parameters{
+		GLenum textureMinFilter = GL_NEAREST;
+		GLenum textureMagFilter = GL_NEAREST;
+		bool generateMipMaps = false;
+	};
+
+	/** @return the map, or nullptr if the file cannot be read or parsed */
+	static std::shared_ptr<TiledMap> load (const std::string& path, const Parameters& parameters);
+
+	static std::shared_ptr<TiledMap> load (const std::string& path) {
+		return load(path, Parameters());
+	}
+};
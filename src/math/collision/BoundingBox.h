@@ -36,7 +36,7 @@ public:
 	 Vector3 max = Vector3();
 	/** @param out The {@link Vector3} to receive the center of the bounding box.
 	 * @return The vector specified with the out argument. */
-	 Vector3 getCenter (Vector3 out) {
+	 Vector3& getCenter (Vector3& out) {
 		return out.set(cnt);
 	}
 
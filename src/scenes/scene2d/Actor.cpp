@@ -0,0 +1,129 @@
+#include "Actor.h"
+#include "Group.h"
+#include <algorithm>
+#include <limits>
+
+void Actor::Bounds::merge (const Affine2& transform, const Bounds& other){
+	if (other.isEmpty()) return;
+	if (transform.m01 == 0 && transform.m10 == 0) {
+		//Only scaled and translated, two corners are enough
+		const float x0 = transform.m00 * other.minX + transform.m02, x1 = transform.m00 * other.maxX + transform.m02;
+		const float y0 = transform.m11 * other.minY + transform.m12, y1 = transform.m11 * other.maxY + transform.m12;
+		minX = std::min(minX, std::min(x0, x1));
+		maxX = std::max(maxX, std::max(x0, x1));
+		minY = std::min(minY, std::min(y0, y1));
+		maxY = std::max(maxY, std::max(y0, y1));
+		return;
+	}
+	const float xs[] = {other.minX, other.maxX, other.maxX, other.minX};
+	const float ys[] = {other.minY, other.minY, other.maxY, other.maxY};
+	for (int i = 0; i < 4; i++) {
+		const float x = transform.m00 * xs[i] + transform.m01 * ys[i] + transform.m02;
+		const float y = transform.m10 * xs[i] + transform.m11 * ys[i] + transform.m12;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+	}
+}
+
+Actor::Bounds Actor::Bounds::empty (){
+	const float max = std::numeric_limits<float>::max();
+	return Bounds{max, max, -max, -max};
+}
+
+void Actor::invalidateTransform (){
+	localDirty = true;
+	worldDirty = true;
+	//The bounds of the actor in the coordinates of the parent changed
+	if (parent) parent->invalidateBounds();
+}
+
+void Actor::invalidateBounds (){
+	for (Actor* actor = this; actor && !actor->boundsDirty; actor = actor->parent)
+		actor->boundsDirty = true;
+}
+
+void Actor::invalidateLayer (){
+	for (Group* group = parent; group; group = group->parent)
+		group->layerDirty = true;
+}
+
+void Actor::updateBounds (){
+	localBounds = Bounds{0, 0, width, height};
+}
+
+const Affine2& Actor::getLocalTransform (){
+	if (localDirty) {
+		if (!usesTransform() || (rotation == 0 && scaleX == 1 && scaleY == 1))
+			localTransform.setToTranslation(x, y);
+		else {
+			localTransform.setToTrnRotScl(x + originX, y + originY, rotation, scaleX, scaleY);
+			if (originX != 0 || originY != 0) localTransform.translate(-originX, -originY);
+		}
+		localDirty = false;
+	}
+	return localTransform;
+}
+
+void Actor::updateWorldTransform (const Affine2& parentTransform){
+	const Affine2& local = getLocalTransform();
+	if (parentTransform.m00 == 1 && parentTransform.m11 == 1 && parentTransform.m01 == 0 && parentTransform.m10 == 0) {
+		worldTransform.set(local);
+		worldTransform.m02 += parentTransform.m02;
+		worldTransform.m12 += parentTransform.m12;
+	} else
+		worldTransform.setToProduct(parentTransform, local);
+	translationOnly = worldTransform.isTranslation();
+	worldDirty = false;
+	worldTransformChanged();
+}
+
+Actor* Actor::hit (const Vector2& stageCoords, bool touchable){
+	if (touchable && this->touchable != Touchable::enabled) return nullptr;
+	float localX, localY;
+	if (translationOnly) {
+		localX = stageCoords.x - worldTransform.m02;
+		localY = stageCoords.y - worldTransform.m12;
+	} else {
+		Affine2 inverse(worldTransform);
+		if (inverse.det() == 0) return nullptr;
+		inverse.inv();
+		localX = inverse.m00 * stageCoords.x + inverse.m01 * stageCoords.y + inverse.m02;
+		localY = inverse.m10 * stageCoords.x + inverse.m11 * stageCoords.y + inverse.m12;
+	}
+	return localX >= 0 && localX < width && localY >= 0 && localY < height ? this : nullptr;
+}
+
+bool Actor::remove (){
+	return parent ? parent->removeActor(this) : false;
+}
+
+void Actor::setVisible (bool visible){
+	if (this->visible == visible) return;
+	this->visible = visible;
+	//Hidden actors are not part of the bounds of the parent, and their transforms are not kept current
+	worldDirty = true;
+	if (parent) parent->invalidateBounds();
+}
+
+void Actor::computeStageTransform (Affine2& transform){
+	transform.set(getLocalTransform());
+	for (Actor* actor = parent; actor; actor = actor->parent)
+		transform.preMul(actor->getLocalTransform());
+}
+
+Vector2& Actor::localToStageCoordinates (Vector2& localCoords){
+	Affine2 transform;
+	computeStageTransform(transform);
+	transform.applyTo(localCoords);
+	return localCoords;
+}
+
+Vector2& Actor::stageToLocalCoordinates (Vector2& stageCoords){
+	Affine2 transform;
+	computeStageTransform(transform);
+	if (transform.det() == 0) return stageCoords;
+	transform.inv().applyTo(stageCoords);
+	return stageCoords;
+}
@@ -0,0 +1,344 @@
+#pragma once
+#include "../../graphics/Color.h"
+#include "../../math/Affine2.h"
+#include "../../math/Vector2.h"
+#include <string>
+
+class Group;
+class Stage;
+class SpriteBatch;
+
+/** Determines how touch input events are distributed to an actor and any children. */
+enum class Touchable{
+	/** All touch input events will be received by the actor and any children. */
+	enabled,
+	/** No touch input events will be received by the actor or any children. */
+	disabled,
+	/** No touch input events will be received by the actor, but children will still receive events. */
+	childrenOnly
+};
+
+/** 2D scene graph node. An actor has a position, rectangular size, origin, scale, rotation, z index, and color. The position
+ * corresponds to the unrotated, unscaled bottom left corner of the actor, relative to its parent. The origin is relative to the
+ * position and is used for scale and rotation.
+ * <p>
+ * The transforms are cached: the local transform is computed when a setter changed it, the world transform, from the stage to
+ * the actor, when the local transform or one of an ancestor changed, and only once the parent is drawn or hit, so actors which
+ * are culled or not touched cost nothing when an ancestor moves. Draw with {@link #getWorldTransform()}, or with the world
+ * position alone when {@link #isTranslationOnly()}.
+ * <p>
+ * The actor also caches its bounds, the rectangle of the actor and of its visible descendants in its local coordinates, which
+ * the parent uses for culling and hit detection.
+ * @author mzechner
+ * @author Nathan Sweet */
+class Actor{
+public:
+	/** An axis aligned rectangle, empty when min > max. */
+	struct Bounds{
+		float minX, minY, maxX, maxY;
+
+		bool isEmpty () const {
+			return minX > maxX || minY > maxY;
+		}
+
+		bool overlaps (const Bounds& other) const {
+			return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+		}
+
+		bool contains (float x, float y) const {
+			return x >= minX && x <= maxX && y >= minY && y <= maxY;
+		}
+
+		/** Extends these bounds by the corners of the other bounds transformed by the matrix. */
+		void merge (const Affine2& transform, const Bounds& other);
+
+		static Bounds empty ();
+	};
+private:
+	friend class Group;
+	friend class Stage;
+
+	Stage* stage = nullptr;
+	Group* parent = nullptr;
+	/** the index in the children of the parent */
+	int index = -1;
+	std::string name;
+	bool visible = true;
+	Touchable touchable = Touchable::enabled;
+
+	Affine2 localTransform;
+	Affine2 worldTransform;
+	Bounds localBounds = Bounds{0, 0, 0, 0};
+	bool translationOnly = true;
+	/** whether the local transform must be computed again */
+	bool localDirty = true;
+	/** whether the world transform must be computed again, before the actor is drawn or hit */
+	bool worldDirty = true;
+	/** whether the bounds of the actor or of a descendant must be computed again, then also set for all ancestors */
+	bool boundsDirty = true;
+	/** whether the local bounds changed since the parent computed the bounds in stage coordinates */
+	bool stageBoundsDirty = true;
+
+	/** Computes the world transform from the one of the parent, which must be current. */
+	void updateWorldTransform (const Affine2& parentTransform);
+protected:
+	float x = 0, y = 0;
+	float width = 0, height = 0;
+	float originX = 0, originY = 0;
+	float scaleX = 1, scaleY = 1;
+	float rotation = 0;
+	Color color = Color(1, 1, 1, 1);
+
+	/** Marks the local transform, and so the world transform of the actor and its descendants, as changed. */
+	void invalidateTransform ();
+
+	/** Marks the bounds of the actor and of its ancestors as changed. */
+	void invalidateBounds ();
+
+	/** @return whether the rotation, scale and origin of the actor are part of its transform, see
+	 * {@link Group#setTransform(bool)} */
+	virtual bool usesTransform () const {
+		return true;
+	}
+
+	/** Computes the bounds of the actor in its local coordinates. */
+	virtual void updateBounds ();
+
+	/** Called when the world transform changed. */
+	virtual void worldTransformChanged () {
+	}
+
+	/** Called when the actor is added to or removed from a stage. */
+	virtual void setStage (Stage* stage) {
+		this->stage = stage;
+	}
+public:
+	Actor(){}
+	virtual ~Actor(){}
+
+	Actor (const Actor&) = delete;
+	Actor& operator= (const Actor&) = delete;
+
+	/** Draws the actor. The batch is configured to draw in the stage coordinate system, the transform of the actor is
+	 * {@link #getWorldTransform()}. The default implementation does nothing.
+	 * @param parentAlpha The parent alpha, to be multiplied with this actor's alpha, allowing the parent's alpha to affect all
+	 *           children. */
+	virtual void draw (SpriteBatch& batch, float parentAlpha) {
+	}
+
+	/** Returns the deepest visible actor that contains the point in stage coordinates, or nullptr. The default implementation
+	 * tests the rectangle of the actor.
+	 * @param touchable If true, hit detection will respect the {@link #setTouchable(Touchable) touchability}. */
+	virtual Actor* hit (const Vector2& stageCoords, bool touchable);
+
+	/** Removes this actor from its parent, if it has a parent. The parent may release the last reference to this actor.
+	 * @return whether the actor had a parent */
+	bool remove ();
+
+	Stage* getStage () const {
+		return stage;
+	}
+
+	Group* getParent () const {
+		return parent;
+	}
+
+	bool hasParent () const {
+		return parent != nullptr;
+	}
+
+	/** @return the index of the actor in the children of its parent, -1 without a parent */
+	int getZIndex () const {
+		return index;
+	}
+
+	const std::string& getName () const {
+		return name;
+	}
+
+	void setName (const std::string& name) {
+		this->name = name;
+	}
+
+	bool isVisible () const {
+		return visible;
+	}
+
+	/** If false, the actor will not be drawn and will not receive touch events. Default is true. */
+	void setVisible (bool visible);
+
+	Touchable getTouchable () const {
+		return touchable;
+	}
+
+	void setTouchable (Touchable touchable) {
+		this->touchable = touchable;
+	}
+
+	float getX () const {
+		return x;
+	}
+
+	float getY () const {
+		return y;
+	}
+
+	void setX (float x) {
+		setPosition(x, y);
+	}
+
+	void setY (float y) {
+		setPosition(x, y);
+	}
+
+	/** Sets the position of the actor's bottom left corner. */
+	void setPosition (float x, float y) {
+		if (this->x == x && this->y == y) return;
+		this->x = x;
+		this->y = y;
+		invalidateTransform();
+	}
+
+	/** Add x and y to current position */
+	void moveBy (float x, float y) {
+		setPosition(this->x + x, this->y + y);
+	}
+
+	float getWidth () const {
+		return width;
+	}
+
+	float getHeight () const {
+		return height;
+	}
+
+	void setWidth (float width) {
+		setSize(width, height);
+	}
+
+	void setHeight (float height) {
+		setSize(width, height);
+	}
+
+	void setSize (float width, float height) {
+		if (this->width == width && this->height == height) return;
+		this->width = width;
+		this->height = height;
+		invalidateBounds();
+		sizeChanged();
+	}
+
+	/** Set bounds the x, y, width, and height. */
+	void setBounds (float x, float y, float width, float height) {
+		setPosition(x, y);
+		setSize(width, height);
+	}
+
+	float getOriginX () const {
+		return originX;
+	}
+
+	float getOriginY () const {
+		return originY;
+	}
+
+	void setOrigin (float originX, float originY) {
+		if (this->originX == originX && this->originY == originY) return;
+		this->originX = originX;
+		this->originY = originY;
+		invalidateTransform();
+	}
+
+	float getScaleX () const {
+		return scaleX;
+	}
+
+	float getScaleY () const {
+		return scaleY;
+	}
+
+	void setScale (float scaleXY) {
+		setScale(scaleXY, scaleXY);
+	}
+
+	void setScale (float scaleX, float scaleY) {
+		if (this->scaleX == scaleX && this->scaleY == scaleY) return;
+		this->scaleX = scaleX;
+		this->scaleY = scaleY;
+		invalidateTransform();
+	}
+
+	float getRotation () const {
+		return rotation;
+	}
+
+	/** @param degrees counterclockwise, around the origin */
+	void setRotation (float degrees) {
+		if (rotation == degrees) return;
+		rotation = degrees;
+		invalidateTransform();
+	}
+
+	void rotateBy (float amountInDegrees) {
+		setRotation(rotation + amountInDegrees);
+	}
+
+	const Color& getColor () const {
+		return color;
+	}
+
+	void setColor (const Color& color) {
+		this->color.set(color);
+		invalidateLayer();
+	}
+
+	void setColor (float r, float g, float b, float a) {
+		color.set(r, g, b, a);
+		invalidateLayer();
+	}
+
+	/** Marks the layers of the ancestors as changed, see {@link Group#setLayerCached(bool)}. Changes of the transform, size,
+	 * visibility or children are detected, call this when the actor draws differently otherwise, e.g. with another region. */
+	void invalidateLayer ();
+
+	/** @return the transform from the actor to its parent */
+	const Affine2& getLocalTransform ();
+
+	/** @return the transform from the actor to the stage, current while the actor is drawn or hit */
+	const Affine2& getWorldTransform () const {
+		return worldTransform;
+	}
+
+	/** @return whether the world transform only translates, so the actor can be drawn at {@link #getWorldX()},
+	 * {@link #getWorldY()} with its width and height */
+	bool isTranslationOnly () const {
+		return translationOnly;
+	}
+
+	float getWorldX () const {
+		return worldTransform.m02;
+	}
+
+	float getWorldY () const {
+		return worldTransform.m12;
+	}
+
+	/** @return the bounds of the actor and its visible descendants in its local coordinates, current while the parent is drawn
+	 * or hit */
+	const Bounds& getLocalBounds () const {
+		return localBounds;
+	}
+
+	/** Computes the transform from the actor to the stage from the actor and its ancestors, without the caches. */
+	void computeStageTransform (Affine2& transform);
+
+	/** Transforms the specified point in the actor's coordinates to be in the stage's coordinates. */
+	Vector2& localToStageCoordinates (Vector2& localCoords);
+
+	/** Transforms the specified point in the stage's coordinates to the actor's local coordinate system. */
+	Vector2& stageToLocalCoordinates (Vector2& stageCoords);
+protected:
+	/** Called when the actor's size has been changed. */
+	virtual void sizeChanged () {
+	}
+};
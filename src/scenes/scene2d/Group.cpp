@@ -0,0 +1,269 @@
+#include "Group.h"
+#include "Stage.h"
+#include "../../graphics/VertexAttribute.h"
+#include "../../graphics/g2d/SpriteBatch.h"
+#include "../../graphics/glutils/FrameBuffer.h"
+#include <cmath>
+#include <limits>
+
+/** layers are rounded up to multiples of this size, so small changes of the bounds reuse the same frame buffer format */
+static const int LAYER_GRANULARITY = 32;
+/** larger subtrees are drawn directly */
+static const int MAX_LAYER_SIZE = 4096;
+
+Group::~Group(){
+	freeLayer();
+	//Children referenced elsewhere outlive the group, they must not point to it
+	for (const std::shared_ptr<Actor>& child : children) {
+		child->parent = nullptr;
+		child->index = -1;
+		child->setStage(nullptr);
+	}
+}
+
+void Group::propagate (){
+	if (!childrenDirty) return;
+	for (const std::shared_ptr<Actor>& child : children)
+		child->worldDirty = true;
+	childrenDirty = false;
+}
+
+void Group::updateChild (int index){
+	Actor& child = *children[index];
+	if (child.worldDirty) {
+		child.updateWorldTransform(getWorldTransform());
+		if (getStage()) getStage()->updatedTransforms++;
+	} else if (!child.stageBoundsDirty)
+		return;
+	Bounds& bounds = childBounds[index];
+	bounds = Bounds::empty();
+	bounds.merge(child.getWorldTransform(), child.getLocalBounds());
+	child.stageBoundsDirty = false;
+}
+
+void Group::reindex (int from){
+	for (int i = from, n = children.size(); i < n; i++)
+		children[i]->index = i;
+}
+
+void Group::updateBounds (){
+	Bounds bounds = width > 0 || height > 0 ? Bounds{0, 0, width, height} : Bounds::empty();
+	for (const std::shared_ptr<Actor>& child : children) {
+		if (!child->isVisible()) continue;
+		if (child->boundsDirty) {
+			child->updateBounds();
+			child->boundsDirty = false;
+			child->stageBoundsDirty = true;
+		}
+		bounds.merge(child->getLocalTransform(), child->getLocalBounds());
+	}
+	localBounds = bounds;
+	//Only called when the group or a descendant changed
+	layerDirty = true;
+}
+
+void Group::setStage (Stage* stage){
+	if (!stage) freeLayer();
+	Actor::setStage(stage);
+	for (const std::shared_ptr<Actor>& child : children)
+		child->setStage(stage);
+}
+
+void Group::draw (SpriteBatch& batch, float parentAlpha){
+	if (layerCached && updateLayer(batch))
+		drawLayer(batch, parentAlpha * color.a);
+	else
+		drawChildren(batch, parentAlpha * color.a);
+}
+
+void Group::setLayerCached (bool layerCached){
+	if (this->layerCached == layerCached) return;
+	this->layerCached = layerCached;
+	if (!layerCached) freeLayer();
+	layerDirty = true;
+}
+
+void Group::freeLayer (){
+	if (layer) layerPool->free(layer);
+	layer = nullptr;
+	layerPool = nullptr;
+	layerDirty = true;
+}
+
+bool Group::updateLayer (SpriteBatch& batch){
+	Stage* stage = getStage();
+	if (!stage) return false;
+	if (layer && !layerDirty) return true;
+
+	const Bounds& bounds = getLocalBounds();
+	if (bounds.isEmpty()) return false;
+	const int x = (int)std::floor(bounds.minX), y = (int)std::floor(bounds.minY);
+	const int width = (int)std::ceil(bounds.maxX) - x, height = (int)std::ceil(bounds.maxY) - y;
+	const int textureWidth = (width + LAYER_GRANULARITY - 1) / LAYER_GRANULARITY * LAYER_GRANULARITY;
+	const int textureHeight = (height + LAYER_GRANULARITY - 1) / LAYER_GRANULARITY * LAYER_GRANULARITY;
+	if (width <= 0 || height <= 0 || textureWidth > MAX_LAYER_SIZE || textureHeight > MAX_LAYER_SIZE) {
+		freeLayer();
+		return false;
+	}
+	//The children are rendered in the coordinates of the group, so moving the group keeps the layer
+	Affine2 stageToGroup(getWorldTransform());
+	if (stageToGroup.det() == 0) return false;
+	stageToGroup.inv();
+
+	if (!layer || layer->getWidth() != textureWidth || layer->getHeight() != textureHeight) {
+		freeLayer();
+		layerPool = stage->getFrameBufferPool();
+		layer = layerPool->obtain(FrameBuffer::Format(textureWidth, textureHeight));
+		if (!layer) {
+			layerPool = nullptr;
+			return false;
+		}
+	}
+	layerX = x;
+	layerY = y;
+	layerWidth = width;
+	layerHeight = height;
+
+	const Matrix4 stageProjection(batch.getProjectionMatrix());
+	const GLenum srcColor = batch.getBlendSrcFunc(), dstColor = batch.getBlendDstFunc();
+	const GLenum srcAlpha = batch.getBlendSrcFuncAlpha(), dstAlpha = batch.getBlendDstFuncAlpha();
+	Matrix4 projection, groupTransform;
+	projection.setToOrtho2D(x, y, textureWidth, textureHeight);
+	projection.mul(groupTransform.set(stageToGroup));
+
+	batch.end();
+	layer->begin();
+	static const GLfloat transparent[] = {0, 0, 0, 0};
+	glClearBufferfv(GL_COLOR, 0, transparent);
+	batch.setProjectionMatrix(projection);
+	//Keeps the coverage in alpha, the colors end up premultiplied
+	batch.setBlendFunctionSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	batch.begin();
+	//The layer holds the whole subtree, not only what is in view now
+	const Bounds cullArea = stage->cullArea;
+	const float max = std::numeric_limits<float>::max();
+	stage->cullArea = Bounds{-max, -max, max, max};
+	drawChildren(batch, 1);
+	stage->cullArea = cullArea;
+	batch.end();
+	layer->end();
+
+	batch.setBlendFunctionSeparate(srcColor, dstColor, srcAlpha, dstAlpha);
+	batch.setProjectionMatrix(stageProjection);
+	batch.begin();
+	layerDirty = false;
+	stage->layerRenders++;
+	return true;
+}
+
+void Group::drawLayer (SpriteBatch& batch, float alpha){
+	TextureRegion region(layer->getColorBufferTexture(), 0, 0, layerWidth, layerHeight);
+	//The frame buffer's origin is the bottom left
+	region.flip(false, true);
+	const GLenum srcColor = batch.getBlendSrcFunc(), dstColor = batch.getBlendDstFunc();
+	const GLenum srcAlpha = batch.getBlendSrcFuncAlpha(), dstAlpha = batch.getBlendDstFuncAlpha();
+	const float color = batch.getPackedColor();
+	batch.setBlendFunction(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	batch.setColor(alpha, alpha, alpha, alpha);
+	if (isTranslationOnly())
+		batch.draw(region, getWorldX() + layerX, getWorldY() + layerY, layerWidth, layerHeight);
+	else {
+		Affine2 transform(getWorldTransform());
+		transform.translate(layerX, layerY);
+		batch.draw(region, layerWidth, layerHeight, transform);
+	}
+	batch.setBlendFunctionSeparate(srcColor, dstColor, srcAlpha, dstAlpha);
+	batch.setPackedColor(color);
+}
+
+void Group::drawChildren (SpriteBatch& batch, float parentAlpha){
+	propagate();
+	Stage* stage = getStage();
+	const Bounds* cullArea = stage ? &stage->cullArea : nullptr;
+	for (int i = 0, n = children.size(); i < n; i++) {
+		Actor& child = *children[i];
+		if (!child.isVisible()) continue;
+		updateChild(i);
+		if (cullArea && !childBounds[i].overlaps(*cullArea)) {
+			stage->culledActors++;
+			continue;
+		}
+		child.draw(batch, parentAlpha);
+		if (stage) stage->drawnActors++;
+	}
+}
+
+Actor* Group::hit (const Vector2& stageCoords, bool touchable){
+	if (touchable && getTouchable() == Touchable::disabled) return nullptr;
+	propagate();
+	for (int i = children.size() - 1; i >= 0; i--) {
+		Actor& child = *children[i];
+		if (!child.isVisible()) continue;
+		updateChild(i);
+		if (!childBounds[i].contains(stageCoords.x, stageCoords.y)) continue;
+		if (Actor* hit = child.hit(stageCoords, touchable)) return hit;
+	}
+	if (touchable && getTouchable() == Touchable::childrenOnly) return nullptr;
+	return Actor::hit(stageCoords, touchable);
+}
+
+void Group::addActor (std::shared_ptr<Actor> actor){
+	addActorAt(children.size(), actor);
+}
+
+void Group::addActorAt (int index, std::shared_ptr<Actor> actor){
+	if (!actor) return;
+	for (Actor* ancestor = this; ancestor; ancestor = ancestor->getParent()) {
+		if (ancestor == actor.get()) {
+			SDL_Log("Group: cannot add an actor to itself or its descendants");
+			return;
+		}
+	}
+	if (actor->parent) actor->parent->removeActor(actor.get());
+	index = std::max(0, std::min(index, (int)children.size()));
+	children.insert(children.begin() + index, actor);
+	childBounds.insert(childBounds.begin() + index, Bounds::empty());
+	reindex(index);
+	actor->parent = this;
+	actor->worldDirty = true;
+	actor->invalidateBounds();
+	invalidateBounds();
+	if (actor->getStage() != getStage()) actor->setStage(getStage());
+}
+
+bool Group::removeActor (Actor* actor){
+	if (!actor || actor->parent != this) return false;
+	const int index = actor->index;
+	//Keep the actor alive until it is detached
+	std::shared_ptr<Actor> removed = children[index];
+	children.erase(children.begin() + index);
+	childBounds.erase(childBounds.begin() + index);
+	reindex(index);
+	actor->parent = nullptr;
+	actor->index = -1;
+	actor->setStage(nullptr);
+	invalidateBounds();
+	return true;
+}
+
+void Group::clearChildren (){
+	for (const std::shared_ptr<Actor>& child : children) {
+		child->parent = nullptr;
+		child->index = -1;
+		child->setStage(nullptr);
+	}
+	children.clear();
+	childBounds.clear();
+	invalidateBounds();
+}
+
+Actor* Group::findActor (const std::string& name) const {
+	for (const std::shared_ptr<Actor>& child : children)
+		if (child->getName() == name) return child.get();
+	for (const std::shared_ptr<Actor>& child : children) {
+		if (Group* group = dynamic_cast<Group*>(child.get())) {
+			if (Actor* actor = group->findActor(name)) return actor;
+		}
+	}
+	return nullptr;
+}
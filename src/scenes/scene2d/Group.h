@@ -0,0 +1,132 @@
+#pragma once
+#include "Actor.h"
+#include <memory>
+#include <vector>
+
+class FrameBuffer;
+class FrameBufferPool;
+
+/** 2D scene graph node that may contain other actors.
+ * <p>
+ * The children are kept in one array, with a parallel array of their bounds in stage coordinates, so drawing and hit detection
+ * cull the children by walking contiguous memory and only touch the children that overlap. Children are drawn in the order
+ * they were added, the last on top, and hit in the reverse order.
+ * <p>
+ * Actors draw with their world transform, so a group never has to change the transform matrix of the batch. A group with
+ * {@link #setTransform(bool)} false ignores its own rotation, scale and origin: its children are only moved by its position,
+ * which keeps their world transforms translations, the fast path of {@link Actor#isTranslationOnly()}.
+ * <p>
+ * A group with {@link #setLayerCached(bool)} renders its children once into a texture and then draws as a single quad of it,
+ * see there.
+ * @author mzechner
+ * @author Nathan Sweet */
+class Group: public Actor{
+	friend class Stage;
+	friend class Actor;
+
+	std::vector<std::shared_ptr<Actor>> children;
+	/** the bounds of each child in stage coordinates, valid for the children without worldDirty */
+	std::vector<Bounds> childBounds;
+	/** whether the world transform changed since the children were last brought up to date */
+	bool childrenDirty = false;
+	bool transform = true;
+
+	/** the texture the children are rendered into, see setLayerCached */
+	std::shared_ptr<FrameBuffer> layer;
+	std::shared_ptr<FrameBufferPool> layerPool;
+	/** the rectangle of the layer holding the children, in the coordinates of the group */
+	int layerX = 0, layerY = 0, layerWidth = 0, layerHeight = 0;
+	bool layerCached = false;
+	/** whether a descendant changed since the layer was rendered */
+	bool layerDirty = true;
+
+	/** Renders the children into the layer if they changed, between the begin and end of the batch.
+	 * @return whether the layer holds the children */
+	bool updateLayer (SpriteBatch& batch);
+
+	void drawLayer (SpriteBatch& batch, float alpha);
+
+	/** Returns the layer to the pool. */
+	void freeLayer ();
+
+	/** Passes a change of the world transform on to the children. */
+	void propagate ();
+
+	/** Brings the world transform and the bounds of the child up to date. */
+	void updateChild (int index);
+
+	void reindex (int from);
+protected:
+	bool usesTransform () const override {
+		return transform;
+	}
+
+	void updateBounds () override;
+
+	void worldTransformChanged () override {
+		childrenDirty = true;
+	}
+
+	void setStage (Stage* stage) override;
+
+	/** Draws all visible children overlapping the culling area of the stage. */
+	void drawChildren (SpriteBatch& batch, float parentAlpha);
+public:
+	Group(){}
+	~Group() override;
+
+	/** Draws the group and its children. The default implementation calls {@link #drawChildren}. */
+	void draw (SpriteBatch& batch, float parentAlpha) override;
+
+	Actor* hit (const Vector2& stageCoords, bool touchable) override;
+
+	/** Adds an actor as a child of this group, removing it from its previous parent. */
+	void addActor (std::shared_ptr<Actor> actor);
+
+	/** Adds an actor as a child of this group at a specific index, removing it from its previous parent.
+	 * @param index May be greater than the number of children. */
+	void addActorAt (int index, std::shared_ptr<Actor> actor);
+
+	/** Removes an actor from this group.
+	 * @return whether the actor was a child */
+	bool removeActor (Actor* actor);
+
+	/** Removes all actors from this group. */
+	void clearChildren ();
+
+	/** Returns the first actor found with the specified name, depth first. */
+	Actor* findActor (const std::string& name) const;
+
+	const std::vector<std::shared_ptr<Actor>>& getChildren () const {
+		return children;
+	}
+
+	bool hasChildren () const {
+		return !children.empty();
+	}
+
+	/** When true (the default), the group's rotation, scale and origin apply to its children. When false, only its position
+	 * does, and its children keep cheaper translation only transforms. */
+	void setTransform (bool transform) {
+		if (this->transform == transform) return;
+		this->transform = transform;
+		invalidateTransform();
+	}
+
+	bool isTransform () const {
+		return transform;
+	}
+
+	/** When true, the children are rendered once into a texture from the {@link Stage#getFrameBufferPool() pool of the stage},
+	 * and the group draws as a single quad of it until a descendant changes: its transform, size or visibility, its children,
+	 * or anything reported with {@link Actor#invalidateLayer()}. Moving, rotating, scaling or fading the group itself keeps the
+	 * layer. This saves the traversal and the overdraw of rarely changing subtrees with many actors, e.g. complex UI panels.
+	 * <p>
+	 * The layer has one texel per stage unit, so it is sharp when the stage maps units to pixels 1:1 and the group is drawn at
+	 * integer positions. The children are not culled while rendered into the layer. Default is false. */
+	void setLayerCached (bool layerCached);
+
+	bool isLayerCached () const {
+		return layerCached;
+	}
+};
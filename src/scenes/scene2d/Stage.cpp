@@ -0,0 +1,43 @@
+#include "Stage.h"
+#include "../../graphics/VertexAttribute.h"
+#include "../../graphics/g2d/SpriteBatch.h"
+
+Stage::Stage(float width, float height, std::shared_ptr<SpriteBatch> batch)
+	:batch(batch ? batch : std::make_shared<SpriteBatch>()),root(std::make_shared<Group>()),
+	frameBufferPool(std::make_shared<FrameBufferPool>()){
+	camera.setToOrtho(false, width, height);
+	root->setStage(this);
+}
+
+Stage::~Stage(){
+	root->setStage(nullptr);
+}
+
+void Stage::validate (){
+	if (root->boundsDirty) {
+		root->updateBounds();
+		root->boundsDirty = false;
+	}
+	if (root->worldDirty) root->updateWorldTransform(Affine2());
+}
+
+void Stage::draw (){
+	camera.update();
+	const float halfWidth = camera.viewportWidth * camera.zoom / 2, halfHeight = camera.viewportHeight * camera.zoom / 2;
+	cullArea = Actor::Bounds{camera.position.x - halfWidth, camera.position.y - halfHeight, camera.position.x + halfWidth,
+		camera.position.y + halfHeight};
+	drawnActors = culledActors = updatedTransforms = layerRenders = 0;
+	validate();
+	if (!root->isVisible()) return;
+
+	batch->setProjectionMatrix(camera.combined);
+	batch->begin();
+	root->draw(*batch, 1);
+	batch->end();
+}
+
+Actor* Stage::hit (const Vector2& stageCoords, bool touchable){
+	validate();
+	if (!root->isVisible()) return nullptr;
+	return root->hit(stageCoords, touchable);
+}
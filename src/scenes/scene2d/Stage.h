@@ -0,0 +1,104 @@
+#pragma once
+#include "Group.h"
+#include "../../OrthographicCamera.h"
+#include "../../graphics/glutils/FrameBufferPool.h"
+#include <memory>
+
+/** A 2D scene graph containing hierarchies of {@link Actor actors}, drawn with a {@link SpriteBatch} through an
+ * {@link OrthographicCamera} looking at the stage, its bottom left corner at 0, 0.
+ * <p>
+ * {@link #draw()} first brings the cached bounds up to date along the paths of the actors changed since the last draw, then
+ * walks the actors, skipping every actor, and its descendants, whose bounds don't overlap the view of the camera. Actors
+ * which didn't change and are not in view cost one bounds test per frame, so large hierarchies with few changes per frame
+ * stay cheap. The camera is assumed not to be rotated.
+ * <p>
+ * A stage has no actions and no event system: change actors directly, and find the actor under a point with {@link #hit}. */
+class Stage{
+	OrthographicCamera camera;
+	std::shared_ptr<SpriteBatch> batch;
+	std::shared_ptr<Group> root;
+	Actor::Bounds cullArea;
+	std::shared_ptr<FrameBufferPool> frameBufferPool;
+	int drawnActors = 0, culledActors = 0, updatedTransforms = 0, layerRenders = 0;
+
+	friend class Group;
+
+	/** Brings the bounds and the world transform of the root up to date. */
+	void validate ();
+public:
+	/** Creates a stage of the given size in world units, with its own batch if batch is nullptr. */
+	Stage(float width, float height, std::shared_ptr<SpriteBatch> batch = nullptr);
+
+	~Stage();
+
+	Stage (const Stage&) = delete;
+	Stage& operator= (const Stage&) = delete;
+
+	void draw ();
+
+	/** Adds an actor to the root of the stage. */
+	void addActor (std::shared_ptr<Actor> actor) {
+		root->addActor(actor);
+	}
+
+	/** Returns the deepest visible actor, and touchable if touchable is true, at the point in stage coordinates, or nullptr. */
+	Actor* hit (const Vector2& stageCoords, bool touchable = true);
+
+	/** Removes the root's children. */
+	void clear () {
+		root->clearChildren();
+	}
+
+	/** Returns the root group which holds all actors in the stage. */
+	Group& getRoot () {
+		return *root;
+	}
+
+	/** The camera looking at the stage, e.g. to scroll or zoom it. */
+	OrthographicCamera& getCamera () {
+		return camera;
+	}
+
+	SpriteBatch& getBatch () {
+		return *batch;
+	}
+
+	/** The pool the layers of the groups are obtained from, see {@link Group#setLayerCached(bool)}. */
+	const std::shared_ptr<FrameBufferPool>& getFrameBufferPool () const {
+		return frameBufferPool;
+	}
+
+	/** Sets the pool the layers are obtained from, e.g. to share it with other offscreen passes. Layers already obtained are
+	 * returned to the pool they came from. */
+	void setFrameBufferPool (std::shared_ptr<FrameBufferPool> frameBufferPool) {
+		if (frameBufferPool) this->frameBufferPool = frameBufferPool;
+	}
+
+	float getWidth () const {
+		return camera.viewportWidth;
+	}
+
+	float getHeight () const {
+		return camera.viewportHeight;
+	}
+
+	/** @return the number of actors drawn by the last {@link #draw()} */
+	int getDrawnActors () const {
+		return drawnActors;
+	}
+
+	/** @return the number of actors skipped by the last {@link #draw()} because they were not in view */
+	int getCulledActors () const {
+		return culledActors;
+	}
+
+	/** @return the number of world transforms computed by the last {@link #draw()} */
+	int getUpdatedTransforms () const {
+		return updatedTransforms;
+	}
+
+	/** @return the number of layers rendered again by the last {@link #draw()} */
+	int getLayerRenders () const {
+		return layerRenders;
+	}
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include "../Actor.h"
+#include "../../../graphics/VertexAttribute.h"
+#include "../../../graphics/g2d/SpriteBatch.h"
+#include "../../../graphics/g2d/TextureRegion.h"
+
+/** Displays a {@link TextureRegion} stretched to the size of the actor, tinted with its color.
+ * @author Nathan Sweet */
+class Image: public Actor{
+	TextureRegion region;
+public:
+	/** Creates an image the size of the region. */
+	Image(const TextureRegion& region):region(region) {
+		setSize(region.regionWidth, region.regionHeight);
+	}
+
+	void draw (SpriteBatch& batch, float parentAlpha) override {
+		batch.setColor(color.r, color.g, color.b, color.a * parentAlpha);
+		if (isTranslationOnly())
+			batch.draw(region, getWorldX(), getWorldY(), width, height);
+		else
+			batch.draw(region, width, height, getWorldTransform());
+	}
+
+	const TextureRegion& getRegion () const {
+		return region;
+	}
+
+	void setRegion (const TextureRegion& region) {
+		this->region = region;
+		invalidateLayer();
+	}
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+/** Provides bit flag constants for alignment.
+ * @author Nathan Sweet */
+class Align{
+public:
+	static const int center = 1 << 0;
+	static const int top = 1 << 1;
+	static const int bottom = 1 << 2;
+	static const int left = 1 << 3;
+	static const int right = 1 << 4;
+
+	static const int topLeft = top | left;
+	static const int topRight = top | right;
+	static const int bottomLeft = bottom | left;
+	static const int bottomRight = bottom | right;
+
+	static bool isLeft (int align) {
+		return (align & left) != 0;
+	}
+
+	static bool isRight (int align) {
+		return (align & right) != 0;
+	}
+
+	static bool isTop (int align) {
+		return (align & top) != 0;
+	}
+
+	static bool isBottom (int align) {
+		return (align & bottom) != 0;
+	}
+
+	static bool isCenterVertical (int align) {
+		return (align & top) == 0 && (align & bottom) == 0;
+	}
+
+	static bool isCenterHorizontal (int align) {
+		return (align & left) == 0 && (align & right) == 0;
+	}
+};
@@ -0,0 +1,73 @@
+#include "MappedFile.h"
+#include "../GL.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path){
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+            HANDLE fileMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (fileMapping != NULL) {
+                mapping = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+                if (mapping != nullptr) {
+                    fileHandle = file;
+                    mappingHandle = fileMapping;
+                    bytes = (const unsigned char*)mapping;
+                    length = (size_t)fileSize.QuadPart;
+                    return;
+                }
+                CloseHandle(fileMapping);
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file >= 0) {
+        struct stat status;
+        if (fstat(file, &status) == 0 && status.st_size > 0) {
+            void* mapped = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapped != MAP_FAILED) {
+                mapping = mapped;
+                bytes = (const unsigned char*)mapped;
+                length = status.st_size;
+            }
+        }
+        close(file);
+        if (mapping != nullptr) return;
+    }
+#endif
+
+    SDL2::RWops rw(SDL_RWFromFile(path.c_str(), "rb"));
+    if (!rw) return;
+    Sint64 size = SDL_RWsize(rw.get());
+    if (size <= 0) return;
+    buffer.resize(size);
+    if (SDL_RWread(rw.get(), buffer.data(), 1, size) != (size_t)size) {
+        buffer.clear();
+        return;
+    }
+    bytes = buffer.data();
+    length = buffer.size();
+}
+
+MappedFile::~MappedFile(){
+    if (mapping == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(mapping);
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+#else
+    munmap(mapping, length);
+#endif
+}
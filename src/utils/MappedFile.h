@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/** Read-only view of a whole file, memory mapped where the platform allows it so parsers can reference the content without
+ * copying. Falls back to reading the file into memory through SDL, which also covers Android assets packed in the APK. */
+class MappedFile{
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+    std::vector<unsigned char> buffer;
+    void* mapping = nullptr;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+public:
+    MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    /** @return whether the file could be opened */
+    bool isValid () const {return bytes != nullptr;}
+
+    /** @return whether the content is mapped rather than copied into memory */
+    bool isMapped () const {return mapping != nullptr;}
+
+    const unsigned char* data () const {return bytes;}
+    size_t size () const {return length;}
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <algorithm>
+#include <atomic>
+
+/** A fixed set of worker threads executing submitted tasks in order. Tasks must not touch GL, which is only current on the
+ * render thread; hand results back to it instead, e.g. through a queue polled once per frame. */
+class ThreadPool{
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+
+    void work () {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this]{return stopping || !tasks.empty();});
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+public:
+    /** @param threads the number of workers, 0 for one less than the number of cores, at least one */
+    ThreadPool(int threads = 0){
+        if (threads <= 0) threads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+        for (int i = 0; i < threads; i++)
+            workers.emplace_back(&ThreadPool::work, this);
+    }
+
+    /** Finishes the queued tasks and joins the workers. */
+    ~ThreadPool(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator= (const ThreadPool&) = delete;
+
+    /** Queues the task.
+     * @return the future receiving the result of the task */
+    template<class F>
+    auto submit (F task) -> std::future<decltype(task())> {
+        typedef decltype(task()) Result;
+        std::shared_ptr<std::packaged_task<Result()>> packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace_back([packaged]{(*packaged)();});
+        }
+        condition.notify_one();
+        return result;
+    }
+
+    /** Splits [begin, end) into chunks of at least grain indices and runs body(chunkBegin, chunkEnd) for each on the workers and
+     * the calling thread, returning once all chunks are done. Must not be called from a task of this pool. */
+    void parallelFor (int begin, int end, int grain, const std::function<void(int,int)>& body) {
+        int count = end - begin;
+        if (count <= 0) return;
+        int chunks = std::min((int)workers.size() + 1, std::max(1, count / std::max(1, grain)));
+        if (chunks == 1) {
+            body(begin, end);
+            return;
+        }
+
+        std::atomic<int> next(0);
+        const int chunkSize = (count + chunks - 1) / chunks;
+        auto run = [&]{
+            int chunk;
+            while ((chunk = next++) < chunks) {
+                int chunkBegin = begin + chunk * chunkSize;
+                body(chunkBegin, std::min(end, chunkBegin + chunkSize));
+            }
+        };
+        std::vector<std::future<void>> helpers;
+        for (int i = 0; i < chunks - 1; i++) helpers.push_back(submit(run));
+        run();
+        for (std::future<void>& helper : helpers) helper.wait();
+    }
+
+    /** @return the number of worker threads */
+    int size () {
+        return workers.size();
+    }
+
+    /** @return the pool shared by the library, created on first use */
+    static ThreadPool& getShared () {
+        static ThreadPool shared;
+        return shared;
+    }
+};
@@ -0,0 +1,251 @@
+#include "XmlReader.h"
+#include "../GL.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    bool isSpace (char c){
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    bool isNameChar (char c){
+        return !isSpace(c) && c != '=' && c != '>' && c != '/' && c != '<' && c != '"' && c != '\'' && c != '?';
+    }
+
+    bool startsWith (const char* data, size_t length, size_t position, const char* prefix){
+        const size_t prefixLength = strlen(prefix);
+        return position + prefixLength <= length && memcmp(data + position, prefix, prefixLength) == 0;
+    }
+
+    /** @return the position of the text at or after position, or length if not found */
+    size_t find (const char* data, size_t length, size_t position, const char* text){
+        const size_t textLength = strlen(text);
+        for (; position + textLength <= length; position++) {
+            const void* first = memchr(data + position, text[0], length - position);
+            if (!first) break;
+            position = (const char*)first - data;
+            if (position + textLength <= length && memcmp(data + position, text, textLength) == 0) return position;
+        }
+        return length;
+    }
+
+    /** Appends the code point as UTF-8. */
+    void appendUtf8 (std::string& out, unsigned long code){
+        if (code < 0x80) out += (char)code;
+        else if (code < 0x800) {
+            out += (char)(0xC0 | (code >> 6));
+            out += (char)(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += (char)(0xE0 | (code >> 12));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        } else {
+            out += (char)(0xF0 | (code >> 18));
+            out += (char)(0x80 | ((code >> 12) & 0x3F));
+            out += (char)(0x80 | ((code >> 6) & 0x3F));
+            out += (char)(0x80 | (code & 0x3F));
+        }
+    }
+}
+
+const std::string& XmlReader::Element::getAttribute (const std::string& name, const std::string& defaultValue) const{
+    auto attribute = attributes.find(name);
+    return attribute == attributes.end() ? defaultValue : attribute->second;
+}
+
+int XmlReader::Element::getIntAttribute (const std::string& name, int defaultValue) const{
+    auto attribute = attributes.find(name);
+    return attribute == attributes.end() ? defaultValue : (int)strtol(attribute->second.c_str(), nullptr, 10);
+}
+
+float XmlReader::Element::getFloatAttribute (const std::string& name, float defaultValue) const{
+    auto attribute = attributes.find(name);
+    return attribute == attributes.end() ? defaultValue : strtof(attribute->second.c_str(), nullptr);
+}
+
+bool XmlReader::Element::getBooleanAttribute (const std::string& name, bool defaultValue) const{
+    auto attribute = attributes.find(name);
+    if (attribute == attributes.end()) return defaultValue;
+    return attribute->second == "true" || attribute->second == "1";
+}
+
+XmlReader::Element* XmlReader::Element::getChildByName (const std::string& name) const{
+    for (const std::unique_ptr<Element>& child : children)
+        if (child->name == name) return child.get();
+    return nullptr;
+}
+
+std::vector<XmlReader::Element*> XmlReader::Element::getChildrenByName (const std::string& name) const{
+    std::vector<Element*> result;
+    for (const std::unique_ptr<Element>& child : children)
+        if (child->name == name) result.push_back(child.get());
+    return result;
+}
+
+std::string XmlReader::Element::getText () const{
+    //CDATA sections are kept raw, everything else is unescaped
+    const char* text = getRawText();
+    const size_t length = getRawTextLength();
+    std::string result;
+    size_t position = 0;
+    while (position < length) {
+        if (startsWith(text, length, position, "<![CDATA[")) {
+            const size_t end = find(text, length, position, "]]>");
+            result.append(text + position + 9, end - position - 9);
+            position = end + 3;
+            continue;
+        }
+        if (startsWith(text, length, position, "<!--")) {
+            position = find(text, length, position, "-->") + 3;
+            continue;
+        }
+        size_t next = position;
+        while (next < length && text[next] != '<') next++;
+        result += unescape(text + position, next - position);
+        position = next;
+    }
+    return result;
+}
+
+std::string XmlReader::unescape (const char* text, size_t length){
+    std::string result;
+    result.reserve(length);
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] != '&') {
+            result += text[i];
+            continue;
+        }
+        const void* found = memchr(text + i, ';', length - i);
+        if (!found) {
+            result += text[i];
+            continue;
+        }
+        const size_t end = (const char*)found - text;
+        const std::string entity(text + i + 1, end - i - 1);
+        if (entity == "lt") result += '<';
+        else if (entity == "gt") result += '>';
+        else if (entity == "amp") result += '&';
+        else if (entity == "quot") result += '"';
+        else if (entity == "apos") result += '\'';
+        else if (entity.size() > 1 && entity[0] == '#') {
+            const bool hex = entity[1] == 'x' || entity[1] == 'X';
+            appendUtf8(result, strtoul(entity.c_str() + (hex ? 2 : 1), nullptr, hex ? 16 : 10));
+        } else {
+            result.append(text + i, end - i + 1);
+        }
+        i = end;
+    }
+    return result;
+}
+
+std::unique_ptr<XmlReader::Element> XmlReader::parse (const char* data, size_t length){
+    std::unique_ptr<Element> root;
+    Element* current = nullptr;
+    size_t position = 0;
+    while (position < length) {
+        if (data[position] != '<') {
+            //Skips text, e.g. megabytes of encoded tile data, at once
+            const void* tag = memchr(data + position, '<', length - position);
+            if (!tag) break;
+            position = (const char*)tag - data;
+        }
+        //Comments and CDATA are part of the text, which ends at the first child element
+        if (startsWith(data, length, position, "<!--")) {
+            position = find(data, length, position, "-->") + 3;
+            continue;
+        }
+        if (startsWith(data, length, position, "<![CDATA[")) {
+            position = find(data, length, position, "]]>") + 3;
+            continue;
+        }
+        if (startsWith(data, length, position, "<?") || startsWith(data, length, position, "<!")) {
+            const void* end = memchr(data + position, '>', length - position);
+            if (!end) break;
+            position = (const char*)end - data + 1;
+            continue;
+        }
+        if (startsWith(data, length, position, "</")) {
+            size_t nameEnd = position + 2;
+            while (nameEnd < length && isNameChar(data[nameEnd])) nameEnd++;
+            const std::string name(data + position + 2, nameEnd - position - 2);
+            if (!current || current->name != name) {
+                SDL_Log("XmlReader: unexpected closing tag </%s> at %u", name.c_str(), (unsigned int)position);
+                return nullptr;
+            }
+            if (current->children.empty()) current->textEnd = position;
+            current = current->parent;
+            const void* end = memchr(data + nameEnd, '>', length - nameEnd);
+            if (!end) break;
+            position = (const char*)end - data + 1;
+            if (!current) return root;
+            continue;
+        }
+
+        //An opening tag
+        const size_t tagBegin = position;
+        size_t cursor = position + 1;
+        while (cursor < length && isNameChar(data[cursor])) cursor++;
+        std::unique_ptr<Element> element(new Element());
+        element->name.assign(data + position + 1, cursor - position - 1);
+        element->source = data;
+        bool closed = false;
+        while (true) {
+            while (cursor < length && isSpace(data[cursor])) cursor++;
+            if (cursor >= length) {
+                SDL_Log("XmlReader: unterminated tag <%s>", element->name.c_str());
+                return nullptr;
+            }
+            if (data[cursor] == '>') {
+                cursor++;
+                break;
+            }
+            if (data[cursor] == '/' && cursor + 1 < length && data[cursor + 1] == '>') {
+                cursor += 2;
+                closed = true;
+                break;
+            }
+            const size_t nameBegin = cursor;
+            while (cursor < length && isNameChar(data[cursor])) cursor++;
+            const std::string name(data + nameBegin, cursor - nameBegin);
+            while (cursor < length && isSpace(data[cursor])) cursor++;
+            if (name.empty() || cursor >= length || data[cursor] != '=') {
+                SDL_Log("XmlReader: malformed attribute in <%s> at %u", element->name.c_str(), (unsigned int)cursor);
+                return nullptr;
+            }
+            cursor++;
+            while (cursor < length && isSpace(data[cursor])) cursor++;
+            const char quote = cursor < length ? data[cursor] : 0;
+            if (quote != '"' && quote != '\'') {
+                SDL_Log("XmlReader: unquoted attribute %s in <%s>", name.c_str(), element->name.c_str());
+                return nullptr;
+            }
+            const void* valueEnd = memchr(data + cursor + 1, quote, length - cursor - 1);
+            if (!valueEnd) {
+                SDL_Log("XmlReader: unterminated attribute %s in <%s>", name.c_str(), element->name.c_str());
+                return nullptr;
+            }
+            const size_t end = (const char*)valueEnd - data;
+            element->attributes[name] = unescape(data + cursor + 1, end - cursor - 1);
+            cursor = end + 1;
+        }
+        position = cursor;
+        element->textBegin = element->textEnd = position;
+
+        Element* added = element.get();
+        if (current) {
+            if (current->children.empty()) current->textEnd = tagBegin;
+            element->parent = current;
+            current->children.push_back(std::move(element));
+        } else if (!root) {
+            root = std::move(element);
+        } else {
+            SDL_Log("XmlReader: more than one root element");
+            return nullptr;
+        }
+        if (closed) {
+            if (added == root.get()) return root;
+        } else current = added;
+    }
+    SDL_Log("XmlReader: unexpected end of document");
+    return nullptr;
+}
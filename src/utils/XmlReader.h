@@ -0,0 +1,91 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** A small non-validating XML parser, enough for data formats such as TMX. The document is parsed into {@link Element}s, text
+ * content is not copied but referenced as a range of the parsed characters, so large text such as encoded tile data can be
+ * decoded later, piece by piece, straight from the source, e.g. a {@link MappedFile}.
+ * <p>
+ * Supports elements, attributes in single or double quotes, text, CDATA sections, comments, processing instructions and the
+ * predefined and numeric character references in attribute values and {@link Element#getText()}. Errors are reported through
+ * SDL_Log and end the parsing, {@link #parse} then returns nullptr. */
+class XmlReader{
+public:
+	class Element{
+		friend class XmlReader;
+		std::string name;
+		std::map<std::string, std::string> attributes;
+		std::vector<std::unique_ptr<Element>> children;
+		Element* parent = nullptr;
+		const char* source = nullptr;
+		size_t textBegin = 0, textEnd = 0;
+	public:
+		const std::string& getName () const {
+			return name;
+		}
+
+		Element* getParent () const {
+			return parent;
+		}
+
+		bool hasAttribute (const std::string& name) const {
+			return attributes.find(name) != attributes.end();
+		}
+
+		/** @return the attribute, or defaultValue if the element has none by this name */
+		const std::string& getAttribute (const std::string& name, const std::string& defaultValue) const;
+
+		std::string getAttribute (const std::string& name) const {
+			return getAttribute(name, std::string());
+		}
+
+		int getIntAttribute (const std::string& name, int defaultValue) const;
+
+		float getFloatAttribute (const std::string& name, float defaultValue) const;
+
+		bool getBooleanAttribute (const std::string& name, bool defaultValue) const;
+
+		const std::map<std::string, std::string>& getAttributes () const {
+			return attributes;
+		}
+
+		int getChildCount () const {
+			return children.size();
+		}
+
+		Element* getChild (int index) const {
+			return children[index].get();
+		}
+
+		/** @return the first child with the name, or nullptr */
+		Element* getChildByName (const std::string& name) const;
+
+		std::vector<Element*> getChildrenByName (const std::string& name) const;
+
+		/** @return the raw text directly inside the element, before the first child element, without unescaping */
+		const char* getRawText () const {
+			return source + textBegin;
+		}
+
+		size_t getRawTextLength () const {
+			return textEnd - textBegin;
+		}
+
+		/** @return the offset of the raw text in the parsed characters */
+		size_t getRawTextOffset () const {
+			return textBegin;
+		}
+
+		/** @return the text directly inside the element, unescaped */
+		std::string getText () const;
+	};
+
+	/** Parses the characters, which must outlive the returned elements as the text is referenced, not copied.
+	 * @return the root element, or nullptr if the document is malformed */
+	static std::unique_ptr<Element> parse (const char* data, size_t length);
+
+	/** Replaces the character references of the text. */
+	static std::string unescape (const char* text, size_t length);
+};